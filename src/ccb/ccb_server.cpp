@@ -34,6 +34,12 @@ ccbid_hash(const CCBID &ccbid) {
 	return ccbid;
 }
 
+	// The reconnect file holds one "ip ccbid cookie" line per record,
+	// appended as targets register.  When a record expires, a line of
+	// this keyword and the ccbid is appended rather than rewriting the
+	// whole file; older versions skip such lines as invalid.
+static char const RECONNECT_REMOVAL_KEYWORD[] = "expired";
+
 bool
 CCBServer::CCBIDFromString(CCBID &ccbid,char const *ccbid_str)
 {
@@ -69,9 +75,8 @@ CCBServer::CCBIDToContactString(char const *my_address,CCBID ccbid,std::string &
 
 CCBServer::CCBServer():
 	m_registered_handlers(false),
-	m_targets(ccbid_hash),
-	m_reconnect_info(ccbid_hash),
 	m_reconnect_fp(NULL),
+	m_reconnect_file_stale_lines(0),
 	m_last_reconnect_info_sweep(0),
 	m_reconnect_info_sweep_interval(0),
 	m_reconnect_allowed_from_any_ip(false),
@@ -79,7 +84,6 @@ CCBServer::CCBServer():
 	m_next_request_id(1),
 	m_read_buffer_size(0),
 	m_write_buffer_size(0),
-	m_requests(ccbid_hash),
 	m_polling_timer(-1),
 	m_epfd(-1)
 {
@@ -97,10 +101,15 @@ CCBServer::~CCBServer()
 		daemonCore->Cancel_Timer( m_polling_timer );
 		m_polling_timer = -1;
 	}
-	CCBTarget *target=NULL;
-	m_targets.startIterations();
-	while( m_targets.iterate(target) ) {
-		RemoveTarget(target);
+	std::vector<CCBTarget *> targets;
+	targets.reserve( m_targets.size() );
+	for( size_t slot = 0; slot < m_targets.capacity(); slot++ ) {
+		if( m_targets.at(slot) ) {
+			targets.push_back( m_targets.at(slot) );
+		}
+	}
+	for( size_t i = 0; i < targets.size(); i++ ) {
+		RemoveTarget( targets[i] );
 	}
 	if (-1 != m_epfd)
 	{
@@ -219,7 +228,7 @@ CCBServer::InitAndReconfig()
 	}
 	if( old_reconnect_fname.IsEmpty() &&
 		!m_reconnect_fname.IsEmpty() &&
-		m_reconnect_info.getNumElements() == 0 )
+		m_reconnect_info.size() == 0 )
 	{
 		// we are starting up from scratch, so load saved info
 		LoadReconnectInfo();
@@ -308,27 +317,44 @@ CCBServer::EpollSockets(int)
 		m_epfd = -1;
 		return -1;
 	}
-	struct epoll_event events[10];
+		// Handle up to 1000 ready targets per call, like before, but
+		// take them from the kernel in bigger batches; with many
+		// thousands of targets heartbeating, this handler is busy.
+	const int max_events = 100;
+	struct epoll_event events[max_events];
 	bool needs_poll = true;
 	unsigned counter = 0;
-	while (needs_poll && counter++ < 100)
+	while (needs_poll && counter++ < 10)
 	{
 		needs_poll = false;
-		int result = epoll_wait(epfd, events, 10, 0);
+		int result = epoll_wait(epfd, events, max_events, 0);
 		if (result > 0)
 		{
 			for (int idx=0; idx<result; idx++)
 			{
 				CCBID id = events[idx].data.u64;
-				CCBTarget *target = NULL;
-				if (m_targets.lookup(id, target) == -1)
+				CCBTarget *target = m_targets.lookup(id);
+				if (!target)
 				{
 					dprintf(D_FULLDEBUG, "No target found for CCBID %ld.\n", id);
 					continue;
 				}
-				if (target->getSock()->readReady())
+					// A target may send several messages at once (e.g. results
+					// for several requests); anything past the first is already
+					// buffered in the sock, so epoll will not tell us about it.
+				if (!target->getSock()->readReady())
+				{
+					continue;
+				}
+				for (int msgs = 0; msgs < 10; msgs++)
 				{
 					HandleRequestResultsMsg(target);
+						// the target is gone if that was a disconnect
+					if (m_targets.lookup(id) != target ||
+						!target->getSock()->msgReady())
+					{
+						break;
+					}
 				}
 			}
 			// We always want to drain out the queue of events.
@@ -403,13 +429,18 @@ CCBServer::PollSockets()
 		// too much.
 	if (m_epfd == -1)
 	{
-		CCBTarget *target=NULL;
-		m_targets.startIterations();
-		while( m_targets.iterate(target) ) {
-			if( target->getSock()->readReady() ) {
-				HandleRequestResultsMsg(target);
+			// handling a message may remove its target, so find the
+			// ready ones before touching the table
+		std::vector<CCBTarget *> ready;
+		for( size_t slot = 0; slot < m_targets.capacity(); slot++ ) {
+			CCBTarget *target = m_targets.at(slot);
+			if( target && target->getSock()->readReady() ) {
+				ready.push_back( target );
 			}
 		}
+		for( size_t i = 0; i < ready.size(); i++ ) {
+			HandleRequestResultsMsg( ready[i] );
+		}
 	}
 
 	// periodically call the following
@@ -841,21 +872,13 @@ CCBServer::RequestFinished( CCBServerRequest *request, bool success, char const
 CCBServerRequest *
 CCBServer::GetRequest( CCBID request_id )
 {
-	CCBServerRequest *result = NULL;
-	if( m_requests.lookup(request_id,result) == -1 ) {
-		return NULL;
-	}
-	return result;
+	return m_requests.lookup( request_id );
 }
 
 CCBTarget *
 CCBServer::GetTarget( CCBID ccbid )
 {
-	CCBTarget *result = NULL;
-	if( m_targets.lookup(ccbid,result) == -1 ) {
-		return NULL;
-	}
-	return result;
+	return m_targets.lookup( ccbid );
 }
 
 bool
@@ -908,8 +931,8 @@ CCBServer::ReconnectTarget( CCBTarget *target, CCBID reconnect_cookie )
 
 	reconnect_info->alive();
 
-	CCBTarget *existing = NULL;
-	if( m_targets.lookup(target->getCCBID(),existing) == 0 ) {
+	CCBTarget *existing = m_targets.lookup( target->getCCBID() );
+	if( existing ) {
 		// perhaps we haven't noticed yet that this existing target socket
 		// has become disconnected; get rid of it
 		dprintf(D_ALWAYS,
@@ -920,7 +943,7 @@ CCBServer::ReconnectTarget( CCBTarget *target, CCBID reconnect_cookie )
 		RemoveTarget( existing );
 	}
 
-	ASSERT( m_targets.insert(target->getCCBID(),target) == 0 );
+	ASSERT( m_targets.insert(target->getCCBID(),target) );
 	EpollAdd(target);
 
 	dprintf(D_FULLDEBUG,"CCB: reconnected target daemon %s with ccbid %lu\n",
@@ -943,20 +966,10 @@ CCBServer::AddTarget( CCBTarget *target )
 			continue;
 		}
 
-		if( m_targets.insert(target->getCCBID(),target) == 0 ) {
+		if( m_targets.insert(target->getCCBID(),target) ) {
 			EpollAdd(target);
 			break; // success
 		}
-
-		CCBTarget *existing = NULL;
-		if( m_targets.lookup(target->getCCBID(),existing) != 0 ) {
-				// That's odd: there is no conflicting ccbid, so why did
-				// the insert fail?!
-			EXCEPT( "CCB: failed to insert registered target ccbid %lu "
-					"for %s",
-					target->getCCBID(),
-					target->getSock()->peer_description());
-		}
 		// else this ccbid is already taken, so try again
 	}
 
@@ -993,7 +1006,7 @@ CCBServer::RemoveTarget( CCBTarget *target )
 		}
 	}
 
-	if( m_targets.remove(target->getCCBID()) != 0 ) {
+	if( !m_targets.remove(target->getCCBID()) ) {
 		EXCEPT("CCB: failed to remove target ccbid=%lu, %s",
 			   target->getCCBID(), target->getSock()->peer_description());
 	}
@@ -1013,19 +1026,9 @@ CCBServer::AddRequest( CCBServerRequest *request, CCBTarget *target )
 	while(true) {
 		request->setRequestID(m_next_request_id++);
 
-		if( m_requests.insert(request->getRequestID(),request) == 0 ) {
+		if( m_requests.insert(request->getRequestID(),request) ) {
 			break; // success
 		}
-
-		CCBServerRequest *existing = NULL;
-		if( m_requests.lookup(request->getRequestID(),existing) != 0 ) {
-				// That's odd: there is no conflicting id, so why did
-				// the insert fail?!
-			EXCEPT( "CCB: failed to insert request id %lu "
-					"for %s",
-					request->getRequestID(),
-					request->getSock()->peer_description());
-		}
 		// else this ccbid is already taken, so try again
 	}
 
@@ -1058,7 +1061,7 @@ CCBServer::RemoveRequest( CCBServerRequest *request )
 {
 	daemonCore->Cancel_Socket( request->getSock() );
 
-	if( m_requests.remove(request->getRequestID()) != 0 ) {
+	if( !m_requests.remove(request->getRequestID()) ) {
 		EXCEPT("CCB: failed to remove request id=%lu from %s for ccbid %lu",
 			   request->getRequestID(),
 			   request->getSock()->peer_description(),
@@ -1107,13 +1110,15 @@ CCBTarget::incPendingRequestResults(CCBServer *ccb_server)
 {
 	m_pending_request_results++;
 
-	if( !m_socket_is_registered ) {
+	if( !m_socket_is_registered && ccb_server->m_epfd == -1 ) {
 		// It is not essential that we register the target socket,
 		// because we also poll all target sockets periodically.
 		// However, while there are outstanding requests (and hence
 		// expectation of a reply from the target), we register
 		// the target socket just to reduce chances of a busy
 		// target having its incoming buffers fill up, etc.
+		// With epoll, we hear about the reply as soon as it
+		// arrives anyway, so DaemonCore need not watch it too.
 
 		int rc = daemonCore->Register_Socket (
 			m_sock,
@@ -1199,28 +1204,26 @@ CCBReconnectInfo::CCBReconnectInfo(CCBID ccbid,CCBID reconnect_cookie,char const
 CCBReconnectInfo *
 CCBServer::GetReconnectInfo(CCBID ccbid)
 {
-	CCBReconnectInfo *result = NULL;
-	if( m_reconnect_info.lookup(ccbid,result) == -1 ) {
-		return NULL;
-	}
-	return result;
+	return m_reconnect_info.lookup( ccbid );
 }
 
 void
 CCBServer::AddReconnectInfo( CCBReconnectInfo *reconnect_info )
 {
-	if( m_reconnect_info.insert(reconnect_info->getCCBID(),reconnect_info) == 0 ) {
+	if( m_reconnect_info.insert(reconnect_info->getCCBID(),reconnect_info) ) {
 		return;
 	}
 
-	ASSERT( m_reconnect_info.remove(reconnect_info->getCCBID()) == 0 );
-	ASSERT( m_reconnect_info.insert(reconnect_info->getCCBID(),reconnect_info) == 0);
+	CCBReconnectInfo *existing = m_reconnect_info.lookup(reconnect_info->getCCBID());
+	ASSERT( m_reconnect_info.remove(reconnect_info->getCCBID()) );
+	delete existing;
+	ASSERT( m_reconnect_info.insert(reconnect_info->getCCBID(),reconnect_info) );
 }
 
 void
 CCBServer::RemoveReconnectInfo( CCBReconnectInfo *reconnect_info )
 {
-	ASSERT( m_reconnect_info.remove(reconnect_info->getCCBID()) == 0 );
+	ASSERT( m_reconnect_info.remove(reconnect_info->getCCBID()) );
 	delete reconnect_info;
 }
 
@@ -1281,7 +1284,17 @@ CCBServer::LoadReconnectInfo()
 		CCBID ccbid,cookie;
 		char ip[128],ccbid_str[128],cookie_str[128];
 		ip[127] = ccbid_str[127] = cookie_str[127] = '\0';
-		if( sscanf(buf,"%127s %127s %127s",ip,ccbid_str,cookie_str)!=3 ||
+		int fields = sscanf(buf,"%127s %127s %127s",ip,ccbid_str,cookie_str);
+		if( fields == 2 && !strcmp(ip,RECONNECT_REMOVAL_KEYWORD) &&
+			CCBIDFromString( ccbid, ccbid_str ) )
+		{
+			CCBReconnectInfo *reconnect_info = GetReconnectInfo( ccbid );
+			if( reconnect_info ) {
+				RemoveReconnectInfo( reconnect_info );
+			}
+			continue;
+		}
+		if( fields!=3 ||
 			!CCBIDFromString( ccbid, ccbid_str) ||
 			!CCBIDFromString( cookie, cookie_str) )
 		{
@@ -1303,8 +1316,13 @@ CCBServer::LoadReconnectInfo()
 	// that may have been recently assigned.
 	m_next_ccbid += 100;
 
-	dprintf(D_ALWAYS,"CCB: loaded %d reconnect records from %s.\n",
-			m_reconnect_info.getNumElements(), m_reconnect_fname.Value());
+	dprintf(D_ALWAYS,"CCB: loaded %lu reconnect records from %s.\n",
+			(unsigned long)m_reconnect_info.size(), m_reconnect_fname.Value());
+
+	m_reconnect_file_stale_lines = line - m_reconnect_info.size();
+	if( m_reconnect_file_stale_lines > m_reconnect_info.size() ) {
+		SaveAllReconnectInfo();
+	}
 }
 
 bool
@@ -1334,6 +1352,32 @@ CCBServer::SaveReconnectInfo(CCBReconnectInfo *reconnect_info)
 	return true;
 }
 
+bool
+CCBServer::SaveReconnectInfoRemoval(CCBID ccbid)
+{
+	if( !OpenReconnectFile() ) {
+		return false;
+	}
+
+	int rc = fseek(m_reconnect_fp,0,SEEK_END);
+	if( rc == -1 ) {
+		dprintf(D_ALWAYS,"CCB: failed to seek to end of %s: %s\n",
+				m_reconnect_fname.Value(), strerror(errno));
+		return false;
+	}
+
+	std::string ccbid_str;
+	rc = fprintf(m_reconnect_fp,"%s %s\n",
+		RECONNECT_REMOVAL_KEYWORD,
+		CCBIDToString(ccbid,ccbid_str));
+	if( rc == -1 ) {
+		dprintf(D_ALWAYS,"CCB: failed to write reconnect info in %s: %s\n",
+				m_reconnect_fname.Value(), strerror(errno));
+		return false;
+	}
+	return true;
+}
+
 void
 CCBServer::SaveAllReconnectInfo()
 {
@@ -1342,8 +1386,9 @@ CCBServer::SaveAllReconnectInfo()
 	}
 	CloseReconnectFile();
 
-	if( m_reconnect_info.getNumElements()==0 ) {
+	if( m_reconnect_info.size()==0 ) {
 		IGNORE_RETURN remove( m_reconnect_fname.Value() );
+		m_reconnect_file_stale_lines = 0;
 		return;
 	}
 
@@ -1355,10 +1400,9 @@ CCBServer::SaveAllReconnectInfo()
 		return;
 	}
 
-	CCBReconnectInfo *reconnect_info=NULL;
-	m_reconnect_info.startIterations();
-	while( m_reconnect_info.iterate(reconnect_info) ) {
-		if( !SaveReconnectInfo(reconnect_info) ) {
+	for( size_t slot = 0; slot < m_reconnect_info.capacity(); slot++ ) {
+		CCBReconnectInfo *reconnect_info = m_reconnect_info.at(slot);
+		if( reconnect_info && !SaveReconnectInfo(reconnect_info) ) {
 			CloseReconnectFile();
 			m_reconnect_fname = orig_reconnect_fname;
 			dprintf(D_ALWAYS,"CCB: aborting rewriting of %s\n",
@@ -1374,6 +1418,9 @@ CCBServer::SaveAllReconnectInfo()
 		dprintf(D_ALWAYS,"CCB: failed to rotate rewritten %s\n",
 				m_reconnect_fname.Value());
 	}
+	else {
+		m_reconnect_file_stale_lines = 0;
+	}
 	m_reconnect_fname = orig_reconnect_fname;
 }
 
@@ -1395,31 +1442,46 @@ CCBServer::SweepReconnectInfo()
 
 	// Now it is time to delete expired reconnect records
 
-	CCBReconnectInfo *reconnect_info=NULL;
-	CCBTarget *target=NULL;
-
-	m_targets.startIterations();
-	while( m_targets.iterate(target) ) {
-		reconnect_info = GetReconnectInfo(target->getCCBID());
-		ASSERT( reconnect_info );
-		reconnect_info->alive();
+	for( size_t slot = 0; slot < m_targets.capacity(); slot++ ) {
+		CCBTarget *target = m_targets.at(slot);
+		if( target ) {
+			CCBReconnectInfo *reconnect_info = GetReconnectInfo(target->getCCBID());
+			ASSERT( reconnect_info );
+			reconnect_info->alive();
+		}
 	}
 
-	unsigned long removed = 0;
-	m_reconnect_info.startIterations();
-	while( m_reconnect_info.iterate(reconnect_info) ) {
-		time_t last = reconnect_info->getLastAlive();
-		if( now - last > 2*m_reconnect_info_sweep_interval ) {
-			RemoveReconnectInfo( reconnect_info );
-			removed++;
+	std::vector<CCBReconnectInfo *> expired;
+	for( size_t slot = 0; slot < m_reconnect_info.capacity(); slot++ ) {
+		CCBReconnectInfo *reconnect_info = m_reconnect_info.at(slot);
+		if( reconnect_info &&
+			now - reconnect_info->getLastAlive() > 2*m_reconnect_info_sweep_interval )
+		{
+			expired.push_back( reconnect_info );
 		}
 	}
 
-	if( removed ) {
-		dprintf(D_ALWAYS,
-				"CCB: pruning %lu expired reconnect records.\n",removed);
+	if( expired.empty() ) {
+		return;
+	}
+	dprintf(D_ALWAYS,
+			"CCB: pruning %lu expired reconnect records.\n",
+			(unsigned long)expired.size());
+
+		// Rather than rewrite the file for every sweep that prunes
+		// something, note the removals at the end of it, and only
+		// rewrite it once most of what it holds is stale.
+	bool noted = true;
+	for( size_t i = 0; i < expired.size(); i++ ) {
+		if( noted && !SaveReconnectInfoRemoval(expired[i]->getCCBID()) ) {
+			noted = false;
+		}
+		RemoveReconnectInfo( expired[i] );
+	}
+		// each removal cancels one line and adds another
+	m_reconnect_file_stale_lines += 2*expired.size();
 
-		// rewrite the file to save space, since some records were deleted
+	if( !noted || m_reconnect_file_stale_lines > m_reconnect_info.size() ) {
 		SaveAllReconnectInfo();
 	}
 }
@@ -30,12 +30,148 @@
 
 #include "MyString.h"
 
+#include <vector>
+
 class CCBTarget;
 class CCBServerRequest;
 class CCBReconnectInfo;
 
 typedef unsigned long CCBID;
 
+/* CCBIDMap: a map from CCBID to pointer for the server's big tables.
+   A collector acting as CCB server may have a hundred thousand targets
+   registered, so this keeps every entry in one flat array (open
+   addressing with linear probing, 16 bytes a slot, nothing allocated
+   per entry).  Removal shifts the rest of the probe run back instead
+   of leaving tombstones, so lookups stay short no matter how much the
+   table churns.  Do not insert or remove while walking it with at().
+ */
+template <class T>
+class CCBIDMap {
+ public:
+	CCBIDMap(): m_count(0) {}
+
+	size_t size() const { return m_count; }
+
+		// returns false if ccbid is already in the map
+	bool insert( CCBID ccbid, T *value );
+		// returns NULL if ccbid is not in the map
+	T *lookup( CCBID ccbid ) const;
+		// returns false if ccbid is not in the map
+	bool remove( CCBID ccbid );
+
+		// To walk the map, visit slots 0 to capacity()-1;
+		// at() returns NULL for an empty slot.
+	size_t capacity() const { return m_slots.size(); }
+	T *at( size_t slot ) const { return m_slots[slot].value; }
+
+ private:
+	struct Slot {
+		CCBID ccbid;
+		T *value;
+	};
+	std::vector<Slot> m_slots; // empty, or a power of two in size
+	size_t m_count;
+
+	size_t home( CCBID ccbid ) const {
+			// CCBIDs are handed out in sequence; scatter them so that
+			// neighbouring ids do not all land in one long probe run
+		return (size_t)(((unsigned long long)ccbid * 0x9E3779B97F4A7C15ULL) >> 32) & (m_slots.size()-1);
+	}
+	void grow();
+};
+
+template <class T>
+T *
+CCBIDMap<T>::lookup( CCBID ccbid ) const
+{
+	if( m_slots.empty() ) {
+		return NULL;
+	}
+	size_t mask = m_slots.size()-1;
+	for( size_t i = home(ccbid); m_slots[i].value; i = (i+1) & mask ) {
+		if( m_slots[i].ccbid == ccbid ) {
+			return m_slots[i].value;
+		}
+	}
+	return NULL;
+}
+
+template <class T>
+bool
+CCBIDMap<T>::insert( CCBID ccbid, T *value )
+{
+	ASSERT( value );
+		// keep the load at or below one half
+	if( 2*(m_count+1) > m_slots.size() ) {
+		grow();
+	}
+	size_t mask = m_slots.size()-1;
+	size_t i = home(ccbid);
+	for( ; m_slots[i].value; i = (i+1) & mask ) {
+		if( m_slots[i].ccbid == ccbid ) {
+			return false;
+		}
+	}
+	m_slots[i].ccbid = ccbid;
+	m_slots[i].value = value;
+	m_count++;
+	return true;
+}
+
+template <class T>
+bool
+CCBIDMap<T>::remove( CCBID ccbid )
+{
+	if( m_slots.empty() ) {
+		return false;
+	}
+	size_t mask = m_slots.size()-1;
+	size_t i = home(ccbid);
+	for( ; m_slots[i].value; i = (i+1) & mask ) {
+		if( m_slots[i].ccbid == ccbid ) {
+			break;
+		}
+	}
+	if( !m_slots[i].value ) {
+		return false;
+	}
+	m_count--;
+
+		// Close the hole at i by pulling back any later entry in the
+		// probe run whose home slot is not between i and where it sits.
+	size_t j = i;
+	for(;;) {
+		m_slots[i].value = NULL;
+		size_t k;
+		do {
+			j = (j+1) & mask;
+			if( !m_slots[j].value ) {
+				return true;
+			}
+			k = home(m_slots[j].ccbid);
+		} while( i <= j ? (i < k && k <= j) : (i < k || k <= j) );
+		m_slots[i] = m_slots[j];
+		i = j;
+	}
+}
+
+template <class T>
+void
+CCBIDMap<T>::grow()
+{
+	std::vector<Slot> old;
+	old.swap( m_slots );
+	Slot empty_slot = { 0, NULL };
+	m_slots.assign( old.empty() ? 64 : 2*old.size(), empty_slot );
+	m_count = 0;
+	for( size_t i = 0; i < old.size(); i++ ) {
+		if( old[i].value ) {
+			insert( old[i].ccbid, old[i].value );
+		}
+	}
+}
+
 // condor/cedar connection broker
 class CCBServer: Service {
  public:
@@ -50,11 +186,13 @@ class CCBServer: Service {
 	friend class CCBTarget;
  private:
 	bool m_registered_handlers;
-	HashTable<CCBID,CCBTarget *> m_targets;        // ccbid --> target
-	HashTable<CCBID,CCBReconnectInfo *> m_reconnect_info;
+	CCBIDMap<CCBTarget> m_targets;        // ccbid --> target
+	CCBIDMap<CCBReconnectInfo> m_reconnect_info;
 	MyString m_address;
 	MyString m_reconnect_fname;
 	FILE *m_reconnect_fp;
+		// lines in the reconnect file that a later line cancels
+	unsigned long m_reconnect_file_stale_lines;
 	time_t m_last_reconnect_info_sweep;
 	int m_reconnect_info_sweep_interval;
 	bool m_reconnect_allowed_from_any_ip;
@@ -65,7 +203,7 @@ class CCBServer: Service {
 
 		// we hold onto client requests so we can propagate failures
 		// to them if things go wrong
-	HashTable<CCBID,CCBServerRequest *> m_requests;// request_id --> req
+	CCBIDMap<CCBServerRequest> m_requests;// request_id --> req
 
 	int m_polling_timer;
 		// The epoll file descriptor.  Only used on platforms where
@@ -111,6 +249,7 @@ class CCBServer: Service {
 	bool OpenReconnectFile(bool only_if_exists=false);
 	void LoadReconnectInfo();
 	bool SaveReconnectInfo(CCBReconnectInfo *reconnect_info);
+	bool SaveReconnectInfoRemoval(CCBID ccbid);
 	void SaveAllReconnectInfo();
 	void SweepReconnectInfo();
 };
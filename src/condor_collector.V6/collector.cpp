@@ -391,6 +391,8 @@ void CollectorDaemon::Init()
 	// install command handlers for updates
 	daemonCore->Register_CommandWithPayload(UPDATE_STARTD_AD,"UPDATE_STARTD_AD",
 		(CommandHandler)receive_update,"receive_update",NULL,ADVERTISE_STARTD_PERM);
+	daemonCore->Register_CommandWithPayload(UPDATE_STARTD_AD_DELTA,"UPDATE_STARTD_AD_DELTA",
+		(CommandHandler)receive_update,"receive_update",NULL,ADVERTISE_STARTD_PERM);
 	daemonCore->Register_CommandWithPayload(MERGE_STARTD_AD,"MERGE_STARTD_AD",
 		(CommandHandler)receive_update,"receive_update",NULL,NEGOTIATOR);
 	daemonCore->Register_CommandWithPayload(UPDATE_SCHEDD_AD,"UPDATE_SCHEDD_AD",
@@ -1268,9 +1270,19 @@ int CollectorDaemon::receive_update(Service* /*s*/, int command, Stream* sock)
 			// which already does all the necessary logging.
 		}
 
+			// -5 is a startd ad delta for an ad we don't have, which
+			// expandStartdAdDelta() has logged.  Returning FALSE closes
+			// the connection, which makes the startd send a full ad next.
+
 		return FALSE;
 
 	}
+
+		// A delta has now been expanded into the full startd ad, so
+		// everything downstream sees an ordinary update.
+	if (command == UPDATE_STARTD_AD_DELTA) {
+		command = UPDATE_STARTD_AD;
+	}
 #ifdef PROFILE_RECEIVE_UPDATE
 	CollectorEngine_ru_collect_runtime += rt.tick(rt_last);
 #endif
@@ -414,6 +414,38 @@ collect (int command, Sock *sock, const condor_sockaddr& from, int &insert)
 	return rval;
 }
 
+bool CollectorEngine::expandStartdAdDelta(ClassAd *delta)
+{
+	AdNameHashKey hk;
+	if (!makeStartdAdHashKey(hk, delta)) {
+		dprintf(D_ALWAYS, "Could not make hashkey for startd ad delta --- ignoring it\n");
+		return false;
+	}
+
+	ClassAd *old_ad = NULL;
+	if (StartdAds.lookup(hk, old_ad) == -1) {
+		MyString hkString;
+		hk.sprint(hkString);
+		dprintf(D_ALWAYS, "Got startd ad delta for %s, but have no ad for it --- ignoring it\n",
+				hkString.Value());
+		return false;
+	}
+
+		// Everything the delta leaves out is unchanged, except for
+		// what we add to ads ourselves on each update.
+	for (auto itr = old_ad->begin(); itr != old_ad->end(); ++itr) {
+		if (delta->Lookup(itr->first) ||
+			strcasecmp(itr->first.c_str(), ATTR_LAST_HEARD_FROM) == 0 ||
+			strcasecmp(itr->first.c_str(), "AuthenticatedIdentity") == 0 ||
+			strcasecmp(itr->first.c_str(), "AuthenticationMethod") == 0)
+		{
+			continue;
+		}
+		delta->Insert(itr->first, itr->second->Copy());
+	}
+	return true;
+}
+
 bool CollectorEngine::ValidateClassAd(int command,ClassAd *clientAd,Sock *sock)
 {
 
@@ -555,6 +587,14 @@ collect (int command,ClassAd *clientAd,const condor_sockaddr& from,int &insert,S
 		repeatStartdAds = param_integer("COLLECTOR_REPEAT_STARTD_ADS",0);
 	}
 
+	if (command == UPDATE_STARTD_AD_DELTA) {
+		if (!expandStartdAdDelta(clientAd)) {
+			insert = -5;
+			return NULL;
+		}
+		command = UPDATE_STARTD_AD;
+	}
+
 	if( !ValidateClassAd(command,clientAd,sock) ) {
 	    insert = -4;
 		return NULL;
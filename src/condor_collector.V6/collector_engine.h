@@ -113,6 +113,10 @@ class CollectorEngine : public Service
 	typedef bool (*HashFunc) (AdNameHashKey &, const ClassAd *);
 
 	bool LookupByAdType(AdTypes, CollectorHashTable *&, HashFunc &);
+
+		// Fill in an UPDATE_STARTD_AD_DELTA ad from the startd ad we
+		// already have.  Returns false if there is no such ad.
+	bool expandStartdAdDelta(ClassAd *delta);
  
 	// the greater tables
 
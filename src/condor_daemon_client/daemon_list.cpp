@@ -276,9 +276,12 @@ DCCollectorAdSequences & CollectorList::getAdSeq()
 int
 CollectorList::sendUpdates (int cmd, ClassAd * ad1, ClassAd* ad2, bool nonblocking,
 	DCTokenRequester *token_requester, const std::string &identity,
-	const std::string authz_name)
+	const std::string authz_name, ClassAd *delta_ad, int *deltas_sent)
 {
 	int success_count = 0;
+	if ( deltas_sent ) {
+		*deltas_sent = 0;
+	}
 
 	if ( ! adSeq) {
 		adSeq = new DCCollectorAdSequences();
@@ -301,9 +304,19 @@ CollectorList::sendUpdates (int cmd, ClassAd * ad1, ClassAd* ad2, bool nonblocki
 			data = token_requester->createCallbackData(daemon->name(),
 				identity, authz_name);
 		}
-		if( daemon->sendUpdate(cmd, ad1, *adSeq, ad2, nonblocking,
-			DCTokenRequester::daemonUpdateCallback, data) )
-		{
+		bool sent;
+		if( delta_ad && cmd == UPDATE_STARTD_AD ) {
+			bool sent_delta = false;
+			sent = daemon->sendDeltaUpdate(ad1, delta_ad, *adSeq, ad2, nonblocking,
+				DCTokenRequester::daemonUpdateCallback, data, &sent_delta);
+			if( sent_delta && deltas_sent ) {
+				(*deltas_sent)++;
+			}
+		} else {
+			sent = daemon->sendUpdate(cmd, ad1, *adSeq, ad2, nonblocking,
+				DCTokenRequester::daemonUpdateCallback, data);
+		}
+		if( sent ) {
 			success_count++;
 		} 
 	}
@@ -109,11 +109,16 @@ class CollectorList : public DaemonList {
 		// Resort a collector list for locality (for negotiator)
 	int resortLocal( const char *preferred_collector );
 
-		// Send updates to all the collectors
+		// Send updates to all the collectors.  If delta_ad is given
+		// with UPDATE_STARTD_AD, it goes instead of ad1 to collectors
+		// that can take it, see DCCollector::sendDeltaUpdate().  If
+		// deltas_sent is given, it is set to how many collectors got
+		// the delta rather than the full ad.
 		// return - number of successfull updates
 	int sendUpdates (int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblocking,
 		DCTokenRequester *token_requester = nullptr, const std::string &identity = "",
-		const std::string authz_name = "");
+		const std::string authz_name = "", ClassAd *delta_ad = nullptr,
+		int *deltas_sent = nullptr);
 
 		// use this to detach the ad sequence counters before destroying the collector list
 		// we do this when we want to move the sequence counters to a new list
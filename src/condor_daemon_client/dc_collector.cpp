@@ -26,6 +26,7 @@
 #include "daemon.h"
 #include "condor_daemon_core.h"
 #include "dc_collector.h"
+#include "selector.h"
 
 #include <sstream>
 #include <algorithm>
@@ -296,30 +297,7 @@ DCCollector::sendUpdate( int cmd, ClassAd* ad1, DCCollectorAdSequences& adSeq, C
 		nonblocking = false;
 	}
 
-	// Add start time & seq # to the ads before we publish 'em
-	if ( ad1 ) {
-		ad1->Assign(ATTR_DAEMON_START_TIME, startTime);
-		ad1->Assign(ATTR_DAEMON_LAST_RECONFIG_TIME, reconfigTime);
-	}
-	if ( ad2 ) {
-		ad2->Assign(ATTR_DAEMON_START_TIME, startTime);
-		ad2->Assign(ATTR_DAEMON_LAST_RECONFIG_TIME, reconfigTime);
-	}
-
-	if ( ad1 ) {
-		DCCollectorAdSeq* seqgen = adSeq.getAdSeq(*ad1);
-		if (seqgen) {
-			long long seq = seqgen->getSequence();
-			ad1->Assign(ATTR_UPDATE_SEQUENCE_NUMBER, seq);
-			if (ad2) { ad2->Assign(ATTR_UPDATE_SEQUENCE_NUMBER, seq); }
-		}
-	}
-
-		// Prior to 7.2.0, the negotiator depended on the startd
-		// supplying matching MyAddress in public and private ads.
-	if ( ad1 && ad2 ) {
-		CopyAttribute(ATTR_MY_ADDRESS,*ad2,*ad1);
-	}
+	stampUpdateAds( ad1, ad2, adSeq );
 
 		// We never want to try sending an update to port 0.  If we're
 		// about to try that, and we're trying to talk to a local
@@ -384,6 +362,106 @@ DCCollector::sendUpdate( int cmd, ClassAd* ad1, DCCollectorAdSequences& adSeq, C
 
 
 
+void
+DCCollector::stampUpdateAds( ClassAd* ad1, ClassAd* ad2, DCCollectorAdSequences& adSeq )
+{
+	// Add start time & seq # to the ads before we publish 'em
+	if ( ad1 ) {
+		ad1->Assign(ATTR_DAEMON_START_TIME, startTime);
+		ad1->Assign(ATTR_DAEMON_LAST_RECONFIG_TIME, reconfigTime);
+	}
+	if ( ad2 ) {
+		ad2->Assign(ATTR_DAEMON_START_TIME, startTime);
+		ad2->Assign(ATTR_DAEMON_LAST_RECONFIG_TIME, reconfigTime);
+	}
+
+	if ( ad1 ) {
+		DCCollectorAdSeq* seqgen = adSeq.getAdSeq(*ad1);
+		if (seqgen) {
+			long long seq = seqgen->getSequence();
+			ad1->Assign(ATTR_UPDATE_SEQUENCE_NUMBER, seq);
+			if (ad2) { ad2->Assign(ATTR_UPDATE_SEQUENCE_NUMBER, seq); }
+		}
+	}
+
+		// Prior to 7.2.0, the negotiator depended on the startd
+		// supplying matching MyAddress in public and private ads.
+	if ( ad1 && ad2 ) {
+		CopyAttribute(ATTR_MY_ADDRESS,*ad2,*ad1);
+	}
+}
+
+
+bool
+DCCollector::sendDeltaUpdate( ClassAd* ad1, ClassAd* delta_ad, DCCollectorAdSequences& adSeq, ClassAd* ad2, bool nonblocking, StartCommandCallbackType callback_fn, void *miscdata, bool *sent_delta )
+{
+	if( sent_delta ) {
+		*sent_delta = false;
+	}
+
+		// The collector expands a delta from the ad it already has, so
+		// only send one where the previous update is known to have
+		// arrived: on our cached TCP socket, with nothing queued ahead.
+	CondorVersionInfo const *verinfo = update_rsock ? update_rsock->get_peer_version() : NULL;
+	if( ! _is_configured || ! use_tcp || ! delta_ad || ! ad1 ||
+		! update_rsock || ! pending_update_list.empty() ||
+		! verinfo || ! verinfo->built_since_version(8, 9, 6) )
+	{
+		return sendUpdate( UPDATE_STARTD_AD, ad1, adSeq, ad2, nonblocking, callback_fn, miscdata );
+	}
+
+		// The collector never writes on the update socket, so anything
+		// to read means it has closed it, as it does when it gets a
+		// delta for an ad it doesn't have.  Start over with a full ad,
+		// rather than lose this delta too.
+	Selector selector;
+	selector.add_fd( update_rsock->get_file_desc(), Selector::IO_READ );
+	selector.set_timeout( 0 );
+	selector.execute();
+	if( selector.has_ready() ) {
+		dprintf( D_FULLDEBUG,
+				 "Collector %s closed the update connection, "
+				 "sending full update on a new connection\n", update_destination );
+		delete update_rsock;
+		update_rsock = NULL;
+		return sendUpdate( UPDATE_STARTD_AD, ad1, adSeq, ad2, nonblocking, callback_fn, miscdata );
+	}
+
+	if(!use_nonblocking_update || !daemonCore) {
+		nonblocking = false;
+	}
+
+	stampUpdateAds( ad1, ad2, adSeq );
+	CopyAttribute( ATTR_DAEMON_START_TIME, *delta_ad, *ad1 );
+	CopyAttribute( ATTR_DAEMON_LAST_RECONFIG_TIME, *delta_ad, *ad1 );
+	CopyAttribute( ATTR_UPDATE_SEQUENCE_NUMBER, *delta_ad, *ad1 );
+	if( ad2 ) {
+		CopyAttribute( ATTR_MY_ADDRESS, *delta_ad, *ad1 );
+	}
+
+	dprintf( D_FULLDEBUG,
+			 "Attempting to send delta update (%d attributes) via TCP to collector %s\n",
+			 delta_ad->size(), update_destination );
+
+	update_rsock->encode();
+	if (update_rsock->put(UPDATE_STARTD_AD_DELTA) && finishUpdate(this, update_rsock, delta_ad, ad2, callback_fn, miscdata)) {
+		if( sent_delta ) {
+			*sent_delta = true;
+		}
+		if (callback_fn) {
+			(*callback_fn)(true, update_rsock, nullptr, update_rsock->getTrustDomain(), update_rsock->shouldTryTokenRequest(), miscdata);
+		}
+		return true;
+	}
+	dprintf( D_FULLDEBUG,
+			 "Couldn't send delta update to collector, "
+			 "sending full update on a new connection\n" );
+	delete update_rsock;
+	update_rsock = NULL;
+	return initiateTCPUpdate( UPDATE_STARTD_AD, ad1, ad2, nonblocking, callback_fn, miscdata );
+}
+
+
 bool
 DCCollector::finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd* ad2, StartCommandCallbackType callback_fn, void *miscdata )
 {
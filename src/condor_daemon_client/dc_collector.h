@@ -95,6 +95,18 @@ public:
 		*/
 	bool sendUpdate( int cmd, ClassAd* ad1, DCCollectorAdSequences& seq, ClassAd* ad2, bool nonblocking, StartCommandCallbackType=nullptr, void *miscdata=nullptr );
 
+		/** Send a startd update as UPDATE_STARTD_AD_DELTA, with
+			delta_ad in place of the full public ad1.  The delta is
+			only sent over an already established TCP connection to a
+			collector new enough to understand it; otherwise, or if
+			sending it fails, the full ad1 is sent instead.
+			@param delta_ad Changed attributes of ad1 since the
+			last update
+			@param sent_delta If given, set to whether the delta
+			went, rather than the full ad
+		*/
+	bool sendDeltaUpdate( ClassAd* ad1, ClassAd* delta_ad, DCCollectorAdSequences& seq, ClassAd* ad2, bool nonblocking, StartCommandCallbackType=nullptr, void *miscdata=nullptr, bool *sent_delta=nullptr );
+
 	void reconfig( void );
 
 	const char* updateDestination( void );
@@ -135,6 +147,8 @@ private:
 
 	static bool finishUpdate( DCCollector *self, Sock* sock, ClassAd* ad1, ClassAd* ad2, StartCommandCallbackType callback_fn, void *miscdata );
 
+	void stampUpdateAds( ClassAd* ad1, ClassAd* ad2, DCCollectorAdSequences& seq );
+
 	void parseTCPInfo( void );
 	void initDestinationStrings( void );
 
@@ -1897,7 +1897,8 @@ bool DCSchedd::getJobConnectInfo(
 	return result;
 }
 
-bool DCSchedd::recycleShadow( int previous_job_exit_reason, ClassAd **new_job_ad, MyString &error_msg )
+bool DCSchedd::recycleShadow( int previous_job_exit_reason, ClassAd **new_job_ad, MyString &error_msg,
+							  PROC_ID const *job_id, bool want_job )
 {
 	int timeout = 300;
 	CondorError errstack;
@@ -1930,6 +1931,9 @@ bool DCSchedd::recycleShadow( int previous_job_exit_reason, ClassAd **new_job_ad
 	int mypid = getpid();
 	if( !sock.put( mypid ) ||
 		!sock.put( previous_job_exit_reason ) ||
+		(job_id && (!sock.put( job_id->cluster ) ||
+					!sock.put( job_id->proc ) ||
+					!sock.put( (int)want_job ))) ||
 		!sock.end_of_message() )
 	{
 		error_msg = "Failed to send job exit reason";
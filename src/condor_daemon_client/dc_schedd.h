@@ -366,7 +366,10 @@ public:
 		// Caller should delete new_job_ad when done with it.
 		// Returns false on error (see error_msg)
 		// If no new job found, returns true with *new_job_ad=NULL
-	bool recycleShadow( int previous_job_exit_reason, ClassAd **new_job_ad, MyString &error_msg );
+		// A multi-job shadow passes the id of the job that exited
+		// and whether it wants another job in its place.
+	bool recycleShadow( int previous_job_exit_reason, ClassAd **new_job_ad, MyString &error_msg,
+						PROC_ID const *job_id = NULL, bool want_job = true );
 
 
 		/*
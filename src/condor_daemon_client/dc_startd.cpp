@@ -231,6 +231,11 @@ ClaimStartdMsg::readMsg( DCMessenger * /*messenger*/, Sock *sock ) {
 		Reply of 4 (REQUEST_CLAIM_PAIR) means claim accepted by a slot
 		  that is paired, and the partner slot ad and claim id will be
 		  sent next.
+		Reply of 5 (REQUEST_CLAIM_SLOTS) means claim accepted by a
+		  partitionable slot, which was split into more dynamic slots
+		  as asked.  The number of extra slots comes next, then the
+		  claim id and slot ad of each, then whether there are
+		  leftovers and, if so, their claim id and slot ad.
 	*/
 
 	if( m_reply == OK ) {
@@ -253,6 +258,36 @@ ClaimStartdMsg::readMsg( DCMessenger * /*messenger*/, Sock *sock ) {
 			// change reply to OK cuz claim was a success
 			m_reply = OK;
 		}
+	} else if( m_reply == REQUEST_CLAIM_SLOTS ) {
+		int num_extra = 0;
+		int leftovers = 0;
+		bool ok = sock->get(num_extra) && num_extra >= 0;
+		for( int i = 0; ok && i < num_extra; i++ ) {
+			std::string claim_id;
+			ClassAd slot_ad;
+			ok = sock->get(claim_id) && getClassAd( sock, slot_ad );
+			if( ok ) {
+				m_extra_slot_claim_ids.push_back( claim_id );
+				m_extra_slot_startd_ads.push_back( slot_ad );
+			}
+		}
+		ok = ok && sock->get(leftovers);
+		if( ok && leftovers ) {
+			ok = sock->get(m_leftover_claim_id) &&
+				getClassAd( sock, m_leftover_startd_ad );
+			m_have_leftovers = ok;
+		}
+		if( !ok ) {
+			dprintf( failureDebugLevel(),
+				 "Failed to read extra dynamic slots from startd - claim %s.\n",
+				 description() );
+			m_extra_slot_claim_ids.clear();
+			m_extra_slot_startd_ads.clear();
+			m_have_leftovers = false;
+			m_reply = NOT_OK;
+		} else {
+			m_reply = OK;
+		}
 	} else if( m_reply == REQUEST_CLAIM_PAIR ) {
 		if( !sock->get(m_paired_claim_id) ||
 			!getClassAd( sock, m_paired_startd_ad ) )
@@ -249,6 +249,11 @@ public:
 	ClassAd *paired_startd_ad()
 		{ return m_have_paired_slot ? &m_paired_startd_ad : NULL; }
 
+	int num_extra_slots() { return (int)m_extra_slot_claim_ids.size(); }
+	char const *extra_slot_claim_id( int i )
+		{ return m_extra_slot_claim_ids[i].c_str(); }
+	ClassAd *extra_slot_startd_ad( int i ) { return &m_extra_slot_startd_ads[i]; }
+
 	const ClassAd *getJobAd() { return &m_job_ad;}
 	bool putExtraClaims(Sock *sock);
 private:
@@ -275,6 +280,11 @@ private:
 	std::string m_paired_claim_id;
 	ClassAd m_paired_startd_ad;
 
+		// If the request asked for more than one dynamic slot, the
+		// startd will send over the ad and claim id of each extra one.
+	std::vector<std::string> m_extra_slot_claim_ids;
+	std::vector<ClassAd> m_extra_slot_startd_ads;
+
 	std::string m_startd_ip_addr;
 	std::string m_startd_fqu;
 };
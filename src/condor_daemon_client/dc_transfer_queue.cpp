@@ -168,7 +168,7 @@ DCTransferQueue::GoAheadAlways( bool downloading ) {
 }
 
 bool
-DCTransferQueue::RequestTransferQueueSlot(bool downloading,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,int timeout,MyString &error_desc)
+DCTransferQueue::RequestTransferQueueSlot(bool downloading,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,int timeout,MyString &error_desc,char const *peer)
 {
 	ASSERT(fname);
 	ASSERT(jobid);
@@ -246,6 +246,9 @@ DCTransferQueue::RequestTransferQueueSlot(bool downloading,filesize_t sandbox_si
 	msg.Assign(ATTR_JOB_ID,jobid);
 	msg.Assign(ATTR_USER,queue_user);
 	msg.Assign(ATTR_SANDBOX_SIZE,sandbox_size);
+	if( peer && peer[0] ) {
+		msg.Assign(ATTR_TRANSFER_PEER,peer);
+	}
 
 	m_xfer_queue_sock->encode();
 
@@ -64,6 +64,7 @@
 #include <vector>
 #include <memory>
 #include <deque>
+#include <mutex>
 
 #include "../condor_procd/proc_family_io.h"
 class ProcFamilyInterface;
@@ -1505,11 +1506,17 @@ class DaemonCore : public Service
 		   @param ad2 The secondary ClassAd to send. Usually NULL,
 		     except in the case of startds sending the "private" ad.
 		   @param nonblock Should the update use non-blocking communication.
+		   @param delta_ad The attributes of ad1 that changed since the
+		     last update, sent instead of ad1 where possible.  Only
+		     used with UPDATE_STARTD_AD.
+		   @param deltas_sent If given, set to the number of collectors
+		     that got delta_ad rather than the full ad1.
 		   @return The number of successful updates that were sent.
 		*/
 	int sendUpdates(int cmd, ClassAd* ad1, ClassAd* ad2 = NULL, bool nonblock = false,
 		DCTokenRequester *requester = nullptr, const std::string &identity = "",
-		const std::string &authz_name = "");
+		const std::string &authz_name = "", ClassAd *delta_ad = nullptr,
+		int *deltas_sent = nullptr);
 
 	DCCollectorAdSequences & getUpdateAdSeq() { return m_collector_list->getAdSeq(); }
 
@@ -2022,8 +2029,17 @@ class DaemonCore : public Service
     __declspec(align(MEMORY_ALLOCATION_ALIGNMENT))
     SLIST_HEADER        PumpWorkHead; // list head for async PumpWorkCallback items.
 #else
-    // implement for non windows?
+    // PumpWorkItem is an item in the PumpWorkCallback queue, which
+    // any thread may append to while holding PumpWorkMutex
+    struct PumpWorkItem
+    {
+        PumpWorkCallback callback;
+        void *           cls;
+        void *           data;
+    };
 
+    std::mutex               PumpWorkMutex;
+    std::deque<PumpWorkItem> PumpWorkQueue;
 #endif
     int  DoPumpWork(); // call on main thread to handle all of work in the PumpWork list, returns number of callbacks handled
             
@@ -2297,6 +2313,11 @@ extern void DC_Skip_Auth_Init();
 */
 extern void DC_Skip_Core_Init();
 
+/** Append to the name of this daemon's log file, as the -a command line
+    option does, and reopen the log.  This is for daemons, such as a
+    prewarmed condor_starter, that only learn the suffix after startup.
+*/
+extern void DC_Set_Log_Append( const char *append_str );
 
 extern void dc_reconfig();
 
@@ -35,6 +35,7 @@
 #include "condor_version.h"
 #include "ipv6_hostname.h"
 #include "daemon_command.h"
+#include "auth_offload.h"
 
 
 static unsigned int ZZZZZ = 0;
@@ -237,6 +238,36 @@ DaemonCommandProtocol::SocketCallback( Stream *stream )
 	return rc;
 }
 
+// Called when authentication has handed some work to an authentication
+// worker thread; the protocol resumes once the worker is done.
+DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::WaitForAuthWorker()
+{
+	if( !AuthOffload::WhenDone( m_sock, [this]() { AuthWorkerCallback(); } ) ) {
+		return WaitForSocketData();
+	}
+
+		// Do not allow ourselves to be deleted until after
+		// AuthWorkerCallback is called.
+	incRefCount();
+
+	condor_gettimestamp( m_async_waiting_start_time );
+
+	return CommandProtocolInProgress;
+}
+
+void
+DaemonCommandProtocol::AuthWorkerCallback()
+{
+	struct timeval async_waiting_stop_time;
+	condor_gettimestamp( async_waiting_stop_time );
+	m_async_waiting_time += timersub_double( async_waiting_stop_time, m_async_waiting_start_time );
+
+	doProtocol();
+
+		// get rid of ref counted when the job was handed off
+	decRefCount();
+}
+
 // This is the first thing we do on an incoming TCP command socket.
 // Once this function is finished, m_sock will point to the socket
 // from which we should read the command.
@@ -913,6 +944,13 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 								dprintf (D_SECURITY, "DC_AUTHENTICATE: generating 3DES key for session %s...\n", m_sid);
 								m_key = new KeyInfo(rbuf, 24, CONDOR_3DES);
 								break;
+							case 'A': // aes_cfb
+								if (strcasecmp(crypto_method, "AES_CFB") == 0) {
+									dprintf (D_SECURITY, "DC_AUTHENTICATE: generating AES_CFB key for session %s...\n", m_sid);
+									m_key = new KeyInfo(rbuf, 24, CONDOR_AES);
+									break;
+								}
+								// fall through
 							default:
 								dprintf (D_SECURITY, "DC_AUTHENTICATE: generating RANDOM key for session %s...\n", m_sid);
 								m_key = new KeyInfo(rbuf, 24);
@@ -1083,6 +1121,10 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::Authenticate
 
 	if (auth_success == 2) {
 		m_state = CommandProtocolAuthenticateContinue;
+		if (AuthOffload::Pending(m_sock)) {
+			dprintf(D_SECURITY, "Will return to DC while an authentication worker thread is busy.\n");
+			return WaitForAuthWorker();
+		}
 		dprintf(D_SECURITY, "Will return to DC because authentication is incomplete.\n");
 		return WaitForSocketData();
 	}
@@ -1096,6 +1138,10 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::Authenticate
 	char *method_used = NULL;
 	int auth_result = m_sock->authenticate_continue(m_errstack, true, &method_used);
 	if (auth_result == 2) {
+		if (AuthOffload::Pending(m_sock)) {
+			dprintf(D_SECURITY, "Will return to DC while an authentication worker thread is busy.\n");
+			return WaitForAuthWorker();
+		}
 		dprintf(D_SECURITY, "Will return to DC to continue authentication..\n");
 		return WaitForSocketData();
 	}
@@ -1216,6 +1262,11 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::EnableCrypto
 		m_sock->set_crypto_key(false, m_key);
 	}
 
+	if (m_is_tcp) {
+		SecMan::sec_feat_act will_compress = m_sec_man->sec_lookup_feat_act(*m_policy, ATTR_SEC_COMPRESSION);
+		static_cast<ReliSock*>(m_sock)->set_compression(will_compress == SecMan::SEC_FEAT_ACT_YES);
+	}
+
 	m_state = CommandProtocolVerifyCommand;
 	return CommandProtocolContinue;
 }
@@ -1620,6 +1671,7 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::SendResponse
 		// outgoing session to a daemon with that IP and
 		// port as its command socket.
 		KeyCacheEntry tmp_key(m_sid, NULL, m_key, m_policy, expiration_time, session_lease );
+		tmp_key.setPersistFlag(true);
 		m_sec_man->session_cache->insert(tmp_key);
 		dprintf (D_SECURITY, "DC_AUTHENTICATE: added incoming session id %s to cache for %i seconds (lease is %ds, return address is %s).\n", m_sid, durint, session_lease, return_addr ? return_addr : "unknown");
 		if (IsDebugVerbose(D_SECURITY)) {
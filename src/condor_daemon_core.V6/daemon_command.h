@@ -100,6 +100,8 @@ private:
 	CommandProtocolResult ExecCommand();
 	CommandProtocolResult WaitForSocketData();
 	int SocketCallback( Stream *stream );
+	CommandProtocolResult WaitForAuthWorker();
+	void AuthWorkerCallback();
 	int finalize();
 };
 
@@ -99,6 +99,7 @@ CRITICAL_SECTION Big_fat_mutex; // coarse grained mutex for debugging purposes
 #include "valgrind.h"
 #include "ipv6_hostname.h"
 #include "daemon_command.h"
+#include "auth_offload.h"
 #include "condor_sockfunc.h"
 
 #if defined ( HAVE_SCHED_SETAFFINITY ) && !defined ( WIN32 )
@@ -881,10 +882,13 @@ int DaemonCore::Register_PumpWork_TS(PumpWorkCallback handler, void* cls, void*
 	}
 	return 1;
 #else
-	// implement for non-windows?
-	dprintf(D_ALWAYS|D_FAILURE, "Register_PumpWork_TS(%p, %p, %p) called, but has not (yet) been implemented on this platform\n",
-			handler, cls, data);
-	return -1;
+	PumpWorkItem work = { handler, cls, data };
+	{
+		std::lock_guard<std::mutex> guard(PumpWorkMutex);
+		PumpWorkQueue.push_back(work);
+	}
+	Do_Wake_up_select();
+	return 1;
 #endif
 }
 
@@ -924,8 +928,24 @@ int DaemonCore::DoPumpWork() {
 	}
 	return citems;
 #else
-	// implement for non-windows?
-	return 0;
+	// take the whole queue at once so that callbacks which register more
+	// pump work don't keep us here, those items wait for the next pass.
+	std::deque<PumpWorkItem> work;
+	{
+		std::lock_guard<std::mutex> guard(PumpWorkMutex);
+		if (PumpWorkQueue.empty()) {
+			return 0;
+		}
+		work.swap(PumpWorkQueue);
+	}
+	dprintf(D_DAEMONCORE, "Processing %d pump work item(s)\n", (int)work.size());
+
+	int citems = 0;
+	for (auto & item : work) {
+		item.callback(item.cls, item.data);
+		++citems;
+	}
+	return citems;
 #endif
 }
 
@@ -3003,6 +3023,9 @@ DaemonCore::reconfig(void) {
 	secman->reconfig();
 	secman->getIpVerify()->Init();
 
+		// worker threads for the CPU heavy parts of authentication
+	AuthOffload::Reconfig();
+
         // invoke reconfig method on our class to handle timer events
     t.reconfig();
 
@@ -3411,7 +3434,7 @@ void DaemonCore::Driver()
 	for(;;)
 	{
 		// handle queued pump work. these are like zero timeout one-shot timers
-		// but unlike timers, can be registered from any thread (only Windows needs the second part)
+		// but unlike timers, can be registered from any thread
 		// We do this before the signal handlers so that pump work can be used to raise a signal
 		int num_pumpwork_fired = DoPumpWork();
 
@@ -3493,6 +3516,16 @@ void DaemonCore::Driver()
 		if ( sent_signal == TRUE ) {
 			timeout = 0;
 		}
+#ifndef WIN32
+			// pump work queued by another thread since DoPumpWork() above
+			// may have had its wake up drained from the async_pipe already
+		{
+			std::lock_guard<std::mutex> guard(PumpWorkMutex);
+			if ( ! PumpWorkQueue.empty()) {
+				timeout = 0;
+			}
+		}
+#endif
 		if ( timeout < 0 ) {
 			timeout = TIME_T_NEVER;
 		}
@@ -4114,6 +4147,17 @@ DaemonCore::CallSocketHandler( int &i, bool default_to_HandleCommand )
 		    ((ReliSock *)insock)->_special_state == ReliSock::relisock_listen
 		    )
 	    {
+#if defined(HAVE_ACCEPT4)
+            // b/c we are now in a tight loop accepting, take each waiting
+            // connection without blocking, and bail once there are none;
+            // no need to select on the listen socket between accepts.
+            bool would_block = false;
+            args->accepted_sock = (Stream *) ((ReliSock *)insock)->accept_nonblocking( would_block );
+            if ( !(args->accepted_sock) && would_block ) {
+                delete args;
+                return;
+            }
+#else
             // b/c we are now in a tight loop accepting, use select to check for more data and bail if none is there.
             Selector selector;
             selector.set_timeout( 0, 0 );
@@ -4127,6 +4171,7 @@ DaemonCore::CallSocketHandler( int &i, bool default_to_HandleCommand )
             }
 
 		    args->accepted_sock = (Stream *) ((ReliSock *)insock)->accept();
+#endif
 
 		    if ( !(args->accepted_sock) ) {
 		        dprintf(D_ALWAYS, "DaemonCore: accept() failed!\n");
@@ -10961,7 +11006,8 @@ DaemonCore::getCollectorList() {
 
 int
 DaemonCore::sendUpdates( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblock,
-	DCTokenRequester *token_requester, const std::string &identity, const std::string &authz_name )
+	DCTokenRequester *token_requester, const std::string &identity, const std::string &authz_name,
+	ClassAd *delta_ad, int *deltas_sent )
 {
 	ASSERT(ad1);
 	ASSERT(m_collector_list);
@@ -10986,7 +11032,7 @@ DaemonCore::sendUpdates( int cmd, ClassAd* ad1, ClassAd* ad2, bool nonblock,
 		// Even if we just decided to shut ourselves down, we should
 		// still send the updates originally requested by the caller.
 	return m_collector_list->sendUpdates(cmd, ad1, ad2, nonblock, token_requester,
-		identity, authz_name);
+		identity, authz_name, delta_ad, deltas_sent);
 }
 
 
@@ -58,6 +58,7 @@
 #include "condor_auth_passwd.h"
 #include "condor_auth_ssl.h"
 #include "authentication.h"
+#include "auth_offload.h"
 
 #define _NO_EXTERN_DAEMON_CORE 1	
 #include "condor_daemon_core.h"
@@ -804,6 +805,10 @@ DC_Exit( int status, const char *shutdown_program )
 		// Now, delete the daemonCore object, since we allocated it. 
 	unsigned long	pid = 0;
 	if (daemonCore) {
+			// The authentication workers hand results back through
+			// daemonCore, so they must be gone first.
+		AuthOffload::Shutdown();
+		daemonCore->getSecMan()->PersistSessionCache();
 		pid = daemonCore->getpid( );
 		delete daemonCore;
 		daemonCore = NULL;
@@ -1116,6 +1121,17 @@ handle_log_append( char* append_str )
 }
 
 
+void
+DC_Set_Log_Append( const char *append_str )
+{
+		// Not freed; logAppend usually points into argv, and this is
+		// called at most once in the life of the daemon.
+	logAppend = strdup( append_str );
+	handle_log_append( logAppend );
+	dprintf_config( get_mySubSystem()->getName() );
+}
+
+
 void
 dc_touch_log_file( )
 {
@@ -4005,6 +4021,9 @@ int dc_main( int argc, char** argv )
 	daemonCore->Register_Timer( 0,
 				dc_touch_lock_files, "dc_touch_lock_files" );
 
+		// Pick up the sessions our peers had with us before a restart.
+	daemonCore->getSecMan()->RestoreSessionCache();
+
 	daemonCore->Register_Timer( 0, 5 * 60,
 				check_session_cache, "check_session_cache" );
 
@@ -24,6 +24,8 @@
 #include "classad_helpers.h" // for cleanStringForUseAsAttr
 #include "condor_config.h"   // for param
 #include "../condor_procapi/procapi.h"
+#include "cedar_compression.h"
+#include "auth_offload.h"
 #include <limits>
 
 int configured_statistics_window_quantum() {
@@ -354,6 +356,10 @@ void DaemonCore::Stats::Publish(ClassAd & ad, int flags) const
    ad.Assign("RecentDaemonCoreDutyCycle", dDutyCycle);
 
    Pool.Publish(ad, flags);
+
+   CedarCompression::Publish(ad);
+
+   AuthOffload::Publish(ad);
 }
 
 void DaemonCore::Stats::Unpublish(ClassAd & ad) const
@@ -70,6 +70,39 @@ ShouldRetryTransfer(int rval) {
     };
 }
 
+// Everything prior to the last '+' in the scheme is the credential name;
+// the actual transfer should only use everything after it.
+void
+SplitCredentialUrl(const std::string &url, std::string &cred, std::string &full_url) {
+    std::string full_scheme = getURLType(url.c_str(), false);
+    auto offset = full_scheme.find_last_of("+");
+    cred = (offset == std::string::npos) ? "" : full_scheme.substr(0, offset);
+    full_url = url;
+    if (offset != std::string::npos) {
+        full_url = full_url.substr(offset + 1);
+    }
+}
+
+// State for one file while DownloadFilesInParallel() has it queued,
+// in flight on the multi handle, or waiting for a retry.
+struct PendingDownload {
+    enum State { WAITING, ACTIVE, DONE };
+
+    std::string url;
+    std::string local_file_name;
+    std::unique_ptr<FileTransferStats> stats;
+    CURL *handle{nullptr};
+    FILE *file{nullptr};
+    struct curl_slist *header_list{nullptr};
+    char error_buffer[CURL_ERROR_SIZE];
+    struct xferProgress progress;
+    State state{WAITING};
+    long partial_bytes{0};
+    int retry_count{0};
+    time_t retry_at{0};
+    int rval{-1};
+};
+
 extern "C"
 size_t
 CurlReadCallback(char *buffer, size_t size, size_t nitems, void *userdata) {
@@ -168,36 +201,36 @@ MultiFileCurlPlugin::InitializeCurl() {
 }
 
 void
-MultiFileCurlPlugin::InitializeCurlHandle(const std::string &url, const std::string &cred,
-        struct curl_slist *& header_list)
+MultiFileCurlPlugin::InitializeCurlHandle(CURL *handle, const std::string &url, const std::string &cred,
+        struct curl_slist *& header_list, char *error_buffer, struct xferProgress *progress)
 {
 	CURLcode r;
-    r = curl_easy_setopt( _handle, CURLOPT_URL, url.c_str() );
+    r = curl_easy_setopt( handle, CURLOPT_URL, url.c_str() );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt CUROPT_URL\n");
 	}
-    r = curl_easy_setopt( _handle, CURLOPT_CONNECTTIMEOUT, 60 );
+    r = curl_easy_setopt( handle, CURLOPT_CONNECTTIMEOUT, 60 );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt CONNECTIMEOUT\n");
 	}
 
     // Provide default read / write callback functions; note these
     // don't segfault if a nullptr is given as the read/write data.
-    r = curl_easy_setopt( _handle, CURLOPT_READFUNCTION, &CurlReadCallback );
+    r = curl_easy_setopt( handle, CURLOPT_READFUNCTION, &CurlReadCallback );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt READFUNCTION\n");
 	}
-    r = curl_easy_setopt( _handle, CURLOPT_WRITEFUNCTION, &CurlWriteCallback );
+    r = curl_easy_setopt( handle, CURLOPT_WRITEFUNCTION, &CurlWriteCallback );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt WRITEFUNCTION\n");
 	}
 
     // Prevent curl from spewing to stdout / in by default.
-    r = curl_easy_setopt( _handle, CURLOPT_READDATA, NULL );
+    r = curl_easy_setopt( handle, CURLOPT_READDATA, NULL );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt READDATA\n");
 	}
-    r = curl_easy_setopt( _handle, CURLOPT_WRITEDATA, NULL );
+    r = curl_easy_setopt( handle, CURLOPT_WRITEDATA, NULL );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt WRITEDATA\n");
 	}
@@ -208,11 +241,11 @@ MultiFileCurlPlugin::InitializeCurlHandle(const std::string &url, const std::str
     if( !strncasecmp( url.c_str(), "http://", 7 ) ||
             !strncasecmp( url.c_str(), "https://", 8 ) ||
             !strncasecmp( url.c_str(), "file://", 7 ) ) {
-        r = curl_easy_setopt( _handle, CURLOPT_FOLLOWLOCATION, 1 );
+        r = curl_easy_setopt( handle, CURLOPT_FOLLOWLOCATION, 1 );
 		if (r != CURLE_OK) {
 			fprintf(stderr, "Can't setopt FOLLOWLOCATION\n");
 		}
-        r = curl_easy_setopt( _handle, CURLOPT_HEADERFUNCTION, &HeaderCallback );
+        r = curl_easy_setopt( handle, CURLOPT_HEADERFUNCTION, &HeaderCallback );
 		if (r != CURLE_OK) {
 			fprintf(stderr, "Can't setopt HEADERFUNCTOIN\n");
 		}
@@ -221,7 +254,7 @@ MultiFileCurlPlugin::InitializeCurlHandle(const std::string &url, const std::str
     }
     // Libcurl options for FTP
     else if( !strncasecmp( url.c_str(), "ftp://", 6 ) ) {
-        r = curl_easy_setopt( _handle, CURLOPT_WRITEFUNCTION, &FtpWriteCallback );
+        r = curl_easy_setopt( handle, CURLOPT_WRITEFUNCTION, &FtpWriteCallback );
 		if (r != CURLE_OK) {
 			fprintf(stderr, "Can't setopt WRITEFUNCTION\n");
 		}
@@ -240,38 +273,38 @@ MultiFileCurlPlugin::InitializeCurlHandle(const std::string &url, const std::str
     // happens? 500 errors fail before we see HTTP headers but I don't
     // think that's a big deal.
     // * Let's keep it set to 1 for now.
-    r = curl_easy_setopt( _handle, CURLOPT_FAILONERROR, 1 );
+    r = curl_easy_setopt( handle, CURLOPT_FAILONERROR, 1 );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt FAILONERROR\n");
 	}
 
     if( _diagnostic ) {
-        r = curl_easy_setopt( _handle, CURLOPT_VERBOSE, 1 );
+        r = curl_easy_setopt( handle, CURLOPT_VERBOSE, 1 );
 		if (r != CURLE_OK) {
 			fprintf(stderr, "Can't setopt VERBOSE\n");
 		}
     }
 
     // Setup a buffer to store error messages. For debug use.
-    _error_buffer[0] = '\0';
-    r = curl_easy_setopt( _handle, CURLOPT_ERRORBUFFER, _error_buffer );
+    error_buffer[0] = '\0';
+    r = curl_easy_setopt( handle, CURLOPT_ERRORBUFFER, error_buffer );
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt ERRORBUFFER\n");
 	}
 
     // Setup a transfer progress callback. We'll use this to determine if a 
     // transfer is not making progress, and if not then abort it.
-    myProgress.curl = _handle;
-    myProgress.lastRunTime = 0;
-    r = curl_easy_setopt(_handle, CURLOPT_PROGRESSFUNCTION, xferInfo);
+    progress->curl = handle;
+    progress->lastRunTime = 0;
+    r = curl_easy_setopt(handle, CURLOPT_PROGRESSFUNCTION, xferInfo);
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt PROGRESSFUNCTION\n");
 	}
-    r = curl_easy_setopt(_handle, CURLOPT_PROGRESSDATA, &myProgress);
+    r = curl_easy_setopt(handle, CURLOPT_PROGRESSDATA, progress);
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt PROGRESSDATA\n");
 	}
-    r = curl_easy_setopt(_handle, CURLOPT_NOPROGRESS, 0L);
+    r = curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
 	if (r != CURLE_OK) {
 		fprintf(stderr, "Can't setopt NOPROGRESS\n");
 	}
@@ -301,31 +334,31 @@ MultiFileCurlPlugin::OpenLocalFile(const std::string &local_file, const char *mo
 
 
 void
-MultiFileCurlPlugin::FinishCurlTransfer( int rval, FILE *file ) {
+MultiFileCurlPlugin::FinishCurlTransfer( CURL *handle, FileTransferStats &stats, const char *error_buffer, int rval, FILE *file ) {
 
     // Gather more statistics
     double bytes_downloaded;
     double transfer_connection_time;
     double transfer_total_time;
     long return_code;
-    curl_easy_getinfo( _handle, CURLINFO_SIZE_DOWNLOAD, &bytes_downloaded );
-    curl_easy_getinfo( _handle, CURLINFO_CONNECT_TIME, &transfer_connection_time );
-    curl_easy_getinfo( _handle, CURLINFO_TOTAL_TIME, &transfer_total_time );
-    curl_easy_getinfo( _handle, CURLINFO_RESPONSE_CODE, &return_code );
+    curl_easy_getinfo( handle, CURLINFO_SIZE_DOWNLOAD, &bytes_downloaded );
+    curl_easy_getinfo( handle, CURLINFO_CONNECT_TIME, &transfer_connection_time );
+    curl_easy_getinfo( handle, CURLINFO_TOTAL_TIME, &transfer_total_time );
+    curl_easy_getinfo( handle, CURLINFO_RESPONSE_CODE, &return_code );
 
-    _this_file_stats->TransferTotalBytes += ( long ) bytes_downloaded;
-    _this_file_stats->ConnectionTimeSeconds +=  ( transfer_total_time - transfer_connection_time );
-    _this_file_stats->TransferHTTPStatusCode = return_code;
-    _this_file_stats->LibcurlReturnCode = rval;
+    stats.TransferTotalBytes += ( long ) bytes_downloaded;
+    stats.ConnectionTimeSeconds +=  ( transfer_total_time - transfer_connection_time );
+    stats.TransferHTTPStatusCode = return_code;
+    stats.LibcurlReturnCode = rval;
 
     if( rval == CURLE_OK ) {
-        _this_file_stats->TransferSuccess = true;
-        _this_file_stats->TransferError = "";
-        _this_file_stats->TransferFileBytes = ftell( file );
+        stats.TransferSuccess = true;
+        stats.TransferError = "";
+        stats.TransferFileBytes = ftell( file );
     }
     else {
-        _this_file_stats->TransferSuccess = false;
-        _this_file_stats->TransferError = _error_buffer;
+        stats.TransferSuccess = false;
+        stats.TransferError = error_buffer;
     }
 }
 
@@ -341,7 +374,7 @@ MultiFileCurlPlugin::UploadFile( const std::string &url, const std::string &loca
     }
     struct curl_slist *header_list = NULL;
     try {
-        InitializeCurlHandle( url, cred, header_list );
+        InitializeCurlHandle( _handle, url, cred, header_list, _error_buffer, &myProgress );
     } catch (const std::exception &exc) {
         _this_file_stats->TransferSuccess = false;
         _this_file_stats->TransferError = exc.what();
@@ -397,7 +430,7 @@ MultiFileCurlPlugin::UploadFile( const std::string &url, const std::string &loca
 
     if (header_list) curl_slist_free_all(header_list);
 
-    FinishCurlTransfer( rval, file );
+    FinishCurlTransfer( _handle, *_this_file_stats, _error_buffer, rval, file );
 
         // Error handling and cleanup
     if( _diagnostic && rval ) {
@@ -423,7 +456,7 @@ MultiFileCurlPlugin::DownloadFile( const std::string &url, const std::string &lo
     }
     struct curl_slist *header_list = NULL;
     try {
-        InitializeCurlHandle( url, cred, header_list );
+        InitializeCurlHandle( _handle, url, cred, header_list, _error_buffer, &myProgress );
     } catch (const std::exception &exc) {
         _this_file_stats->TransferSuccess = false;
         _this_file_stats->TransferError = exc.what();
@@ -488,7 +521,7 @@ MultiFileCurlPlugin::DownloadFile( const std::string &url, const std::string &lo
         strcpy(_error_buffer, "The URL you requested could not be found.");
     }
 
-    FinishCurlTransfer( rval, file );
+    FinishCurlTransfer( _handle, *_this_file_stats, _error_buffer, rval, file );
 
         // Error handling and cleanup
     if( _diagnostic && rval ) {
@@ -579,7 +612,7 @@ MultiFileCurlPlugin::UploadMultipleFiles( const std::string &input_filename ) {
 
         // Initialize the stats structure for this transfer.
         _this_file_stats.reset(new FileTransferStats());
-        InitializeStats( url );
+        InitializeStats( *_this_file_stats, url );
         _this_file_stats->TransferStartTime = time(NULL);
 	_this_file_stats->TransferFileName = local_file_name;
 
@@ -588,16 +621,8 @@ MultiFileCurlPlugin::UploadMultipleFiles( const std::string &input_filename ) {
 
             std::this_thread::sleep_for(std::chrono::seconds(retry_count++));
 
-            // Everything prior to the first '+' is the credential name.
-            std::string full_scheme = getURLType(url.c_str(), false);
-            auto offset = full_scheme.find_last_of("+");
-            auto cred = (offset == std::string::npos) ? "" : full_scheme.substr(0, offset);
-
-            // The actual transfer should only be everything after the last '+'
-            std::string full_url = url;
-            if (offset != std::string::npos) {
-                full_url = full_url.substr(offset + 1);
-            }
+            std::string cred, full_url;
+            SplitCredentialUrl( url, cred, full_url );
 
             file_rval = UploadFile( full_url, local_file_name, cred );
             // If curl request is successful, break out of the loop
@@ -646,6 +671,9 @@ MultiFileCurlPlugin::DownloadMultipleFiles( const std::string &input_filename )
     if ( rval != 0 ) {
         return rval;
     }
+    if ( m_max_parallel > 1 && requested_files.size() > 1 ) {
+        return DownloadFilesInParallel( requested_files );
+    }
     classad::ClassAdUnParser unparser;
 
     // Iterate over the map of files to transfer.
@@ -660,7 +688,7 @@ MultiFileCurlPlugin::DownloadMultipleFiles( const std::string &input_filename )
 
         // Initialize the stats structure for this transfer.
         _this_file_stats.reset( new FileTransferStats() );
-        InitializeStats( url );
+        InitializeStats( *_this_file_stats, url );
         _this_file_stats->TransferStartTime = time(NULL);
 	_this_file_stats->TransferFileName = local_file_name;
 
@@ -671,16 +699,8 @@ MultiFileCurlPlugin::DownloadMultipleFiles( const std::string &input_filename )
 
             std::this_thread::sleep_for(std::chrono::seconds(retry_count++));
 
-            // Everything prior to the first '+' is the credential name.
-            std::string full_scheme = getURLType(url.c_str(), false);
-            auto offset = full_scheme.find_last_of("+");
-            auto cred = (offset == std::string::npos) ? "" : full_scheme.substr(0, offset);
-
-            // The actual transfer should only be everything after the last '+'
-            std::string full_url = url;
-            if (offset != std::string::npos) {
-                full_url = full_url.substr(offset + 1);
-            }
+            std::string cred, full_url;
+            SplitCredentialUrl( url, cred, full_url );
 
             // partial_bytes are updated if the file downloaded partially.
             rval = DownloadFile( full_url, local_file_name, cred, partial_bytes );
@@ -718,6 +738,304 @@ MultiFileCurlPlugin::DownloadMultipleFiles( const std::string &input_filename )
     return rval;
 }
 
+/*
+    Download the requested files over a single curl multi handle, keeping up
+    to m_max_parallel transfers in flight. Connections are cached by the multi
+    handle and reused for later files on the same host, and HTTP/2 transfers
+    to one host are multiplexed over a single connection where libcurl
+    supports it. Retries follow the same rules as the serial loop above, and
+    the per-file stats ads are written in the order the files were requested.
+    As with the serial loop, no new downloads are started once one has failed.
+*/
+int
+MultiFileCurlPlugin::DownloadFilesInParallel( const std::vector<std::pair<std::string, transfer_request>> &requested_files ) {
+
+    CURLM *multi = curl_multi_init();
+    if ( !multi ) {
+        fprintf( stderr, "Error: failed to initialize curl multi handle\n" );
+        return -1;
+    }
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt( multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX );
+#endif
+#if LIBCURL_VERSION_NUM >= 0x071e00
+    curl_multi_setopt( multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)m_max_parallel );
+#endif
+
+    if ( _diagnostic ) {
+        fprintf( stderr, "Downloading %lu files, up to %d at a time.\n",
+            (unsigned long)requested_files.size(), m_max_parallel );
+    }
+
+    std::vector<std::unique_ptr<PendingDownload>> downloads;
+    for ( const auto &file_pair : requested_files ) {
+        std::unique_ptr<PendingDownload> download( new PendingDownload() );
+        download->url = file_pair.first;
+        download->local_file_name = file_pair.second.local_file_name;
+        download->stats.reset( new FileTransferStats() );
+        InitializeStats( *download->stats, download->url );
+        download->stats->TransferStartTime = time(NULL);
+        download->stats->TransferFileName = download->local_file_name;
+        downloads.push_back( std::move(download) );
+    }
+
+    // Easy handles are recycled between files; the connections they used
+    // stay in the multi handle's cache either way.
+    std::vector<CURL *> idle_handles;
+    int running = 0;
+    bool failed = false;
+
+    for ( ;; ) {
+        time_t now = time(NULL);
+        bool waiting = false;
+
+        for ( auto &download : downloads ) {
+            if ( download->state != PendingDownload::WAITING ) {
+                continue;
+            }
+            if ( failed ) {
+                // Files already attempted keep their last result; the rest
+                // are left out of the output, as in the serial loop.
+                if ( download->retry_count ) {
+                    download->state = PendingDownload::DONE;
+                    download->stats->TransferEndTime = now;
+                }
+                continue;
+            }
+            if ( running >= m_max_parallel || download->retry_at > now ) {
+                waiting = true;
+                continue;
+            }
+
+            if ( _diagnostic ) {
+                fprintf( stderr, "Will download %s to %s.\n", download->url.c_str(), download->local_file_name.c_str() );
+                if ( download->retry_count ) { fprintf( stderr, "Retry count #%d\n", download->retry_count ); }
+            }
+            download->retry_count++;
+            download->stats->TransferType = "download";
+            download->stats->TransferTries += 1;
+
+            std::string cred, full_url;
+            SplitCredentialUrl( download->url, cred, full_url );
+
+            download->file = OpenLocalFile( download->local_file_name, download->partial_bytes ? "a+" : "w" );
+            if ( !download->file ) {
+                download->rval = -1;
+                download->state = PendingDownload::DONE;
+                download->stats->TransferEndTime = now;
+                failed = true;
+                continue;
+            }
+
+            if ( idle_handles.empty() ) {
+                download->handle = curl_easy_init();
+            } else {
+                download->handle = idle_handles.back();
+                idle_handles.pop_back();
+            }
+            if ( !download->handle ) {
+                fprintf( stderr, "Error: failed to initialize curl handle for %s\n", full_url.c_str() );
+                fclose( download->file );
+                download->file = nullptr;
+                download->rval = -1;
+                download->state = PendingDownload::DONE;
+                download->stats->TransferEndTime = now;
+                failed = true;
+                continue;
+            }
+
+            try {
+                InitializeCurlHandle( download->handle, full_url, cred, download->header_list,
+                    download->error_buffer, &download->progress );
+            } catch (const std::exception &exc) {
+                download->stats->TransferSuccess = false;
+                download->stats->TransferError = exc.what();
+                fprintf( stderr, "Error: %s.\n", exc.what() );
+                if ( download->header_list ) {
+                    curl_slist_free_all( download->header_list );
+                    download->header_list = nullptr;
+                }
+                curl_easy_reset( download->handle );
+                idle_handles.push_back( download->handle );
+                download->handle = nullptr;
+                fclose( download->file );
+                download->file = nullptr;
+                download->rval = -1;
+                download->state = PendingDownload::DONE;
+                download->stats->TransferEndTime = now;
+                failed = true;
+                continue;
+            }
+
+            curl_easy_setopt( download->handle, CURLOPT_WRITEDATA, download->file );
+            curl_easy_setopt( download->handle, CURLOPT_HEADERDATA, download->stats.get() );
+            curl_easy_setopt( download->handle, CURLOPT_PRIVATE, download.get() );
+            if ( download->header_list ) {
+                curl_easy_setopt( download->handle, CURLOPT_HTTPHEADER, download->header_list );
+            }
+            if ( download->partial_bytes ) {
+                char partial_range[20];
+                sprintf( partial_range, "%lu-", download->partial_bytes );
+                curl_easy_setopt( download->handle, CURLOPT_RANGE, partial_range );
+            }
+#if LIBCURL_VERSION_NUM >= 0x072f00
+            // Ask for HTTP/2 on https:// URLs; libcurl quietly falls back
+            // to HTTP/1.1 if it or the server can't do it.
+            curl_easy_setopt( download->handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS );
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072b00
+            // Prefer waiting to multiplex on a connection being set up to
+            // the same host over opening another one.
+            curl_easy_setopt( download->handle, CURLOPT_PIPEWAIT, 1L );
+#endif
+
+            CURLMcode mrval = curl_multi_add_handle( multi, download->handle );
+            if ( mrval != CURLM_OK ) {
+                fprintf( stderr, "Error: curl_multi_add_handle failed: %s\n", curl_multi_strerror( mrval ) );
+                if ( download->header_list ) {
+                    curl_slist_free_all( download->header_list );
+                    download->header_list = nullptr;
+                }
+                curl_easy_reset( download->handle );
+                idle_handles.push_back( download->handle );
+                download->handle = nullptr;
+                fclose( download->file );
+                download->file = nullptr;
+                download->rval = -1;
+                download->state = PendingDownload::DONE;
+                download->stats->TransferEndTime = now;
+                failed = true;
+                continue;
+            }
+            download->state = PendingDownload::ACTIVE;
+            running++;
+        }
+
+        if ( running == 0 ) {
+            if ( !waiting ) {
+                break;
+            }
+            // Everything left is waiting out a retry delay.
+            std::this_thread::sleep_for( std::chrono::seconds(1) );
+            continue;
+        }
+
+        int still_running = 0;
+        CURLMcode mrval = curl_multi_perform( multi, &still_running );
+        if ( mrval != CURLM_OK ) {
+            fprintf( stderr, "Error: curl_multi_perform failed: %s\n", curl_multi_strerror( mrval ) );
+            break;
+        }
+
+        CURLMsg *msg;
+        int msgs_left;
+        while ( (msg = curl_multi_info_read( multi, &msgs_left )) ) {
+            if ( msg->msg != CURLMSG_DONE ) {
+                continue;
+            }
+            PendingDownload *download = nullptr;
+            curl_easy_getinfo( msg->easy_handle, CURLINFO_PRIVATE, reinterpret_cast<char **>(&download) );
+            int rval = msg->data.result;
+            curl_multi_remove_handle( multi, download->handle );
+            running--;
+
+            if ( download->header_list ) {
+                curl_slist_free_all( download->header_list );
+                download->header_list = nullptr;
+            }
+
+            // Check if the request completed partially. If so, remember
+            // how far we got so the retry can resume from there.
+            if ( ( rval == CURLE_PARTIAL_FILE ) && download->stats->HttpCacheHitOrMiss != "HIT" ) {
+                std::string cred, full_url;
+                SplitCredentialUrl( download->url, cred, full_url );
+                if ( ServerSupportsResume( full_url ) ) {
+                    download->partial_bytes = ftell( download->file );
+                }
+            }
+
+            // Treat a redirect without a Location header as an error; see
+            // DownloadFile().
+            char* redirect_url;
+            long return_code;
+            curl_easy_getinfo( download->handle, CURLINFO_REDIRECT_URL, &redirect_url );
+            curl_easy_getinfo( download->handle, CURLINFO_RESPONSE_CODE, &return_code );
+            if( ( return_code == 301 || return_code == 302 ) && !redirect_url ) {
+                rval = CURLE_REMOTE_FILE_NOT_FOUND;
+                strcpy(download->error_buffer, "The URL you requested could not be found.");
+            }
+
+            FinishCurlTransfer( download->handle, *download->stats, download->error_buffer, rval, download->file );
+
+            if( _diagnostic && rval ) {
+                fprintf(stderr, "curl transfer of %s returned CURLcode %d: %s\n",
+                        download->url.c_str(), rval, curl_easy_strerror( ( CURLcode ) rval ) );
+            }
+
+            fclose( download->file );
+            download->file = nullptr;
+            curl_easy_reset( download->handle );
+            idle_handles.push_back( download->handle );
+            download->handle = nullptr;
+            download->rval = rval;
+
+            if ( rval == CURLE_OK ) {
+                download->state = PendingDownload::DONE;
+                download->stats->TransferEndTime = time(NULL);
+            }
+            else if ( download->retry_count <= MAX_RETRY_ATTEMPTS && ShouldRetryTransfer(rval) ) {
+                download->state = PendingDownload::WAITING;
+                download->retry_at = time(NULL) + download->retry_count;
+            }
+            else {
+                download->state = PendingDownload::DONE;
+                download->stats->TransferEndTime = time(NULL);
+                failed = true;
+            }
+        }
+
+        if ( running > 0 ) {
+            curl_multi_wait( multi, NULL, 0, 1000, NULL );
+        }
+    }
+
+    // Write out the stats for every file we attempted, in request order,
+    // and return the result of the first one that failed.
+    int rval = 0;
+    classad::ClassAdUnParser unparser;
+    for ( auto &download : downloads ) {
+        if ( download->state == PendingDownload::ACTIVE ) {
+            // Only reachable if curl_multi_perform() itself failed.
+            curl_multi_remove_handle( multi, download->handle );
+            if ( download->header_list ) { curl_slist_free_all( download->header_list ); }
+            curl_easy_cleanup( download->handle );
+            fclose( download->file );
+            download->rval = -1;
+            download->stats->TransferSuccess = false;
+            download->stats->TransferEndTime = time(NULL);
+        }
+        if ( !download->retry_count ) {
+            continue;
+        }
+        classad::ClassAd stats_ad;
+        download->stats->Publish( stats_ad );
+        std::string stats_string;
+        unparser.Unparse( stats_string, &stats_ad );
+        _all_files_stats += stats_string;
+
+        if ( rval == 0 && download->rval != CURLE_OK ) {
+            rval = download->rval;
+        }
+    }
+
+    for ( auto handle : idle_handles ) {
+        curl_easy_cleanup( handle );
+    }
+    curl_multi_cleanup( multi );
+
+    return rval;
+}
+
 /*
     Check if this server supports resume requests using the HTTP "Range" header
     by sending a Range request and checking the return code. Code 206 means
@@ -778,7 +1096,7 @@ MultiFileCurlPlugin::ServerSupportsResume( const std::string &url ) {
 }
 
 void
-MultiFileCurlPlugin::InitializeStats( std::string request_url ) {
+MultiFileCurlPlugin::InitializeStats( FileTransferStats &stats, std::string request_url ) {
 
     char* url = strdup( request_url.c_str() );
     char* url_token;
@@ -786,23 +1104,23 @@ MultiFileCurlPlugin::InitializeStats( std::string request_url ) {
     // Set the transfer protocol. If it's not http, ftp and file, then just
     // leave it blank because this transfer will fail quickly.
     if ( !strncasecmp( url, "http://", 7 ) ) {
-        _this_file_stats->TransferProtocol = "http";
+        stats.TransferProtocol = "http";
     }
     else if ( !strncasecmp( url, "https://", 8 ) ) {
-        _this_file_stats->TransferProtocol = "https";
+        stats.TransferProtocol = "https";
     }
     else if ( !strncasecmp( url, "ftp://", 6 ) ) {
-        _this_file_stats->TransferProtocol = "ftp";
+        stats.TransferProtocol = "ftp";
     }
     else if ( !strncasecmp( url, "file://", 7 ) ) {
-        _this_file_stats->TransferProtocol = "file";
+        stats.TransferProtocol = "file";
     }
 
     // Set the request host name by parsing it out of the URL
-    _this_file_stats->TransferUrl = url;
+    stats.TransferUrl = url;
     url_token = strtok( url, ":/" );
     url_token = strtok( NULL, "/" );
-    _this_file_stats->TransferHostName = url_token;
+    stats.TransferHostName = url_token;
 
     // Set the host name of the local machine using getaddrinfo().
     struct addrinfo hints, *info;
@@ -820,7 +1138,7 @@ MultiFileCurlPlugin::InitializeStats( std::string request_url ) {
     // Look up the host name. If this fails for any reason, do not include
     // it with the stats.
     if ( ( addrinfo_result = getaddrinfo( hostname, "http", &hints, &info ) ) == 0 ) {
-        _this_file_stats->TransferLocalMachineName = info->ai_canonname;
+        stats.TransferLocalMachineName = info->ai_canonname;
     }
 
     // Cleanup and exit
@@ -913,6 +1231,10 @@ MultiFileCurlPlugin::ParseAds() {
     if (job_ad.EvaluateAttrInt("LowSpeedTime", speed_time)) {
         m_speed_time = speed_time;
     }
+    int max_parallel;
+    if (job_ad.EvaluateAttrInt("MaxParallelTransfers", max_parallel) && max_parallel > 0) {
+        m_max_parallel = max_parallel;
+    }
 }
 
 
@@ -923,6 +1245,7 @@ main( int argc, char **argv ) {
     FILE* output_file;
     bool diagnostic = false;
     bool upload = false;
+    int max_parallel = 0;
     int rval = 0;
     std::string input_filename;
     std::string output_filename;
@@ -965,6 +1288,14 @@ main( int argc, char **argv ) {
             if ( strcmp( argv[i], "-upload" ) == 0 ) {
                 upload = true;
             }
+            if ( strcmp( argv[i], "-parallel" ) == 0 ) {
+                if ( i < ( argc - 1 ) && atoi( argv[i+1] ) > 0 ) {
+                    max_parallel = atoi( argv[i+1] );
+                }
+                else {
+                    valid_inputs = false;
+                }
+            }
         }
     }
 
@@ -974,6 +1305,7 @@ main( int argc, char **argv ) {
         fprintf( stderr, "[general-opts] are:\n" );
         fprintf( stderr, "\t-diagnostic\t\tRun the plugin in diagnostic (verbose) mode\n\n" );
         fprintf( stderr, "\t-upload\t\tRun the plugin in upload mode, copying files to a remote location\n\n" );
+        fprintf( stderr, "\t-parallel <n>\t\tDownload up to <n> files at once (overrides MaxParallelTransfers)\n\n" );
         return 1;
     }
 
@@ -983,6 +1315,9 @@ main( int argc, char **argv ) {
         fprintf( stderr, "ERROR: curl_plugin failed to initialize. Aborting.\n" );
         return 1;
     }
+    if ( max_parallel > 0 ) {
+        curl_plugin.SetMaxParallelTransfers( max_parallel );
+    }
 
     // Do the transfer(s)
     rval = upload ?
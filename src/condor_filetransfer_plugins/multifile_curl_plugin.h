@@ -12,6 +12,7 @@ struct transfer_request {
 };
 
 class FileTransferStats;
+struct xferProgress;
 
 class MultiFileCurlPlugin {
 
@@ -26,17 +27,23 @@ class MultiFileCurlPlugin {
 
     std::string GetStats() const { return _all_files_stats; }
 
+        // Number of downloads to keep in flight at once; 1 means the
+        // files are fetched one after another on a single handle.
+    void SetMaxParallelTransfers( int max_parallel ) { m_max_parallel = max_parallel; }
+
   private:
 
-    void InitializeStats( std::string request_url );
-    void InitializeCurlHandle( const std::string &request_url, const std::string &cred, struct curl_slist *& );
-    void FinishCurlTransfer( int rval, FILE *file );
+    void InitializeStats( FileTransferStats &stats, std::string request_url );
+    void InitializeCurlHandle( CURL *handle, const std::string &request_url, const std::string &cred,
+        struct curl_slist *&, char *error_buffer, struct xferProgress *progress );
+    void FinishCurlTransfer( CURL *handle, FileTransferStats &stats, const char *error_buffer, int rval, FILE *file );
 
     static size_t HeaderCallback( char* buffer, size_t size, size_t nitems, void *userdata );
     static size_t FtpWriteCallback( void* buffer, size_t size, size_t nmemb, void* stream );
     int ServerSupportsResume( const std::string &url );
     int UploadFile( const std::string &url, const std::string &local_file_name, const std::string &cred );
     int DownloadFile( const std::string &url, const std::string &local_file_name, const std::string &cred, long &partial_bytes );
+    int DownloadFilesInParallel( const std::vector<std::pair<std::string, transfer_request>> &requested_files );
     int BuildTransferRequests (const std::string & input_filename, std::vector<std::pair<std::string, transfer_request>> &requested_files) const;
     FILE *OpenLocalFile (const std::string &local_file, const char *mode) const;
 
@@ -52,4 +59,5 @@ class MultiFileCurlPlugin {
     char _error_buffer[CURL_ERROR_SIZE];
     int m_speed_limit{1024};
     int m_speed_time{30};
+    int m_max_parallel{1};
 };
@@ -30,8 +30,12 @@
 #include "simplelist.h"
 #include "condor_sockaddr.h"
 
+#include <map>
+
 class SecMan;
+class KeyCache;
 class KeyCacheEntry {
+    friend class KeyCache;
  public:
     KeyCacheEntry(
 			char const * id,
@@ -55,6 +59,10 @@ class KeyCacheEntry {
 	void                  setExpiration(int new_expiration);
 	void                  setLingerFlag(bool flag) { _lingering = flag; }
 	bool                  getLingerFlag() { return _lingering; }
+		// Set on incoming sessions that were negotiated with a peer,
+		// which are the ones worth saving across a restart.
+	void                  setPersistFlag(bool flag) { _persist = flag; }
+	bool                  getPersistFlag() { return _persist; }
 
 	void                  renewLease();
  private:
@@ -71,6 +79,11 @@ class KeyCacheEntry {
 	time_t               _lease_expiration; // time of lease expiration
 	bool                 _lingering; // true if session only exists
 	                                 // to catch lingering communication
+	bool                 _persist;   // true if worth saving across restarts
+		// Where the entry sits in its cache's expiry index.  A lease
+		// renewal only ever moves the real expiration later, so this
+		// may be earlier than expiration(), but never later.
+	time_t               _indexed_expiration;
 };
 
 
@@ -90,7 +103,22 @@ public:
 	void expire(KeyCacheEntry*);
 	int  count();
 
+		// Change the lifetime of a session in this cache.
+	void setExpiration(KeyCacheEntry*, int new_expiration);
+
 	StringList * getExpiredKeys();
+
+		/** Write the sessions marked with the persist flag to
+			filename, so that a restarted daemon can pick them up
+			with restore().  The file holds session keys and is
+			only ever readable by its owner.
+			@return the number of sessions written, or -1 on error */
+	int persist(const char *filename);
+
+		/** Add the unexpired sessions saved by persist() to the
+			cache.  The file is removed once read.
+			@return the number of sessions restored, or -1 on error */
+	int restore(const char *filename);
 	StringList * getKeysForPeerAddress(char const *addr);
 	StringList * getKeysForProcess(char const *parent_unique_id,int pid);
 
@@ -99,9 +127,15 @@ private:
 	void delete_storage();
 
 	typedef HashTable<MyString, SimpleList<KeyCacheEntry *>* > KeyCacheIndex;
+	typedef std::multimap<time_t, KeyCacheEntry *> KeyCacheExpiryIndex;
 
 	HashTable<MyString, KeyCacheEntry*> *key_table;
 	KeyCacheIndex *m_index;
+		// Entries that expire, soonest first.
+	KeyCacheExpiryIndex m_expiry_index;
+
+	void addToExpiryIndex(KeyCacheEntry *);
+	void removeFromExpiryIndex(KeyCacheEntry *);
 
 	void addToIndex(KeyCacheEntry *);
 	void removeFromIndex(KeyCacheEntry *);
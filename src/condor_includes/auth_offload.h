@@ -0,0 +1,70 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef AUTH_OFFLOAD_H
+#define AUTH_OFFLOAD_H
+
+#include "condor_classad.h"
+
+#include <functional>
+
+class Sock;
+
+/*
+ * A bounded pool of worker threads for the CPU heavy steps of server
+ * side authentication, such as a TLS handshake.  The work handed to
+ * the pool must only touch state that belongs to the connection being
+ * authenticated; no param(), no ClassAds, nothing else shared with the
+ * main thread.  While a job is pending the connection must be left
+ * alone.  When the job finishes, the main thread is told through
+ * DaemonCore pump work and calls whatever was handed to WhenDone().
+ *
+ * Only daemons start the pool, see AUTHENTICATION_WORKER_THREADS.
+ * Everywhere else Submit() refuses and the work runs inline as before.
+ */
+class AuthOffload {
+public:
+		// (Re)read AUTHENTICATION_WORKER_THREADS and
+		// AUTHENTICATION_WORKER_QUEUE_LIMIT, starting or stopping
+		// threads to match.  Must be called on the main thread.
+	static void Reconfig();
+
+		// Stop the workers and wait for them, dropping any work still
+		// queued.  Must be called on the main thread, before
+		// DaemonCore goes away.
+	static void Shutdown();
+
+		/** Run work on a worker thread on behalf of sock.
+			@return false if the pool is off or its queue is full,
+			in which case the caller should do the work itself */
+	static bool Submit( const Sock *sock, std::function<void()> work );
+
+		// Is a job for sock queued or running?
+	static bool Pending( const Sock *sock );
+
+		/** Call resume on the main thread once the job for sock is done.
+			@return false if there is no such job */
+	static bool WhenDone( const Sock *sock, std::function<void()> resume );
+
+		// Queue depth and throughput for the daemon ClassAd.  Nothing
+		// is published while the pool is off.
+	static void Publish( ClassAd &ad );
+};
+
+#endif
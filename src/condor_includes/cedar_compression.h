@@ -0,0 +1,89 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef CEDAR_COMPRESSION_H
+#define CEDAR_COMPRESSION_H
+
+#include "condor_classad.h"
+
+#include <vector>
+
+/*
+ * zlib compression of CEDAR traffic.  A ReliSock compresses what it
+ * sends once the security session has negotiated compression (see
+ * SEC_<context>_COMPRESSION).  Message packets are compressed whole,
+ * and file data sent by ReliSock::put_file() a chunk at a time.  Either
+ * way the data says whether it was compressed, so the receiver needs no
+ * setting of its own.  Data whose bytes look close to random, which is
+ * what compressed or encrypted data looks like, is sent as is without
+ * trying.
+ *
+ * Nothing is compressed on an encrypted connection unless
+ * CEDAR_COMPRESS_ENCRYPTED says so: compressing before encrypting lets
+ * anyone watching the connection learn about the plaintext from the
+ * size of what is sent (as in the CRIME attack on TLS).
+ */
+class CedarCompression {
+public:
+		// Statistics are kept by the kind of connection the data
+		// went over.
+	enum Connection {
+		ConnPlain = 0,
+		ConnEncrypted,
+		NumConnections
+	};
+
+	static Connection ConnectionType( bool encrypted )
+		{ return encrypted ? ConnEncrypted : ConnPlain; }
+
+		// Is zlib support compiled in?
+	static bool Available();
+
+		// The zlib level sockets should use, from
+		// CEDAR_COMPRESSION_LEVEL; 0 means off.
+	static int ConfiguredLevel();
+
+		// May file data be compressed before it is encrypted?  From
+		// CEDAR_COMPRESS_ENCRYPTED; false by default.
+	static bool CompressEncrypted();
+
+		/** Compress len bytes at data into out.
+			@return false, with out unspecified, if the data looks
+			incompressible or did not get smaller */
+	static bool Compress( Connection conn, int level, const char *data, int len,
+			std::vector<char> &out );
+
+		/** Inflate len bytes at data into exactly out_len bytes at out.
+			@return false if the data is corrupt or the wrong size */
+	static bool Uncompress( Connection conn, const char *data, int len,
+			char *out, int out_len );
+
+		// Record data that was sent as is.
+	static void Skipped( Connection conn, int len );
+
+		// Bytes, ratios and time spent, per kind of connection, for
+		// the daemon ClassAd.  Nothing is published until something
+		// has been compressed or uncompressed.
+	static void Publish( ClassAd &ad );
+
+private:
+	static bool LooksCompressible( const char *data, int len );
+};
+
+#endif
@@ -153,6 +153,8 @@
 #define ATTR_DAG_NODES_TOTAL "DAG_NodesTotal"
 #define ATTR_DAG_NODES_UNREADY "DAG_NodesUnready"
 #define ATTR_DAG_STATUS "DAG_Status"
+#define ATTR_DATA_REUSE_BYTES_COPIED "DataReuseBytesCopied"
+#define ATTR_DATA_REUSE_BYTES_REFLINKED "DataReuseBytesReflinked"
 #define ATTR_DAG_STATS "DAG_Stats"
 #define ATTR_DAGMAN_MAXIDLE "DAGMan_MaxIdle"
 #define ATTR_DAGMAN_MAXJOBS "DAGMan_MaxJobs"
@@ -263,6 +265,7 @@
 #define ATTR_HAS_JOB_AD_FROM_FILE  "HasJobAdFromFile"
 #define ATTR_HAS_JOB_DEFERRAL  "HasJobDeferral"
 #define ATTR_HAS_MPI  "HasMPI"
+#define ATTR_HAS_MULTI_JOB  "HasMultiJob"
 #define ATTR_HAS_OLD_VANILLA  "HasOldVanilla"
 #define ATTR_HAS_PVM  "HasPVM"
 #define ATTR_HAS_RECONNECT  "HasReconnect"
@@ -476,6 +479,8 @@
 #define ATTR_CURB_MATCHMAKING "CurbMatchmaking"
 #define ATTR_MEMORY  "Memory"
 #define ATTR_MEMORY_USAGE  "MemoryUsage"
+#define ATTR_MEMORY_PRESSURE_EVENTS  "MemoryPressureEvents"
+#define ATTR_LAST_MEMORY_PRESSURE_DATE  "LastMemoryPressureDate"
 #define ATTR_DETECTED_MEMORY  "DetectedMemory"
 #define ATTR_DETECTED_CPUS  "DetectedCpus"
 #define ATTR_MIN_HOSTS  "MinHosts"
@@ -606,6 +611,7 @@
 #define ATTR_SCHEDD_NAME  "ScheddName"
 #define ATTR_SCHEDULER  "Scheduler"
 #define ATTR_SHADOW_WAIT_FOR_DEBUG  "ShadowWaitForDebug"
+#define ATTR_SHADOW_SIGNAL  "ShadowSignal"
 #define ATTR_SHOULD_FORWARD	"ShouldForward"
 #define ATTR_SCITOKENS_FILE "ScitokensFile"
 #define ATTR_SINGULARITY_VERSION "SingularityVersion"
@@ -632,6 +638,13 @@
 #define ATTR_STARTER_ULOG_FILE  "StarterUserLog"
 #define ATTR_STARTER_ULOG_USE_XML  "StarterUserLogUseXML"
 #define ATTR_STARTER_WAIT_FOR_DEBUG  "StarterWaitForDebug"
+#define ATTR_STARTER_PREWARMED  "StarterPrewarmed"
+#define ATTR_STARTER_INIT_DURATION  "StarterInitDuration"
+#define ATTR_STARTER_JOB_AD_DURATION  "StarterJobAdDuration"
+#define ATTR_STARTER_SANDBOX_DURATION  "StarterSandboxDuration"
+#define ATTR_STARTER_ENVIRONMENT_DURATION  "StarterEnvironmentDuration"
+#define ATTR_STARTER_SPAWN_DURATION  "StarterSpawnDuration"
+#define ATTR_STARTER_STARTUP_DURATION  "StarterStartupDuration"
 #define ATTR_STATUS  "Status"
 #define ATTR_STREAM_INPUT  "StreamIn"
 #define ATTR_STREAM_OUTPUT  "StreamOut"
@@ -854,6 +867,7 @@
 #define ATTR_SEC_AUTH_REQUIRED  "AuthRequired"
 #define ATTR_SEC_ENCRYPTION  "Encryption"
 #define ATTR_SEC_INTEGRITY  "Integrity"
+#define ATTR_SEC_COMPRESSION  "Compression"
 #define ATTR_SEC_ENACT  "Enact"
 #define ATTR_SEC_RESPOND  "Respond"
 #define ATTR_SEC_COMMAND  "Command"
@@ -1099,6 +1113,7 @@ extern const char ATTR_SEC_AUTHENTICATED_USER [];
 #define ATTR_TRANSFER_QUEUE_UPLOAD_WAIT_TIME  "TransferQueueUploadWaitTime"
 #define ATTR_TRANSFER_QUEUE_DOWNLOAD_WAIT_TIME  "TransferQueueDownloadWaitTime"
 #define ATTR_SANDBOX_SIZE "SandboxSize"
+#define ATTR_TRANSFER_STREAMS "TransferStreams"
 #define ATTR_FILE_TRANSFER_UPLOAD_BYTES_PER_SECOND "FileTransferUploadBytesPerSecond"
 #define ATTR_FILE_TRANSFER_DOWNLOAD_BYTES_PER_SECOND "FileTransferDownloadBytesPerSecond"
 #define ATTR_FILE_TRANSFER_UPLOAD_DISK_LOAD "FileTransferUploadDiskLoad"
@@ -1110,6 +1125,9 @@ extern const char ATTR_SEC_AUTHENTICATED_USER [];
 #define ATTR_FILE_TRANSFER_DISK_THROTTLE_LIMIT "FileTransferDiskThrottleLimit"
 #define ATTR_FILE_TRANSFER_DISK_THROTTLE_EXCESS "FileTransferDiskThrottleExcess"
 #define ATTR_FILE_TRANSFER_DISK_THROTTLE_SHORTFALL "FileTransferDiskThrottleShortfall"
+#define ATTR_FILE_TRANSFER_UPLOAD_THROUGHPUT_LIMIT "FileTransferUploadThroughputLimit"
+#define ATTR_FILE_TRANSFER_DOWNLOAD_THROUGHPUT_LIMIT "FileTransferDownloadThroughputLimit"
+#define ATTR_TRANSFER_PEER "TransferPeer"
 #define ATTR_MACHINE_MAX_VACATE_TIME  "MachineMaxVacateTime"
 #define ATTR_JOB_MAX_VACATE_TIME  "JobMaxVacateTime"
 #define ATTR_WANT_GRACEFUL_REMOVAL  "WantGracefulRemoval"
@@ -152,6 +152,10 @@ class Condor_Auth_SSL final : public Condor_Auth_Base {
 	// Common to both client and server: fail and release state.
 	CondorAuthSSLRetval authenticate_fail();
 
+	// Hand this round's SSL_accept to an authentication worker thread.
+	// Returns false if it must be done inline.
+	bool offload_accept();
+
 	class AuthState {
 	public:
 		AuthState() {}
@@ -172,6 +176,8 @@ class Condor_Auth_SSL final : public Condor_Auth_Base {
 		SSL_CTX *m_ctx{nullptr};
 		unsigned char m_session_key[AUTH_SSL_SESSION_KEY_LEN];
 		Phase m_phase{Phase::Startup};
+		// Set by a worker thread once it has run this round's SSL_accept.
+		bool m_accept_done{false};
 	};
 
 	std::unique_ptr<AuthState> m_auth_state;
@@ -344,6 +344,10 @@ const int UPDATE_OWN_SUBMITTOR_AD = 80;
 // Request a collector to retrieve an identity token from a schedd.
 const int IMPERSONATION_TOKEN_REQUEST = 81;
 
+// Like UPDATE_STARTD_AD, but the public ad holds only the attributes
+// that changed since the last update sent on the same connection.
+const int UPDATE_STARTD_AD_DELTA = 82;
+
 /* these comments are used to control command_table_generator.pl
 NAMETABLE_DIRECTIVE:END_SECTION:collector
 */
@@ -544,6 +548,7 @@ NAMETABLE_DIRECTIVE:END_SECTION:collector
 /* Replies specific to the REQUEST_CLAIM command */
 #define REQUEST_CLAIM_LEFTOVERS		3
 #define REQUEST_CLAIM_PAIR			4
+#define REQUEST_CLAIM_SLOTS			5
 
 /* Replies specific to the SWAP_CLAIM_AND_ACTIVATION command */
 #define SWAP_CLAIM_ALREADY_SWAPPED	4
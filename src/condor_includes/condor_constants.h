@@ -89,6 +89,12 @@ static const char NULL_FILE[] = "/dev/null";
 static const char CONDOR_EXEC[] = "condor_exec.exe";
 #endif
 
+/* The directory in each execute directory that job sandboxes are moved
+ * into to await deletion, by the startd or by the starter itself when
+ * EXECUTE_CLEANUP_THREADS is set.
+ */
+static const char EXECUTE_TRASH_DIR[] = ".condor_trash";
+
 /* condor_submit canonicalizes all NULLFILE's to the UNIX_NULL_FILE */
 static const char WINDOWS_NULL_FILE[] = "NUL";
 static const char UNIX_NULL_FILE[] = "/dev/null";
@@ -0,0 +1,111 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef CONDOR_CRYPTO_AES_H
+#define CONDOR_CRYPTO_AES_H
+
+#ifdef HAVE_EXT_OPENSSL
+
+#include "condor_common.h"
+#include "condor_crypt.h"          // base class
+#include <openssl/evp.h>
+
+class Condor_Crypt_AES : public Condor_Crypt_Base {
+
+ public:
+    Condor_Crypt_AES(const KeyInfo& key, bool initiator);
+    //------------------------------------------
+    // PURPOSE: Cryto base class constructor
+    // REQUIRE: key of any length; it is hashed to
+    //          256 bits.  initiator is true on the
+    //          side that connected, false on the
+    //          side that accepted.  Each direction
+    //          gets its own IV, derived from the key
+    // RETURNS: None
+    //------------------------------------------
+
+    Condor_Crypt_AES(const KeyInfo& key,
+                     const unsigned char * enc_iv,
+                     const unsigned char * dec_iv);
+    //------------------------------------------
+    // PURPOSE: Use the key and IVs exactly as
+    //          given, for known-answer tests
+    // REQUIRE: a 32 byte key and 16 byte IVs
+    // RETURNS: None
+    //------------------------------------------
+
+    ~Condor_Crypt_AES();
+    //------------------------------------------
+    // PURPOSE: Crypto base class destructor
+    // REQUIRE: None
+    // RETURNS: None
+    //------------------------------------------
+
+    void resetState();
+
+    bool encrypt(const unsigned char *  input,
+                 int              input_len, 
+                 unsigned char *& output, 
+                 int&             output_len);
+
+    bool decrypt(const unsigned char *  input,
+                 int              input_len, 
+                 unsigned char *& output, 
+                 int&             output_len);
+
+ private:
+    Condor_Crypt_AES();
+    //------------------------------------------
+    // Private constructor
+    //------------------------------------------
+
+    void init(const unsigned char * keyData,
+              const unsigned char * enc_iv,
+              const unsigned char * dec_iv);
+    //------------------------------------------
+    // PURPOSE: Set up both contexts
+    // REQUIRE: a 32 byte key and 16 byte IVs
+    // RETURNS: None
+    //------------------------------------------
+
+    bool cfb128(EVP_CIPHER_CTX * ctx,
+                const unsigned char *  input,
+                int              input_len,
+                unsigned char *& output,
+                int&             output_len);
+    //------------------------------------------
+    // PURPOSE: Run AES-256 in 128-bit cipher
+    //          feedback mode on ctx, carrying the
+    //          feedback register across calls
+    // REQUIRE: ctx is enc_ctx_ or dec_ctx_
+    // RETURNS: true on success
+    //------------------------------------------
+
+        // Each direction has its own context and IV, so the two never
+        // share a feedback register or a key stream.
+    EVP_CIPHER_CTX *  enc_ctx_;
+    EVP_CIPHER_CTX *  dec_ctx_;
+    unsigned char     enc_iv_[16];
+    unsigned char     dec_iv_[16];
+};
+
+#endif /* HAVE_EXT_OPENSSL */
+
+#endif /* CONDOR_CRYPTO_AES_H */
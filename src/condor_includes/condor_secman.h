@@ -291,6 +291,14 @@ public:
 		// session, the lingering session will simply be replaced.
 	bool SetSessionLingerFlag(char const *session_id);
 
+		// Save the incoming sessions peers negotiated with us to
+		// SEC_SESSION_CACHE_FILE, with this daemon's name added, on
+		// the way out, and pick them up again on startup, so that
+		// peers can carry on using them across a restart instead of
+		// authenticating again.
+	void PersistSessionCache();
+	void RestoreSessionCache();
+
  private:
 	void invalidateOneExpiredCache(KeyCache *session_cache);
 
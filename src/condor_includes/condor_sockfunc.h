@@ -24,6 +24,11 @@
 
 int condor_connect(int sockfd, const condor_sockaddr& addr);
 int condor_accept(int sockfd, condor_sockaddr& addr);
+#if defined(HAVE_ACCEPT4)
+// accept4(): the new socket gets only the given flags, and does not take
+// O_NONBLOCK from a non-blocking listener, as it would on some platforms
+int condor_accept4(int sockfd, condor_sockaddr& addr, int flags);
+#endif
 int condor_bind(int sockfd, const condor_sockaddr& addr);
 int condor_getsockname(int sockfd, condor_sockaddr& addr);
 int condor_getpeername(int sockfd, condor_sockaddr& addr);
@@ -137,6 +137,9 @@
 /* Define to 1 if you have the <pthread.h> header file. (USED)*/
 #cmakedefine HAVE_PTHREAD_H 1
 
+/* Define to 1 if you have the 'accept4' function. (USED)*/
+#cmakedefine HAVE_ACCEPT4 1
+
 /* Define to 1 if you have the 'access' function. */
 #cmakedefine HAVE_ACCESS 1
 
@@ -476,6 +479,9 @@
 /* "use system (v)snprintf instead of our replacement" (USED)*/
 #cmakedefine HAVE_WORKING_SNPRINTF 1
 
+/* Define to 1 if you have the <zlib.h> header file. (USED)*/
+#cmakedefine HAVE_ZLIB_H 1
+
 /* Define to 1 if you have the '_fstati64' function. (USED)*/
 #cmakedefine HAVE__FSTATI64 1
 
@@ -92,6 +92,7 @@ struct DebugFileInfo
 	bool rotate_by_time; // when true, logMax is a time interval for rotation
 	bool dont_panic;
 	void *userData;
+	long long asyncLength; // size of the file once queued writes are done
 	DebugFileInfo() :
 			outputTarget(FILE_OUT),
 			debugFP(0),
@@ -105,12 +106,13 @@ struct DebugFileInfo
 			rotate_by_time(false),
 			dont_panic(false),
 			userData(NULL),
+			asyncLength(0),
 			dprintfFunc(NULL)
 			{}
 	DebugFileInfo(const DebugFileInfo &dfi) : outputTarget(dfi.outputTarget), debugFP(NULL),
 		choice(dfi.choice), headerOpts(dfi.headerOpts),
 		logPath(dfi.logPath), maxLog(dfi.maxLog), logZero(dfi.logZero), maxLogNum(dfi.maxLogNum), want_truncate(dfi.want_truncate),
-		accepts_all(dfi.accepts_all), rotate_by_time(dfi.rotate_by_time), dont_panic(dfi.dont_panic), userData(dfi.userData), dprintfFunc(dfi.dprintfFunc) {}
+		accepts_all(dfi.accepts_all), rotate_by_time(dfi.rotate_by_time), dont_panic(dfi.dont_panic), userData(dfi.userData), asyncLength(0), dprintfFunc(dfi.dprintfFunc) {}
 	DebugFileInfo(const dprintf_output_settings&);
 	~DebugFileInfo();
 	bool MatchesCatAndFlags(int cat_and_flags) const;
@@ -149,5 +151,20 @@ void _dprintf_to_buffer(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info
 void dprintf_to_outdbgstr(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, const char* message, DebugFileInfo* dbgInfo);
 #endif
 
+// Asynchronous writer for FILE_OUT logs, see dprintf_async.cpp.
+// buffer_size of 0 flushes and stops the writer thread.
+bool dprintf_async_configure(long long buffer_size);
+bool dprintf_async_active();
+enum { DPRINTF_ASYNC_QUEUED, DPRINTF_ASYNC_DROPPED, DPRINTF_ASYNC_TOO_BIG };
+// Queue a formatted record for fd.  On DPRINTF_ASYNC_TOO_BIG the queue has been
+// flushed and the caller should write the record itself.
+int dprintf_async_write(int fd, const char * data, int len);
+// Number of records dropped since the last call, and in total.
+long long dprintf_async_take_drops(long long & total_dropped);
+// Wait for the writer thread to write everything queued so far.
+void dprintf_async_flush();
+// Async-signal-safe; writes out whatever is queued and stops the writer.
+void dprintf_async_crash_flush();
+
 #endif
 
@@ -29,6 +29,7 @@
 #include "condor_md.h"
 
 #include <memory>
+#include <vector>
 
 /*
 **	R E L I A B L E    S O C K
@@ -147,6 +148,14 @@ public:
 	int accept(ReliSock &);
     ///
 	int accept(ReliSock *);
+	/** Accept a connection only if one is already waiting, so that a
+		caller can take every waiting connection in turn without
+		checking the listen socket in between.  Makes the listen socket
+		non-blocking; the accepted sockets are not.  Where that can't be
+		done (no accept4()), this just calls accept().
+		@param would_block set if no connection was waiting
+		@return the new socket, or NULL */
+	ReliSock *accept_nonblocking( bool & would_block );
 
     ///
 	int put_line_raw( const char *buffer );
@@ -178,7 +187,8 @@ public:
 				  bool flush_buffers=false, bool append=false, filesize_t max_bytes=-1, class DCTransferQueue *xfer_q=NULL);
     /// returns <0 on failure, 0 for ok
 	//  See put_file() for the meaning of specific return codes.
-	int put_file_with_permissions( filesize_t *size, const char *source, filesize_t max_bytes=-1, class DCTransferQueue *xfer_q=NULL);
+	//  A non-zero offset sends only what follows it, as put_file() does.
+	int put_file_with_permissions( filesize_t *size, const char *source, filesize_t max_bytes=-1, class DCTransferQueue *xfer_q=NULL, filesize_t offset=0);
 	// xfer_q (if not NULL) is used to report i/o stats
     /// returns <0 on failure, 0 for ok
 	//  failure codes: PUT_FILE_OPEN_FAILED  (errno contains specific error)
@@ -284,6 +294,21 @@ public:
 
 	bool is_closed() const {return rcv_msg.m_closed;}
 
+		// Compress what this socket sends from now on, as negotiated
+		// by the security session; see cedar_compression.h.  Received
+		// data is uncompressed whether or not this is set.
+	void set_compression(bool enable);
+		// Whether what is sent right now gets compressed: while
+		// encryption is on, only if CEDAR_COMPRESS_ENCRYPTED allows it.
+	bool get_compression() const
+		{return m_compress_level > 0 && (!get_encryption() || m_compress_encrypted);}
+
+		// Whether put_file() may hand unencrypted file data to
+		// sendfile().  Unless this is called, put_file() reads
+		// ENABLE_SENDFILE itself, so a socket used off the main thread
+		// must be told.
+	void set_sendfile(bool enable) {m_sendfile = enable ? 1 : 0;}
+
 	// serialize and deserialize
 	const char * serialize(const char *);	// restore state from buffer
 	char * serialize() const;	// save state into buffer
@@ -297,6 +322,7 @@ protected:
 
         virtual bool init_MD(CONDOR_MD_MODE mode, KeyInfo * key, const char * keyId);
         virtual bool set_encryption_id(const char * keyId);
+	virtual bool isCryptoInitiator() const { return is_client != 0; }
 
 	/*
 	**	Types
@@ -309,6 +335,12 @@ protected:
 	*/
 
 	int prepare_for_nobuffering( stream_coding = stream_unknown);
+		// Set up a socket just accepted from this one in c.
+	void setup_accepted( ReliSock &c, int c_sock );
+		// One chunk of file data when put_file() compresses; see
+		// cedar_no_ckpt.cpp.
+	int put_file_chunk( const char *data, int len );
+	int get_file_chunk( std::vector<char> &buf, filesize_t max_len );
 	int perform_authenticate( bool with_key, KeyInfo *& key, 
 							  const char* methods, CondorError* errstack,
 							  int auth_timeout, bool non_blocking, char **method_used );
@@ -339,6 +371,8 @@ protected:
 		int			ready;
 		bool m_closed;
 		bool init_MD(CONDOR_MD_MODE mode, KeyInfo * key);
+	private:
+		bool uncompress_packet();
 	} rcv_msg;
 
 	class SndMsg {
@@ -368,7 +402,8 @@ protected:
 
         bool init_MD(CONDOR_MD_MODE mode, KeyInfo * key);
 
-
+	private:
+		bool compress_packet(int header_size);
 	} snd_msg;
 
 	relisock_state	_special_state;
@@ -390,7 +425,12 @@ protected:
 
 	bool m_has_backlog;
 	bool m_read_would_block;
+		// the listen socket has been made non-blocking
+	bool m_listen_nonblocking{false};
 	bool m_non_blocking;
+	int m_compress_level;
+	bool m_compress_encrypted;
+	int m_sendfile;	// -1 until set_sendfile()
 
 	virtual void setTargetSharedPortID( char const *id );
 	virtual bool sendTargetSharedPortID();
@@ -288,6 +288,18 @@ public:
         //          key id -- if the data is checksumed
         //------------------------------------------
 
+        bool set_derived_session_keys(const Sock &parent, const char *salt);
+        //------------------------------------------
+        // PURPOSE: key this socket from the encryption and MAC
+        //          keys in use on parent, so that an extra connection
+        //          opened alongside it is protected by the same session
+        //          without reusing its cipher stream.  Encryption is
+        //          left off; turn it on with set_crypto_mode().
+        // REQUIRE: salt -- a value both peers agreed on over parent,
+        //          different for every connection derived from it
+        // RETURNS: true -- success; false -- failure
+        //------------------------------------------
+
 	/*
 	**	Stream protocol
 	*/
@@ -537,6 +549,10 @@ protected:
 	void resetCrypto();
 	virtual bool canEncrypt() const;
 
+	// True on the side that started the conversation.  AES_CFB gives
+	// each direction its own IV, and needs to know which one it sends.
+	virtual bool isCryptoInitiator() const { return is_connected(); }
+
 	/*
 	**	Data structures
 	*/
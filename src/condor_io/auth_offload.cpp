@@ -0,0 +1,283 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "condor_daemon_core.h"
+#include "auth_offload.h"
+#include "utc_time.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Job {
+	const Sock *sock{nullptr};
+	std::function<void()> work;
+	std::function<void()> resume;
+	double queued_at{0};
+};
+
+	// Everything here is protected by pool_mutex.
+std::mutex pool_mutex;
+std::condition_variable work_ready;
+std::deque<Job *> work_queue;
+int target_threads = 0;
+int live_threads = 0;
+int busy_threads = 0;
+size_t queue_limit = 0;
+size_t peak_queue_depth = 0;
+long long jobs_offloaded = 0;
+long long jobs_completed = 0;
+long long jobs_run_inline = 0;
+double queue_seconds = 0;
+double work_seconds = 0;
+	// Workers that have returned and are waiting to be joined.
+std::vector<std::thread::id> exited_threads;
+
+	// Every worker started and not yet joined.  Only touched on the
+	// main thread.
+std::vector<std::thread> workers;
+
+	// Submitted jobs that the main thread has not yet heard the end of.
+	// Only touched on the main thread.
+std::map<const Sock *, Job *> pending_jobs;
+
+int
+job_done( void * /*cls*/, void *data )
+{
+	Job *job = static_cast<Job *>( data );
+
+	auto it = pending_jobs.find( job->sock );
+	if( it != pending_jobs.end() && it->second == job ) {
+		pending_jobs.erase( it );
+	}
+	if( job->resume ) {
+		job->resume();
+	}
+	delete job;
+	return 0;
+}
+
+void
+worker_main()
+{
+#ifndef WIN32
+		// Signal handlers belong on the main thread.
+	sigset_t all;
+	sigfillset( &all );
+	pthread_sigmask( SIG_BLOCK, &all, NULL );
+#endif
+
+	std::unique_lock<std::mutex> guard( pool_mutex );
+	for(;;) {
+		while( work_queue.empty() && live_threads <= target_threads ) {
+			work_ready.wait( guard );
+		}
+			// When shutting the pool down entirely, the last threads
+			// stay long enough to finish what was already queued.
+		if( live_threads > target_threads &&
+			( work_queue.empty() || target_threads > 0 ) )
+		{
+			live_threads--;
+			exited_threads.push_back( std::this_thread::get_id() );
+			return;
+		}
+
+		Job *job = work_queue.front();
+		work_queue.pop_front();
+		busy_threads++;
+		guard.unlock();
+
+		double start = condor_gettimestamp_double();
+		job->work();
+		double finish = condor_gettimestamp_double();
+
+		guard.lock();
+		busy_threads--;
+		jobs_completed++;
+		queue_seconds += start - job->queued_at;
+		work_seconds += finish - start;
+		guard.unlock();
+
+		daemonCore->Register_PumpWork_TS( job_done, NULL, job );
+
+		guard.lock();
+	}
+}
+
+	// Join the workers that have stopped since the last call.
+void
+join_exited_workers()
+{
+	std::vector<std::thread::id> exited;
+	{
+		std::lock_guard<std::mutex> guard( pool_mutex );
+		exited.swap( exited_threads );
+	}
+	for( auto &id : exited ) {
+		for( auto it = workers.begin(); it != workers.end(); ++it ) {
+			if( it->get_id() == id ) {
+				it->join();
+				workers.erase( it );
+				break;
+			}
+		}
+	}
+}
+
+}
+
+
+void
+AuthOffload::Reconfig()
+{
+	int threads = param_integer( "AUTHENTICATION_WORKER_THREADS", 0, 0, 64 );
+	int limit = param_integer( "AUTHENTICATION_WORKER_QUEUE_LIMIT", 1000, 1 );
+#ifdef WIN32
+		// pump work is how workers hand results back, and that is
+		// not worth the trouble here
+	threads = 0;
+#endif
+
+	if( threads > 0 ) {
+			// The work logs, e.g. from the TLS verify callback.
+		dprintf_make_thread_safe();
+	}
+
+	join_exited_workers();
+
+	std::lock_guard<std::mutex> guard( pool_mutex );
+	if( threads != target_threads ) {
+		dprintf( D_FULLDEBUG, "Using %d authentication worker thread(s).\n", threads );
+	}
+	target_threads = threads;
+	queue_limit = limit;
+	while( live_threads < target_threads ) {
+		workers.emplace_back( worker_main );
+		live_threads++;
+	}
+	work_ready.notify_all();
+}
+
+
+void
+AuthOffload::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> guard( pool_mutex );
+		target_threads = 0;
+			// Nobody is left to hear how queued work turns out.
+		for( Job *job : work_queue ) {
+			delete job;
+		}
+		work_queue.clear();
+	}
+	work_ready.notify_all();
+
+	for( auto &worker : workers ) {
+		worker.join();
+	}
+	workers.clear();
+	exited_threads.clear();
+	pending_jobs.clear();
+}
+
+
+bool
+AuthOffload::Submit( const Sock *sock, std::function<void()> work )
+{
+	if( !daemonCore || !sock ) {
+		return false;
+	}
+	if( pending_jobs.find( sock ) != pending_jobs.end() ) {
+		EXCEPT( "AuthOffload: second job submitted for %s", sock->peer_description() );
+	}
+
+	Job *job = new Job;
+	job->sock = sock;
+	job->work = std::move( work );
+	job->queued_at = condor_gettimestamp_double();
+	{
+		std::lock_guard<std::mutex> guard( pool_mutex );
+		if( target_threads <= 0 ) {
+			delete job;
+			return false;
+		}
+		if( work_queue.size() >= queue_limit ) {
+			jobs_run_inline++;
+			delete job;
+			return false;
+		}
+		work_queue.push_back( job );
+		jobs_offloaded++;
+		if( work_queue.size() > peak_queue_depth ) {
+			peak_queue_depth = work_queue.size();
+		}
+	}
+	pending_jobs[sock] = job;
+	work_ready.notify_one();
+	return true;
+}
+
+
+bool
+AuthOffload::Pending( const Sock *sock )
+{
+	return pending_jobs.find( sock ) != pending_jobs.end();
+}
+
+
+bool
+AuthOffload::WhenDone( const Sock *sock, std::function<void()> resume )
+{
+	auto it = pending_jobs.find( sock );
+	if( it == pending_jobs.end() ) {
+		return false;
+	}
+		// Safe without the pool lock; only the main thread reads this,
+		// and only after the worker is done with the job.
+	it->second->resume = std::move( resume );
+	return true;
+}
+
+
+void
+AuthOffload::Publish( ClassAd &ad )
+{
+	std::lock_guard<std::mutex> guard( pool_mutex );
+	if( target_threads <= 0 && !jobs_offloaded ) {
+		return;
+	}
+	ad.Assign( "AuthenticationWorkerThreads", target_threads );
+	ad.Assign( "AuthenticationWorkersBusy", busy_threads );
+	ad.Assign( "AuthenticationQueueDepth", (long long)work_queue.size() );
+	ad.Assign( "AuthenticationQueueDepthPeak", (long long)peak_queue_depth );
+	ad.Assign( "AuthenticationsOffloaded", jobs_offloaded );
+	ad.Assign( "AuthenticationsCompleted", jobs_completed );
+	ad.Assign( "AuthenticationsRunInline", jobs_run_inline );
+	ad.Assign( "AuthenticationQueueSeconds", queue_seconds );
+	ad.Assign( "AuthenticationWorkSeconds", work_seconds );
+}
@@ -0,0 +1,209 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "cedar_compression.h"
+#include "utc_time.h"
+
+#include <math.h>
+#include <mutex>
+
+#if defined(HAVE_ZLIB_H)
+#include <zlib.h>
+#endif
+
+// Sampled bytes with at least this much entropy, in bits per byte, are
+// taken to be compressed or encrypted already.  Text and ClassAds come
+// in well under 6; zlib and AES output are very close to 8.
+static const double INCOMPRESSIBLE_ENTROPY = 7.5;
+
+// How many bytes of a buffer the entropy probe looks at.
+static const int ENTROPY_SAMPLE = 1024;
+
+// Anything smaller isn't worth the trouble.
+static const int MIN_COMPRESS_BYTES = 256;
+
+namespace {
+
+struct TrafficStats {
+	long long raw_bytes{0};        // bytes that went into the compressor
+	long long wire_bytes{0};       // what came out, when it was used
+	long long skipped_bytes{0};    // sent as is
+	long long inflated_bytes{0};   // bytes produced by uncompressing
+	double compress_time{0};
+	double uncompress_time{0};
+};
+
+std::mutex stats_mutex;
+TrafficStats traffic_stats[CedarCompression::NumConnections];
+const char *connection_names[CedarCompression::NumConnections] = { "Plain", "Encrypted" };
+
+}
+
+
+bool
+CedarCompression::Available()
+{
+#if defined(HAVE_ZLIB_H)
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+int
+CedarCompression::ConfiguredLevel()
+{
+	if( !Available() ) {
+		return 0;
+	}
+	return param_integer( "CEDAR_COMPRESSION_LEVEL", 1, 0, 9 );
+}
+
+
+bool
+CedarCompression::CompressEncrypted()
+{
+	return param_boolean( "CEDAR_COMPRESS_ENCRYPTED", false );
+}
+
+
+bool
+CedarCompression::LooksCompressible( const char *data, int len )
+{
+	int counts[256];
+	memset( counts, 0, sizeof(counts) );
+
+	int samples = len < ENTROPY_SAMPLE ? len : ENTROPY_SAMPLE;
+	int stride = len / samples;
+	for( int i = 0; i < samples; i++ ) {
+		counts[(unsigned char)data[i * stride]]++;
+	}
+
+	double entropy = 0;
+	for( int c = 0; c < 256; c++ ) {
+		if( counts[c] ) {
+			double p = (double)counts[c] / samples;
+			entropy -= p * log2( p );
+		}
+	}
+	return entropy < INCOMPRESSIBLE_ENTROPY;
+}
+
+
+bool
+CedarCompression::Compress( Connection conn, int level, const char *data, int len,
+	std::vector<char> &out )
+{
+#if defined(HAVE_ZLIB_H)
+	if( level <= 0 || len < MIN_COMPRESS_BYTES || !LooksCompressible( data, len ) ) {
+		Skipped( conn, len );
+		return false;
+	}
+
+	double start = condor_gettimestamp_double();
+	uLongf out_len = compressBound( len );
+	out.resize( out_len );
+	int rc = compress2( (Bytef *)&out[0], &out_len, (const Bytef *)data, len, level );
+	double elapsed = condor_gettimestamp_double() - start;
+
+		// Demand a real saving; otherwise the receiver's time is wasted.
+	bool used = rc == Z_OK && out_len < (uLongf)(len - len / 8);
+	if( used ) {
+		out.resize( out_len );
+	} else if( rc != Z_OK ) {
+		dprintf( D_NETWORK, "CedarCompression: compress2() failed: %d\n", rc );
+	}
+
+	std::lock_guard<std::mutex> guard( stats_mutex );
+	TrafficStats &stats = traffic_stats[conn];
+	stats.compress_time += elapsed;
+	stats.raw_bytes += len;
+	stats.wire_bytes += used ? (long long)out_len : len;
+	return used;
+#else
+	(void)level; (void)out;
+	Skipped( conn, len );
+	return false;
+#endif
+}
+
+
+bool
+CedarCompression::Uncompress( Connection conn, const char *data, int len,
+	char *out, int out_len )
+{
+#if defined(HAVE_ZLIB_H)
+	double start = condor_gettimestamp_double();
+	uLongf inflated = out_len;
+	int rc = uncompress( (Bytef *)out, &inflated, (const Bytef *)data, len );
+	double elapsed = condor_gettimestamp_double() - start;
+
+	if( rc != Z_OK || inflated != (uLongf)out_len ) {
+		dprintf( D_ALWAYS, "CedarCompression: failed to uncompress %d bytes "
+				 "into %d (rc=%d, got %lu)\n", len, out_len, rc,
+				 (unsigned long)inflated );
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard( stats_mutex );
+	TrafficStats &stats = traffic_stats[conn];
+	stats.uncompress_time += elapsed;
+	stats.inflated_bytes += out_len;
+	return true;
+#else
+	(void)conn; (void)data; (void)len; (void)out; (void)out_len;
+	dprintf( D_ALWAYS, "CedarCompression: received compressed data, but "
+			 "compression is not supported\n" );
+	return false;
+#endif
+}
+
+
+void
+CedarCompression::Skipped( Connection conn, int len )
+{
+	std::lock_guard<std::mutex> guard( stats_mutex );
+	traffic_stats[conn].skipped_bytes += len;
+}
+
+
+void
+CedarCompression::Publish( ClassAd &ad )
+{
+	std::lock_guard<std::mutex> guard( stats_mutex );
+	for( int t = 0; t < NumConnections; t++ ) {
+		const TrafficStats &stats = traffic_stats[t];
+		if( !stats.raw_bytes && !stats.inflated_bytes ) {
+			continue;
+		}
+		std::string prefix = std::string( "Cedar" ) + connection_names[t];
+		ad.Assign( (prefix + "CompressedBytes").c_str(), stats.raw_bytes );
+		ad.Assign( (prefix + "CompressedWireBytes").c_str(), stats.wire_bytes );
+		ad.Assign( (prefix + "UncompressedBytes").c_str(), stats.skipped_bytes );
+		ad.Assign( (prefix + "InflatedBytes").c_str(), stats.inflated_bytes );
+		ad.Assign( (prefix + "CompressionRatio").c_str(),
+				stats.wire_bytes ? (double)stats.raw_bytes / stats.wire_bytes : 1.0 );
+		ad.Assign( (prefix + "CompressionSeconds").c_str(), stats.compress_time );
+		ad.Assign( (prefix + "DecompressionSeconds").c_str(), stats.uncompress_time );
+	}
+}
@@ -45,13 +45,35 @@
 #include "ipv6_hostname.h"
 #include "condor_fsync.h"
 #include "dc_transfer_queue.h"
+#include "cedar_compression.h"
+
+#include "selector.h"
 
 #ifdef WIN32
 #include <mswsock.h>	// For TransmitFile()
 #endif
+#ifdef LINUX
+#include <sys/sendfile.h>
+#endif
 
 const unsigned int PUT_FILE_EOM_NUM = 666;
 
+// Size of the buffer used to copy file data to or from the network.
+// Unencrypted data is moved in chunks of up to 1MB, so large files
+// take fewer system calls.  Encrypted data stays at 64k, so that both
+// ends agree on the size of each encrypted block.
+static size_t
+file_xfer_buffer_size( bool encrypted, filesize_t bytes )
+{
+	const size_t default_size = 65536;
+	const size_t max_size = 1024 * 1024;
+
+	if( encrypted || bytes <= (filesize_t)default_size ) {
+		return default_size;
+	}
+	return bytes < (filesize_t)max_size ? (size_t)bytes : max_size;
+}
+
 // This special file descriptor number must not be a valid fd number.
 // It is used to make get_file() consume transferred data without writing it.
 const int GET_FILE_NULL_FD = -10;
@@ -128,13 +150,11 @@ ReliSock::get_file( filesize_t *size, const char *destination,
 	return result;
 }
 
-MSC_DISABLE_WARNING(6262) // function uses 64k of stack
 int
 ReliSock::get_file( filesize_t *size, int fd,
 					bool flush_buffers, bool append, filesize_t max_bytes,
 					DCTransferQueue *xfer_q)
 {
-	char buf[65536];
 	filesize_t filesize, bytes_to_receive;
 	unsigned int eom_num;
 	filesize_t total = 0;
@@ -144,8 +164,11 @@ ReliSock::get_file( filesize_t *size, int fd,
 		// NOTE: the caller may pass fd=GET_FILE_NULL_FD, in which
 		// case we just read but do not write the data.
 
-	// Read the filesize from the other end of the wire
-	if ( !get(filesize) || !end_of_message() ) {
+	// Read the filesize from the other end of the wire, and whether the
+	// data follows in compressed chunks; see put_file().
+	int chunked = 0;
+	if ( !get(filesize) || (!peek_end_of_message() && !get(chunked)) ||
+		 !end_of_message() ) {
 		dprintf(D_ALWAYS, 
 				"Failed to receive filesize in ReliSock::get_file\n");
 		return -1;
@@ -170,15 +193,21 @@ ReliSock::get_file( filesize_t *size, int fd,
 		*/
 
 	// Now, read it all in & save it
+	std::vector<char> buf( file_xfer_buffer_size( get_encryption(), bytes_to_receive ) );
 	while( total < bytes_to_receive ) {
 		struct timeval t1,t2;
 		if( xfer_q ) {
 			condor_gettimestamp(t1);
 		}
 
-		int	iosize =
-			(int) MIN( (filesize_t) sizeof(buf), bytes_to_receive - total );
-		int	nbytes = get_bytes_nobuffer( buf, iosize, 0 );
+		int nbytes;
+		if( chunked ) {
+			nbytes = get_file_chunk( buf, bytes_to_receive - total );
+		} else {
+			int	iosize =
+				(int) MIN( (filesize_t) buf.size(), bytes_to_receive - total );
+			nbytes = get_bytes_nobuffer( &buf[0], iosize, 0 );
+		}
 
 		if( xfer_q ) {
 			condor_gettimestamp(t2);
@@ -302,7 +331,6 @@ ReliSock::get_file( filesize_t *size, int fd,
 	errno = saved_errno;
 	return retval;
 }
-MSC_RESTORE_WARNING(6262) // function uses 64k of stack
 
 int
 ReliSock::put_empty_file( filesize_t *size )
@@ -357,7 +385,6 @@ ReliSock::put_file( filesize_t *size, const char *source, filesize_t offset, fil
 	return result;
 }
 
-MSC_DISABLE_WARNING(6262) // function uses 64k of stack
 int
 ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_bytes, DCTransferQueue *xfer_q )
 {
@@ -412,8 +439,11 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 		max_bytes_exceeded = true;
 	}
 
-	// Send the file size to the receiver
-	if ( !put(bytes_to_send) || !end_of_message() ) {
+	// Send the file size to the receiver.  If this socket compresses,
+	// follow it with a flag saying the data comes in chunks, each with
+	// its own header, instead of as a plain stream of bytes.
+	bool chunked = get_compression();
+	if ( !put(bytes_to_send) || (chunked && !put(1)) || !end_of_message() ) {
 		dprintf(D_ALWAYS, "ReliSock: put_file: Failed to send filesize.\n");
 		return -1;
 	}
@@ -433,7 +463,7 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 		// On Win32, if we don't need encryption, use the super-efficient Win32
 		// TransmitFile system call. Also, TransmitFile does not support
 		// file sizes over 2GB, so we avoid that case as well.
-		if (  (!get_encryption()) &&
+		if (  (!get_encryption()) && (!chunked) &&
 			  (0 == offset) &&
 			  (bytes_to_send < INT_MAX)  ) {
 
@@ -475,12 +505,110 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 		}
 #endif
 
-		char buf[65536];
+#if defined(LINUX)
+		// On Linux, if we don't need encryption, have the kernel copy
+		// the file straight into the socket with sendfile() instead of
+		// reading it through a buffer of our own.  No message digest
+		// is computed over file data in either case, because
+		// put_bytes_nobuffer() bypasses it.
+		bool use_sendfile = m_sendfile >= 0 ? m_sendfile > 0 :
+			param_boolean( "ENABLE_SENDFILE", true );
+		if ( !get_encryption() && !chunked && use_sendfile ) {
+
+			// First drain outgoing buffers
+			if ( !prepare_for_nobuffering(stream_encode) ) {
+				dprintf(D_ALWAYS,
+						"ReliSock: put_file: failed to drain buffers!\n");
+				return -1;
+			}
+
+			Selector selector;
+			selector.add_fd( _sock, Selector::IO_WRITE );
+			off_t file_offset = offset;
+
+			while (total < bytes_to_send) {
+				if ( _timeout > 0 ) {
+					selector.set_timeout( _timeout );
+					selector.execute();
+					if ( selector.signalled() ) {
+						continue;
+					}
+					if ( !selector.has_ready() ) {
+						dprintf(D_ALWAYS,
+								"ReliSock: put_file: timed out sending to %s\n",
+								peer_description() );
+						return -1;
+					}
+				}
+
+				struct timeval t1;
+				if( xfer_q ) {
+					condor_gettimestamp(t1);
+				}
+
+				size_t chunk = file_xfer_buffer_size( false, bytes_to_send - total );
+				ssize_t nsent = sendfile( _sock, fd, &file_offset, chunk );
+				int sendfile_errno = errno;
+
+				if( xfer_q ) {
+					struct timeval t2;
+					condor_gettimestamp(t2);
+						// We don't know how much of the time was spent
+						// reading from disk vs. writing to the network,
+						// so we just report it all as network i/o time.
+					xfer_q->AddUsecNetWrite(timersub_usec(t2, t1));
+					if ( nsent > 0 ) {
+						xfer_q->AddBytesSent(nsent);
+					}
+					xfer_q->ConsiderSendingReport(t2.tv_sec);
+				}
+
+				if ( nsent < 0 ) {
+					if ( sendfile_errno == EINTR || sendfile_errno == EAGAIN ) {
+						continue;
+					}
+					if ( total == 0 && (sendfile_errno == EINVAL || sendfile_errno == ENOSYS) ) {
+							// This file can't be sent this way; fall
+							// back to the read loop below.
+						dprintf(D_FULLDEBUG,
+								"ReliSock: put_file: sendfile() not supported "
+								"for this file (errno=%d), copying instead\n",
+								sendfile_errno );
+						break;
+					}
+					dprintf(D_ALWAYS,
+							"ReliSock: put_file: sendfile() failed, errno=%d (%s)\n",
+							sendfile_errno, strerror(sendfile_errno) );
+					return -1;
+				}
+				if ( nsent == 0 ) {
+						// The file is shorter than it was when we
+						// stat'ed it; the check below reports this.
+					break;
+				}
+				total += nsent;
+				_bytes_sent += nsent;
+			}
+			if ( total > 0 ) {
+				dprintf(D_FULLDEBUG,
+						"ReliSock: put_file: sendfile() sent " FILESIZE_T_FORMAT " bytes\n",
+						total );
+			}
+
+				// sendfile() does not move the file offset, so put it
+				// where the read loop below should pick up, if needed.
+			if ( total < bytes_to_send ) {
+				lseek( fd, offset + total, SEEK_SET );
+			}
+		}
+#endif
+
+		std::vector<char> buf( file_xfer_buffer_size( get_encryption(), bytes_to_send - total ) );
 		int nbytes, nrd;
 
-		// On Unix, always send the file using put_bytes_nobuffer().
-		// Note that on Win32, we use this method as well if encryption 
-		// is required.
+		// On Unix, send the file using put_bytes_nobuffer() when
+		// sendfile() can't be used.  Note that on Win32, we use this
+		// method as well if encryption is required.
 		while (total < bytes_to_send) {
 			struct timeval t1;
 			struct timeval t2;
@@ -489,7 +617,7 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 			}
 
 			// Be very careful about where the cast to size_t happens; see gt#4150
-			nrd = ::read(fd, buf, (size_t)((bytes_to_send-total) < (int)sizeof(buf) ? bytes_to_send-total : sizeof(buf)));
+			nrd = ::read(fd, &buf[0], (size_t)((bytes_to_send-total) < (filesize_t)buf.size() ? bytes_to_send-total : buf.size()));
 
 			if( xfer_q ) {
 				condor_gettimestamp(t2);
@@ -499,7 +627,12 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 			if( nrd <= 0) {
 				break;
 			}
-			if ((nbytes = put_bytes_nobuffer(buf, nrd, 0)) < nrd) {
+			if( chunked ) {
+				nbytes = put_file_chunk(&buf[0], nrd);
+			} else {
+				nbytes = put_bytes_nobuffer(&buf[0], nrd, 0);
+			}
+			if (nbytes < nrd) {
 					// put_bytes_nobuffer() does the appropriate
 					// looping for us already, the only way this could
 					// return less than we asked for is if it returned
@@ -555,7 +688,70 @@ ReliSock::put_file( filesize_t *size, int fd, filesize_t offset, filesize_t max_
 	*size = filesize;
 	return 0;
 }
-MSC_RESTORE_WARNING(6262) // function uses 64k of stack
+
+// A chunk of a compressed file transfer is a message holding the
+// chunk's size and the number of bytes that follow on the wire, then
+// those bytes, sent like any other file data.  If the two sizes are
+// equal, the chunk did not compress and is sent as is.  On an encrypted
+// connection, chunks are only sent when CEDAR_COMPRESS_ENCRYPTED allows
+// compressing ahead of the encryption; see get_compression().
+int
+ReliSock::put_file_chunk( const char *data, int len )
+{
+	std::vector<char> compressed;
+	const char *wire = data;
+	int wire_len = len;
+	if ( CedarCompression::Compress( CedarCompression::ConnectionType( get_encryption() ),
+			m_compress_level, data, len, compressed ) ) {
+		wire = &compressed[0];
+		wire_len = (int) compressed.size();
+	}
+
+	encode();
+	if ( !code(len) || !code(wire_len) || !end_of_message() ) {
+		dprintf( D_ALWAYS, "ReliSock::put_file: failed to send chunk header\n" );
+		return -1;
+	}
+	if ( put_bytes_nobuffer( wire, wire_len, 0 ) < wire_len ) {
+		return -1;
+	}
+	return len;
+}
+
+int
+ReliSock::get_file_chunk( std::vector<char> &buf, filesize_t max_len )
+{
+	int len = 0, wire_len = 0;
+
+	decode();
+	if ( !code(len) || !code(wire_len) || !end_of_message() ) {
+		dprintf( D_ALWAYS, "ReliSock::get_file: failed to receive chunk header\n" );
+		return -1;
+	}
+	if ( len <= 0 || wire_len <= 0 || wire_len > len || len > max_len ||
+		 len > 1024 * 1024 ) {
+		dprintf( D_ALWAYS, "ReliSock::get_file: bad chunk header "
+				 "(size %d, %d on the wire)\n", len, wire_len );
+		return -1;
+	}
+	if ( buf.size() < (size_t)len ) {
+		buf.resize( len );
+	}
+
+	if ( wire_len == len ) {
+		return get_bytes_nobuffer( &buf[0], len, 0 );
+	}
+
+	std::vector<char> wire( wire_len );
+	if ( get_bytes_nobuffer( &wire[0], wire_len, 0 ) != wire_len ) {
+		return -1;
+	}
+	if ( !CedarCompression::Uncompress( CedarCompression::ConnectionType( get_encryption() ),
+			&wire[0], wire_len, &buf[0], len ) ) {
+		return -1;
+	}
+	return len;
+}
 
 int
 ReliSock::get_file_with_permissions( filesize_t *size, 
@@ -616,7 +812,7 @@ ReliSock::get_file_with_permissions( filesize_t *size,
 
 
 int
-ReliSock::put_file_with_permissions( filesize_t *size, const char *source, filesize_t max_bytes, DCTransferQueue *xfer_q )
+ReliSock::put_file_with_permissions( filesize_t *size, const char *source, filesize_t max_bytes, DCTransferQueue *xfer_q, filesize_t offset )
 {
 	int result;
 	condor_mode_t file_mode;
@@ -667,7 +863,7 @@ ReliSock::put_file_with_permissions( filesize_t *size, const char *source, files
 		return -1;
 	}
 
-	result = put_file( size, source, 0, max_bytes, xfer_q );
+	result = put_file( size, source, offset, max_bytes, xfer_q );
 
 	return result;
 }
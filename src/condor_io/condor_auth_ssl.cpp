@@ -32,6 +32,7 @@
 #include "condor_sinful.h"
 #include "condor_secman.h"
 #include "condor_scitokens.h"
+#include "auth_offload.h"
 
 #if defined(DLOPEN_SECURITY_LIBS)
 #include <dlfcn.h>
@@ -717,16 +718,28 @@ Condor_Auth_SSL::CondorAuthSSLRetval
 Condor_Auth_SSL::authenticate_server_connect(CondorError *errstack, bool non_blocking) {
 		m_auth_state->m_phase = Phase::Connect;
         while( !m_auth_state->m_done ) {
+            bool accepted_by_worker = false;
             if( m_auth_state->m_server_status != AUTH_SSL_HOLDING ) {
-                ouch("Trying to accept.\n");
-                m_auth_state->m_ssl_status = (*SSL_accept_ptr)( m_auth_state->m_ssl );
+                if( m_auth_state->m_accept_done ) {
+                    m_auth_state->m_accept_done = false;
+                    accepted_by_worker = true;
+                } else if( non_blocking && offload_accept() ) {
+                    ouch("Waiting for a worker thread to accept.\n");
+                    return CondorAuthSSLRetval::WouldBlock;
+                } else {
+                    ouch("Trying to accept.\n");
+                    m_auth_state->m_ssl_status = (*SSL_accept_ptr)( m_auth_state->m_ssl );
+                }
                 dprintf(D_SECURITY, "Accept returned %d.\n", m_auth_state->m_ssl_status);
             }
             if( m_auth_state->m_ssl_status < 1 ) {
                 m_auth_state->m_server_status = AUTH_SSL_QUITTING;
                 m_auth_state->m_done = 1;
-                m_auth_state->m_err = (*SSL_get_error_ptr)( m_auth_state->m_ssl,
-					m_auth_state->m_ssl_status );
+                    // the worker thread had to look at its own error queue
+                if( !accepted_by_worker ) {
+                    m_auth_state->m_err = (*SSL_get_error_ptr)( m_auth_state->m_ssl,
+                        m_auth_state->m_ssl_status );
+                }
                 switch( m_auth_state->m_err ) {
                 case SSL_ERROR_ZERO_RETURN:
                     ouch("SSL: connection has been closed.\n");
@@ -752,7 +765,8 @@ Condor_Auth_SSL::authenticate_server_connect(CondorError *errstack, bool non_blo
                     ouch("SSL: Syscall.\n" );
                     break;
                 case SSL_ERROR_SSL:
-                    dprintf(D_SECURITY, "SSL: library failure: %s\n", (*ERR_error_string_ptr)((*ERR_get_error_ptr)(), NULL));
+                    dprintf(D_SECURITY, "SSL: library failure: %s\n", accepted_by_worker ?
+                        m_auth_state->m_err_buf : (*ERR_error_string_ptr)((*ERR_get_error_ptr)(), NULL));
                     break;
                 default:
                     ouch("SSL: unknown error?\n" );
@@ -1083,6 +1097,34 @@ Condor_Auth_SSL::authenticate_fail()
 }
 
 
+bool
+Condor_Auth_SSL::offload_accept()
+{
+#if OPENSSL_VERSION_NUMBER < 0x10100000L || defined(LIBRESSL_VERSION_NUMBER)
+		// Older OpenSSL needs locking callbacks before it can be
+		// used from more than one thread; we don't install them.
+	return false;
+#else
+		// The handshake works on memory BIOs, so the worker never
+		// touches the socket.  OpenSSL keeps its error queue per
+		// thread, so the worker decodes any failure itself and leaves
+		// its queue empty for the next connection.
+	AuthState *state = m_auth_state.get();
+	return AuthOffload::Submit( mySock_, [state]() {
+		state->m_ssl_status = (*SSL_accept_ptr)( state->m_ssl );
+		if( state->m_ssl_status < 1 ) {
+			state->m_err = (*SSL_get_error_ptr)( state->m_ssl, state->m_ssl_status );
+			if( state->m_err == SSL_ERROR_SSL ) {
+				(*ERR_error_string_ptr)( (*ERR_get_error_ptr)(), state->m_err_buf );
+			}
+		}
+		while( (*ERR_get_error_ptr)() ) {}
+		state->m_accept_done = true;
+	} );
+#endif
+}
+
+
 int Condor_Auth_SSL::isValid() const
 {
 	if ( m_crypto ) {
@@ -0,0 +1,200 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "condor_common.h"
+#include "condor_crypt_aes.h"
+#include "condor_debug.h"
+
+#ifdef HAVE_EXT_OPENSSL
+
+#if !defined(SKIP_AUTHENTICATION)
+	// The IV for one direction of a session: the first 16 bytes of
+	// SHA-256 over a label naming the direction and the session key.
+	// Every session has its own key, so every session and direction
+	// starts from its own IV.
+static void derive_iv(const KeyInfo& key, const char * label, unsigned char * iv)
+{
+	KeyInfo k(key);
+	unsigned char md[32];
+	unsigned int mdLen = 0;
+	EVP_MD_CTX * mdctx = EVP_MD_CTX_create();
+	ASSERT(mdctx);
+	ASSERT(EVP_DigestInit_ex(mdctx, EVP_sha256(), NULL) &&
+		EVP_DigestUpdate(mdctx, label, strlen(label)) &&
+		EVP_DigestUpdate(mdctx, k.getKeyData(), k.getKeyLength()) &&
+		EVP_DigestFinal_ex(mdctx, md, &mdLen));
+	EVP_MD_CTX_destroy(mdctx);
+	ASSERT(mdLen == sizeof(md));
+	memcpy(iv, md, 16);
+	memset(md, 0, sizeof(md));
+}
+#endif
+
+Condor_Crypt_AES :: Condor_Crypt_AES(const KeyInfo& key, bool initiator)
+#if !defined(SKIP_AUTHENTICATION)
+    : Condor_Crypt_Base(CONDOR_AES, key)
+{
+    KeyInfo k(key);
+
+		// AES-256 wants exactly 32 bytes of key, and session keys
+		// are usually 24, so hash whatever we were given down to 256
+		// bits rather than padding it with zeros.
+	unsigned char keyData[32];
+	unsigned int keyLen = 0;
+	ASSERT(EVP_Digest(k.getKeyData(), k.getKeyLength(), keyData, &keyLen, EVP_sha256(), NULL));
+	ASSERT(keyLen == sizeof(keyData));
+
+		// What the initiator sends is what the responder receives.
+	unsigned char to_responder[16];
+	unsigned char to_initiator[16];
+	derive_iv(key, "CEDAR AES_CFB initiator to responder", to_responder);
+	derive_iv(key, "CEDAR AES_CFB responder to initiator", to_initiator);
+
+	if (initiator) {
+		init(keyData, to_responder, to_initiator);
+	} else {
+		init(keyData, to_initiator, to_responder);
+	}
+
+	memset(keyData, 0, sizeof(keyData));
+}
+#else
+{
+    enc_ctx_ = NULL;
+    dec_ctx_ = NULL;
+}
+#endif
+
+Condor_Crypt_AES :: Condor_Crypt_AES(const KeyInfo& key,
+                                     const unsigned char * enc_iv,
+                                     const unsigned char * dec_iv)
+#if !defined(SKIP_AUTHENTICATION)
+    : Condor_Crypt_Base(CONDOR_AES, key)
+{
+    KeyInfo k(key);
+	ASSERT(k.getKeyLength() == 32);
+	init(k.getKeyData(), enc_iv, dec_iv);
+}
+#else
+{
+    enc_ctx_ = NULL;
+    dec_ctx_ = NULL;
+}
+#endif
+
+void Condor_Crypt_AES :: init(const unsigned char * keyData,
+                              const unsigned char * enc_iv,
+                              const unsigned char * dec_iv)
+{
+	memcpy(enc_iv_, enc_iv, sizeof(enc_iv_));
+	memcpy(dec_iv_, dec_iv, sizeof(dec_iv_));
+
+		// One context for each direction, so that OpenSSL sets up
+		// the key schedule once and can use AES-NI where the CPU has
+		// it.
+    enc_ctx_ = EVP_CIPHER_CTX_new();
+    dec_ctx_ = EVP_CIPHER_CTX_new();
+	ASSERT(enc_ctx_ && dec_ctx_);
+	ASSERT(EVP_EncryptInit_ex(enc_ctx_, EVP_aes_256_cfb128(), NULL, keyData, enc_iv_));
+	ASSERT(EVP_DecryptInit_ex(dec_ctx_, EVP_aes_256_cfb128(), NULL, keyData, dec_iv_));
+}
+
+Condor_Crypt_AES :: ~Condor_Crypt_AES()
+{
+    if (enc_ctx_) {
+        EVP_CIPHER_CTX_free(enc_ctx_);
+    }
+    if (dec_ctx_) {
+        EVP_CIPHER_CTX_free(dec_ctx_);
+    }
+	memset(enc_iv_, 0, sizeof(enc_iv_));
+	memset(dec_iv_, 0, sizeof(dec_iv_));
+}
+
+void Condor_Crypt_AES:: resetState()
+{
+	if (enc_ctx_) {
+		EVP_CipherInit_ex(enc_ctx_, NULL, NULL, NULL, enc_iv_, -1);
+		EVP_CIPHER_CTX_set_num(enc_ctx_, 0);
+	}
+	if (dec_ctx_) {
+		EVP_CipherInit_ex(dec_ctx_, NULL, NULL, NULL, dec_iv_, -1);
+		EVP_CIPHER_CTX_set_num(dec_ctx_, 0);
+	}
+}
+
+bool Condor_Crypt_AES :: encrypt(const unsigned char *  input,
+                                 int              input_len, 
+                                 unsigned char *& output, 
+                                 int&             output_len)
+{
+#if !defined(SKIP_AUTHENTICATION)
+    return cfb128(enc_ctx_, input, input_len, output, output_len);
+#else
+	return true;
+#endif
+}
+
+bool Condor_Crypt_AES :: decrypt(const unsigned char *  input,
+                                 int              input_len, 
+                                 unsigned char *& output, 
+                                 int&             output_len)
+{
+#if !defined(SKIP_AUTHENTICATION)
+    return cfb128(dec_ctx_, input, input_len, output, output_len);
+#else
+	return true;
+#endif
+}
+
+bool Condor_Crypt_AES :: cfb128(EVP_CIPHER_CTX * ctx,
+                                const unsigned char *  input,
+                                int              input_len,
+                                unsigned char *& output,
+                                int&             output_len)
+{
+    output = (unsigned char *) malloc(input_len > 0 ? input_len : 1);
+    if (!output) {
+        return false;
+    }
+    output_len = input_len;
+
+	int outl = 0;
+	if (input_len > 0 &&
+		(!EVP_CipherUpdate(ctx, output, &outl, input, input_len) || outl != input_len))
+	{
+		dprintf(D_ALWAYS, "AES: failed to %s %d bytes\n",
+				ctx == enc_ctx_ ? "encrypt" : "decrypt", input_len);
+		free(output);
+		output = NULL;
+		output_len = 0;
+		return false;
+	}
+
+    return true;
+}
+
+Condor_Crypt_AES :: Condor_Crypt_AES()
+{
+	enc_ctx_ = NULL;
+	dec_ctx_ = NULL;
+}
+
+#endif /*HAVE_EXT_OPENSSL*/
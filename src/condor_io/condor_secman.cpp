@@ -42,6 +42,7 @@
 #include "ipv6_hostname.h"
 #include "condor_auth_passwd.h"
 #include "condor_auth_ssl.h"
+#include "cedar_compression.h"
 
 #include <sstream>
 
@@ -491,6 +492,12 @@ SecMan::FillInSecurityPolicyAd( DCpermission auth_level, ClassAd* ad,
 	sec_req sec_integrity = sec_req_param(
 		 "SEC_%s_INTEGRITY", auth_level, SEC_REQ_OPTIONAL);
 
+	sec_req sec_compression = sec_req_param(
+		 "SEC_%s_COMPRESSION", auth_level, SEC_REQ_OPTIONAL);
+	if( !CedarCompression::Available() ) {
+		sec_compression = SEC_REQ_NEVER;
+	}
+
 
 	// regarding SEC_NEGOTIATE values:
 	// REQUIRED- outgoing will always negotiate, and incoming must
@@ -511,6 +518,7 @@ SecMan::FillInSecurityPolicyAd( DCpermission auth_level, ClassAd* ad,
 		sec_authentication = SEC_REQ_NEVER;
 		sec_encryption = SEC_REQ_NEVER;
 		sec_integrity = SEC_REQ_NEVER;
+		sec_compression = SEC_REQ_NEVER;
 	}
 
 
@@ -615,6 +623,8 @@ SecMan::FillInSecurityPolicyAd( DCpermission auth_level, ClassAd* ad,
 
 	ad->Assign ( ATTR_SEC_INTEGRITY, SecMan::sec_req_rev[sec_integrity] );
 
+	ad->Assign ( ATTR_SEC_COMPRESSION, SecMan::sec_req_rev[sec_compression] );
+
 	ad->Assign ( ATTR_SEC_ENACT, "NO" );
 
 
@@ -864,9 +874,19 @@ SecMan::ReconcileSecurityPolicyAds(const ClassAd &cli_ad, const ClassAd &srv_ad)
 								ATTR_SEC_INTEGRITY,
 								cli_ad, srv_ad );
 
+		// Peers older than 8.9.6 don't mention compression at all,
+		// which means no.
+	sec_feat_act compression_action = SEC_FEAT_ACT_NO;
+	if( cli_ad.LookupExpr( ATTR_SEC_COMPRESSION ) && srv_ad.LookupExpr( ATTR_SEC_COMPRESSION ) ) {
+		compression_action = ReconcileSecurityAttribute(
+								ATTR_SEC_COMPRESSION,
+								cli_ad, srv_ad );
+	}
+
 	if ( (authentication_action == SEC_FEAT_ACT_FAIL) ||
 	     (encryption_action == SEC_FEAT_ACT_FAIL) ||
-	     (integrity_action == SEC_FEAT_ACT_FAIL) ) {
+	     (integrity_action == SEC_FEAT_ACT_FAIL) ||
+	     (compression_action == SEC_FEAT_ACT_FAIL) ) {
 
 		// one or more decisions could not be agreed upon, so
 		// we fail.
@@ -897,6 +917,9 @@ SecMan::ReconcileSecurityPolicyAds(const ClassAd &cli_ad, const ClassAd &srv_ad)
 	sprintf (buf, "%s=\"%s\"", ATTR_SEC_INTEGRITY, SecMan::sec_feat_act_rev[integrity_action]);
 	action_ad->Insert(buf);
 
+	sprintf (buf, "%s=\"%s\"", ATTR_SEC_COMPRESSION, SecMan::sec_feat_act_rev[compression_action]);
+	action_ad->Insert(buf);
+
 
 	char* cli_methods = NULL;
 	char* srv_methods = NULL;
@@ -1957,6 +1980,10 @@ SecManStartCommand::receiveAuthInfo_inner()
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_AUTH_REQUIRED );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_ENCRYPTION );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_INTEGRITY );
+				// Older servers don't send this, which must not leave
+				// our own requirement in its place.
+			m_auth_info.Delete( ATTR_SEC_COMPRESSION );
+			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_COMPRESSION );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_SESSION_DURATION );
 			m_sec_man.sec_copy_attribute( m_auth_info, auth_response, ATTR_SEC_SESSION_LEASE );
 
@@ -2195,7 +2222,11 @@ SecManStartCommand::authenticate_inner_finish()
 			m_sock->encode();
 			m_sock->set_crypto_key(false, m_private_key);
 		}
-		
+
+			// Compressed packets are marked as such, so it doesn't
+			// matter which side starts compressing first.
+		SecMan::sec_feat_act will_compress = m_sec_man.sec_lookup_feat_act( m_auth_info, ATTR_SEC_COMPRESSION );
+		static_cast<ReliSock*>(m_sock)->set_compression(will_compress == SecMan::SEC_FEAT_ACT_YES);
 	}
 
 	m_state = ReceivePostAuthInfo;
@@ -2998,6 +3029,49 @@ SecMan::invalidateOneExpiredCache(KeyCache *cache)
     delete list;
 }
 
+	// SEC_SESSION_CACHE_FILE, made distinct for this daemon by adding
+	// its subsystem and local name, so that daemons sharing one
+	// setting don't overwrite each other's sessions.
+static bool
+session_cache_filename(std::string &filename)
+{
+	if( !param(filename, "SEC_SESSION_CACHE_FILE") ) {
+		return false;
+	}
+	SubsystemInfo *subsys = get_mySubSystem();
+	filename += ".";
+	filename += subsys->getName();
+	if( subsys->getLocalName() ) {
+		filename += ".";
+		filename += subsys->getLocalName();
+	}
+	return true;
+}
+
+void
+SecMan::PersistSessionCache()
+{
+	std::string filename;
+	if( !session_cache_filename(filename) ) {
+		return;
+	}
+	m_default_session_cache.persist(filename.c_str());
+}
+
+void
+SecMan::RestoreSessionCache()
+{
+	std::string filename;
+	if( !session_cache_filename(filename) ) {
+		return;
+	}
+	int count = m_default_session_cache.restore(filename.c_str());
+	if( count > 0 ) {
+		dprintf(D_ALWAYS, "SECMAN: restored %d security sessions from %s\n",
+				count, filename.c_str());
+	}
+}
+
 void
 SecMan::invalidateExpiredCache()
 {
@@ -3077,7 +3151,7 @@ MyString SecMan::getDefaultAuthenticationMethods(DCpermission perm) {
 
 MyString SecMan::getDefaultCryptoMethods() {
 #ifdef HAVE_EXT_OPENSSL
-	return "BLOWFISH,3DES";
+	return "AES_CFB,BLOWFISH,3DES";
 #else
 	return "";
 #endif
@@ -3179,6 +3253,13 @@ Protocol CryptProtocolNameToEnum(char const *name) {
 	case '3': // 3des
 	case 'T': // Tripledes
 		return CONDOR_3DES;
+	case 'A': // aes_cfb
+			// Only the full name: other versions of HTCondor mean
+			// something else by "AES", and must not be taken for this.
+		if (strcasecmp(name, "AES_CFB") == 0) {
+			return CONDOR_AES;
+		}
+		return CONDOR_NO_PROTOCOL;
 	default:
 		return CONDOR_NO_PROTOCOL;
 	}
@@ -3219,6 +3300,9 @@ SecMan::CreateNonNegotiatedSecuritySession(DCpermission auth_level, char const *
 	sec_copy_attribute(policy,*auth_info,ATTR_SEC_INTEGRITY);
 	sec_copy_attribute(policy,*auth_info,ATTR_SEC_ENCRYPTION);
 	sec_copy_attribute(policy,*auth_info,ATTR_SEC_CRYPTO_METHODS);
+		// Nothing tells us the other end of this session can read
+		// compressed data, so don't send any.
+	policy.Assign(ATTR_SEC_COMPRESSION, SecMan::sec_feat_act_rev[SEC_FEAT_ACT_NO]);
 
 		// remove all but the first crypto method
 	std::string crypto_methods;
@@ -3499,7 +3583,7 @@ SecMan::SetSessionExpiration(char const *session_id,time_t expiration_time) {
 				"session %s\n",session_id);
 		return false;
 	}
-	session_key->setExpiration(expiration_time);
+	session_cache->setExpiration(session_key,expiration_time);
 
 	dprintf(D_SECURITY,"Set expiration time for security session %s to %ds\n",session_id,(int)(expiration_time-time(NULL)));
 
@@ -29,10 +29,20 @@
 #include "selector.h"
 #include "ccb_client.h"
 #include "condor_sockfunc.h"
+#include "cedar_compression.h"
 
 #define NORMAL_HEADER_SIZE 5
 #define MAX_HEADER_SIZE MAC_SIZE + NORMAL_HEADER_SIZE
 
+// Set in the end byte of a packet header when the payload is a 4-byte
+// uncompressed length followed by zlib data.
+#define COMPRESSED_PACKET_FLAG 2
+// Packets are allowed to grow to this before being sent when they will
+// be compressed, since bigger packets compress better.
+#define COMPRESSED_PACKET_SIZE 65536
+// Largest packet payload accepted, compressed or not.
+#define MAX_PACKET_SIZE (1024*1024)
+
 /**************************************************************/
 
 /* 
@@ -47,6 +57,9 @@ ReliSock::init()
 	m_has_backlog = false;
 	m_read_would_block = false;
 	m_non_blocking = false;
+	m_compress_level = 0;
+	m_compress_encrypted = false;
+	m_sendfile = -1;
 	ignore_next_encode_eom = FALSE;
 	ignore_next_decode_eom = FALSE;
 	_bytes_sent = 0.0;
@@ -63,6 +76,19 @@ ReliSock::init()
 }
 
 
+void
+ReliSock::set_compression(bool enable)
+{
+	m_compress_level = enable ? CedarCompression::ConfiguredLevel() : 0;
+	m_compress_encrypted = m_compress_level > 0 && CedarCompression::CompressEncrypted();
+	if (m_compress_level > 0) {
+		snd_msg.buf.grow_buf(COMPRESSED_PACKET_SIZE);
+	}
+	dprintf(D_NETWORK, "ReliSock: compression %s for %s.\n",
+		m_compress_level > 0 ? "enabled" : "disabled", peer_description());
+}
+
+
 ReliSock::ReliSock()
 	: Sock()
 {
@@ -204,6 +230,13 @@ ReliSock::accept( ReliSock	&c )
 
 	}
 
+	setup_accepted(c, c_sock);
+	return TRUE;
+}
+
+void
+ReliSock::setup_accepted( ReliSock &c, int c_sock )
+{
 	c.assignSocket(c_sock);
 	c.enter_connected_state("ACCEPT");
 	c.decode();
@@ -216,8 +249,53 @@ ReliSock::accept( ReliSock	&c )
 		*/
 	int on = 1;
 	c.setsockopt(IPPROTO_TCP, TCP_NODELAY, (char*)&on, sizeof(on));
+}
 
-	return TRUE;
+ReliSock *
+ReliSock::accept_nonblocking( bool & would_block )
+{
+	would_block = false;
+#if defined(HAVE_ACCEPT4)
+	if (_state != sock_special || _special_state != relisock_listen) {
+		return NULL;
+	}
+
+	if ( ! m_listen_nonblocking) {
+		int fcntl_flags = fcntl(_sock, F_GETFL);
+		if (fcntl_flags < 0 || fcntl(_sock, F_SETFL, fcntl_flags | O_NONBLOCK) < 0) {
+			dprintf(D_ALWAYS, "ReliSock: failed to make listen socket non-blocking: %s\n",
+					strerror(errno));
+				// check first, so that accept() won't block
+			Selector selector;
+			selector.set_timeout( 0, 0 );
+			selector.add_fd( _sock, Selector::IO_READ );
+			selector.execute();
+			if ( !selector.has_ready() ) {
+				would_block = true;
+				return NULL;
+			}
+			return accept();
+		}
+		m_listen_nonblocking = true;
+	}
+
+	ReliSock *c_rs = new ReliSock();
+	errno = 0;
+	int c_sock = condor_accept4(_sock, c_rs->_who, 0);
+	if (c_sock < 0) {
+		if ( errno == EMFILE ) {
+			_condor_fd_panic ( __LINE__, __FILE__ ); /* This calls dprintf_exit! */
+		}
+		would_block = (errno == EAGAIN || errno == EWOULDBLOCK);
+		delete c_rs;
+		return NULL;
+	}
+
+	setup_accepted(*c_rs, c_sock);
+	return c_rs;
+#else
+	return accept();
+#endif
 }
 
 
@@ -804,7 +882,7 @@ int ReliSock::RcvMsg::rcv_packet( char const *peer_description, SOCKET _sock, in
 		return FALSE;
 	}
         
-	if (len > 1024*1024){
+	if (len > MAX_PACKET_SIZE){
 		dprintf(D_ALWAYS, "IO: Incoming packet is larger than 1MB limit (requested size %d)\n", len);
 		return FALSE;
 	}
@@ -853,6 +931,15 @@ read_packet:
             }
         }
         
+	if (m_end & COMPRESSED_PACKET_FLAG) {
+		m_end &= ~COMPRESSED_PACKET_FLAG;
+		if (!uncompress_packet()) {
+			delete m_tmp;
+			m_tmp = NULL;
+			return FALSE;
+		}
+	}
+
 	if (!buf.put(m_tmp)) {
 		delete m_tmp;
 		m_tmp = NULL;
@@ -867,6 +954,35 @@ read_packet:
 }
 
 
+	// Replace the compressed packet in m_tmp with its contents.
+bool ReliSock::RcvMsg::uncompress_packet()
+{
+	int len = m_tmp->num_untouched();
+	uint32_t raw_len_n;
+	if (len < (int)sizeof(raw_len_n) || m_tmp->get_max(&raw_len_n, sizeof(raw_len_n)) != sizeof(raw_len_n)) {
+		dprintf(D_ALWAYS, "IO: Compressed packet is too short (%d bytes)\n", len);
+		return false;
+	}
+	int raw_len = (int) ntohl(raw_len_n);
+	if (raw_len <= 0 || raw_len > MAX_PACKET_SIZE) {
+		dprintf(D_ALWAYS, "IO: Compressed packet has bad size %d\n", raw_len);
+		return false;
+	}
+
+	std::vector<char> inflated(raw_len);
+	if (!CedarCompression::Uncompress(CedarCompression::ConnectionType(p_sock->get_encryption()),
+		(const char *)m_tmp->get_ptr(), m_tmp->num_untouched(), &inflated[0], raw_len))
+	{
+		return false;
+	}
+	Buf *raw = new Buf;
+	raw->grow_buf(raw_len+1);
+	raw->put_max(&inflated[0], raw_len);
+	delete m_tmp;
+	m_tmp = raw;
+	return true;
+}
+
 ReliSock::SndMsg::SndMsg() : 
     mode_(MD_OFF), 
     mdChecker_(0),
@@ -946,6 +1062,14 @@ int ReliSock::SndMsg::snd_packet( char const *peer_description, int _sock, int e
 	header_size = (mode_ != MD_OFF) ? MAX_HEADER_SIZE : NORMAL_HEADER_SIZE;
 	hdr[0] = (char) end;
 	ns = buf.num_used() - header_size;
+		// Messages are encrypted a put() at a time, before they reach
+		// the packet, so there is nothing to gain compressing them here
+		// when encryption is on.
+	if (p_sock->m_compress_level > 0 && !p_sock->get_encryption() &&
+		ns <= MAX_PACKET_SIZE && compress_packet(header_size)) {
+		hdr[0] |= COMPRESSED_PACKET_FLAG;
+		ns = buf.num_used() - header_size;
+	}
 	len = (int) htonl(ns);
 
 	memcpy(&hdr[1], &len, 4);
@@ -975,6 +1099,28 @@ int ReliSock::SndMsg::snd_packet( char const *peer_description, int _sock, int e
 	return TRUE;
 }
 
+	// Compress the payload of the packet in buf in place, if that is
+	// worth doing.  The result is always smaller, so it fits.
+bool ReliSock::SndMsg::compress_packet(int header_size)
+{
+	int ns = buf.num_used() - header_size;
+	buf.rewind();
+	buf.seek(header_size);
+	std::vector<char> compressed;
+	if (!CedarCompression::Compress(CedarCompression::ConnPlain, p_sock->m_compress_level,
+		(const char *)buf.get_ptr(), ns, compressed))
+	{
+		return false;
+	}
+
+	uint32_t raw_len_n = htonl(ns);
+	buf.reset();
+	buf.seek(header_size);
+	buf.put_max(&raw_len_n, sizeof(raw_len_n));
+	buf.put_max(&compressed[0], compressed.size());
+	return true;
+}
+
 bool ReliSock::SndMsg::init_MD(CONDOR_MD_MODE mode, KeyInfo * key)
 {
     if (!buf.empty()) {
@@ -1036,7 +1182,7 @@ ReliSock::serialize() const
 	char * crypto = serializeCryptoInfo();
 	char * md = serializeMdInfo();
 
-	formatstr( state, "%s%d*%s*%s*%s*", parent_state, _special_state, _who.to_sinful().Value(), crypto, md );
+	formatstr( state, "%s%d*%s*%d*%s*%s*", parent_state, _special_state, _who.to_sinful().Value(), is_client, crypto, md );
 
 	delete[] parent_state;
 	delete[] crypto;
@@ -1073,6 +1219,14 @@ ReliSock::serialize(const char *buf)
 		sinful_string[ptr - ptmp] = 0;
 
         ptmp = ++ptr;
+        // Which side connected, which the crypto needs to know
+        citems = sscanf(ptmp, "%d*", &itmp);
+        if (citems == 1) {
+            is_client = itmp;
+        }
+        ptmp = strchr(ptmp, '*');
+        ASSERT( ptmp );
+        ptmp++;
         // The next part is for crypto
         ptmp = serializeCryptoInfo(ptmp);
         // Followed by Md
@@ -23,6 +23,7 @@
 #include "subsystem_info.h"
 #include "shared_port_client.h"
 #include "shared_port_endpoint.h"
+#include "utc_time.h"
 
 #include <sstream>
 
@@ -32,6 +33,11 @@ unsigned int SharedPortClient::m_maxPendingPassSocketCalls = 0;
 unsigned int SharedPortClient::m_successPassSocketCalls = 0;
 unsigned int SharedPortClient::m_failPassSocketCalls = 0;
 unsigned int SharedPortClient::m_wouldBlockPassSocketCalls = 0;
+unsigned int SharedPortClient::m_reusedConnectionPassSocketCalls = 0;
+double SharedPortClient::m_passSocketSeconds = 0;
+double SharedPortClient::m_maxPassSocketSeconds = 0;
+int SharedPortClient::m_maxIdleConnections = 0;
+std::map<std::string, std::vector<ReliSock*> > SharedPortClient::m_idleConnections;
 
 
 #ifdef HAVE_SCM_RIGHTS_PASSFD
@@ -51,7 +57,9 @@ public:
 		  m_sock_name("UNKNOWN"),
 		  m_state(UNBOUND),
 		  m_non_blocking(non_blocking),
-		  m_dealloc_sock(false)
+		  m_dealloc_sock(false),
+		  m_reused_connection(false),
+		  m_start_time(condor_gettimestamp_double())
 	{
 		// Ctor
 
@@ -88,8 +96,11 @@ private:
 	SPState m_state;
 	bool m_non_blocking;
 	bool m_dealloc_sock;
+	bool m_reused_connection; // s came from SharedPortClient's idle connections
+	double m_start_time;
 
 	HandlerResult HandleUnbound(Stream *&s);
+	HandlerResult HandleStaleConnection(Stream *&s);
 	HandlerResult HandleHeader(Stream *&s);
 	HandlerResult HandleFD(Stream *&s);
 	HandlerResult HandleResp(Stream *&s);
@@ -371,10 +382,101 @@ SharedPortClient::PassSocket(Sock *sock_to_pass,char const *shared_port_id,char
 #endif
 }
 
+void
+SharedPortClient::setMaxIdleConnections(int max_idle)
+{
+	m_maxIdleConnections = max_idle;
+	trimIdleConnections(max_idle);
+}
+
+void
+SharedPortClient::clearIdleConnections()
+{
+	trimIdleConnections(0);
+}
+
+unsigned int
+SharedPortClient::get_idleConnections()
+{
+	unsigned int count = 0;
+	for (auto it = m_idleConnections.begin(); it != m_idleConnections.end(); ++it) {
+		count += it->second.size();
+	}
+	return count;
+}
+
+void
+SharedPortClient::trimIdleConnections(int max_idle)
+{
+	auto it = m_idleConnections.begin();
+	while (it != m_idleConnections.end()) {
+		std::vector<ReliSock*> &socks = it->second;
+		while ((int)socks.size() > max_idle) {
+				// oldest first
+			delete socks.front();
+			socks.erase(socks.begin());
+		}
+		if (socks.empty()) {
+			it = m_idleConnections.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+ReliSock *
+SharedPortClient::takeIdleConnection(const std::string &shared_port_id)
+{
+	auto it = m_idleConnections.find(shared_port_id);
+	if (it == m_idleConnections.end()) {
+		return NULL;
+	}
+	std::vector<ReliSock*> &socks = it->second;
+	while (!socks.empty()) {
+		ReliSock *sock = socks.back();
+		socks.pop_back();
+
+			// The endpoint never speaks first, so if there is anything
+			// to read, it is the endpoint closing the connection, because
+			// it exited or because it is too old to keep connections open.
+		Selector selector;
+		selector.set_timeout(0, 0);
+		selector.add_fd(sock->get_file_desc(), Selector::IO_READ);
+		selector.execute();
+		if (selector.timed_out()) {
+			return sock;
+		}
+		dprintf(D_FULLDEBUG, "SharedPortClient: idle connection to %s was closed.\n",
+				shared_port_id.c_str());
+		delete sock;
+	}
+	m_idleConnections.erase(it);
+	return NULL;
+}
+
+void
+SharedPortClient::returnIdleConnection(const std::string &shared_port_id, ReliSock *sock)
+{
+	std::vector<ReliSock*> &socks = m_idleConnections[shared_port_id];
+	if ((int)socks.size() >= m_maxIdleConnections) {
+		delete sock;
+		if (socks.empty()) {
+			m_idleConnections.erase(shared_port_id);
+		}
+		return;
+	}
+	sock->set_deadline(0);
+	socks.push_back(sock);
+}
+
 #ifdef HAVE_SCM_RIGHTS_PASSFD
 int
 SharedPortState::Handle(Stream *s)
 {
+		// daemonCore calls us with the connection to the endpoint
+		// once the endpoint has answered; on the first call there is none
+	bool called_by_daemon_core = (s != NULL);
+
 	HandlerResult result = CONTINUE;
 	while (result == CONTINUE || (!m_non_blocking && (result == WAIT))) {
 		switch (m_state)
@@ -416,11 +518,30 @@ SharedPortState::Handle(Stream *s)
 	// Update result statistics
 	if (result == DONE) {
 		SharedPortClient::m_successPassSocketCalls++;
+		if (m_reused_connection) {
+			SharedPortClient::m_reusedConnectionPassSocketCalls++;
+		}
+		double elapsed = condor_gettimestamp_double() - m_start_time;
+		SharedPortClient::m_passSocketSeconds += elapsed;
+		if (elapsed > SharedPortClient::m_maxPassSocketSeconds) {
+			SharedPortClient::m_maxPassSocketSeconds = elapsed;
+		}
 	}
 	if (result == FAILED) {
 		SharedPortClient::m_failPassSocketCalls++;
 	}
 
+	// Keep the connection to the endpoint for the next socket we pass it.
+	if (result == DONE && called_by_daemon_core && m_non_blocking &&
+		SharedPortClient::m_maxIdleConnections > 0)
+	{
+		daemonCore->Cancel_Socket(s);
+		SharedPortClient::returnIdleConnection(m_sock_name, static_cast<ReliSock*>(s));
+		delete this;
+		// daemonCore must not close the connection now that it is ours
+		return KEEP_STREAM;
+	}
+
 	// If we are done, clean up and dellocate
 	if (result == DONE || result == FAILED) {
 		if ((s) && (m_state != RECV_RESP || !m_non_blocking || !daemonCore->SocketIsRegistered(s))) {
@@ -446,12 +567,35 @@ SharedPortState::Handle(Stream *s)
 SharedPortState::HandlerResult
 SharedPortState::HandleUnbound(Stream *&s)
 {
-	if( !SharedPortClient::SharedPortIdIsValid(m_shared_port_id) ) {
-			dprintf(D_ALWAYS,
-							"ERROR: SharedPortClient: refusing to connect to shared port"
-							"%s, because specified id is illegal! (%s)\n",
-							m_requested_by.c_str(), m_shared_port_id );
-			return FAILED;
+		// m_shared_port_id belongs to our caller, so it is only good
+		// on the first pass; we come back here with it cleared if a
+		// reused connection turns out to be stale.
+	if( m_shared_port_id ) {
+		if( !SharedPortClient::SharedPortIdIsValid(m_shared_port_id) ) {
+				dprintf(D_ALWAYS,
+								"ERROR: SharedPortClient: refusing to connect to shared port"
+								"%s, because specified id is illegal! (%s)\n",
+								m_requested_by.c_str(), m_shared_port_id );
+				return FAILED;
+		}
+		m_sock_name = m_shared_port_id;
+		m_shared_port_id = NULL;
+
+		if( !m_requested_by.size() ) {
+			formatstr(m_requested_by,
+					" as requested by %s", m_sock->peer_description());
+		}
+
+		if( m_non_blocking ) {
+			ReliSock *idle_sock = SharedPortClient::takeIdleConnection(m_sock_name);
+			if( idle_sock ) {
+				idle_sock->set_deadline( m_sock->get_deadline() );
+				s = idle_sock;
+				m_reused_connection = true;
+				m_state = SEND_HEADER;
+				return CONTINUE;
+			}
+		}
 	}
 
 	std::string sock_name;
@@ -460,20 +604,12 @@ SharedPortState::HandleUnbound(Stream *&s)
 	bool has_alt_socket = SharedPortEndpoint::GetAltDaemonSocketDir(alt_sock_name);;
 
 	std::stringstream ss;
-	ss << sock_name << DIR_DELIM_CHAR << m_shared_port_id;
+	ss << sock_name << DIR_DELIM_CHAR << m_sock_name;
 	sock_name = ss.str();
-	m_sock_name = m_shared_port_id;
 	ss.str("");
 	ss.clear();
-	ss << alt_sock_name << DIR_DELIM_CHAR << m_shared_port_id;
+	ss << alt_sock_name << DIR_DELIM_CHAR << m_sock_name;
 	alt_sock_name = ss.str();
-	m_shared_port_id = NULL;
-	
-
-	if( !m_requested_by.size() ) {
-		formatstr(m_requested_by,
-				" as requested by %s", m_sock->peer_description());
-	}
 
 	struct sockaddr_un named_sock_addr;
 	memset(&named_sock_addr, 0, sizeof(named_sock_addr));
@@ -638,6 +774,22 @@ SharedPortState::HandleUnbound(Stream *&s)
 	return CONTINUE;
 }
 
+// A reused connection failed before the endpoint could have received
+// the socket, so it is safe to start over on a new connection.
+SharedPortState::HandlerResult
+SharedPortState::HandleStaleConnection(Stream *&s)
+{
+	dprintf(D_FULLDEBUG,
+		"SharedPortClient: reused connection to %s%s failed; reconnecting.\n",
+		m_sock_name.c_str(),
+		m_requested_by.c_str());
+	delete s;
+	s = NULL;
+	m_reused_connection = false;
+	m_state = UNBOUND;
+	return CONTINUE;
+}
+
 SharedPortState::HandlerResult
 SharedPortState::HandleHeader(Stream *&s)
 {
@@ -648,6 +800,9 @@ SharedPortState::HandleHeader(Stream *&s)
 	if( !sock->put((int)SHARED_PORT_PASS_SOCK) ||
 		!sock->end_of_message() )
 	{
+		if( m_reused_connection ) {
+			return HandleStaleConnection(s);
+		}
 		dprintf(D_ALWAYS,"SharedPortClient: failed to send SHARED_PORT_PASS_FD to %s%s: %s\n",
 			m_sock_name.c_str(),
 			m_requested_by.c_str(),
@@ -713,11 +868,15 @@ SharedPortState::HandleFD(Stream *&s)
 	// CCB), write an audit log entry about where the socket is going.
 	//
 	// In this construction, the non-error state is in the last if statement,
-	// rather than the inner-most.
+	// rather than the inner-most.  Looking up the peer costs several system
+	// calls per forwarded connection, so skip it all when nobody is
+	// keeping an audit log.
 	//
 	struct sockaddr_un addr;
 	socklen_t addrlen = sizeof(struct sockaddr_un);
-	if( -1 == getpeername( sock->get_file_desc(), (struct sockaddr *) & addr, & addrlen ) ) {
+	if( !IsDebugLevel( D_AUDIT ) ) {
+		// nothing to do
+	} else if( -1 == getpeername( sock->get_file_desc(), (struct sockaddr *) & addr, & addrlen ) ) {
 		dprintf( D_AUDIT, *sock, "Failure while auditing connection from %s: unable to obtain domain socket peer address: %s\n",
 			m_sock->peer_addr().to_ip_and_port_string().c_str(),
 			strerror( errno ) );
@@ -794,7 +953,14 @@ SharedPortState::HandleFD(Stream *&s)
 	}
 #endif
 
-	if( sendmsg(sock->get_file_desc(),&msg,0) != 1 ) {
+	int send_flags = 0;
+#ifdef MSG_NOSIGNAL
+	send_flags |= MSG_NOSIGNAL;
+#endif
+	if( sendmsg(sock->get_file_desc(),&msg,send_flags) != 1 ) {
+		if( m_reused_connection && (errno == EPIPE || errno == ECONNRESET) ) {
+			return HandleStaleConnection(s);
+		}
 		dprintf(D_ALWAYS,"SharedPortClient: failed to pass socket to %s%s: %s\n",
 			m_sock_name.c_str(),
 			m_requested_by.c_str(),
@@ -23,6 +23,10 @@
 #include "MyString.h"
 #include "reli_sock.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 class SharedPortState;
 
 class SharedPortClient {
@@ -47,6 +51,23 @@ friend class SharedPortState;
 		{return m_failPassSocketCalls;}
 	unsigned int get_wouldBlockPassSocketCalls() 
 		{return m_wouldBlockPassSocketCalls;}
+	double get_passSocketSeconds()
+		{return m_passSocketSeconds;}
+	unsigned int get_reusedConnectionPassSocketCalls()
+		{return m_reusedConnectionPassSocketCalls;}
+		// returns the slowest successful PassSocket() since the last call
+	double take_maxPassSocketSeconds()
+		{double max = m_maxPassSocketSeconds; m_maxPassSocketSeconds = 0; return max;}
+
+		// A non-blocking PassSocket() keeps up to this many idle
+		// connections to each endpoint, and reuses them rather than
+		// connecting to the endpoint's named socket every time.
+		// Zero disables the cache.
+	static void setMaxIdleConnections(int max_idle);
+		// Close all idle connections, e.g. when the socket directory
+		// may have changed.
+	static void clearIdleConnections();
+	static unsigned int get_idleConnections();
 
  private:
 	MyString myName();
@@ -64,6 +85,15 @@ friend class SharedPortState;
 	static unsigned int m_successPassSocketCalls;
 	static unsigned int m_failPassSocketCalls;
 	static unsigned int m_wouldBlockPassSocketCalls;
+	static unsigned int m_reusedConnectionPassSocketCalls;
+	static double m_passSocketSeconds;
+	static double m_maxPassSocketSeconds;
+
+	static int m_maxIdleConnections;
+	static std::map<std::string, std::vector<ReliSock*> > m_idleConnections;
+	static ReliSock *takeIdleConnection(const std::string &shared_port_id);
+	static void returnIdleConnection(const std::string &shared_port_id, ReliSock *sock);
+	static void trimIdleConnections(int max_idle);
 };
 
 #endif
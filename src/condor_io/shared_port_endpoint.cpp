@@ -258,6 +258,16 @@ SharedPortEndpoint::StopListener()
 		daemonCore->Cancel_Socket( &m_listener_sock );
 	}
 	m_listener_sock.close();
+	for( std::set<ReliSock*>::iterator it = m_named_connections.begin();
+		 it != m_named_connections.end();
+		 ++it )
+	{
+		if( daemonCore ) {
+			daemonCore->Cancel_Socket( *it );
+		}
+		delete *it;
+	}
+	m_named_connections.clear();
 	if( !m_full_name.IsEmpty() ) {
 		RemoveSocket(m_full_name.Value());
 	}
@@ -1085,18 +1095,50 @@ SharedPortEndpoint::DoListenerAccept(ReliSock *return_remote_sock)
 		return;
 	}
 
+	if( !ReadPassRequest(accepted_sock, false) ) {
+		delete accepted_sock;
+		return;
+	}
+
+	ReceiveSocket(accepted_sock,return_remote_sock);
+
+		// The shared port server may keep this connection open to
+		// pass us more sockets, so listen for further requests on it.
+		// Older servers simply close it.
+	if( return_remote_sock || !daemonCore ) {
+		delete accepted_sock;
+		return;
+	}
+	int rc = daemonCore->Register_Socket(
+		accepted_sock,
+		"SharedPortEndpoint named connection",
+		(SocketHandlercpp)&SharedPortEndpoint::HandleNamedConnection,
+		"SharedPortEndpoint::HandleNamedConnection",
+		this);
+	if( rc < 0 ) {
+		delete accepted_sock;
+		return;
+	}
+	m_named_connections.insert(accepted_sock);
+#endif
+}
+
+#ifndef WIN32
+bool
+SharedPortEndpoint::ReadPassRequest( ReliSock *named_sock, bool reused )
+{
 		// Currently, instead of having daemonCore handle the command
 		// for us, we read it here.  This means we only support the raw
 		// command protocol.
 
-	accepted_sock->decode();
+	named_sock->decode();
 	int cmd;
-	if( !accepted_sock->get(cmd) ) {
-		dprintf(D_ALWAYS,
+	if( !named_sock->get(cmd) ) {
+			// a kept connection is closed when the server is done with it
+		dprintf(reused ? D_FULLDEBUG : D_ALWAYS,
 				"SharedPortEndpoint: failed to read command on %s\n",
 				m_full_name.Value());
-		delete accepted_sock;
-		return;
+		return false;
 	}
 
 	if( cmd != SHARED_PORT_PASS_SOCK ) {
@@ -1105,29 +1147,37 @@ SharedPortEndpoint::DoListenerAccept(ReliSock *return_remote_sock)
 				cmd,
 				getCommandString(cmd),
 				m_full_name.Value());
-		delete accepted_sock;
-		return;
+		return false;
 	}
 
-	if( !accepted_sock->end_of_message() ) {
+	if( !named_sock->end_of_message() ) {
 		dprintf(D_ALWAYS,
 				"SharedPortEndpoint: failed to read end of message for cmd %s on %s\n",
 				getCommandString(cmd),
 				m_full_name.Value());
-		delete accepted_sock;
-		return;
+		return false;
 	}
 
 	dprintf(D_COMMAND|D_FULLDEBUG,
 			"SharedPortEndpoint: received command %d SHARED_PORT_PASS_SOCK on named socket %s\n",
 			cmd,
 			m_full_name.Value());
+	return true;
+}
 
-	ReceiveSocket(accepted_sock,return_remote_sock);
-
-	delete accepted_sock;
-#endif
+int
+SharedPortEndpoint::HandleNamedConnection( Stream *stream )
+{
+	ReliSock *named_sock = static_cast<ReliSock*>(stream);
+	if( !ReadPassRequest(named_sock, true) ) {
+		m_named_connections.erase(named_sock);
+			// daemonCore closes it
+		return FALSE;
+	}
+	ReceiveSocket(named_sock, NULL);
+	return KEEP_STREAM;
 }
+#endif
 
 #ifndef WIN32
 void
@@ -24,6 +24,7 @@
 #include "reli_sock.h"
 #include "selector.h"
 #include <queue>
+#include <set>
 
 #ifdef LINUX
 #define USE_ABSTRACT_DOMAIN_SOCKET 1
@@ -172,6 +173,9 @@ class SharedPortEndpoint: Service {
 	bool StartListenerWin32();
 #else
 	ReliSock m_listener_sock; // named socket to receive forwarded connections
+		// connections on the named socket that the shared port server
+		// keeps open to pass us more than one socket
+	std::set<ReliSock*> m_named_connections;
 #endif
 	int m_socket_check_timer;
 
@@ -179,6 +183,8 @@ class SharedPortEndpoint: Service {
 
 	int HandleListenerAccept( Stream * stream );
 #ifndef WIN32
+	bool ReadPassRequest( ReliSock *named_sock, bool reused );
+	int HandleNamedConnection( Stream *stream );
 	void ReceiveSocket( ReliSock *local_sock, ReliSock *return_remote_sock );
 #endif
 	bool InitRemoteAddress();
@@ -23,10 +23,14 @@
 #include "shared_port_server.h"
 
 #include "daemon_command.h"
+#include "utc_time.h"
 
 SharedPortServer::SharedPortServer():
 	m_registered_handlers(false),
-	m_publish_addr_timer(-1)
+	m_publish_addr_timer(-1),
+	m_last_publish_time(condor_gettimestamp_double()),
+	m_last_success_count(0),
+	m_last_pass_seconds(0)
 {
 }
 
@@ -42,6 +46,8 @@ SharedPortServer::~SharedPortServer() {
 	if( m_publish_addr_timer != -1 ) {
 		daemonCore->Cancel_Timer( m_publish_addr_timer );
 	}
+
+	SharedPortClient::clearIdleConnections();
 }
 
 void
@@ -95,6 +101,12 @@ SharedPortServer::InitAndReconfig() {
 	forker.Initialize();
 	int max_workers = param_integer("SHARED_PORT_MAX_WORKERS",50,0);
 	forker.setMaxWorkers( max_workers );
+
+		// DAEMON_SOCKET_DIR may have changed, so start over with
+		// fresh connections to the endpoints.
+	SharedPortClient::clearIdleConnections();
+	SharedPortClient::setMaxIdleConnections(
+		param_integer("SHARED_PORT_MAX_IDLE_CONNECTIONS", 4, 0) );
 }
 
 void
@@ -153,6 +165,23 @@ SharedPortServer::PublishAddress()
 	ad.Assign("RequestsBlocked",m_shared_port_client.get_wouldBlockPassSocketCalls());
 	ad.Assign("ForkedChildrenCurrent",forker.getNumWorkers());
 	ad.Assign("ForkedChildrenPeak",forker.getPeakWorkers());
+	ad.Assign("RequestsReusedConnection",m_shared_port_client.get_reusedConnectionPassSocketCalls());
+	ad.Assign("IdleEndpointConnections",SharedPortClient::get_idleConnections());
+
+	// Routing rate and latency since the last time we were called
+	double now = condor_gettimestamp_double();
+	unsigned int succeeded = m_shared_port_client.get_successPassSocketCalls();
+	double pass_seconds = m_shared_port_client.get_passSocketSeconds();
+	unsigned int recent_succeeded = succeeded - m_last_success_count;
+	if( now > m_last_publish_time ) {
+		ad.Assign("RecentRequestsSucceededPerSecond",recent_succeeded / (now - m_last_publish_time));
+	}
+	ad.Assign("RecentRoutingLatencyAvg",
+		recent_succeeded ? (pass_seconds - m_last_pass_seconds) / recent_succeeded : 0.0);
+	ad.Assign("RecentRoutingLatencyMax",m_shared_port_client.take_maxPassSocketSeconds());
+	m_last_publish_time = now;
+	m_last_success_count = succeeded;
+	m_last_pass_seconds = pass_seconds;
 
 	// print the ad to our log file as D_ALWAYS for now, as a) it contains
 	// metrics that may be useful for debugging, and b) this method is 
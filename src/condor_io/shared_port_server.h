@@ -47,6 +47,10 @@ class SharedPortServer: Service {
 	SharedPortClient m_shared_port_client;
 	std::string m_default_id;
 	ForkWork forker;
+		// counters as of the last PublishAddress(), for recent rates
+	double m_last_publish_time;
+	unsigned int m_last_success_count;
+	double m_last_pass_seconds;
 
 	int HandleConnectRequest(int cmd,Stream *sock);
 	int HandleDefaultRequest(int cmd,Stream *sock);
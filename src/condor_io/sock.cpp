@@ -51,7 +51,9 @@
 #ifdef HAVE_EXT_OPENSSL
 #include "condor_crypt_blowfish.h"
 #include "condor_crypt_3des.h"
+#include "condor_crypt_aes.h"
 #include "condor_md.h"                // Message authentication stuff
+#include <openssl/sha.h>
 #endif
 
 #if !defined(WIN32)
@@ -2886,6 +2888,10 @@ Sock::initialize_crypto(KeyInfo * key)
 			setCryptoMethodUsed("3DES");
             crypto_ = new Condor_Crypt_3des(*key);
             break;
+        case CONDOR_AES:
+			setCryptoMethodUsed("AES_CFB");
+            crypto_ = new Condor_Crypt_AES(*key, isCryptoInitiator());
+            break;
 #endif
         default:
             break;
@@ -2970,6 +2976,53 @@ Sock::set_crypto_key(bool enable, KeyInfo * key, const char * keyId)
     return inited;
 }
 
+#ifdef HAVE_EXT_OPENSSL
+// Stretch SHA-256(counter | key | salt) out to the length of the key.
+static KeyInfo
+derive_session_key( const KeyInfo &key, const char *salt )
+{
+	int len = key.getKeyLength();
+	std::vector<unsigned char> derived( len );
+	std::vector<unsigned char> input;
+	for( int done = 0, counter = 0; done < len; counter++ ) {
+		input.clear();
+		input.push_back( (unsigned char)counter );
+		input.insert( input.end(), key.getKeyData(), key.getKeyData() + len );
+		input.insert( input.end(), salt, salt + strlen(salt) );
+		unsigned char md[SHA256_DIGEST_LENGTH];
+		SHA256( &input[0], input.size(), md );
+		int n = MIN( len - done, SHA256_DIGEST_LENGTH );
+		memcpy( &derived[done], md, n );
+		done += n;
+	}
+	return KeyInfo( &derived[0], len, key.getProtocol(), key.getDuration() );
+}
+#endif
+
+bool
+Sock::set_derived_session_keys( const Sock &parent, const char *salt )
+{
+#ifdef HAVE_EXT_OPENSSL
+	if( parent.crypto_ ) {
+		KeyInfo key = derive_session_key( parent.get_crypto_key(), salt );
+		if( !set_crypto_key( false, &key ) ) {
+			return false;
+		}
+	}
+	if( parent.mdMode_ != MD_OFF ) {
+		if( parent.mdKey_ ) {
+			KeyInfo key = derive_session_key( *parent.mdKey_, salt );
+			return set_MD_mode( parent.mdMode_, &key );
+		}
+		return set_MD_mode( parent.mdMode_ );
+	}
+#else
+	(void)parent;
+	(void)salt;
+#endif
+	return true;
+}
+
 bool
 Sock::canEncrypt() const
 {
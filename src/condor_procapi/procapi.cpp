@@ -29,6 +29,12 @@
 #if HAVE_SYS_PROCFS_H
 # include <sys/procfs.h>
 #endif
+#ifdef LINUX
+# include <sys/socket.h>
+# include <linux/netlink.h>
+# include <linux/connector.h>
+# include <linux/cn_proc.h>
+#endif
 
 
 size_t pidHashFunc( const pid_t& pid );
@@ -70,6 +76,12 @@ int ProcAPI::pagesize		= 0;
 #ifdef LINUX
 long unsigned ProcAPI::boottime	= 0;
 long ProcAPI::boottime_expiration = 0;
+std::map<pid_t, ProcAPI::procCacheEntry> * ProcAPI::procCache = NULL;
+unsigned ProcAPI::procCacheScan = 0;
+int ProcAPI::procCacheFds = 0;
+int ProcAPI::procCacheMaxFds = 0;
+int ProcAPI::procEventSock = -1;
+time_t ProcAPI::procEventsFullScan = 0;
 #endif // LINUX
 #else // WIN32
 
@@ -465,13 +477,13 @@ ProcAPI::getProcInfo( pid_t pid, piPTR& pi, int &status )
 
 		/* grab out the environment, if possible. I've noticed that
 		   under linux it appears that once the /proc/<pid>/environ
-		   file is made, it never changes. Luckily, we're only looking
-		   for specific stuff the parent only puts into the child's
-		   environment.
+		   file is made, it never changes until the process execs.
+		   Luckily, we're only looking for specific stuff the parent
+		   only puts into the child's environment.
 
 		   We don't care if it fails, its optional
 		*/
-	fillProcInfoEnv(pi);
+	fillProcInfoEnvCached(pi, procRaw);
 
 		// success
 	return PROCAPI_SUCCESS;
@@ -635,6 +647,86 @@ size_t ProcAPI::getBasicUsage(pid_t pid, double * puser_time, double * psys_time
    sample_time	: seconds since epoch
    proc_flags	: special process flags
 */
+/* Pulls the fields we want out of a line of /proc/<pid>/stat, in
+   place and without allocating.  The process name in parentheses may
+   contain anything, spaces and parentheses included, so fields are
+   counted from the last ')'.  Returns false if the line is too short.
+*/
+static bool
+parse_proc_stat( const char *line, procInfoRaw& procRaw )
+{
+		// field N of the man page is fields[N]; 1 and 2 are the pid and
+		// name, and 3 is the state letter, which we don't want
+	const int max_field = 51;
+	unsigned long long fields[max_field + 1];
+	memset(fields, 0, sizeof(fields));
+
+	char *end = NULL;
+	procRaw.pid = (pid_t)strtol(line, &end, 10);
+	if (end == line) {
+		return false;
+	}
+	const char *p = strrchr(line, ')');
+	if (p == NULL) {
+		return false;
+	}
+	p++;
+
+	int n = 2;
+	while (n < max_field) {
+		while (*p == ' ') {
+			p++;
+		}
+		if (*p == '\0' || *p == '\n') {
+			break;
+		}
+		n++;
+		if (n == 3) {
+			p++;
+			continue;
+		}
+			// a few fields are signed; they come out right when cast back
+		fields[n] = strtoull(p, &end, 10);
+		if (end == p) {
+			return false;
+		}
+		p = end;
+	}
+		// the old sscanf() wanted 35 fields, and so do we
+	if (n < 35) {
+		return false;
+	}
+
+	procRaw.ppid = (pid_t)fields[4];
+	procRaw.proc_flags = (unsigned long)fields[9];
+	procRaw.minfault = (long)fields[10];
+	procRaw.majfault = (long)fields[12];
+	procRaw.user_time_1 = (long)fields[14];
+	procRaw.sys_time_1 = (long)fields[15];
+	procRaw.creation_time = (birthday_t)fields[22];
+	procRaw.imgsize = (unsigned long)(fields[23] / 1024);
+	procRaw.rssize = (unsigned long)fields[24];
+	procRaw.env_start = (unsigned long)fields[50];
+	procRaw.env_end = (unsigned long)fields[51];
+	return true;
+}
+
+/* Fills in procInfoRaw with the following units:
+   imgsize		: kbytes
+   rssize		: pages
+   pssize       : k
+   minfault		: total minor faults
+   majfault		: total major faults
+   user_time_1	: jiffies (1/100 of a second)
+   user_time_2	: not set
+   sys_time_1	: jiffies (1/100 of a second)
+   sys_time_2	: not set
+   creation_time: jiffies since system boot
+   sample_time	: seconds since epoch
+   proc_flags	: special process flags
+   env_start	: address of the environment, if the kernel says
+   env_end		: end of the environment, if the kernel says
+*/
 int
 ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status ) 
 {
@@ -643,16 +735,19 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 // actually seems to work in Linux...nice, but annoyingly different.
 
 	char path[64];
-	FILE *fp;
+	char line[2048];
+	int fd = -1;
 	
 	int number_of_attempts;
-	long i;
-	unsigned long u;
-	unsigned long long imgsize_bytes;
-	char c;
-	char s[256];
 	int num_attempts = 5;
 
+		// if setIncrementalScan() was called, the stat file may
+		// still be open from last time
+	procCacheEntry *entry = NULL;
+	if (procCache) {
+		entry = &(*procCache)[pid];
+	}
+
 		// assume success
 	status = PROCAPI_OK;
 
@@ -671,7 +766,12 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 		// set the sample time
 		procRaw.sample_time = secsSinceEpoch();
 
-		if( (fp = safe_fopen_wrapper_follow(path, "r")) == NULL ) {
+		bool kept_open = false;
+		if (entry && entry->stat_fd != -1) {
+			fd = entry->stat_fd;
+			kept_open = true;
+		}
+		else if( (fd = safe_open_wrapper_follow(path, O_RDONLY | O_CLOEXEC)) == -1 ) {
 			if( errno == ENOENT ) {
 				// /proc/pid doesn't exist
 				status = PROCAPI_NOPID;
@@ -698,53 +798,42 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 			}
 		}
 
-	        // format of /proc/self/stat is
-	        // pid (ProcessName) State number number number number...
-	        // The process name can have spaces in it, so read the
-	        // whole line in with fgets, whack the spaces, then 
-	        // parse again with sprintf
-	        char line[512];
-		if (fgets(line, 512, fp) == NULL) {
-			// couldn't read the right number of entries.
+			// reading from offset 0 gets the current contents, so a
+			// stat file kept open from an earlier call is as good as
+			// a new one, until its process goes away
+		ssize_t len = pread(fd, line, sizeof(line) - 1, 0);
+		if (len <= 0) {
+			int read_errno = errno;
+			if (kept_open) {
+					// the process we had open is gone, though the
+					// pid may have been reused; open it again to see
+				forgetProcFile(*entry);
+				fd = -1;
+				number_of_attempts--;
+				continue;
+			}
+			close(fd);
+			fd = -1;
+			if (len == 0 || read_errno == ESRCH) {
+				// it exited between the open and the read
+				status = PROCAPI_NOPID;
+				dprintf( D_FULLDEBUG, 
+					"ProcAPI::getProcInfo() pid %d does not exist.\n", pid );
+				break;
+			}
 			status = PROCAPI_UNSPECIFIED;
 			dprintf( D_ALWAYS, 
 				"ProcAPI: Read error on %s: errno (%d): %s\n", 
-				 path, errno,  strerror(errno));
-
-			// don't leak for the next attempt;
-			fclose( fp );
-			fp = NULL;
+				 path, read_errno,  strerror(read_errno));
 
 			// try again
 			continue;
 		}
-
-		char *rparen = strrchr(line, ')');
-		char *lparen = strchr(line, '(');
-		if (lparen && rparen && lparen < rparen) {
-			while (lparen != rparen) {
-				if (*lparen == ' ') {
-					*lparen = '_';
-				}
-				lparen++;
-			}
-		}
+		line[len] = '\0';
 
 			// fill the raw structure from the proc file
 			// ensure I read the right number of arguments....
-		if ( sscanf( line, "%d %s %c %d "
-			"%ld %ld %ld %ld "
-			"%lu %lu %lu %lu %lu "
-			"%ld %ld %ld %ld %ld %ld "
-			"%lu %lu %llu %llu %lu %lu %lu %lu %lu %lu %lu "
-			"%ld %ld %ld %ld %lu",
-			&procRaw.pid, s, &c, &procRaw.ppid, 
-			&i, &i, &i, &i, 
-			&procRaw.proc_flags, &procRaw.minfault, &u, &procRaw.majfault, &u, 
-			&procRaw.user_time_1, &procRaw.sys_time_1, &i, &i, &i, &i, 
-			&u, &u, &procRaw.creation_time, &imgsize_bytes, &procRaw.rssize, &u, &u, &u, 
-			&u, &u, &u, &i, &i, &i, &i, &u ) != 35 )
-		{
+		if ( !parse_proc_stat(line, procRaw) ) {
 			// couldn't read the right number of entries.
 			status = PROCAPI_UNSPECIFIED;
 			dprintf( D_ALWAYS, 
@@ -752,16 +841,17 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 				 path, line, errno );
 
 			// don't leak for the next attempt;
-			fclose( fp );
-			fp = NULL;
+			if (kept_open) {
+				forgetProcFile(*entry);
+			} else {
+				close(fd);
+			}
+			fd = -1;
 
 			// try again
 			continue;
 		}
 
-		// covert imgsize_bytes to k
-		procRaw.imgsize = imgsize_bytes/1024;
-
 		// do a small verification of the read in data...
 		if ( pid == procRaw.pid ) {
 			// end the loop, data looks ok.
@@ -774,6 +864,12 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 		// and we'll either try again or give up based on
 		// number_of_attempts.
 		status = PROCAPI_GARBLED;
+		if (kept_open) {
+			forgetProcFile(*entry);
+		} else {
+			close(fd);
+		}
+		fd = -1;
 
 	} 	// end of while number_of_attempts < 0
 
@@ -788,19 +884,28 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 				"garbage! Aborting read.\n", num_attempts, path);
 		}
 
-		if (fp != NULL) {
-			fclose( fp );
-			fp = NULL;
+		if (entry) {
+			forgetProcFile(*entry);
+			procCache->erase(pid);
 		}
 
 		return PROCAPI_FAILURE;
 	}
 
 	// grab the process owner uid
-	procRaw.owner = getFileOwner(fileno(fp));
+	procRaw.owner = getFileOwner(fd);
 
-		// close the file
-	fclose( fp );
+		// keep the file open for next time, if we may
+	if (entry) {
+		entry->scan = procCacheScan;
+		if (entry->stat_fd == -1 && procCacheFds < procCacheMaxFds) {
+			entry->stat_fd = fd;
+			procCacheFds++;
+		}
+	}
+	if (!entry || entry->stat_fd != fd) {
+		close( fd );
+	}
 
 		// only one value for times
 	procRaw.user_time_2 = 0;
@@ -809,6 +914,184 @@ ProcAPI::getProcInfoRaw( pid_t pid, procInfoRaw& procRaw, int &status )
 	return PROCAPI_SUCCESS;
 }
 
+void
+ProcAPI::forgetProcFile(procCacheEntry& entry)
+{
+	if (entry.stat_fd != -1) {
+		close(entry.stat_fd);
+		entry.stat_fd = -1;
+		procCacheFds--;
+	}
+	entry.env_valid = false;
+	entry.ancestors.clear();
+}
+
+void
+ProcAPI::fillProcInfoEnvCached(piPTR pi, const procInfoRaw& procRaw)
+{
+	procCacheEntry *entry = NULL;
+	if (procCache) {
+		std::map<pid_t, procCacheEntry>::iterator it = procCache->find(pi->pid);
+		if (it != procCache->end()) {
+			entry = &it->second;
+		}
+	}
+	if (entry == NULL) {
+		fillProcInfoEnv(pi);
+		return;
+	}
+
+		// exec gives the process a new environment at a new address,
+		// and the birthday guards against the pid being reused
+	if (entry->env_valid && procRaw.env_end != 0 &&
+	    entry->env_start == procRaw.env_start &&
+	    entry->env_end == procRaw.env_end &&
+	    entry->birthday == procRaw.creation_time)
+	{
+		for (size_t i = 0; i < entry->ancestors.size() && i < PIDENVID_MAX; i++) {
+			pi->penvid.ancestors[i] = entry->ancestors[i];
+		}
+		return;
+	}
+
+	fillProcInfoEnv(pi);
+
+	entry->ancestors.clear();
+	for (int i = 0; i < pi->penvid.num; i++) {
+		if (pi->penvid.ancestors[i].active == FALSE) {
+			break;
+		}
+		entry->ancestors.push_back(pi->penvid.ancestors[i]);
+	}
+	entry->env_valid = procRaw.env_end != 0;
+	entry->env_start = procRaw.env_start;
+	entry->env_end = procRaw.env_end;
+	entry->birthday = procRaw.creation_time;
+}
+
+void
+ProcAPI::setIncrementalScan( bool watch_events )
+{
+	if (procCache == NULL) {
+		procCache = new std::map<pid_t, procCacheEntry>;
+	}
+
+		// leave the other half of our descriptors for everyone else
+	struct rlimit rl;
+	if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY) {
+		procCacheMaxFds = (int)(rl.rlim_cur / 2);
+	} else {
+		procCacheMaxFds = 1024;
+	}
+
+	if (!watch_events || procEventSock != -1) {
+		return;
+	}
+
+	int sock = socket(PF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+	if (sock == -1) {
+		dprintf(D_FULLDEBUG, "ProcAPI: no process connector (errno %d), will list /proc\n", errno);
+		return;
+	}
+
+	struct sockaddr_nl addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_pid = 0;
+	addr.nl_groups = CN_IDX_PROC;
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+		dprintf(D_FULLDEBUG, "ProcAPI: can't bind to the process connector (errno %d), will list /proc\n", errno);
+		close(sock);
+		return;
+	}
+
+	enum proc_cn_mcast_op op = PROC_CN_MCAST_LISTEN;
+	char req[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(op))] __attribute__((aligned(NLMSG_ALIGNTO)));
+	memset(req, 0, sizeof(req));
+	struct nlmsghdr *hdr = (struct nlmsghdr *)req;
+	hdr->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(op));
+	hdr->nlmsg_type = NLMSG_DONE;
+	hdr->nlmsg_pid = getpid();
+	struct cn_msg *msg = (struct cn_msg *)NLMSG_DATA(hdr);
+	msg->id.idx = CN_IDX_PROC;
+	msg->id.val = CN_VAL_PROC;
+	msg->len = sizeof(op);
+	memcpy(msg->data, &op, sizeof(op));
+	if (send(sock, req, hdr->nlmsg_len, 0) != (ssize_t)hdr->nlmsg_len) {
+		dprintf(D_FULLDEBUG, "ProcAPI: can't listen to the process connector (errno %d), will list /proc\n", errno);
+		close(sock);
+		return;
+	}
+
+	dprintf(D_FULLDEBUG, "ProcAPI: watching the process connector for new processes\n");
+	procEventSock = sock;
+		// we know nothing yet, so the next list reads all of /proc
+	procEventsFullScan = 0;
+}
+
+bool
+ProcAPI::readProcEvents()
+{
+	if (procEventSock == -1) {
+		return false;
+	}
+
+	bool lost = false;
+	char buf[8192] __attribute__((aligned(NLMSG_ALIGNTO)));
+	for (;;) {
+		ssize_t len = recv(procEventSock, buf, sizeof(buf), 0);
+		if (len < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == ENOBUFS) {
+					// the kernel dropped some; more may follow
+				lost = true;
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				dprintf(D_ALWAYS, "ProcAPI: error reading the process connector (errno %d), will list /proc\n", errno);
+				close(procEventSock);
+				procEventSock = -1;
+				lost = true;
+			}
+			break;
+		}
+		if (len == 0) {
+			break;
+		}
+
+		int remaining = (int)len;
+		for (struct nlmsghdr *hdr = (struct nlmsghdr *)buf;
+		     NLMSG_OK(hdr, remaining);
+		     hdr = NLMSG_NEXT(hdr, remaining))
+		{
+			if (hdr->nlmsg_type == NLMSG_NOOP) {
+				continue;
+			}
+			if (hdr->nlmsg_type == NLMSG_ERROR || hdr->nlmsg_type == NLMSG_OVERRUN) {
+				lost = true;
+				continue;
+			}
+			struct cn_msg *msg = (struct cn_msg *)NLMSG_DATA(hdr);
+			if (msg->id.idx != CN_IDX_PROC || msg->id.val != CN_VAL_PROC) {
+				continue;
+			}
+			struct proc_event *ev = (struct proc_event *)msg->data;
+				// a new thread is not a new process
+			if (ev->what == proc_event::PROC_EVENT_FORK &&
+			    ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid)
+			{
+				(*procCache)[ev->event_data.fork.child_tgid];
+			}
+				// anything that went away is noticed when reading
+				// its stat file fails, so exits are of no interest
+		}
+	}
+
+	return !lost;
+}
+
 int 
 ProcAPI::fillProcInfoEnv(piPTR pi)
 {
@@ -2088,6 +2371,35 @@ ProcAPI::buildPidList() {
 
 	current = pidList;
 
+#ifdef LINUX
+		// With the process connector, every process we know of is in
+		// procCache already, and forks add the new ones.  Still list
+		// /proc now and then, in case of events from before we started
+		// listening or that the kernel dropped.
+	if (procCache) {
+		time_t now = time(NULL);
+		bool complete = readProcEvents();
+		if (complete && procEventsFullScan != 0 && now >= procEventsFullScan &&
+		    now - procEventsFullScan < 60)
+		{
+			std::map<pid_t, procCacheEntry>::iterator it;
+			for (it = procCache->begin(); it != procCache->end(); it++) {
+				temp = new pidlist;
+				temp->pid = it->first;
+				temp->next = NULL;
+				current->next = temp;
+				current = temp;
+			}
+			temp = pidList;
+			pidList = pidList->next;
+			delete temp;           // remove header node.
+
+			return PROCAPI_SUCCESS;
+		}
+		procEventsFullScan = (procEventSock != -1) ? now : 0;
+	}
+#endif
+
 	dirp = condor_opendir("/proc");
 	if( dirp != NULL ) {
 			// NOTE: this will use readdir64() when available to avoid
@@ -2284,6 +2596,10 @@ ProcAPI::buildProcInfoList() {
 	current = allProcInfos;
 	current->next = NULL;
 
+#ifdef LINUX
+	procCacheScan++;
+#endif
+
 	temp = NULL;
 	while( (thispid = getAndRemNextPid()) >= 0 ) {
 		if( getProcInfo(thispid, temp, status) == PROCAPI_SUCCESS) {
@@ -2302,6 +2618,21 @@ ProcAPI::buildProcInfoList() {
 	allProcInfos = allProcInfos->next;
 	delete temp;
 
+#ifdef LINUX
+		// anything not in this list is gone
+	if (procCache) {
+		std::map<pid_t, procCacheEntry>::iterator it = procCache->begin();
+		while (it != procCache->end()) {
+			if (it->second.scan != procCacheScan) {
+				forgetProcFile(it->second);
+				procCache->erase(it++);
+			} else {
+				it++;
+			}
+		}
+	}
+#endif
+
 	return PROCAPI_SUCCESS;
 }
 
@@ -37,6 +37,11 @@
 #include <sys/types.h>     // various types needed.
 #include <time.h>          // use of time() for process age. 
 
+#ifdef LINUX
+#include <map>
+#include <vector>
+#endif
+
 #ifdef Darwin
 #include <sys/sysctl.h>
 #include <mach/mach.h>
@@ -321,6 +326,10 @@ typedef struct procInfoRaw{
 // special process flags for Linux
 #ifdef LINUX
 	  unsigned long proc_flags;
+	  // where the environment is in the process's address space;
+	  // 0 if the kernel is too old to tell us, or won't
+	  unsigned long env_start;
+	  unsigned long env_end;
 #endif //LINUX
 }procInfoRaw;
 
@@ -542,6 +551,23 @@ class ProcAPI {
     */
   static size_t getBasicUsage(pid_t pid, double * puser_time, double * psys_time=NULL);
 
+#ifdef LINUX
+  /**
+    * Make repeated calls to getProcInfoList() cheaper, for a caller
+    * like the procd that looks at every process on the machine every
+    * few seconds.  From now on each process's /proc/<pid>/stat is kept
+    * open between calls (up to half of our file descriptor limit), and
+    * its ancestor environment is only read again after it execs.
+    *
+    * If watch_events is true, also listen to the kernel's process
+    * connector and learn about new processes from their fork events,
+    * instead of listing /proc on every call.  /proc is still listed
+    * once a minute, and whenever events were lost.  This needs root;
+    * without it we quietly keep listing /proc.
+    */
+  static void setIncrementalScan( bool watch_events );
+#endif
+
  private:
 
   /** Default constructor.  It's private so that no one really
@@ -599,6 +625,12 @@ class ProcAPI {
 	  // extracts the environment from the system
 	  // Currently only have a linux implementation
   static int fillProcInfoEnv(piPTR);
+	  // fills in the environment from what setIncrementalScan() kept,
+	  // if that is still good, otherwise reads and keeps it
+  static void fillProcInfoEnvCached(piPTR, const procInfoRaw& procRaw);
+	  // drains the process connector, see setIncrementalScan()
+	  // returns false if events were lost
+  static bool readProcEvents();
 	  // updates the statically stored boottime variable if neccessary
 	  // something similar probably belongs in sys_api
   static int checkBootTime(long now);
@@ -699,6 +731,26 @@ private:
 		// change if the time is adjusted on this machine (by ntpd or afs,
 		// for example), so we recompute it when our value expires
 
+	// What setIncrementalScan() has us remember about each process.
+  struct procCacheEntry {
+	int stat_fd;              // /proc/<pid>/stat, or -1 if not kept open
+	unsigned scan;            // last list this process was seen in
+	bool env_valid;           // ancestors is good for the values below
+	birthday_t birthday;
+	unsigned long env_start;
+	unsigned long env_end;
+	std::vector<PidEnvIDEntry> ancestors;
+	procCacheEntry() : stat_fd(-1), scan(0), env_valid(false),
+		birthday(0), env_start(0), env_end(0) {}
+  };
+  static void forgetProcFile(procCacheEntry& entry);
+  static std::map<pid_t, procCacheEntry> *procCache; // NULL if not in use
+  static unsigned procCacheScan;
+  static int procCacheFds;
+  static int procCacheMaxFds;
+  static int procEventSock;        // process connector, or -1
+  static time_t procEventsFullScan; // when we last listed /proc
+
 #endif // LINUX
 
 #endif // not defined WIN32
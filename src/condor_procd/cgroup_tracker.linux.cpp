@@ -53,6 +53,36 @@ CGroupTracker::remove_mapping(ProcFamily* family)
 	return false;
 }
 
+void
+CGroupTracker::find_new_processes()
+{
+	std::vector<pid_t> pids;
+	std::map<std::string, ProcFamily*>::const_iterator end = m_cgroup_pool.end();
+	for (std::map<std::string, ProcFamily*>::const_iterator it = m_cgroup_pool.begin(); it != end; ++it) {
+		if (it->second->get_cgroup_refresh_interval() == -1 ||
+			!it->second->get_cgroup_procs(pids))
+		{
+			continue;
+		}
+		for (std::vector<pid_t>::const_iterator pid = pids.begin(); pid != pids.end(); ++pid) {
+			// a known PID is left for the next snapshot, which also
+			// catches a PID that has been reused
+			if (m_monitor->lookup_member(*pid) != NULL) {
+				continue;
+			}
+			procInfo* pi = NULL;
+			int status;
+			if (ProcAPI::getProcInfo(*pid, pi, status) != PROCAPI_SUCCESS) {
+				// it has exited already
+				delete pi;
+				continue;
+			}
+			pi->next = NULL;
+			m_monitor->add_member_to_family(it->second, pi, "CGROUP_PROCS");
+		}
+	}
+}
+
 bool
 CGroupTracker::check_process(procInfo* pi)
 {
@@ -22,6 +22,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "proc_family_tracker.h"
 
@@ -35,6 +36,11 @@ public:
 	bool remove_mapping(ProcFamily* family);
 	bool check_process(procInfo* pi);
 
+	// add processes listed in our families' cgroups that we haven't
+	// seen before; this is how cgroup-tracked families find new
+	// processes in between snapshots
+	void find_new_processes();
+
 private:
 
 	std::map<std::string, ProcFamily*> m_cgroup_pool;
@@ -61,12 +61,28 @@ ProcFamily::ProcFamily(ProcFamilyMonitor* monitor,
 	m_cm(CgroupManager::getInstance()),
 	m_initial_user_cpu(0),
 	m_initial_sys_cpu(0),
-	m_last_signal_was_sigstop(false)
+	m_last_signal_was_sigstop(false),
+	m_last_cpuacct_usage(0)
 #endif
 {
 #if !defined(WIN32)
 	m_proxy = NULL;
 #endif
+#if defined(HAVE_EXT_LIBCGROUP)
+	m_last_cpuacct_time.tv_sec = 0;
+	m_last_cpuacct_time.tv_usec = 0;
+#endif
+}
+
+int
+ProcFamily::get_max_snapshot_interval()
+{
+#if defined(HAVE_EXT_LIBCGROUP)
+	if (get_cgroup_refresh_interval() != -1) {
+		return -1;
+	}
+#endif
+	return m_max_snapshot_interval;
 }
 
 ProcFamily::~ProcFamily()
@@ -96,6 +112,101 @@ ProcFamily::~ProcFamily()
 
 #if defined(HAVE_EXT_LIBCGROUP)
 
+// Read the single number in a cgroup file such as memory.usage_in_bytes.
+static bool
+read_cgroup_uint64(const std::string &path, u_int64_t &value)
+{
+	if (path.empty()) {
+		return false;
+	}
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+	char buf[64];
+	ssize_t len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0) {
+		return false;
+	}
+	buf[len] = '\0';
+
+	char *end = NULL;
+	errno = 0;
+	unsigned long long tmp = strtoull(buf, &end, 10);
+	if (errno || end == buf) {
+		return false;
+	}
+	value = tmp;
+	return true;
+}
+
+std::string
+ProcFamily::cgroup_file_path(const char *controller, const char *file)
+{
+	std::string path;
+	char *mount_point = NULL;
+	int err = cgroup_get_subsys_mount_point(controller, &mount_point);
+	if (err || !mount_point) {
+		dprintf(D_PROCFAMILY,
+			"Unable to find the %s controller mount point (ProcFamily %u): %u %s.\n",
+			controller, m_root_pid, err, cgroup_strerror(err));
+		return path;
+	}
+	path = mount_point;
+	free(mount_point);
+	path += "/";
+	path += m_cgroup_string;
+	path += "/";
+	path += file;
+
+	if (access(path.c_str(), R_OK) != 0) {
+		dprintf(D_PROCFAMILY,
+			"Unable to read %s (ProcFamily %u): %u %s.\n",
+			path.c_str(), m_root_pid, errno, strerror(errno));
+		path.clear();
+	}
+	return path;
+}
+
+bool
+ProcFamily::has_cgroup_usage()
+{
+	return m_cgroup.isValid() &&
+		!m_memory_usage_path.empty() && !m_cpuacct_usage_path.empty();
+}
+
+int
+ProcFamily::get_cgroup_refresh_interval()
+{
+	if (!has_cgroup_usage() || m_cgroup_procs_path.empty()) {
+		return -1;
+	}
+	return m_max_snapshot_interval;
+}
+
+bool
+ProcFamily::get_cgroup_procs(std::vector<pid_t>& pids)
+{
+	pids.clear();
+	if (m_cgroup_procs_path.empty()) {
+		return false;
+	}
+	FILE* fp = safe_fopen_wrapper(m_cgroup_procs_path.c_str(), "r");
+	if (fp == NULL) {
+		dprintf(D_PROCFAMILY,
+			"Unable to open %s (ProcFamily %u): %u %s.\n",
+			m_cgroup_procs_path.c_str(), m_root_pid, errno, strerror(errno));
+		return false;
+	}
+	long pid;
+	while (fscanf(fp, "%ld", &pid) == 1) {
+		pids.push_back((pid_t)pid);
+	}
+	fclose(fp);
+	return true;
+}
+
 int
 ProcFamily::migrate_to_cgroup(pid_t pid)
 {
@@ -236,11 +347,24 @@ ProcFamily::set_cgroup(const std::string &cgroup_string)
 
 	m_cm.create(cgroup_string, m_cgroup, CgroupManager::ALL_CONTROLLERS, CgroupManager::NO_CONTROLLERS);
 	m_cgroup_string = m_cgroup.getCgroupString();
+	m_memory_usage_path.clear();
+	m_cpuacct_usage_path.clear();
+	m_cgroup_procs_path.clear();
+	m_last_cpuacct_time.tv_sec = 0;
+	m_last_cpuacct_time.tv_usec = 0;
 
 	if (!m_cgroup.isValid()) {
 		return 1;
 	}
 
+	if (m_cm.isMounted(CgroupManager::MEMORY_CONTROLLER) &&
+		m_cm.isMounted(CgroupManager::CPUACCT_CONTROLLER))
+	{
+		m_memory_usage_path = cgroup_file_path(MEMORY_CONTROLLER_STR, "memory.usage_in_bytes");
+		m_cpuacct_usage_path = cgroup_file_path(CPUACCT_CONTROLLER_STR, "cpuacct.usage");
+		m_cgroup_procs_path = cgroup_file_path(MEMORY_CONTROLLER_STR, "cgroup.procs");
+	}
+
 	// Now that we have a cgroup, let's move all the existing processes to it
 	ProcFamilyMember* member = m_member_list;
 	while (member != NULL) {
@@ -681,6 +805,30 @@ int ProcFamily::get_cpu_usage_cgroup(long &user_time, long &sys_time) {
 	return 0;
 }
 
+bool
+ProcFamily::get_cpu_percent_cgroup(double &percent_cpu)
+{
+	u_int64_t cpuacct_usage;
+	if (!read_cgroup_uint64(m_cpuacct_usage_path, cpuacct_usage)) {
+		return false;
+	}
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	bool have_percent = false;
+	if (m_last_cpuacct_time.tv_sec && cpuacct_usage >= m_last_cpuacct_usage) {
+		double elapsed = (now.tv_sec - m_last_cpuacct_time.tv_sec) +
+			(now.tv_usec - m_last_cpuacct_time.tv_usec) / 1.e6;
+		if (elapsed > 0) {
+			percent_cpu = (cpuacct_usage - m_last_cpuacct_usage) / 1.e9 / elapsed * 100.0;
+			have_percent = true;
+		}
+	}
+	m_last_cpuacct_usage = cpuacct_usage;
+	m_last_cpuacct_time = now;
+	return have_percent;
+}
+
 int
 ProcFamily::aggregate_usage_cgroup(ProcFamilyUsage* usage)
 {
@@ -689,41 +837,51 @@ ProcFamily::aggregate_usage_cgroup(ProcFamilyUsage* usage)
 		return -1;
 	}
 
-	int err;
+	int err = 0;
 	u_int64_t usage_in_bytes = 0;
-	struct cgroup_controller *memct;
 
 	// Update memory
 
-	Cgroup memcg;
-	if (m_cm.create(m_cgroup_string, memcg, CgroupManager::MEMORY_CONTROLLER, CgroupManager::MEMORY_CONTROLLER) ||
-			!memcg.isValid()) {
-		dprintf(D_PROCFAMILY,
-			"Unable to create cgroup %s (ProcFamily %u).\n",
-			m_cgroup_string.c_str(), m_root_pid);
-		return -1;
-	}
+	if (!m_memory_usage_path.empty()) {
+		if (!read_cgroup_uint64(m_memory_usage_path, usage_in_bytes)) {
+			dprintf(D_PROCFAMILY,
+				"Unable to read %s (ProcFamily %u): %u %s.\n",
+				m_memory_usage_path.c_str(), m_root_pid, errno, strerror(errno));
+			err = 1;
+		}
+	} else {
+		struct cgroup_controller *memct;
+		Cgroup memcg;
+		if (m_cm.create(m_cgroup_string, memcg, CgroupManager::MEMORY_CONTROLLER, CgroupManager::MEMORY_CONTROLLER) ||
+				!memcg.isValid()) {
+			dprintf(D_PROCFAMILY,
+				"Unable to create cgroup %s (ProcFamily %u).\n",
+				m_cgroup_string.c_str(), m_root_pid);
+			return -1;
+		}
 
-	if ((memct = cgroup_get_controller(&const_cast<struct cgroup &>(memcg.getCgroup()), MEMORY_CONTROLLER_STR)) == NULL) {
-		dprintf(D_PROCFAMILY,
-			"Unable to load memory controller for cgroup %s (ProcFamily %u).\n",
-			m_cgroup_string.c_str(), m_root_pid);
-		return -1;
-	}
+		if ((memct = cgroup_get_controller(&const_cast<struct cgroup &>(memcg.getCgroup()), MEMORY_CONTROLLER_STR)) == NULL) {
+			dprintf(D_PROCFAMILY,
+				"Unable to load memory controller for cgroup %s (ProcFamily %u).\n",
+				m_cgroup_string.c_str(), m_root_pid);
+			return -1;
+		}
 
-	err = cgroup_get_value_uint64(memct, "memory.usage_in_bytes", &usage_in_bytes);
-	if (err != 0) {
-		dprintf(D_PROCFAMILY,
-			"Unable to read cgroup %s memory usage (ProcFamily %u): %u %s.\n",
-			m_cgroup_string.c_str(), m_root_pid, err, cgroup_strerror(err));
-	} else {
+		err = cgroup_get_value_uint64(memct, "memory.usage_in_bytes", &usage_in_bytes);
+		if (err != 0) {
+			dprintf(D_PROCFAMILY,
+				"Unable to read cgroup %s memory usage (ProcFamily %u): %u %s.\n",
+				m_cgroup_string.c_str(), m_root_pid, err, cgroup_strerror(err));
+		}
+	}
+	if (err == 0) {
 
 		// Memory is ok
 		usage->total_image_size = usage_in_bytes/1024;
 		usage->total_resident_set_size = usage_in_bytes/1024;
 
 		// The poor man's way of updating the max image size.
-		if (usage_in_bytes > m_max_image_size) {
+		if (usage_in_bytes/1024 > m_max_image_size) {
 			m_max_image_size = usage_in_bytes/1024;
 		}
 		// XXX: Try again at using this at a later date.
@@ -792,6 +950,19 @@ ProcFamily::aggregate_usage(ProcFamilyUsage* usage)
 {
 	ASSERT(usage != NULL);
 
+	// a family in a cgroup gets its usage from the cgroup's counters,
+	// which are always current; it is walked in /proc only at the
+	// ProcD's own snapshot interval, so the per-process figures below
+	// may be stale, and reading smaps for PSS is costly anyway
+	//
+#if HAVE_PSS
+	bool per_process_pss = true;
+#if defined(HAVE_EXT_LIBCGROUP)
+	per_process_pss = !has_cgroup_usage();
+#endif
+#endif
+	double percent_cpu = 0.0;
+
 	// factor in usage from processes that are still alive
 	//
 	ProcFamilyMember* member = m_member_list;
@@ -801,7 +972,7 @@ ProcFamily::aggregate_usage(ProcFamilyUsage* usage)
 		//
 		usage->user_cpu_time += member->m_proc_info->user_time;
 		usage->sys_cpu_time += member->m_proc_info->sys_time;
-		usage->percent_cpu += member->m_proc_info->cpuusage;
+		percent_cpu += member->m_proc_info->cpuusage;
 
 		// current total image size
 		//
@@ -811,11 +982,13 @@ ProcFamily::aggregate_usage(ProcFamilyUsage* usage)
 
 		// PSS is special: it's expensive to calculate for every process,
 		// so we calculate it on demand
-		int status; // Is ignored
-		int rc = ProcAPI::getPSSInfo(member->m_proc_info->pid, *(member->m_proc_info), status);
-		if( (rc == PROCAPI_SUCCESS) && (member->m_proc_info->pssize_available) ) {
-			usage->total_proportional_set_size_available = true;
-			usage->total_proportional_set_size += member->m_proc_info->pssize;
+		if (per_process_pss) {
+			int status; // Is ignored
+			int rc = ProcAPI::getPSSInfo(member->m_proc_info->pid, *(member->m_proc_info), status);
+			if( (rc == PROCAPI_SUCCESS) && (member->m_proc_info->pssize_available) ) {
+				usage->total_proportional_set_size_available = true;
+				usage->total_proportional_set_size += member->m_proc_info->pssize;
+			}
 		}
 #endif
 
@@ -833,8 +1006,11 @@ ProcFamily::aggregate_usage(ProcFamilyUsage* usage)
 
 #if defined(HAVE_EXT_LIBCGROUP)
 	aggregate_usage_cgroup(usage);
+	if (has_cgroup_usage()) {
+		get_cpu_percent_cgroup(percent_cpu);
+	}
 #endif
-
+	usage->percent_cpu += percent_cpu;
 }
 
 void
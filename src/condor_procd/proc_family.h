@@ -27,6 +27,7 @@
 
 #if defined(HAVE_EXT_LIBCGROUP)
 #include "../condor_starter.V6.1/cgroup.linux.h"
+#include <vector>
 #endif
 
 class ProcFamilyMonitor;
@@ -64,9 +65,24 @@ public:
 	//
 	pid_t get_watcher_pid() { return m_watcher_pid; };
 
-	// accessor for the requested maximum snapshot interval
+	// accessor for the requested maximum snapshot interval. a family
+	// whose usage comes from its cgroup's counters returns -1 (no
+	// requirement): it finds its new processes in the cgroup's process
+	// list instead, at the interval it asked for (see below)
 	//
-	int get_max_snapshot_interval() { return m_max_snapshot_interval; }
+	int get_max_snapshot_interval();
+
+#if defined(HAVE_EXT_LIBCGROUP)
+	// how often a cgroup-tracked family wants its cgroup's process list
+	// read for new members; -1 if the family is not tracked that way
+	//
+	int get_cgroup_refresh_interval();
+
+	// the PIDs currently in this family's cgroup; false if the
+	// cgroup's process list can't be read
+	//
+	bool get_cgroup_procs(std::vector<pid_t>& pids);
+#endif
 
 	// since we maintain the tree of process families in
 	// ProcFamilyMonitor, not here, we need help in maintaining the
@@ -202,6 +218,22 @@ private:
 	int migrate_to_cgroup(pid_t);
 	void update_max_image_size_cgroup();
 	int get_cpu_usage_cgroup(long &user_cpu, long &sys_cpu);
+	bool get_cpu_percent_cgroup(double &percent_cpu);
+
+	// The handful of cgroup files read for every usage report or
+	// refresh of the family's members, found once in set_cgroup().  Reading them directly is much cheaper than
+	// having libcgroup load every file of the controller.  Empty if the
+	// file could not be found or read.
+	std::string m_memory_usage_path;
+	std::string m_cpuacct_usage_path;
+	std::string m_cgroup_procs_path;
+	std::string cgroup_file_path(const char *controller, const char *file);
+	bool has_cgroup_usage();
+
+	// cpuacct.usage (nanoseconds) at the last usage report, for the
+	// family's CPU percentage since then
+	u_int64_t m_last_cpuacct_usage;
+	struct timeval m_last_cpuacct_time;
 #endif
 };
 
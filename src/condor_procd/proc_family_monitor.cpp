@@ -774,7 +774,7 @@ ProcFamilyMonitor::get_snapshot_interval(Tree<ProcFamily*>* tree)
 		if (ret_value == -1) {
 			ret_value = child_value;
 		}
-		else if (child_value < ret_value) {
+		else if (child_value != -1 && child_value < ret_value) {
 			ret_value = child_value;
 		}
 		child = child->get_sibling();
@@ -783,6 +783,42 @@ ProcFamilyMonitor::get_snapshot_interval(Tree<ProcFamily*>* tree)
 	return ret_value;
 }
 
+#if defined(HAVE_EXT_LIBCGROUP)
+int
+ProcFamilyMonitor::get_cgroup_refresh_interval()
+{
+	return get_cgroup_refresh_interval(m_tree);
+}
+
+int
+ProcFamilyMonitor::get_cgroup_refresh_interval(Tree<ProcFamily*>* tree)
+{
+	int ret_value = tree->get_data()->get_cgroup_refresh_interval();
+
+	Tree<ProcFamily*>* child = tree->get_child();
+	while (child != NULL) {
+		int child_value = get_cgroup_refresh_interval(child);
+		if (ret_value == -1) {
+			ret_value = child_value;
+		}
+		else if (child_value != -1 && child_value < ret_value) {
+			ret_value = child_value;
+		}
+		child = child->get_sibling();
+	}
+
+	return ret_value;
+}
+
+void
+ProcFamilyMonitor::refresh_cgroup_families()
+{
+	if (m_cgroup_tracker != NULL) {
+		m_cgroup_tracker->find_new_processes();
+	}
+}
+#endif
+
 unsigned long
 ProcFamilyMonitor::update_max_image_sizes(Tree<ProcFamily*>* tree)
 {
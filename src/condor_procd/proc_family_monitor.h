@@ -132,6 +132,19 @@ public:
 	//
 	void snapshot();
 
+#if defined(HAVE_EXT_LIBCGROUP)
+	// return the time that the procd should wait in between looking
+	// for new processes in the cgroups of cgroup-tracked families
+	// (which don't ask for snapshots); -1 if there are none
+	//
+	int get_cgroup_refresh_interval();
+
+	// add processes that have appeared in the cgroups of cgroup-tracked
+	// families since the last snapshot, without walking /proc
+	//
+	void refresh_cgroup_families();
+#endif
+
 	// used to access the pid_t to ProcFamilyMember hash table
 	// (these need to be public since they are called from the
 	//  various tracker classes)
@@ -189,6 +202,9 @@ private:
 	// snapshot intervals"
 	//
 	int get_snapshot_interval(Tree<ProcFamily*>*);
+#if defined(HAVE_EXT_LIBCGROUP)
+	int get_cgroup_refresh_interval(Tree<ProcFamily*>*);
+#endif
 
 	// since we maintain the tree of process families in this class,
 	// each ProcFamily object needs our help in maintaining the maximum
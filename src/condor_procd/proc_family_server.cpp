@@ -357,22 +357,62 @@ ProcFamilyServer::quit()
 	write_to_client(&err, sizeof(proc_family_error_t));
 }
 
+// keep a timer's countdown (in seconds, or -1 for "never") in line with
+// its current interval
+//
+static void
+limit_countdown(int& countdown, int interval)
+{
+	if (interval == -1) {
+		countdown = -1;
+	}
+	else if (countdown == -1 || countdown > interval) {
+		countdown = interval;
+	}
+}
+
+// take elapsed seconds off of a countdown, without going below 0 since
+// -1 means "INFINITE"
+//
+static void
+run_countdown(int& countdown, int elapsed)
+{
+	if (countdown != -1) {
+		countdown -= elapsed;
+		if (countdown < 0) {
+			countdown = 0;
+		}
+	}
+}
+
 void
 ProcFamilyServer::wait_loop()
 {
 	int snapshot_interval;
 	int snapshot_countdown = INT_MAX;
+#if defined(HAVE_EXT_LIBCGROUP)
+	// families tracked by a cgroup don't ask for snapshots; instead we
+	// look for their new processes in their cgroups, which is much
+	// cheaper than walking all of /proc
+	//
+	int cgroup_interval;
+	int cgroup_countdown = INT_MAX;
+#endif
 
 	bool quit_received = false;
 	while(!quit_received) {
 
 		snapshot_interval = m_monitor.get_snapshot_interval();
-		if (snapshot_interval == -1) {
-			snapshot_countdown = -1;
-		}
-		else if (snapshot_countdown > snapshot_interval) {
-			snapshot_countdown = snapshot_interval;
+		limit_countdown(snapshot_countdown, snapshot_interval);
+#if defined(HAVE_EXT_LIBCGROUP)
+		cgroup_interval = m_monitor.get_cgroup_refresh_interval();
+		limit_countdown(cgroup_countdown, cgroup_interval);
+
+		if (cgroup_countdown == 0) {
+			m_monitor.refresh_cgroup_families();
+			cgroup_countdown = cgroup_interval;
 		}
+#endif
 
 		// see if we need to run our timer handler
 		//
@@ -403,30 +443,44 @@ ProcFamilyServer::wait_loop()
 			snapshot_countdown = snapshot_interval;
 		}
 	
+		// wait for a command until the next timer is due
+		//
+		int timeout = snapshot_countdown;
+#if defined(HAVE_EXT_LIBCGROUP)
+		if (cgroup_countdown != -1 &&
+		    (timeout == -1 || cgroup_countdown < timeout))
+		{
+			timeout = cgroup_countdown;
+		}
+#endif
+
 		time_t time_before = time(NULL);
 		bool command_ready;
-		bool ok = m_server->accept_connection(snapshot_countdown,
+		bool ok = m_server->accept_connection(timeout,
 		                                      command_ready);
 		if (!ok) {
 			EXCEPT("ProcFamilyServer: failed trying to accept client");
 		}
 		if (!command_ready) {
-			// timeout; make sure we execute the timer handler
-			// next time around by explicitly setting the
-			// countdown to zero
+			// timeout; make sure we execute the timer handler(s)
+			// that were due next time around by taking the whole
+			// timeout off of the countdowns
 			//
-			snapshot_countdown = 0;
+			run_countdown(snapshot_countdown, timeout);
+#if defined(HAVE_EXT_LIBCGROUP)
+			run_countdown(cgroup_countdown, timeout);
+#endif
 			continue;
 		}
 
-		// adjust the countdown according to how long it took
-		// to receive the command. we need to make sure this
-		// doesn't go below 0 since -1 means "INFINITE"
+		// adjust the countdowns according to how long it took
+		// to receive the command
 		//
-		snapshot_countdown -= (time(NULL) - time_before);
-		if (snapshot_countdown < 0) {
-			snapshot_countdown = 0;
-		}
+		int elapsed = time(NULL) - time_before;
+		run_countdown(snapshot_countdown, elapsed);
+#if defined(HAVE_EXT_LIBCGROUP)
+		run_countdown(cgroup_countdown, elapsed);
+#endif
 
 		// read the command int from the client
 		//
@@ -461,6 +461,17 @@ main(int argc, char* argv[])
 	}
 #endif
 
+#if defined(LINUX)
+	// we snapshot every process on the system over and over, so keep
+	// what ProcAPI learns about each process from one snapshot to the
+	// next. our parent can't param for us, so whether to also use the
+	// kernel's process connector comes in the environment
+	//
+	const char* use_proc_events = getenv("_condor_PROCD_USE_PROC_EVENTS");
+	ProcAPI::setIncrementalScan(use_proc_events == NULL ||
+	                            (*use_proc_events != 'f' && *use_proc_events != 'F'));
+#endif
+
 	// initialize the "engine" for tracking process families
 	// If we specified a root pid, that means we don't want to except if it
 	// dies. If we didn't specify a root pid, it means the procd's parent
@@ -7957,6 +7957,45 @@ void FindRunnableJob(PROC_ID & jobid, ClassAd* my_match_ad,
 	// no more jobs to run anywhere.  nothing more to do.  failure.
 }
 
+/*
+ * Count the runnable, unmatched jobs of user in the most recently
+ * constructed list that are in the same autocluster as jobid, not
+ * counting jobid itself, stopping at limit.  Those are the jobs that
+ * could run on further slots just like the one jobid was matched with.
+ */
+int CountRunnableJobsInAutocluster(PROC_ID jobid, char const * user, int limit)
+{
+	JobQueueJob *job = GetJobAd( jobid.cluster, jobid.proc );
+	if( !job || !user || !*user ) {
+		return 0;
+	}
+	int auto_id = job->autocluster_id;
+	if( auto_id == -1 ) {
+		auto_id = jobid.cluster;
+	}
+
+	MyString owner = user;
+	int at_sign_pos = owner.FindChar('@');
+	if ( at_sign_pos >= 0 ) {
+		owner.truncate(at_sign_pos);
+	}
+
+	int count = 0;
+	for( int i = 0; i < N_PrioRecs && count < limit; i++ ) {
+		if( PrioRec[i].auto_cluster_id != auto_id ||
+			PrioRec[i].owner[0] == '\0' ||
+			strcmp(PrioRec[i].owner, owner.Value()) != 0 ||
+			PrioRec[i].id == jobid )
+		{
+			continue;
+		}
+		if( Runnable(&PrioRec[i].id) && !scheduler.AlreadyMatched(&PrioRec[i].id) ) {
+			count++;
+		}
+	}
+	return count;
+}
+
 int Runnable(JobQueueJob *job, const char *& reason)
 {
 	int status, universe, cur = 0, max = 1;
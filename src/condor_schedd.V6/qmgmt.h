@@ -566,6 +566,7 @@ extern HashTable<int,int> *PrioRecAutoClusterRejected;
 extern int grow_prio_recs(int);
 
 extern void	FindRunnableJob(PROC_ID & jobid, ClassAd* my_match_ad, char const * user);
+extern int CountRunnableJobsInAutocluster(PROC_ID jobid, char const * user, int limit);
 extern int Runnable(PROC_ID*);
 extern int Runnable(JobQueueJob *job, const char *& reason);
 
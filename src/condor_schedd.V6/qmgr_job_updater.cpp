@@ -171,6 +171,15 @@ QmgrJobUpdater::initJobQueueAttrLists( void )
 	common_job_queue_attrs->insert( ATTR_JOB_TRANSFERRING_OUTPUT_TIME );
 	common_job_queue_attrs->insert( ATTR_NUM_JOB_COMPLETIONS );
 	common_job_queue_attrs->insert( ATTR_IO_WAIT);
+	common_job_queue_attrs->insert( ATTR_STARTER_PREWARMED );
+	common_job_queue_attrs->insert( ATTR_STARTER_INIT_DURATION );
+	common_job_queue_attrs->insert( ATTR_STARTER_JOB_AD_DURATION );
+	common_job_queue_attrs->insert( ATTR_STARTER_SANDBOX_DURATION );
+	common_job_queue_attrs->insert( ATTR_STARTER_ENVIRONMENT_DURATION );
+	common_job_queue_attrs->insert( ATTR_STARTER_SPAWN_DURATION );
+	common_job_queue_attrs->insert( ATTR_STARTER_STARTUP_DURATION );
+	common_job_queue_attrs->insert( ATTR_DATA_REUSE_BYTES_REFLINKED );
+	common_job_queue_attrs->insert( ATTR_DATA_REUSE_BYTES_COPIED );
 
 	// FIXME: What I'd actually like is a way to queue all attributes
 	// not in any whitelist for delivery with the last update.
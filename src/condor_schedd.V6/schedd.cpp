@@ -115,6 +115,7 @@ extern GridUniverseLogic* _gridlogic;
 #include "condor_vm_universe_types.h"
 #include "enum_utils.h"
 #include "credmon_interface.h"
+#include "condor_sinful.h"
 
 extern "C"
 {
@@ -464,6 +465,9 @@ match_rec::match_rec( char const* claim_id, char const* p, PROC_ID* job_id,
 	keep_while_idle = 0;
 	idle_timer_deadline = 0;
 
+	m_prefetch_deadline = 0;
+	m_idle_since = 0;
+
 	m_can_start_jobs = true;
 	m_paired_mrec = NULL;
 }
@@ -654,6 +658,7 @@ Scheduler::Scheduler() :
 	matches = NULL;
 	matchesByJobID = NULL;
 	shadowsByPid = NULL;
+	m_killedMultiJobShadowJobsTid = -1;
 	spoolJobFileWorkers = NULL;
 
 	shadowsByProcID = NULL;
@@ -673,6 +678,10 @@ Scheduler::Scheduler() :
 	checkReconnectQueue_tid = -1;
 	num_pending_startd_contacts = 0;
 	max_pending_startd_contacts = 0;
+	max_pending_startd_contacts_per_host = 0;
+	startd_contact_target_latency = 0;
+	adaptive_startd_contact_limit = 0;
+	last_startd_contact_backoff = 0;
 
 	act_on_job_myself_queue.
 		registerHandlercpp( (ServiceDataHandlercpp)
@@ -717,6 +726,8 @@ Scheduler::Scheduler() :
 	From.sin_addr.s_addr = 0;
 
 	m_use_startd_for_local = false;
+	m_claim_prefetch = false;
+	m_claim_prefetch_lifetime = 0;
 	cronTabs = 0;
 	MaxExceptions = 0;
 	m_job_machine_attrs_history_length = 0;
@@ -791,6 +802,17 @@ Scheduler::~Scheduler()
 		}
 		delete shadowsByPid;
 	}
+	if (shadowsByProcID) {
+			// jobs in a multi-job shadow share its pid, so they are
+			// not in shadowsByPid
+		shadowsByProcID->startIterations();
+		shadow_rec *rec;
+		while (shadowsByProcID->iterate(rec) == 1) {
+			if (rec->multi_job_shadow && rec->pid) {
+				delete rec;
+			}
+		}
+	}
 	if (spoolJobFileWorkers) {
 		spoolJobFileWorkers->startIterations();
 		ExtArray<PROC_ID> * rec;
@@ -1932,6 +1954,7 @@ int Scheduler::make_ad_list(
    stats.Tick(now);
    stats.JobsSubmitted = GetJobQueuedCount();
    stats.ShadowsRunning = numShadows;
+   stats.MultiJobShadowsRunning = shadow_mgr.numMultiJobShadows();
    stats.Autoclusters = autocluster.getNumAutoclusters();
 
    OtherPoolStats.Tick(now);
@@ -7667,6 +7690,26 @@ Scheduler::release_claim(int, Stream *sock)
 	return;
 }
 
+// The machine a claim request goes to, for
+// MAX_PENDING_STARTD_CONTACTS_PER_HOST: the slot's Machine attribute,
+// else the host part of the startd's address, so that the startds and
+// slots of one machine are counted together.
+static std::string
+startd_contact_host( match_rec *mrec, char const *sinful )
+{
+	std::string host;
+	if( mrec && mrec->my_match_ad &&
+		mrec->my_match_ad->LookupString( ATTR_MACHINE, host ) && !host.empty() )
+	{
+		return host;
+	}
+	Sinful addr( sinful );
+	if( addr.valid() && addr.getHost() ) {
+		return addr.getHost();
+	}
+	return sinful ? sinful : "";
+}
+
 void
 Scheduler::contactStartd( ContactStartdArgs* args ) 
 {
@@ -7774,6 +7817,24 @@ Scheduler::contactStartd( ContactStartdArgs* args )
 	jobAd->Assign( ATTR_STARTER_HANDLES_ALIVES, 
 					param_boolean("STARTER_HANDLES_ALIVES",true) );
 
+	// If this is a partitionable slot, ask for a dynamic slot for each
+	// idle job in this job's autocluster, up to
+	// CLAIM_DYNAMIC_SLOTS_PER_REQUEST, rather than claiming them one
+	// request at a time.  Only those jobs are sure to want slots just
+	// like this one, so we won't claim slots we have no job for.
+	if( !mrec->is_dedicated ) {
+		int num_slots = param_integer( "CLAIM_DYNAMIC_SLOTS_PER_REQUEST", 1, 1 );
+		if( num_slots > 1 ) {
+			PROC_ID jobid;
+			jobid.cluster = mrec->cluster;
+			jobid.proc = mrec->proc;
+			num_slots = 1 + CountRunnableJobsInAutocluster( jobid, mrec->user, num_slots - 1 );
+		}
+		if( num_slots > 1 ) {
+			jobAd->Assign( "_condor_NUM_DYNAMIC_SLOTS", num_slots );
+		}
+	}
+
 	// Setup to claim the slot asynchronously
 
 	classy_counted_ptr<DCMsgCallback> cb = new DCMsgCallback(
@@ -7789,6 +7850,12 @@ Scheduler::contactStartd( ContactStartdArgs* args )
 
 	this->num_pending_startd_contacts++;
 
+	PendingStartdContact &pending = pending_startd_contacts[cb.get()];
+	pending.host = startd_contact_host( mrec, args->sinful() );
+	pending.start = _condor_debug_get_time_double();
+	pending_startd_contacts_by_host[pending.host]++;
+	stats.ClaimRequestsSent += 1;
+
 	int deadline_timeout = -1;
 	if( RequestClaimTimeout > 0 ) {
 			// Add in a little slop time so that schedd has a chance
@@ -7816,6 +7883,7 @@ Scheduler::claimedStartd( DCMsgCallback *cb ) {
 	ClaimStartdMsg *msg = (ClaimStartdMsg *)cb->getMessage();
 
 	this->num_pending_startd_contacts--;
+	startdContactFinished( cb, msg->claimed_startd_success() );
 	scheduler.rescheduleContactQueue();
 
 	match_rec *match = (match_rec *)cb->getMiscDataPtr();
@@ -7945,6 +8013,13 @@ Scheduler::claimedStartd( DCMsgCallback *cb ) {
 		delete sn;
 	} 
 
+	// If the startd carved more dynamic slots for this request, find a
+	// job for each and start it, giving back any we have no use for.
+	for( int i = 0; !match->is_dedicated && i < msg->num_extra_slots(); i++ ) {
+		claimedExtraSlot( match, msg->extra_slot_claim_id(i),
+						  msg->extra_slot_startd_ad(i) );
+	}
+
 	// AsyncXfer: If this isn't a dedicated match, handle a paired claim
 	if ( !match->is_dedicated && msg->have_paired_slot() ) {
 		// AsyncXfer: TODO Is this the right job id to use for the paired
@@ -7994,10 +8069,131 @@ Scheduler::claimedStartd( DCMsgCallback *cb ) {
 }
 
 
+void
+Scheduler::claimedExtraSlot( match_rec *match, char const *claim_id, ClassAd *slot_ad )
+{
+	std::string slot_name;
+	slot_ad->LookupString( ATTR_NAME, slot_name );
+
+		// Carry Negotiator Match expressions over from the match record.
+	size_t len = strlen(ATTR_NEGOTIATOR_MATCH_EXPR);
+	for ( auto itr = match->my_match_ad->begin(); itr != match->my_match_ad->end(); itr++ ) {
+		if( !strncmp(itr->first.c_str(),ATTR_NEGOTIATOR_MATCH_EXPR,len) &&
+			itr->second && !slot_ad->LookupExpr(itr->first) )
+		{
+			slot_ad->Insert( itr->first, itr->second->Copy() );
+		}
+	}
+
+	PROC_ID jobid;
+	jobid.cluster = -1; jobid.proc = -1;
+	if( canSpawnShadow() ) {
+		FindRunnableJob( jobid, slot_ad, match->user );
+	}
+
+	match_rec *mrec = NULL;
+	if( jobid.cluster != -1 && jobid.proc != -1 ) {
+		mrec = AddMrec( claim_id, match->peer, &jobid, slot_ad, match->user,
+						match->getPool().empty() ? nullptr : match->getPool().c_str() );
+	}
+	if( !mrec ) {
+		dprintf( D_FULLDEBUG, "No job found to run on extra slot %s, releasing it\n",
+				 slot_name.c_str() );
+		send_matchless_vacate( slot_name.c_str(), NULL, match->peer, claim_id, RELEASE_CLAIM );
+		return;
+	}
+	dprintf( D_FULLDEBUG, "Received extra slot %s for job %d.%d\n",
+			 slot_name.c_str(), jobid.cluster, jobid.proc );
+
+	mrec->setStatus( M_CLAIMED );
+	if ( match->auth_hole_id != NULL ) {
+		mrec->auth_hole_id = new MyString( *match->auth_hole_id );
+		IpVerify* ipv = daemonCore->getSecMan()->getIpVerify();
+		if (!ipv->PunchHole(READ, *mrec->auth_hole_id)) {
+			dprintf(D_ALWAYS,
+				"WARNING: IpVerify::PunchHole error for %s: "
+				"job %d.%d may fail to execute\n",
+				mrec->auth_hole_id->Value(), mrec->cluster, mrec->proc);
+			delete mrec->auth_hole_id;
+			mrec->auth_hole_id = NULL;
+		}
+	}
+
+	StartJob( mrec );
+}
+
+
+void
+Scheduler::startdContactFinished( DCMsgCallback *cb, bool success )
+{
+	auto it = pending_startd_contacts.find( cb );
+	if( it == pending_startd_contacts.end() ) {
+		return;
+	}
+
+	double now = _condor_debug_get_time_double();
+	double latency = now - it->second.start;
+
+	auto host = pending_startd_contacts_by_host.find( it->second.host );
+	if( host != pending_startd_contacts_by_host.end() && --host->second <= 0 ) {
+		pending_startd_contacts_by_host.erase( host );
+	}
+	pending_startd_contacts.erase( it );
+
+	if( success ) {
+		stats.ClaimRequestsSucceeded += 1;
+	}
+	else {
+		stats.ClaimRequestsFailed += 1;
+	}
+	stats.ClaimRequestLatency += latency;
+
+	if( startd_contact_target_latency <= 0 ) {
+		return;
+	}
+
+	if( success && latency <= startd_contact_target_latency ) {
+		adaptive_startd_contact_limit += 1;
+		if( max_pending_startd_contacts > 0 &&
+			adaptive_startd_contact_limit > max_pending_startd_contacts )
+		{
+			adaptive_startd_contact_limit = max_pending_startd_contacts;
+		}
+	}
+	else if( latency > startd_contact_target_latency &&
+			 now - last_startd_contact_backoff >= startd_contact_target_latency )
+	{
+			// Back off at most once per target latency, so that a burst
+			// of slow replies to requests sent before the last backoff
+			// does not collapse the limit.
+		adaptive_startd_contact_limit /= 2;
+		if( adaptive_startd_contact_limit < 1 ) {
+			adaptive_startd_contact_limit = 1;
+		}
+		last_startd_contact_backoff = now;
+		dprintf( D_FULLDEBUG, "Claim request took %.3fs (target %.3fs), "
+				 "reducing pending claim request limit to %d\n",
+				 latency, startd_contact_target_latency, startdContactLimit() );
+	}
+}
+
+int
+Scheduler::startdContactLimit() const
+{
+	if( startd_contact_target_latency <= 0 ) {
+		return max_pending_startd_contacts;
+	}
+	int limit = (int)adaptive_startd_contact_limit;
+	if( max_pending_startd_contacts > 0 && limit > max_pending_startd_contacts ) {
+		limit = max_pending_startd_contacts;
+	}
+	return limit;
+}
+
 bool
 Scheduler::enqueueStartdContact( ContactStartdArgs* args )
 {
-	 startdContactQueue.push(args);
+	 startdContactQueue.push_back(args);
 	 dprintf( D_FULLDEBUG, "Enqueued contactStartd startd=%s\n",
 			  args->sinful() );  
 
@@ -8034,6 +8230,8 @@ void
 Scheduler::checkContactQueue() 
 {
 	ContactStartdArgs *args;
+	int limit = startdContactLimit();
+	size_t next = 0;
 
 		// clear out the timer tid, since we made it here.
 	checkContactQueue_tid = -1;
@@ -8043,13 +8241,26 @@ Scheduler::checkContactQueue()
 		// daemonCore, which ensures we do not run ourselves out
 		// of socket descriptors.
 	while( !daemonCore->TooManyRegisteredSockets() &&
-		   (num_pending_startd_contacts < max_pending_startd_contacts
-            || max_pending_startd_contacts <= 0) &&
-		   (!startdContactQueue.empty()) ) {
+		   (num_pending_startd_contacts < limit || limit <= 0) &&
+		   next < startdContactQueue.size() ) {
 			// there's a pending registration in the queue:
 
-		args = startdContactQueue.front();
-		startdContactQueue.pop();
+		args = startdContactQueue[next];
+		if( max_pending_startd_contacts_per_host > 0 ) {
+			match_rec *mrec = args->isDedicated() ?
+				dedicated_scheduler.FindMrecByClaimID( args->claimId() ) :
+				FindMrecByClaimID( args->claimId() );
+			auto host = pending_startd_contacts_by_host.find(
+				startd_contact_host( mrec, args->sinful() ) );
+			if( host != pending_startd_contacts_by_host.end() &&
+				host->second >= max_pending_startd_contacts_per_host )
+			{
+					// leave it queued until this machine answers
+				next++;
+				continue;
+			}
+		}
+		startdContactQueue.erase( startdContactQueue.begin() + next );
 		dprintf( D_FULLDEBUG, "In checkContactQueue(), args = %p, "
 				 "host=%s\n", args, args->sinful() ); 
 		contactStartd( args );
@@ -8645,6 +8856,8 @@ Scheduler::StartJob(match_rec *rec)
 
 		// Now that the shadow has spawned, consider this match "ACTIVE"
 	rec->setStatus( M_ACTIVE );
+	ClaimWentBusy( rec );
+	PrefetchNextJobForClaim( rec );
 }
 
 bool
@@ -8656,6 +8869,36 @@ Scheduler::FindRunnableJobForClaim(match_rec* mrec,bool accept_std_univ)
 	new_job_id.cluster = -1;
 	new_job_id.proc = -1;
 
+	if( mrec->m_prefetch_job.isValid() ) {
+			// A job was reserved for this claim while the previous
+			// job was running.  Use it if it is still good, otherwise
+			// fall back to searching the queue.
+		PROC_ID prefetched = mrec->m_prefetch_job;
+		bool lapsed = mrec->m_prefetch_deadline < time(NULL);
+		ClearPrefetchedJob( mrec );
+
+		JobQueueJob *job = GetJobAd( prefetched );
+		const char *reason = "job was removed";
+		if( !lapsed && job && mrec->my_match_ad && mrec->m_can_start_jobs &&
+			!ExitWhenDone && !mrec->m_now_job.isValid() &&
+			(accept_std_univ || job->Universe() != CONDOR_UNIVERSE_STANDARD) &&
+			Runnable( job, reason ) && !AlreadyMatched( &prefetched ) &&
+			jobCanUseMatch( job, mrec->my_match_ad, mrec->getPool(), reason ) )
+		{
+			stats.ClaimPrefetchHits += 1;
+			dprintf(D_ALWAYS,
+					"match (%s) switching to prefetched job %d.%d\n",
+					mrec->description(), prefetched.cluster, prefetched.proc );
+			SetMrecJobID(mrec,prefetched);
+			return true;
+		}
+		stats.ClaimPrefetchMisses += 1;
+		dprintf(D_FULLDEBUG,
+				"match (%s) not using prefetched job %d.%d (%s)\n",
+				mrec->description(), prefetched.cluster, prefetched.proc,
+				lapsed ? "reservation lapsed" : reason );
+	}
+
 	if( mrec->my_match_ad && mrec->m_can_start_jobs && !ExitWhenDone ) {
 		FindRunnableJob(new_job_id,mrec->my_match_ad,mrec->user);
 	}
@@ -9411,6 +9654,18 @@ Scheduler::isStillRunnable( int cluster, int proc, int &status )
 }
 
 
+	// Which multi-job shadows a job may share: a shadow runs as one
+	// user, so only those of jobs with the same Owner and NTDomain.
+static void
+getMultiJobShadowOwner( PROC_ID job_id, std::string &owner_key )
+{
+	std::string owner, domain;
+	GetAttributeString( job_id.cluster, job_id.proc, ATTR_OWNER, owner );
+	GetAttributeString( job_id.cluster, job_id.proc, ATTR_NT_DOMAIN, domain );
+	formatstr( owner_key, "%s@%s", owner.c_str(), domain.c_str() );
+}
+
+
 void
 Scheduler::spawnShadow( shadow_rec* srec )
 {
@@ -9427,6 +9682,7 @@ Scheduler::spawnShadow( shadow_rec* srec )
 
 	Shadow*	shadow_obj = NULL;
 	bool	sh_is_dc = FALSE;
+	bool	sh_multi_job = false;
 	char* 	shadow_path = NULL;
 	bool wants_reconnect = false;
 
@@ -9503,6 +9759,7 @@ Scheduler::spawnShadow( shadow_rec* srec )
 
 	sh_is_dc = shadow_obj->isDC();
 	bool sh_reads_file = shadow_obj->provides( ATTR_HAS_JOB_AD_FROM_FILE );
+	sh_multi_job = shadow_obj->provides( ATTR_HAS_MULTI_JOB );
 	shadow_path = strdup( shadow_obj->path() );
 
 	delete( shadow_obj );
@@ -9518,6 +9775,23 @@ Scheduler::spawnShadow( shadow_rec* srec )
 		return;
 	}
 
+		// Serial jobs may share a shadow process with other jobs, up
+		// to SHADOW_MAX_JOBS_PER_PROCESS.  Reconnect shadows always
+		// get a process of their own.
+	bool want_multi_job = sh_multi_job && sh_is_dc && sh_reads_file &&
+		!wants_reconnect && shadow_mgr.maxJobsPerShadow() > 1 &&
+		( universe == CONDOR_UNIVERSE_VANILLA ||
+		  universe == CONDOR_UNIVERSE_JAVA ||
+		  universe == CONDOR_UNIVERSE_VM ) &&
+		!IsLocalUniverse( srec );
+	MultiJobShadow *multi_job_shadow = NULL;
+	std::string multi_job_owner;
+	if( want_multi_job ) {
+		getMultiJobShadowOwner( *job_id, multi_job_owner );
+		multi_job_shadow = shadow_mgr.assignMultiJobShadow( multi_job_owner );
+		srec->multi_job_shadow = true;
+	}
+
 	args.AppendArg("condor_shadow");
 	if(sh_is_dc) {
 		args.AppendArg("-f");
@@ -9534,6 +9808,10 @@ Scheduler::spawnShadow( shadow_rec* srec )
 				args.AppendArg("--reconnect");
 			}
 
+			if( want_multi_job ) {
+				args.AppendArg("--multi-job");
+			}
+
 			// pass the public ip/port of the schedd (used w/ reconnect)
 			// We need this even if we are not currently in reconnect mode,
 			// because the shadow may go into reconnect mode at any time.
@@ -9578,8 +9856,17 @@ Scheduler::spawnShadow( shadow_rec* srec )
 	want_udp = false;
 #endif
 
-	rval = spawnJobHandlerRaw( srec, shadow_path, args, NULL, "shadow",
-							   sh_is_dc, sh_reads_file, want_udp );
+	int multi_job_pipe = -1;
+	if( multi_job_shadow ) {
+		rval = assignJobToMultiJobShadow( srec, multi_job_shadow );
+	} else {
+		rval = spawnJobHandlerRaw( srec, shadow_path, args, NULL, "shadow",
+								   sh_is_dc, sh_reads_file, want_udp,
+								   want_multi_job ? &multi_job_pipe : NULL );
+		if( rval && want_multi_job ) {
+			shadow_mgr.addMultiJobShadow( srec->pid, multi_job_pipe, multi_job_owner );
+		}
+	}
 
 	free( shadow_path );
 
@@ -9599,14 +9886,24 @@ Scheduler::spawnShadow( shadow_rec* srec )
 		return;
 	}
 
-	dprintf( D_ALWAYS, "Started shadow for job %d.%d on %s, "
-			 "(shadow pid = %d)\n", job_id->cluster, job_id->proc,
-			 mrec->description(), srec->pid );
+	if( multi_job_shadow ) {
+		dprintf( D_ALWAYS, "Handed job %d.%d on %s to running shadow "
+				 "(shadow pid = %d, %d jobs)\n", job_id->cluster, job_id->proc,
+				 mrec->description(), srec->pid,
+				 (int)multi_job_shadow->jobs.size() );
+	} else {
+		dprintf( D_ALWAYS, "Started shadow for job %d.%d on %s, "
+				 "(shadow pid = %d)\n", job_id->cluster, job_id->proc,
+				 mrec->description(), srec->pid );
+	}
 
     //time_t now = time(NULL);
     time_t now = stats.Tick();
-    stats.ShadowsStarted += 1;
+    if( !multi_job_shadow ) {
+        stats.ShadowsStarted += 1;
+    }
     stats.ShadowsRunning = numShadows;
+    stats.MultiJobShadowsRunning = shadow_mgr.numMultiJobShadows();
 
 	OtherPoolStats.Tick(now);
 
@@ -9695,11 +9992,86 @@ Scheduler::tryNextJob()
 }
 
 
+	// Write a job ad to a handler's stdin pipe.  If delimit is true,
+	// the ad is followed by the "***" line the shadow uses to tell
+	// one ad from the next, so more can follow on the same pipe.
+static bool
+writeJobAdToPipe( int pipe_end, ClassAd *job_ad, bool delimit )
+{
+	MyString ad_str;
+	sPrintAd(ad_str, *job_ad);
+	if( delimit ) {
+		ad_str += "***\n";
+	}
+	const char* ptr = ad_str.Value();
+	int len = ad_str.Length();
+	while (len) {
+		int bytes_written = daemonCore->Write_Pipe(pipe_end, ptr, len);
+		if (bytes_written == -1) {
+			dprintf(D_ALWAYS, "writeJobAd: Write_Pipe failed\n");
+			return false;
+		}
+		ptr += bytes_written;
+		len -= bytes_written;
+	}
+	return true;
+}
+
+
+bool
+Scheduler::assignJobToMultiJobShadow( shadow_rec* srec, MultiJobShadow* msh )
+{
+	PROC_ID* job_id = &srec->job_id;
+
+		// same bookkeeping as spawnJobHandlerRaw(), except that the
+		// job ad goes down the pipe of a shadow that is already running
+	srec->pid = 0;
+	add_shadow_rec( srec );
+	time_t now = stats.Tick();
+	stats.ShadowsRunning = numShadows;
+	OtherPoolStats.Tick(now);
+
+	ClassAd *job_ad = GetExpandedJobAd( *job_id, true );
+	if( ! job_ad ) {
+		if( ! GetJobAd(*job_id) ) {
+			EXCEPT( "Impossible: GetJobAd() returned NULL for %d.%d " 
+					"but that job is already known to exist",
+					job_id->cluster, job_id->proc );
+		}
+		dprintf( D_ALWAYS, "ERROR: Failed to get classad for job "
+				 "%d.%d, can't hand it to shadow pid %d, aborting\n", 
+				 job_id->cluster, job_id->proc, msh->pid );
+		return false;
+	}
+
+	if( ! writeJobAdToPipe( msh->pipe_fd, job_ad, true ) ) {
+		dprintf( D_ALWAYS, "ERROR: Failed to write job %d.%d to shadow "
+				 "pid %d, no longer using that shadow for new jobs\n",
+				 job_id->cluster, job_id->proc, msh->pid );
+		shadow_mgr.retireMultiJobShadow( msh );
+		delete job_ad;
+		return false;
+	}
+
+	srec->pid = msh->pid;
+	add_shadow_rec_pid( srec );
+
+	ClassAd *machine_ad = NULL;
+	if( srec->match ) {
+		machine_ad = srec->match->my_match_ad;
+	}
+	setNextJobDelay( job_ad, machine_ad );
+
+	delete job_ad;
+	return true;
+}
+
+
 bool
 Scheduler::spawnJobHandlerRaw( shadow_rec* srec, const char* path, 
 							   ArgList const &args, Env const *env, 
 							   const char* name, bool is_dc, bool wants_pipe,
-							   bool want_udp)
+							   bool want_udp, int *pipe_write_end)
 {
 	int pid = -1;
 	PROC_ID* job_id = &srec->job_id;
@@ -9882,19 +10254,7 @@ Scheduler::spawnJobHandlerRaw( shadow_rec* srec, const char* path,
 			// 2) dump out the job ad to the write end, since the
 			// handler is now alive and can read from the pipe.
 		ASSERT( job_ad );
-		MyString ad_str;
-		sPrintAd(ad_str, *job_ad);
-		const char* ptr = ad_str.Value();
-		int len = ad_str.Length();
-		while (len) {
-			int bytes_written = daemonCore->Write_Pipe(pipe_fds[1], ptr, len);
-			if (bytes_written == -1) {
-				dprintf(D_ALWAYS, "writeJobAd: Write_Pipe failed\n");
-				break;
-			}
-			ptr += bytes_written;
-			len -= bytes_written;
-		}
+		writeJobAdToPipe( pipe_fds[1], job_ad, pipe_write_end != NULL );
 
 			// TODO: if this is an MPI job, we should really write all
 			// the match info (ClaimIds, sinful strings and machine
@@ -9902,8 +10262,13 @@ Scheduler::spawnJobHandlerRaw( shadow_rec* srec, const char* path,
 			// performance optimization, not a correctness issue.
 
 			// Now that all the data is written to the pipe, we can
-			// safely close the other end, too.  
-		daemonCore->Close_Pipe(pipe_fds[1]);
+			// safely close the other end, too, unless the caller
+			// wants to hand the handler more job ads later.
+		if( pipe_write_end ) {
+			*pipe_write_end = pipe_fds[1];
+		} else {
+			daemonCore->Close_Pipe(pipe_fds[1]);
+		}
 	}
 
 	{
@@ -10687,8 +11052,13 @@ Scheduler::display_shadow_recs()
 	dprintf( D_FULLDEBUG, "\n");
 	dprintf( D_FULLDEBUG, "..................\n" );
 	dprintf( D_FULLDEBUG, ".. Shadow Recs (%d/%d)\n", numShadows, numMatches );
-	shadowsByPid->startIterations();
-	while (shadowsByPid->iterate(r) == 1) {
+		// shadowsByPid holds only one srec per pid, so go by job id
+		// to see every job in a multi-job shadow
+	shadowsByProcID->startIterations();
+	while (shadowsByProcID->iterate(r) == 1) {
+		if( !r->pid ) {
+			continue;
+		}
 
 		int cur_hosts=-1, status=-1;
 		GetAttributeInt(r->job_id.cluster, r->job_id.proc, ATTR_CURRENT_HOSTS, &cur_hosts);
@@ -10716,7 +11086,8 @@ shadow_rec::shadow_rec():
 	reconnect_succeeded(false),
 	keepClaimAttributes(false),
 	recycle_shadow_stream(NULL),
-	exit_already_handled(false)
+	exit_already_handled(false),
+	multi_job_shadow(false)
 {
 	prev_job_id.proc = -1;
 	prev_job_id.cluster = -1;
@@ -11002,7 +11373,11 @@ Scheduler::add_shadow_rec( shadow_rec* new_rec )
 		numShadows++;
 	}
 	if( new_rec->pid ) {
-		ASSERT( shadowsByPid->insert(new_rec->pid, new_rec) == 0 );
+		if( new_rec->multi_job_shadow ) {
+			shadow_mgr.addJob( new_rec->pid, new_rec->job_id );
+		} else {
+			ASSERT( shadowsByPid->insert(new_rec->pid, new_rec) == 0 );
+		}
 	}
 	ASSERT( shadowsByProcID->insert(new_rec->job_id, new_rec) == 0 );
 
@@ -11103,7 +11478,11 @@ Scheduler::add_shadow_rec_pid( shadow_rec* new_rec )
 	if( ! new_rec->pid ) {
 		EXCEPT( "add_shadow_rec_pid() called on an srec without a pid!" );
 	}
-	ASSERT( shadowsByPid->insert(new_rec->pid, new_rec) == 0 );
+	if( new_rec->multi_job_shadow ) {
+		shadow_mgr.addJob( new_rec->pid, new_rec->job_id );
+	} else {
+		ASSERT( shadowsByPid->insert(new_rec->pid, new_rec) == 0 );
+	}
 	dprintf( D_FULLDEBUG, "Added shadow record for PID %d, job (%d.%d)\n",
 			 new_rec->pid, new_rec->job_id.cluster, new_rec->job_id.proc );
 	//scheduler.display_shadow_recs();
@@ -11379,7 +11758,11 @@ Scheduler::delete_shadow_rec( shadow_rec *rec )
 	}
 
 	if( pid ) {
-		shadowsByPid->remove(pid);
+		if( rec->multi_job_shadow ) {
+			shadow_mgr.removeJob(pid, rec->job_id);
+		} else {
+			shadowsByPid->remove(pid);
+		}
 	}
 	shadowsByProcID->remove(rec->job_id);
 	if ( rec->conn_fd != -1 ) {
@@ -11578,8 +11961,13 @@ Scheduler::clean_shadow_recs()
 
 	dprintf( D_FULLDEBUG, "============ Begin clean_shadow_recs =============\n" );
 
-	shadowsByPid->startIterations();
-	while (shadowsByPid->iterate(rec) == 1) {
+		// go by job id, so that jobs in a multi-job shadow, which
+		// are not in shadowsByPid, are checked too
+	shadowsByProcID->startIterations();
+	while (shadowsByProcID->iterate(rec) == 1) {
+		if( !rec->pid ) {
+			continue;
+		}
 		if( !is_alive(rec) ) {
 			if ( rec->isZombie ) { // bad news...means we missed a reaper
 				dprintf( D_ALWAYS,
@@ -11608,7 +11996,7 @@ Scheduler::preempt( int n, bool force_sched_jobs )
 			 force_sched_jobs  ? " forcing scheduler/local univ preemptions" : "",
 			 ExitWhenDone ? " for a graceful shutdown" : "" );
 
-	shadowsByPid->startIterations();
+	shadowsByProcID->startIterations();
 
 	/* Now we loop until we are out of shadows or until we've preempted
 	 * `n' shadows.  Note that the behavior of this loop is slightly 
@@ -11617,8 +12005,9 @@ Scheduler::preempt( int n, bool force_sched_jobs )
 	 * ExitWhenDone is False, we will preempt n minus the number of shadows we
 	 * have previously told to preempt but are still waiting for them to exit.
 	 */
-	while (shadowsByPid->iterate(rec) == 1 && n > 0) {
-		if( is_alive(rec) ) {
+	while (shadowsByProcID->iterate(rec) == 1 && n > 0) {
+			// shadows that have not been spawned yet have no pid
+		if( rec->pid && is_alive(rec) ) {
 			if( rec->preempted ) {
 				if( ! ExitWhenDone ) {
 						// if we're not trying to exit, we should
@@ -11704,9 +12093,14 @@ Scheduler::preempt( int n, bool force_sched_jobs )
 					} else {
 							//
 							// Call the blocking form of Send_Signal, rather than
-							// sendSignalToShadow().
+							// sendSignalToShadow().  A shadow servicing
+							// several jobs only drops this one.
 							//
-						daemonCore->Send_Signal( rec->pid, SIGKILL );
+						if( rec->multi_job_shadow ) {
+							signalMultiJobShadow( rec, SIGKILL );
+						} else {
+							daemonCore->Send_Signal( rec->pid, SIGKILL );
+						}
 						dprintf( D_ALWAYS, 
 								"Sent signal %d to %s [pid %d] for job %d.%d\n",
 								SIGKILL, rec->match->peer, rec->pid, cluster, proc );
@@ -11963,7 +12357,40 @@ set_job_status(int cluster, int proc, int status)
 void
 Scheduler::child_exit(int pid, int status)
 {
-	shadow_rec*     srec;
+	MultiJobShadow *msh = shadow_mgr.findMultiJobShadow(pid);
+	if( msh ) {
+			// A shadow servicing several jobs exited.  Any jobs it
+			// had not yet reported on get the shadow's exit status,
+			// as the job of a single-job shadow would.
+		std::set<PROC_ID> jobs = msh->jobs;
+		shadow_mgr.retireMultiJobShadow(msh);
+		dprintf( D_FULLDEBUG, "Multi-job shadow pid %d exited with %d "
+				 "jobs outstanding\n", pid, (int)jobs.size() );
+
+		std::set<PROC_ID>::iterator it;
+		for( it = jobs.begin(); it != jobs.end(); it++ ) {
+			shadow_rec *srec = FindSrecByProcID(*it);
+			if( srec && srec->pid == pid ) {
+				shadow_exit(pid, status, srec);
+			}
+		}
+		shadow_mgr.removeMultiJobShadow(pid);
+		return;
+	}
+
+	shadow_rec *srec = FindSrecByPid(pid);
+	ASSERT(srec);
+	shadow_exit(pid, status, srec);
+}
+
+
+	// Handle the exit of the job behind srec, whose shadow (or local
+	// starter, or scheduler universe job) is pid.  For a multi-job
+	// shadow this is called once per job, when the shadow reports
+	// that job done or when the whole shadow exits.
+void
+Scheduler::shadow_exit(int pid, int status, shadow_rec *srec)
+{
 	int             StartJobsFlag=TRUE;
 	PROC_ID	        job_id;
 	bool            srec_was_local_universe = false;
@@ -11974,9 +12401,6 @@ Scheduler::child_exit(int pid, int status)
 	// AsyncXfer: Should this match be held idle waiting for a paired match?
 	bool            paired_match_wait = false;
 
-	srec = FindSrecByPid(pid);
-	ASSERT(srec);
-
 	if( srec->match ) {
 		match_rec *mrec = srec->match;
 
@@ -12043,7 +12467,7 @@ Scheduler::child_exit(int pid, int status)
  		// scheduler universe process
 		daemonCore->Kill_Family( pid );
 		scheduler_univ_job_exit(pid,status,srec);
-		delete_shadow_rec( pid );
+		delete_shadow_rec( srec );
 		// even though this will get set correctly in
 		// count_jobs(), try to keep it accurate here, too.
 		if( SchedUniverseJobsRunning > 0 ) {
@@ -12124,7 +12548,7 @@ Scheduler::child_exit(int pid, int status)
 
 		// We always want to delete the shadow record regardless
 		// of how the job exited
-		delete_shadow_rec( pid );
+		delete_shadow_rec( srec );
 
 	} else {
 		// Hmm -- doesn't seem like we can ever get here, given
@@ -13129,6 +13553,18 @@ Scheduler::Init()
 		// note: the special value 0 means 'unlimited'
 	max_pending_startd_contacts = param_integer( "MAX_PENDING_STARTD_CONTACTS", 0, 0 );
 
+		// Keep any one startd from holding all of the pending claim
+		// requests, so that claiming proceeds on other hosts while a
+		// slow startd works through its share.
+	max_pending_startd_contacts_per_host = param_integer( "MAX_PENDING_STARTD_CONTACTS_PER_HOST", 0, 0 );
+
+	double target_latency = param_double( "STARTD_CONTACT_TARGET_LATENCY", 0, 0 );
+	if( target_latency != startd_contact_target_latency ) {
+		adaptive_startd_contact_limit = 10;
+		last_startd_contact_backoff = 0;
+	}
+	startd_contact_target_latency = target_latency;
+
 
 #ifdef USE_VANILLA_START
 		// Start "vanilla" universe expression
@@ -13229,6 +13665,12 @@ Scheduler::Init()
 		launch_local_startd();
 	}
 
+	m_claim_prefetch = param_boolean("CLAIM_RECYCLING_PREFETCH", false);
+	m_claim_prefetch_lifetime = param_integer("CLAIM_RECYCLING_PREFETCH_LIFETIME", 60, 0);
+	if( !m_claim_prefetch || m_claim_prefetch_lifetime <= 0 ) {
+		m_claim_prefetch = false;
+	}
+
 	/* Initialize the hash tables to size MaxJobsRunning * 1.2 */
 		// Someday, we might want to actually resize these hashtables
 		// on reconfig if MaxJobsRunning changes size, but we don't
@@ -14201,6 +14643,14 @@ Scheduler::shutdown_fast()
 					rec->job_id.cluster, rec->job_id.proc );
 	}
 
+	std::vector<int> multi_job_pids;
+	shadow_mgr.getMultiJobShadowPids( multi_job_pids );
+	for( size_t i = 0; i < multi_job_pids.size(); i++ ) {
+		daemonCore->Send_Signal( multi_job_pids[i], SIGKILL );
+		dprintf( D_ALWAYS, "Sent signal %d to multi-job shadow [pid %d]\n",
+				 SIGKILL, multi_job_pids[i] );
+	}
+
 	// Shut down the cron logic
 	if( CronJobMgr ) {
 		CronJobMgr->Shutdown( true );
@@ -14570,6 +15020,8 @@ Scheduler::unlinkMrec(match_rec* match)
 	jobId.proc = match->proc;
 	matchesByJobID->remove(jobId);
 
+	ClearPrefetchedJob(match);
+
 		// fill any authorization hole we made for this match
 	if (match->auth_hole_id != NULL) {
 		IpVerify* ipv = daemonCore->getSecMan()->getIpVerify();
@@ -14663,12 +15115,126 @@ Scheduler::RemoveShadowRecFromMrec( shadow_rec* shadow )
 			// and set its status back to CLAIMED
 		SetMrecJobID(mrec,mrec->origcluster,-1);
 		mrec->setStatus( M_CLAIMED );
+		ClaimWentIdle( mrec );
 		if( mrec->is_dedicated ) {
 			deallocMatchRec( mrec );
 		}
 	}
 }
 
+/*
+ * With CLAIM_RECYCLING_PREFETCH enabled, choose the job that should
+ * run next on this claim while the current one is still running, so
+ * that when the current job exits the claim can be handed its next
+ * job without searching the queue on the critical path.  This only
+ * prefetches the selection: the job is activated on the claim by
+ * FindRunnableJobForClaim() once the current job exits, as usual.
+ * The chosen job is reserved (see AlreadyMatched()) until it is
+ * started or the reservation lapses after
+ * CLAIM_RECYCLING_PREFETCH_LIFETIME seconds.
+ */
+void
+Scheduler::PrefetchNextJobForClaim( match_rec *mrec )
+{
+	if( !m_claim_prefetch || !mrec || mrec->is_dedicated ) {
+		return;
+	}
+	if( !mrec->my_match_ad || !mrec->m_can_start_jobs || ExitWhenDone ||
+		mrec->m_paired_mrec || mrec->m_now_job.isValid() ||
+		mrec->m_prefetch_job.isValid() )
+	{
+		return;
+	}
+
+	PROC_ID next_job_id;
+	next_job_id.cluster = -1;
+	next_job_id.proc = -1;
+	FindRunnableJob( next_job_id, mrec->my_match_ad, mrec->user );
+	if( next_job_id.proc == -1 ) {
+		return;
+	}
+
+		// Only shadows that can be recycled will ask for the
+		// next job, and those cannot run the standard universe.
+	JobQueueJob *job = GetJobAd( next_job_id );
+	if( !job || job->Universe() == CONDOR_UNIVERSE_STANDARD ) {
+		return;
+	}
+
+	mrec->m_prefetch_job = next_job_id;
+	mrec->m_prefetch_deadline = time(NULL) + m_claim_prefetch_lifetime;
+	m_prefetchedJobs[next_job_id] = mrec;
+
+	dprintf( D_FULLDEBUG, "match (%s) prefetched job %d.%d to run next\n",
+			 mrec->description(), next_job_id.cluster, next_job_id.proc );
+}
+
+void
+Scheduler::ClearPrefetchedJob( match_rec *mrec )
+{
+	if( !mrec->m_prefetch_job.isValid() ) {
+		return;
+	}
+	std::map<PROC_ID, match_rec *>::iterator it =
+		m_prefetchedJobs.find( mrec->m_prefetch_job );
+	if( it != m_prefetchedJobs.end() && it->second == mrec ) {
+		m_prefetchedJobs.erase( it );
+	}
+	mrec->m_prefetch_job.invalidate();
+	mrec->m_prefetch_deadline = 0;
+}
+
+bool
+Scheduler::IsPrefetchedJob( PROC_ID job_id )
+{
+	if( m_prefetchedJobs.empty() ) {
+		return false;
+	}
+	std::map<PROC_ID, match_rec *>::iterator it =
+		m_prefetchedJobs.find( job_id );
+	if( it == m_prefetchedJobs.end() ) {
+		return false;
+	}
+	match_rec *mrec = it->second;
+	if( mrec->m_prefetch_deadline < time(NULL) ) {
+			// The reservation lapsed; let anyone have this job.
+		dprintf( D_FULLDEBUG,
+				 "match (%s) reservation of job %d.%d lapsed\n",
+				 mrec->description(), job_id.cluster, job_id.proc );
+		stats.ClaimPrefetchMisses += 1;
+		ClearPrefetchedJob( mrec );
+		return false;
+	}
+	return true;
+}
+
+void
+Scheduler::ClaimWentIdle( match_rec *mrec )
+{
+	if( mrec->m_idle_since == 0 ) {
+		mrec->m_idle_since = time(NULL);
+	}
+}
+
+void
+Scheduler::ClaimWentBusy( match_rec *mrec )
+{
+	if( mrec->m_idle_since == 0 ) {
+			// first job on this claim
+		return;
+	}
+	time_t now = stats.Tick();
+	time_t idle_time = now - mrec->m_idle_since;
+	if( idle_time < 0 ) {
+		idle_time = 0;
+	}
+	mrec->m_idle_since = 0;
+
+	stats.ClaimsReused += 1;
+	stats.ClaimsAccumIdleTime += idle_time;
+	OtherPoolStats.Tick(now);
+}
+
 int Scheduler::AlreadyMatched(JobQueueJob * job, int universe)
 {
 	bool wantPS = 0;
@@ -14692,6 +15258,10 @@ int Scheduler::AlreadyMatched(JobQueueJob * job, int universe)
 			// if the match was deleted but the shadow has not yet gone away.
 		return TRUE;
 	}
+	if( IsPrefetchedJob(job->jid) ) {
+			// This job is reserved to run next on a busy claim.
+		return TRUE;
+	}
 	return FALSE;
 
 }
@@ -15070,7 +15640,11 @@ Scheduler::sendAlives()
 				DelMrec( mrec );
 				jobExitCode( srec->job_id, JOB_RECONNECT_FAILED );
 				srec->exit_already_handled = true;
-				daemonCore->Send_Signal( srec->pid, SIGKILL );
+				if( srec->multi_job_shadow ) {
+					signalMultiJobShadow( srec, SIGKILL );
+				} else {
+					daemonCore->Send_Signal( srec->pid, SIGKILL );
+				}
 			}
 		}
 	}
@@ -16841,6 +17415,18 @@ private:
 void
 Scheduler::sendSignalToShadow(pid_t pid,int sig,PROC_ID proc)
 {
+		// A shadow servicing several jobs gets the signal for one
+		// of them down its job pipe instead.
+	shadow_rec *srec = FindSrecByProcID( proc );
+	if( srec && srec->multi_job_shadow && srec->pid == pid ) {
+		if( !signalMultiJobShadow( srec, sig ) ) {
+			dprintf( D_ALWAYS, "Failed to send signal %d for job %d.%d "
+					 "to multi-job shadow pid %d\n",
+					 sig, proc.cluster, proc.proc, pid );
+		}
+		return;
+	}
+
 	classy_counted_ptr<DCShadowKillMsg> msg = new DCShadowKillMsg(pid,sig,proc);
 	daemonCore->Send_Signal_nonblocking(msg.get());
 
@@ -16848,6 +17434,63 @@ Scheduler::sendSignalToShadow(pid_t pid,int sig,PROC_ID proc)
 		// will take care of setting shadow_rec->preempted = TRUE.
 }
 
+bool
+Scheduler::signalMultiJobShadow(shadow_rec *srec, int sig)
+{
+	MultiJobShadow *msh = shadow_mgr.findMultiJobShadow( srec->pid );
+	if( !msh || msh->pipe_fd == -1 ) {
+		return false;
+	}
+
+	ClassAd signal_ad;
+	signal_ad.Assign( ATTR_CLUSTER_ID, srec->job_id.cluster );
+	signal_ad.Assign( ATTR_PROC_ID, srec->job_id.proc );
+	signal_ad.Assign( ATTR_SHADOW_SIGNAL, sig );
+	if( !writeJobAdToPipe( msh->pipe_fd, &signal_ad, true ) ) {
+		return false;
+	}
+
+		// same as DCShadowKillMsg::messageSent()
+	switch( sig ) {
+	case DC_SIGSUSPEND:
+	case DC_SIGCONTINUE:
+		break;
+	default:
+		srec->preempt_pending = false;
+		srec->preempted = true;
+	}
+
+		// The shadow drops a SIGKILLed job without telling us, and
+		// no reaper will fire for it, so clean up the srec ourselves.
+		// Do it from a timer, since our callers still use the srec.
+	if( sig == SIGKILL ) {
+		m_killedMultiJobShadowJobs.push_back( std::make_pair( srec->pid, srec->job_id ) );
+		if( m_killedMultiJobShadowJobsTid == -1 ) {
+			m_killedMultiJobShadowJobsTid = daemonCore->Register_Timer( 0,
+				(TimerHandlercpp)&Scheduler::reapKilledMultiJobShadowJobs,
+				"Scheduler::reapKilledMultiJobShadowJobs", this );
+		}
+	}
+	return true;
+}
+
+void
+Scheduler::reapKilledMultiJobShadowJobs()
+{
+	m_killedMultiJobShadowJobsTid = -1;
+
+	std::vector< std::pair<int,PROC_ID> > killed;
+	killed.swap( m_killedMultiJobShadowJobs );
+
+	std::vector< std::pair<int,PROC_ID> >::iterator it;
+	for( it = killed.begin(); it != killed.end(); it++ ) {
+		shadow_rec *srec = FindSrecByProcID( it->second );
+		if( srec && srec->pid == it->first ) {
+			shadow_exit( it->first, SIGKILL, srec );
+		}
+	}
+}
+
 static
 void
 WriteCompletionVisa(ClassAd* ad)
@@ -16914,23 +17557,62 @@ Scheduler::RecycleShadow(int /*cmd*/, Stream *stream)
 
 	stream->decode();
 	if( !stream->get( shadow_pid ) ||
-		!stream->get( previous_job_exit_reason ) ||
-		!stream->end_of_message() )
+		!stream->get( previous_job_exit_reason ) )
 	{
 		dprintf(D_ALWAYS,
 			"recycleShadow() failed to receive job exit reason from shadow\n");
 		return FALSE;
 	}
 
-	srec = FindSrecByPid( shadow_pid );
+		// A multi-job shadow also says which of its jobs exited and
+		// whether it wants another job in that job's place.  It does
+		// not exit afterwards, so whatever we would do in child_exit()
+		// for that job must happen here.
+	bool multi_job = shadow_mgr.findMultiJobShadow( shadow_pid ) != NULL;
+	int want_job = 1;
+	PROC_ID multi_job_id;
+	if( multi_job ) {
+		if( !stream->get( multi_job_id.cluster ) ||
+			!stream->get( multi_job_id.proc ) ||
+			!stream->get( want_job ) )
+		{
+			dprintf(D_ALWAYS,
+				"recycleShadow() failed to receive job id from multi-job shadow %d\n",
+				shadow_pid);
+			return FALSE;
+		}
+	}
+	if( !stream->end_of_message() ) {
+		dprintf(D_ALWAYS,
+			"recycleShadow() failed to receive job exit reason from shadow\n");
+		return FALSE;
+	}
+
+	if( multi_job ) {
+		srec = FindSrecByProcID( multi_job_id );
+		if( srec && srec->pid != shadow_pid ) {
+			srec = NULL;
+		}
+	} else {
+		srec = FindSrecByPid( shadow_pid );
+	}
 	if( !srec ) {
 		dprintf(D_ALWAYS,"recycleShadow() called with unknown shadow pid %d\n",
 				shadow_pid);
+		if( multi_job ) {
+			stream->encode();
+			stream->put((int)0);
+			stream->end_of_message();
+		}
 		return FALSE;
 	}
 	prev_job_id = srec->job_id;
 	mrec = srec->match;
 
+		// Exit status as the reaper would have seen it, had this job's
+		// shadow exited with previous_job_exit_reason.
+	int multi_job_exit_status = (previous_job_exit_reason & 0xff) << 8;
+
 		// currently we only support serial jobs here
 	if( !mrec || !mrec->user || srec->preempted || srec->preempt_pending ||
 		(srec->universe != CONDOR_UNIVERSE_VANILLA &&
@@ -16940,16 +17622,22 @@ Scheduler::RecycleShadow(int /*cmd*/, Stream *stream)
 		stream->encode();
 		stream->put((int)0);
 		stream->end_of_message();
+		if( multi_job ) {
+			shadow_exit( shadow_pid, multi_job_exit_status, srec );
+		}
 		return FALSE;
 	}
 
 		// If this match is earmarked for high-priority job, don't reuse
 		// the shadow.  It's possible that we could, but for now, keep
 		// things simple and only spawn the high-priority job in child_exit().
-	if( mrec->m_now_job.isValid() ) {
+	if( mrec->m_now_job.isValid() || !want_job ) {
 		stream->encode();
 		stream->put((int)0);
 		stream->end_of_message();
+		if( multi_job ) {
+			shadow_exit( shadow_pid, multi_job_exit_status, srec );
+		}
 		return FALSE;
 	}
 
@@ -16982,6 +17670,7 @@ Scheduler::RecycleShadow(int /*cmd*/, Stream *stream)
 		jobExitCode( prev_job_id, previous_job_exit_reason );
 		srec->exit_already_handled = true;
 	}
+	ClaimWentIdle( mrec );
 
 		// The standard universe shadow never calls this function,
 		// and the shadow that does call this function is not capable of
@@ -17001,12 +17690,36 @@ Scheduler::RecycleShadow(int /*cmd*/, Stream *stream)
 		stream->encode();
 		stream->put((int)0);
 		stream->end_of_message();
+		if( multi_job ) {
+			shadow_exit( shadow_pid, multi_job_exit_status, srec );
+		}
 		return TRUE;
 	}
 
 	new_job_id.cluster = mrec->cluster;
 	new_job_id.proc = mrec->proc;
 
+		// A multi-job shadow only takes jobs of the owner it runs as.
+		// A job of another owner under the same submitter gets a
+		// shadow of its own on this claim.
+	if( multi_job ) {
+		std::string owner_key;
+		getMultiJobShadowOwner( new_job_id, owner_key );
+		MultiJobShadow *msh = shadow_mgr.findMultiJobShadow( shadow_pid );
+		if( !msh || msh->owner != owner_key ) {
+			dprintf(D_FULLDEBUG,
+				"Job %d.%d is not owned by %s; starting it in another shadow.\n",
+				new_job_id.cluster, new_job_id.proc,
+				msh ? msh->owner.c_str() : "(unknown)");
+			stream->encode();
+			stream->put((int)0);
+			stream->end_of_message();
+			delete_shadow_rec( srec );
+			StartJob( mrec, &new_job_id );
+			return TRUE;
+		}
+	}
+
 	dprintf(D_ALWAYS,
 			"Shadow pid %d switching to job %d.%d.\n",
 			shadow_pid, new_job_id.cluster, new_job_id.proc );
@@ -17017,11 +17730,16 @@ Scheduler::RecycleShadow(int /*cmd*/, Stream *stream)
 	OtherPoolStats.Tick(now);
 
 		// the add/delete_shadow_rec() functions update the job
-		// ads, so we need to do that here
+		// ads, so we need to do that here.  Record the new job with
+		// a multi-job shadow first, so it is never seen idle.
+	if( multi_job ) {
+		shadow_mgr.addJob( shadow_pid, new_job_id );
+	}
 	delete_shadow_rec( srec );
 	SetMrecJobID(mrec,new_job_id);
 	srec = new shadow_rec;
 	srec->pid = shadow_pid;
+	srec->multi_job_shadow = multi_job;
 	srec->match = mrec;
 	mrec->shadowRec = srec;
 	srec->job_id = new_job_id;
@@ -17032,6 +17750,8 @@ Scheduler::RecycleShadow(int /*cmd*/, Stream *stream)
 	mark_serial_job_running(&new_job_id);
 
 	mrec->setStatus( M_ACTIVE );
+	ClaimWentBusy( mrec );
+	PrefetchNextJobForClaim( mrec );
 
 	callAboutToSpawnJobHandler(new_job_id.cluster, new_job_id.proc, srec);
 	return KEEP_STREAM;
@@ -17096,6 +17816,12 @@ Scheduler::finishRecycleShadow(shadow_rec *srec)
 
 	delete new_ad;
 	delete stream;
+
+		// A multi-job shadow that failed to take the new job will
+		// not exit, so nothing else will clean up after it.
+	if( srec->multi_job_shadow && srec->exit_already_handled ) {
+		shadow_exit( shadow_pid, JOB_SHOULD_REQUEUE << 8, srec );
+	}
 }
 
 int
@@ -192,8 +192,19 @@ void ScheddStatistics::InitMain()
    SCHEDD_STATS_ADD_RECENT(Pool, ShadowsRecycled,           IF_VERBOSEPUB);
    SCHEDD_STATS_ADD_RECENT(Pool, ShadowsReconnections,      IF_VERBOSEPUB);
 
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimsReused,              IF_VERBOSEPUB);
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimsAccumIdleTime,       IF_VERBOSEPUB);
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimPrefetchHits,         IF_VERBOSEPUB | IF_NONZERO);
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimPrefetchMisses,       IF_VERBOSEPUB | IF_NONZERO);
+
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimRequestsSent,         IF_BASICPUB);
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimRequestsSucceeded,    IF_BASICPUB);
+   SCHEDD_STATS_ADD_RECENT(Pool, ClaimRequestsFailed,       IF_BASICPUB);
+   Pool.AddProbe("ClaimRequestLatency", &ClaimRequestLatency, NULL, IF_VERBOSEPUB | ProbeDetailMode_Brief | ClaimRequestLatency.PubValueAndRecent);
+
    SCHEDD_STATS_ADD_VAL(Pool, ShadowsRunning,               IF_BASICPUB);
    SCHEDD_STATS_PUB_PEAK(Pool, ShadowsRunning,              IF_BASICPUB);
+   SCHEDD_STATS_ADD_VAL(Pool, MultiJobShadowsRunning,       IF_VERBOSEPUB | IF_NONZERO);
 
    SCHEDD_STATS_ADD_VAL(Pool, JobsRestartReconnectsFailed, IF_BASICPUB);
    SCHEDD_STATS_ADD_VAL(Pool, JobsRestartReconnectsLeaseExpired, IF_BASICPUB);
@@ -130,6 +130,19 @@ typedef struct ScheddStatistics : public ScheddJobCounters {
    stats_entry_recent<int> ShadowsRecycled;      // number of times shadows have been recycled
    //stats_entry_recent<int> ShadowExceptions;     // number of times shadows have excepted
    stats_entry_recent<int> ShadowsReconnections; // number of times shadows have reconnected
+   stats_entry_abs<int> MultiJobShadowsRunning;  // current number of shadow processes servicing several jobs
+
+   // claim reuse
+   stats_entry_recent<int> ClaimsReused;           // number of times a claim was handed another job
+   stats_entry_recent<time_t> ClaimsAccumIdleTime; // sum of time claims sat idle between jobs
+   stats_entry_recent<int> ClaimPrefetchHits;      // prefetched jobs that were started on their claim
+   stats_entry_recent<int> ClaimPrefetchMisses;    // prefetched jobs that were no longer runnable or had lapsed
+
+   // claim requests to startds
+   stats_entry_recent<int> ClaimRequestsSent;       // REQUEST_CLAIM messages sent to startds
+   stats_entry_recent<int> ClaimRequestsSucceeded;  // claim requests that the startd accepted
+   stats_entry_recent<int> ClaimRequestsFailed;     // claim requests that were refused, failed or canceled
+   stats_entry_recent<Probe> ClaimRequestLatency;   // seconds between sending a claim request and getting the reply
 
 
    // non-published values
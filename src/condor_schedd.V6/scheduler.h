@@ -34,6 +34,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <queue>
+#include <deque>
 
 #include "dc_collector.h"
 #include "daemon.h"
@@ -138,6 +139,9 @@ struct shadow_rec
 	PROC_ID			prev_job_id;
 	Stream*			recycle_shadow_stream;
 	bool			exit_already_handled;
+		// the shadow process (pid) also services other jobs; this
+		// srec is tracked by ShadowMgr rather than shadowsByPid
+	bool			multi_job_shadow;
 
 	shadow_rec();
 	~shadow_rec();
@@ -337,6 +341,16 @@ class match_rec: public ClaimIdParser
 	int keep_while_idle; // number of seconds to hold onto an idle claim
 	int idle_timer_deadline; // if the above is nonzero, abstime to hold claim
 
+		// With CLAIM_RECYCLING_PREFETCH, the job chosen to run next on
+		// this claim while the current job is still running, and the
+		// abstime at which that reservation lapses.
+	PROC_ID m_prefetch_job;
+	time_t m_prefetch_deadline;
+
+		// abstime at which the previous job on this claim exited,
+		// or 0 if the claim is busy or has never run a job.
+	time_t m_idle_since;
+
 		// Set the mrec status to the given value (also updates
 		// entered_current_status)
 	void	setStatus( int stat );
@@ -631,7 +645,13 @@ class Scheduler : public Service
 	shadow_rec*		FindSrecByPid(int);
 	shadow_rec*		FindSrecByProcID(PROC_ID);
 	void			RemoveShadowRecFromMrec(shadow_rec*);
+	void			PrefetchNextJobForClaim(match_rec *mrec);
+	void			ClearPrefetchedJob(match_rec *mrec);
+	bool			IsPrefetchedJob(PROC_ID job_id);
+	void			ClaimWentIdle(match_rec *mrec);
+	void			ClaimWentBusy(match_rec *mrec);
 	void            sendSignalToShadow(pid_t pid,int sig,PROC_ID proc);
+	bool			signalMultiJobShadow(shadow_rec *srec, int sig);
 	int				AlreadyMatched(PROC_ID*);
 	int				AlreadyMatched(JobQueueJob * job, int universe);
 	void			ExpediteStartJobs();
@@ -937,10 +957,31 @@ private:
 
 		// Here we enqueue calls to 'contactStartd' when we can't just 
 		// call it any more.  See contactStartd and the call to it...
-	std::queue<ContactStartdArgs*> startdContactQueue;
+	std::deque<ContactStartdArgs*> startdContactQueue;
 	int				checkContactQueue_tid;	// DC Timer ID to check queue
 	int num_pending_startd_contacts;
 	int max_pending_startd_contacts;
+	int max_pending_startd_contacts_per_host;
+
+		// Claim requests that are waiting for a reply from the startd,
+		// keyed by their callback, so that we can time them and know
+		// how many are outstanding to each machine.
+	struct PendingStartdContact {
+		std::string host;
+		double start;
+	};
+	std::map<DCMsgCallback*, PendingStartdContact> pending_startd_contacts;
+	std::map<std::string, int> pending_startd_contacts_by_host;
+
+		// When STARTD_CONTACT_TARGET_LATENCY is set, the number of
+		// concurrent claim requests adapts to the observed latency:
+		// it grows while replies come back faster than the target
+		// and is halved when they do not.
+	double startd_contact_target_latency;
+	double adaptive_startd_contact_limit;
+	double last_startd_contact_backoff;
+	int startdContactLimit() const;
+	void startdContactFinished( DCMsgCallback *cb, bool success );
 
 		// If we we need to reconnect to disconnected starters, we
 		// stash the proc IDs in here while we read through the job
@@ -1014,6 +1055,7 @@ private:
 	OwnerInfo * get_ownerinfo(JobQueueJob * job);
 	void		remove_unused_owners();
 	void			child_exit(int, int);
+	void			shadow_exit(int pid, int status, shadow_rec *srec);
 	// AFAICT, reapers should be be registered void to begin with.
 	int				child_exit_from_reaper(int a, int b) { child_exit(a, b); return 0; }
 	void			scheduler_univ_job_exit(int pid, int status, shadow_rec * srec);
@@ -1071,6 +1113,8 @@ private:
 		 */
 	void	contactStartd( ContactStartdArgs* args );
 	void claimedStartd( DCMsgCallback *cb );
+		// Find a job for an extra dynamic slot claimed along with match.
+	void claimedExtraSlot( match_rec *match, char const *claim_id, ClassAd *slot_ad );
 
 	shadow_rec*		StartJob(match_rec*, PROC_ID*);
 
@@ -1080,7 +1124,11 @@ private:
 										ArgList const &args,
 										Env const *env, 
 										const char* name, bool is_dc,
-										bool wants_pipe, bool want_udp );
+										bool wants_pipe, bool want_udp,
+										int *pipe_write_end = NULL );
+	bool			assignJobToMultiJobShadow( shadow_rec* srec,
+											   MultiJobShadow* msh );
+	void			reapKilledMultiJobShadowJobs();
 	void			check_zombie(int, PROC_ID*);
 	void			kill_zombie(int, PROC_ID*);
 	int				is_alive(shadow_rec* srec);
@@ -1093,6 +1141,10 @@ private:
 	HashTable <PROC_ID, match_rec *> *matchesByJobID;
 	HashTable <int, shadow_rec *> *shadowsByPid;
 	HashTable <PROC_ID, shadow_rec *> *shadowsByProcID;
+		// jobs SIGKILLed inside a multi-job shadow, whose srecs are
+		// cleaned up from a timer since no reaper will fire for them
+	std::vector< std::pair<int,PROC_ID> > m_killedMultiJobShadowJobs;
+	int				m_killedMultiJobShadowJobsTid;
 	HashTable <int, ExtArray<PROC_ID> *> *spoolJobFileWorkers;
 	int				numMatches;
 	int				numShadows;
@@ -1148,6 +1200,12 @@ private:
 
 	bool m_use_startd_for_local;
 	int m_local_startd_pid;
+
+		// Jobs selected ahead of time to run next on a busy claim,
+		// see PrefetchNextJobForClaim().
+	bool m_claim_prefetch;
+	int m_claim_prefetch_lifetime;
+	std::map<PROC_ID, match_rec *> m_prefetchedJobs;
 	std::map<std::string, ClassAd *> m_unclaimedLocalStartds;
 	std::map<std::string, ClassAd *> m_claimedLocalStartds;
 
@@ -26,6 +26,7 @@
 #include "condor_config.h"
 #include "classad_merge.h"
 #include "my_popen.h"
+#include "condor_daemon_core.h"
 
 /*
 
@@ -164,6 +165,8 @@ Shadow::builtSinceVersion(int major, int minor, int sub_minor) {
 
 ShadowMgr::ShadowMgr()
 {
+	m_max_jobs_per_shadow = 1;
+	m_multi_job_shadow_worklife = 0;
 }
 
 
@@ -233,6 +236,9 @@ ShadowMgr::init( void )
 		checked_shadow_list.append( shadow_path );
 		free( shadow_path );
 	}
+
+	m_max_jobs_per_shadow = param_integer( "SHADOW_MAX_JOBS_PER_PROCESS", 1, 1 );
+	m_multi_job_shadow_worklife = param_integer( "SHADOW_WORKLIFE", 3600 );
 }
 
 
@@ -267,7 +273,7 @@ Shadow*
 ShadowMgr::makeShadow( const char* path )
 {
 	Shadow* new_shadow;
-	FILE* fp;
+	FILE* fp;
 	const char *args[] = {path, "-classad", NULL};
 	char buf[1024];
 
@@ -302,3 +308,125 @@ ShadowMgr::makeShadow( const char* path )
 	return new_shadow;
 }
 
+
+
+MultiJobShadow*
+ShadowMgr::assignMultiJobShadow( const std::string &owner )
+{
+	MultiJobShadow* best = NULL;
+	time_t now = time(NULL);
+
+	std::map<int,MultiJobShadow>::iterator it;
+	for( it = m_multi_job_shadows.begin(); it != m_multi_job_shadows.end(); it++ ) {
+		MultiJobShadow* msh = &it->second;
+		if( !msh->accepting || msh->pipe_fd == -1 || msh->owner != owner ) {
+			continue;
+		}
+			// Stop handing out work to a shadow once it has lived
+			// past SHADOW_WORKLIFE; it exits after its last job.
+		if( m_multi_job_shadow_worklife >= 0 &&
+			now > msh->birth + m_multi_job_shadow_worklife )
+		{
+			retireMultiJobShadow( msh );
+			continue;
+		}
+		if( (int)msh->jobs.size() >= m_max_jobs_per_shadow ) {
+			continue;
+		}
+		if( !best || msh->jobs.size() > best->jobs.size() ) {
+			best = msh;
+		}
+	}
+	return best;
+}
+
+
+MultiJobShadow*
+ShadowMgr::findMultiJobShadow( int pid )
+{
+	std::map<int,MultiJobShadow>::iterator it = m_multi_job_shadows.find( pid );
+	if( it == m_multi_job_shadows.end() ) {
+		return NULL;
+	}
+	return &it->second;
+}
+
+
+void
+ShadowMgr::addMultiJobShadow( int pid, int pipe_fd, const std::string &owner )
+{
+	MultiJobShadow* msh = findMultiJobShadow( pid );
+	if( !msh ) {
+		msh = &m_multi_job_shadows[pid];
+		msh->pid = pid;
+		msh->birth = time(NULL);
+		msh->accepting = true;
+	}
+	msh->pipe_fd = pipe_fd;
+	msh->owner = owner;
+}
+
+
+void
+ShadowMgr::addJob( int pid, PROC_ID job_id )
+{
+		// The first job is recorded as soon as the shadow is spawned,
+		// before the schedd has handed us the shadow's pipe.
+	MultiJobShadow* msh = findMultiJobShadow( pid );
+	if( !msh ) {
+		addMultiJobShadow( pid, -1, "" );
+		msh = findMultiJobShadow( pid );
+	}
+	msh->jobs.insert( job_id );
+}
+
+
+void
+ShadowMgr::removeJob( int pid, PROC_ID job_id )
+{
+	MultiJobShadow* msh = findMultiJobShadow( pid );
+	if( !msh ) {
+		return;
+	}
+	msh->jobs.erase( job_id );
+	if( msh->jobs.empty() ) {
+		retireMultiJobShadow( msh );
+	}
+}
+
+
+void
+ShadowMgr::retireMultiJobShadow( MultiJobShadow* msh )
+{
+	msh->accepting = false;
+	if( msh->jobs.empty() && msh->pipe_fd != -1 ) {
+		dprintf( D_FULLDEBUG, "Closing job pipe to idle multi-job shadow "
+				 "pid %d\n", msh->pid );
+		daemonCore->Close_Pipe( msh->pipe_fd );
+		msh->pipe_fd = -1;
+	}
+}
+
+
+void
+ShadowMgr::removeMultiJobShadow( int pid )
+{
+	MultiJobShadow* msh = findMultiJobShadow( pid );
+	if( !msh ) {
+		return;
+	}
+	if( msh->pipe_fd != -1 ) {
+		daemonCore->Close_Pipe( msh->pipe_fd );
+	}
+	m_multi_job_shadows.erase( pid );
+}
+
+
+void
+ShadowMgr::getMultiJobShadowPids( std::vector<int> &pids )
+{
+	std::map<int,MultiJobShadow>::iterator it;
+	for( it = m_multi_job_shadows.begin(); it != m_multi_job_shadows.end(); it++ ) {
+		pids.push_back( it->first );
+	}
+}
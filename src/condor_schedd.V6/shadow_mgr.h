@@ -48,6 +48,11 @@
 #include "condor_classad.h"
 #include "simplelist.h"
 #include "condor_ver_info.h"
+#include "proc.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 
 class Shadow {
@@ -73,6 +78,23 @@ private:
 };
 
 
+/*
+  A running shadow process that services more than one job.  The
+  schedd keeps the write end of the shadow's stdin pipe open and
+  hands it further job ads (and per-job signals) over that pipe.
+  User ids are process-wide, so a shadow only ever services jobs
+  of the one owner.
+*/
+struct MultiJobShadow {
+	int pid;
+	int pipe_fd;		// write end of the shadow's stdin, -1 once closed
+	std::string owner;	// Owner@NTDomain of the jobs it services
+	time_t birth;
+	bool accepting;		// false once retired; no new jobs are assigned
+	std::set<PROC_ID> jobs;
+};
+
+
 class ShadowMgr {
 public:
 	ShadowMgr();
@@ -84,12 +106,37 @@ public:
 
 	void printShadowInfo( int debug_level );
 
+		// How many jobs a single shadow process may service
+		// (SHADOW_MAX_JOBS_PER_PROCESS).  1 means one shadow per job.
+	int maxJobsPerShadow( void ) const { return m_max_jobs_per_shadow; };
+
+		// Pick a running multi-job shadow of the given owner with
+		// room for one more job, preferring the fullest one so idle
+		// shadows drain and exit.  Returns NULL if a new shadow
+		// should be spawned.
+	MultiJobShadow* assignMultiJobShadow( const std::string &owner );
+
+	MultiJobShadow* findMultiJobShadow( int pid );
+	void addMultiJobShadow( int pid, int pipe_fd, const std::string &owner );
+	void addJob( int pid, PROC_ID job_id );
+		// Closes the shadow's pipe once its last job is gone, which
+		// tells the shadow to exit.
+	void removeJob( int pid, PROC_ID job_id );
+	void retireMultiJobShadow( MultiJobShadow* msh );
+	void removeMultiJobShadow( int pid );
+	void getMultiJobShadowPids( std::vector<int> &pids );
+	int numMultiJobShadows( void ) const { return (int)m_multi_job_shadows.size(); };
+
 private:
 
 	Shadow* makeShadow( const char* path );
 
 	SimpleList<Shadow*> shadows;
 
+	int m_max_jobs_per_shadow;
+	int m_multi_job_shadow_worklife;
+	std::map<int,MultiJobShadow> m_multi_job_shadows;
+
         // This makes this class un-copy-able:
     ShadowMgr( const ShadowMgr& );
     ShadowMgr& operator = ( const ShadowMgr& );
@@ -28,16 +28,19 @@
 #include "condor_email.h"
 #include "algorithm"
 
-TransferQueueRequest::TransferQueueRequest(ReliSock *sock,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,bool downloading,time_t max_queue_age):
+TransferQueueRequest::TransferQueueRequest(ReliSock *sock,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,char const *peer,bool downloading,time_t max_queue_age):
 	m_sock(sock),
 	m_queue_user(queue_user),
 	m_jobid(jobid),
 	m_sandbox_size_MB(sandbox_size/1024.0/1024.0),
 	m_fname(fname),
 	m_downloading(downloading),
+	m_peer(peer),
+	m_bytes_rate(-1),
 	m_max_queue_age(max_queue_age)
 {
 	m_gave_go_ahead = false;
+	m_small_sandbox_slot = false;
 	m_notified_about_taking_too_long = false;
 	m_time_born = time(NULL);
 	m_time_go_ahead = 0;
@@ -139,6 +142,11 @@ TransferQueueManager::TransferQueueManager() {
 	m_update_iostats_interval = 0;
 	m_update_iostats_timer = -1;
 	m_publish_flags = 0;
+	m_throttle_throughput = false;
+	m_throughput_min_gain = 0.05;
+	m_throughput_increment_wait = 60;
+	m_small_sandbox_MB = 0;
+	m_small_sandbox_slots = 0;
 
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_MAX_UPLOADING,&m_max_uploading_stat,NULL,IF_BASICPUB|m_max_uploading_stat.PubValue);
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_MAX_DOWNLOADING,&m_max_downloading_stat,NULL,IF_BASICPUB|m_max_downloading_stat.PubValue);
@@ -148,6 +156,7 @@ TransferQueueManager::TransferQueueManager() {
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_NUM_WAITING_TO_DOWNLOAD,&m_waiting_to_download_stat,NULL,IF_BASICPUB|m_waiting_to_download_stat.PubDefault);
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_UPLOAD_WAIT_TIME,&m_upload_wait_time_stat,NULL,IF_BASICPUB|m_upload_wait_time_stat.PubDefault);
 	m_stat_pool.AddProbe(ATTR_TRANSFER_QUEUE_DOWNLOAD_WAIT_TIME,&m_download_wait_time_stat,NULL,IF_BASICPUB|m_download_wait_time_stat.PubDefault);
+	m_iostats.InitWaitTimeHistograms();
 	RegisterStats(NULL,m_iostats);
 }
 
@@ -249,6 +258,24 @@ TransferQueueManager::InitAndReconfig() {
 		m_stat_pool.RemoveProbe(ATTR_FILE_TRANSFER_DISK_THROTTLE_SHORTFALL);
 	}
 
+	m_throttle_throughput = param_boolean("FILE_TRANSFER_THROUGHPUT_THROTTLE",false);
+	m_throughput_min_gain = param_double("FILE_TRANSFER_THROUGHPUT_THROTTLE_MIN_GAIN",0.05,0);
+	m_throughput_increment_wait = (time_t) param_integer("FILE_TRANSFER_THROUGHPUT_THROTTLE_WAIT_BETWEEN_INCREMENTS",60,0);
+
+	if( m_throttle_throughput ) {
+		m_stat_pool.AddProbe(ATTR_FILE_TRANSFER_UPLOAD_THROUGHPUT_LIMIT,&m_upload_throughput_limit_stat,NULL,IF_BASICPUB|m_upload_throughput_limit_stat.PubValue);
+		m_stat_pool.AddProbe(ATTR_FILE_TRANSFER_DOWNLOAD_THROUGHPUT_LIMIT,&m_download_throughput_limit_stat,NULL,IF_BASICPUB|m_download_throughput_limit_stat.PubValue);
+	}
+	else {
+		m_stat_pool.RemoveProbe(ATTR_FILE_TRANSFER_UPLOAD_THROUGHPUT_LIMIT);
+		m_stat_pool.RemoveProbe(ATTR_FILE_TRANSFER_DOWNLOAD_THROUGHPUT_LIMIT);
+		m_upload_throughput = ThroughputThrottle();
+		m_download_throughput = ThroughputThrottle();
+	}
+
+	m_small_sandbox_MB = param_double("TRANSFER_QUEUE_SMALL_SANDBOX_SIZE",10,0);
+	m_small_sandbox_slots = param_integer("TRANSFER_QUEUE_SMALL_SANDBOX_SLOTS",2,0);
+
 	m_update_iostats_interval = param_integer("TRANSFER_IO_REPORT_INTERVAL",10,0);
 	if( m_update_iostats_interval != 0 ) {
 		if( m_update_iostats_timer != -1 ) {
@@ -346,6 +373,7 @@ int TransferQueueManager::HandleRequest(int cmd,Stream *stream)
 	std::string fname;
 	std::string jobid;
 	std::string queue_user;
+	std::string peer;
 	filesize_t sandbox_size;
 	if( !msg.LookupBool(ATTR_DOWNLOADING,downloading) ||
 		!msg.LookupString(ATTR_FILE_NAME,fname) ||
@@ -359,6 +387,8 @@ int TransferQueueManager::HandleRequest(int cmd,Stream *stream)
 				sock->peer_description(), msg_str.Value());
 		return FALSE;
 	}
+		// only sent by 8.9.6 and newer
+	msg.LookupString(ATTR_TRANSFER_PEER,peer);
 
 		// Currently, we just create the client with the default max queue
 		// age.  If it becomes necessary to customize the maximum age
@@ -371,6 +401,7 @@ int TransferQueueManager::HandleRequest(int cmd,Stream *stream)
 			fname.c_str(),
 			jobid.c_str(),
 			queue_user.c_str(),
+			peer.c_str(),
 			downloading,
 			m_default_max_queue_age);
 
@@ -504,6 +535,16 @@ TransferQueueRequest::ReadReport(TransferQueueManager *manager)
 	iostats.net_read = (double)recent_usec_net_read/1000000;
 	iostats.net_write = (double)recent_usec_net_write/1000000;
 
+	if( report_interval_usec > 0 ) {
+		double rate = ((double)recent_bytes_sent + recent_bytes_received) * 1000000 / report_interval_usec;
+		if( m_bytes_rate < 0 ) {
+			m_bytes_rate = rate;
+		}
+		else {
+			m_bytes_rate = 0.7*m_bytes_rate + 0.3*rate;
+		}
+	}
+
 	manager->AddRecentIOStats(iostats,m_up_down_queue_user);
 	return true;
 }
@@ -610,6 +651,7 @@ TransferQueueManager::GetUserRec(const std::string &user)
 		itr = m_queue_users.insert(QueueUserMap::value_type(user,TransferQueueUser())).first;
 		itr->second.iostats.ConfigureEMAHorizons(ema_config);
 		itr->second.iostats.Clear();
+		itr->second.iostats.InitWaitTimeHistograms();
 		RegisterStats(user.c_str(),itr->second.iostats);
 	}
 	return itr->second;
@@ -673,6 +715,14 @@ TransferQueueManager::RegisterStats(char const *user,IOStats &iostats,bool unreg
 		else {
 			m_stat_pool.AddProbe(attr.c_str(),&iostats.download_MB_waiting,NULL,flags|iostats.download_MB_waiting.PubValue);
 		}
+		formatstr(attr,"%s%s",user_attr.c_str(),"FileTransferDownloadWaitTimes");
+		if( unregister ) {
+			m_stat_pool.RemoveProbe(attr.c_str());
+			iostats.download_wait_times.Unpublish(*unpublish_ad,attr.c_str());
+		}
+		else {
+			m_stat_pool.AddProbe(attr.c_str(),&iostats.download_wait_times,NULL,flags|iostats.download_wait_times.PubValue);
+		}
 	}
 	if( uploading ) {
 		formatstr(attr,"%sFileTransferUploadBytes",user_attr.c_str());
@@ -707,6 +757,14 @@ TransferQueueManager::RegisterStats(char const *user,IOStats &iostats,bool unreg
 		else {
 			m_stat_pool.AddProbe(attr.c_str(),&iostats.upload_MB_waiting,NULL,flags|iostats.upload_MB_waiting.PubValue);
 		}
+		formatstr(attr,"%s%s",user_attr.c_str(),"FileTransferUploadWaitTimes");
+		if( unregister ) {
+			m_stat_pool.RemoveProbe(attr.c_str());
+			iostats.upload_wait_times.Unpublish(*unpublish_ad,attr.c_str());
+		}
+		else {
+			m_stat_pool.AddProbe(attr.c_str(),&iostats.upload_wait_times,NULL,flags|iostats.upload_wait_times.PubValue);
+		}
 	}
 }
 
@@ -733,6 +791,10 @@ TransferQueueManager::ClearTransferCounts()
 
 void
 TransferQueueManager::IOStatsChanged() {
+	if( m_throttle_throughput && (m_waiting_to_upload > 0 || m_waiting_to_download > 0) ) {
+			// give the throughput throttle a chance to adjust
+		TransferQueueChanged();
+	}
 	if( m_throttle_disk_load &&
 		(m_waiting_to_upload > 0 || m_waiting_to_download > 0) &&
 		m_throttle_disk_load &&
@@ -747,7 +809,14 @@ TransferQueueManager::CheckTransferQueue() {
 	TransferQueueRequest *client = NULL;
 	int downloading = 0;
 	int uploading = 0;
+	int small_downloading = 0; // small sandboxes started ahead of the queue
+	int small_uploading = 0;
+	int idle_downloads = 0;
+	int idle_uploads = 0;
 	bool clients_waiting = false;
+	PeerLoadMap peer_load;
+	double upload_rate_sum = 0, download_rate_sum = 0;
+	int upload_rate_count = 0, download_rate_count = 0;
 
 	m_check_queue_timer = -1;
 
@@ -759,16 +828,52 @@ TransferQueueManager::CheckTransferQueue() {
 			GetUserRec(client->m_up_down_queue_user).running++;
 			if( client->m_downloading ) {
 				downloading += 1;
+				if( client->m_small_sandbox_slot ) {
+					small_downloading += 1;
+				}
 			}
 			else {
 				uploading += 1;
+				if( client->m_small_sandbox_slot ) {
+					small_uploading += 1;
+				}
+			}
+
+			PeerLoad &load = peer_load[(client->m_downloading ? "D" : "U") + client->m_peer];
+			load.running++;
+			if( client->m_bytes_rate >= 0 ) {
+				load.reporting++;
+				load.rate += client->m_bytes_rate;
+				if( client->m_downloading ) {
+					download_rate_sum += client->m_bytes_rate;
+					download_rate_count++;
+				}
+				else {
+					upload_rate_sum += client->m_bytes_rate;
+					upload_rate_count++;
+				}
 			}
 		}
 		else {
 			GetUserRec(client->m_up_down_queue_user).idle++;
+			if( client->m_downloading ) {
+				idle_downloads++;
+			}
+			else {
+				idle_uploads++;
+			}
 		}
 	}
 
+	if( m_throttle_throughput ) {
+		AdjustThroughputLimit(m_upload_throughput,false,uploading,idle_uploads);
+		AdjustThroughputLimit(m_download_throughput,true,downloading,idle_downloads);
+	}
+		// what a new transfer to a destination we know nothing about is
+		// expected to achieve
+	double default_upload_rate = upload_rate_count ? upload_rate_sum/upload_rate_count : 1.0;
+	double default_download_rate = download_rate_count ? download_rate_sum/download_rate_count : 1.0;
+
 	if( m_throttle_disk_load ) {
 		int old_concurrency_limit = m_throttle_disk_load_max_concurrency;
 
@@ -821,14 +926,23 @@ TransferQueueManager::CheckTransferQueue() {
 	}
 
 		// schedule new transfers
-	while( uploading < m_max_uploads || m_max_uploads <= 0 ||
-		   downloading < m_max_downloads || m_max_downloads <= 0 )
-	{
+	while( true ) {
 		TransferQueueRequest *best_client = NULL;
 		int best_recency = 0;
 		unsigned int best_running_count = 0;
-
-		if( m_throttle_disk_load && (uploading + downloading >= m_throttle_disk_load_max_concurrency) ) {
+		bool best_small_slot = false;
+		double best_rate = 0;
+
+		bool disk_limited = m_throttle_disk_load && (uploading + downloading >= m_throttle_disk_load_max_concurrency);
+		bool can_upload = !disk_limited &&
+			(uploading < m_max_uploads || m_max_uploads <= 0) &&
+			!ThroughputLimitReached(false,uploading);
+		bool can_download = !disk_limited &&
+			(downloading < m_max_downloads || m_max_downloads <= 0) &&
+			!ThroughputLimitReached(true,downloading);
+		bool can_use_small_slot = small_uploading + small_downloading < m_small_sandbox_slots;
+
+		if( !can_upload && !can_download ) {
 			break;
 		}
 
@@ -837,40 +951,65 @@ TransferQueueManager::CheckTransferQueue() {
 			if( client->m_gave_go_ahead ) {
 				continue;
 			}
-			if( (client->m_downloading && 
-				(downloading < m_max_downloads || m_max_downloads <= 0)) ||
-				((!client->m_downloading) &&
-				(uploading < m_max_uploads || m_max_uploads <= 0)) )
-			{
-				TransferQueueUser &this_user = GetUserRec(client->m_up_down_queue_user);
-				unsigned int this_user_active_count = this_user.running;
-				int this_user_recency = this_user.recency;
-
-				bool this_client_is_better = false;
-				if( !best_client ) {
+			if( !(client->m_downloading ? can_download : can_upload) ) {
+				continue;
+			}
+				// Up to m_small_sandbox_slots small sandboxes at a time
+				// may go ahead of the rest of the queue, so they need
+				// not wait behind big transfers.  They still count
+				// against the limits above.
+			bool small_slot = can_use_small_slot &&
+				client->m_sandbox_size_MB <= m_small_sandbox_MB;
+
+			TransferQueueUser &this_user = GetUserRec(client->m_up_down_queue_user);
+			unsigned int this_user_active_count = this_user.running;
+			int this_user_recency = this_user.recency;
+			double this_rate = 0;
+			if( m_throttle_throughput ) {
+				this_rate = ExpectedRate(client,peer_load,client->m_downloading ? default_download_rate : default_upload_rate);
+			}
+
+			bool this_client_is_better = false;
+			if( !best_client ) {
+				this_client_is_better = true;
+			}
+			else if( best_client->m_downloading != client->m_downloading ) {
+					// effectively treat up/down queues independently
+				if( client->m_downloading ) {
 					this_client_is_better = true;
 				}
-				else if( best_client->m_downloading != client->m_downloading ) {
-						// effectively treat up/down queues independently
-					if( client->m_downloading ) {
-						this_client_is_better = true;
-					}
+			}
+			else if( best_small_slot != small_slot ) {
+					// small sandboxes go ahead of the queue
+				if( small_slot ) {
+					this_client_is_better = true;
 				}
-				else if( best_running_count > this_user_active_count ) {
-						// prefer users with fewer active transfers
-						// (only counting transfers in one direction for this comparison)
+			}
+			else if( best_running_count != this_user_active_count ) {
+					// prefer users with fewer active transfers
+					// (only counting transfers in one direction for this comparison)
+				if( best_running_count > this_user_active_count ) {
 					this_client_is_better = true;
 				}
-				else if( best_recency > this_user_recency ) {
-						// if still tied: round robin
+			}
+			else if( best_rate != this_rate ) {
+					// prefer the destination where another transfer is
+					// expected to add the most to the aggregate rate
+				if( best_rate < this_rate ) {
 					this_client_is_better = true;
 				}
+			}
+			else if( best_recency > this_user_recency ) {
+					// if still tied: round robin
+				this_client_is_better = true;
+			}
 
-				if( this_client_is_better ) {
-					best_client = client;
-					best_running_count = this_user_active_count;
-					best_recency = this_user_recency;
-				}
+			if( this_client_is_better ) {
+				best_client = client;
+				best_running_count = this_user_active_count;
+				best_recency = this_user_recency;
+				best_small_slot = small_slot;
+				best_rate = this_rate;
 			}
 		}
 
@@ -880,8 +1019,9 @@ TransferQueueManager::CheckTransferQueue() {
 		}
 
 		dprintf(D_FULLDEBUG,
-				"TransferQueueManager: sending GoAhead to %s.\n",
-				client->Description() );
+				"TransferQueueManager: sending GoAhead to %s%s.\n",
+				client->Description(),
+				best_small_slot ? " (small sandbox)" : "" );
 
 		if( !client->SendGoAhead() ) {
 			dprintf(D_FULLDEBUG,
@@ -899,12 +1039,31 @@ TransferQueueManager::CheckTransferQueue() {
 			TransferQueueUser &user = GetUserRec(client->m_up_down_queue_user);
 			user.running += 1;
 			user.idle -= 1;
+
+			time_t waited = client->m_time_go_ahead - client->m_time_born;
+			if( waited < 0 ) {
+				waited = 0; // clock jumped back
+			}
+			client->m_small_sandbox_slot = best_small_slot;
 			if( client->m_downloading ) {
+				m_iostats.download_wait_times += waited;
+				user.iostats.download_wait_times += waited;
 				downloading += 1;
+				if( best_small_slot ) {
+					small_downloading += 1;
+				}
 			}
 			else {
+				m_iostats.upload_wait_times += waited;
+				user.iostats.upload_wait_times += waited;
 				uploading += 1;
+				if( best_small_slot ) {
+					small_uploading += 1;
+				}
 			}
+
+			PeerLoad &load = peer_load[(client->m_downloading ? "D" : "U") + client->m_peer];
+			load.running++;
 		}
 	}
 
@@ -978,6 +1137,107 @@ TransferQueueManager::CheckTransferQueue() {
 	}
 }
 
+bool
+TransferQueueManager::ThroughputLimitReached(bool downloading,int running)
+{
+	if( !m_throttle_throughput ) {
+		return false;
+	}
+	ThroughputThrottle &throttle = downloading ? m_download_throughput : m_upload_throughput;
+	return throttle.limit > 0 && running >= throttle.limit;
+}
+
+void
+TransferQueueManager::AdjustThroughputLimit(ThroughputThrottle &throttle,bool downloading,int running,int waiting)
+{
+	char const *ema_horizon = m_iostats.bytes_sent.ShortestHorizonEMAName();
+	if( !ema_horizon ) {
+		return;
+	}
+	double rate = downloading ?
+		m_iostats.bytes_received.EMAValue(ema_horizon) :
+		m_iostats.bytes_sent.EMAValue(ema_horizon);
+
+	time_t now = time(NULL);
+	if( throttle.stepped > now ) {
+		throttle.stepped = now; // clock jumped back
+	}
+
+	int max_limit = downloading ? m_max_downloads : m_max_uploads;
+	int old_limit = throttle.limit;
+
+	if( throttle.limit == 0 ) {
+			// start from wherever we are
+		throttle.limit = running > 1 ? running : 1;
+		throttle.rate_at_step = rate;
+		throttle.stepped = now;
+		return;
+	}
+
+		// Only learn from the limit while it is what holds transfers back.
+	if( waiting == 0 || running < throttle.limit ) {
+		return;
+	}
+
+	time_t since_step = now - throttle.stepped;
+	if( throttle.last_step < 0 ) {
+			// After backing off, hold there for a while before
+			// probing upwards again.
+		if( since_step < 5*m_throughput_increment_wait ) {
+			return;
+		}
+		throttle.limit += 1;
+		throttle.last_step = 1;
+	}
+	else {
+		if( since_step < m_throughput_increment_wait ) {
+			return;
+		}
+		if( throttle.last_step == 0 || rate > throttle.rate_at_step*(1+m_throughput_min_gain) ) {
+				// the last increase paid off (or this is the first), so try another
+			throttle.limit += 1;
+			throttle.last_step = 1;
+		}
+		else if( throttle.limit > 1 ) {
+				// the last increase did not help; the link or disk is saturated
+			throttle.limit -= 1;
+			throttle.last_step = -1;
+		}
+	}
+
+	if( max_limit > 0 && throttle.limit > max_limit ) {
+		throttle.limit = max_limit;
+	}
+	throttle.rate_at_step = rate;
+	throttle.stepped = now;
+
+	if( throttle.limit != old_limit ) {
+		dprintf(D_ALWAYS,
+				"TransferQueueManager: adjusted %s concurrency limit by %+d based on throughput: "
+				"new limit %d, %s rate %.0f bytes/s\n",
+				downloading ? "download" : "upload",
+				throttle.limit - old_limit,
+				throttle.limit,
+				ema_horizon,
+				rate);
+	}
+}
+
+double
+TransferQueueManager::ExpectedRate(TransferQueueRequest *client,PeerLoadMap &peer_load,double default_rate)
+{
+		// Assume transfers to the same destination share its bandwidth,
+		// so one more gets an equal share of what the ones already
+		// there achieve together.
+	PeerLoadMap::iterator itr = peer_load.find((client->m_downloading ? "D" : "U") + client->m_peer);
+	if( itr == peer_load.end() || itr->second.running == 0 ) {
+		return default_rate;
+	}
+	PeerLoad &load = itr->second;
+	double per_transfer = load.reporting ? load.rate/load.reporting : default_rate;
+	return per_transfer*load.running/(load.running+1);
+}
+
 void
 TransferQueueManager::notifyAboutTransfersTakingTooLong()
 {
@@ -1082,6 +1342,20 @@ IOStats::Clear() {
 	net_write.Clear();
 }
 
+	// upper bounds of the wait time histogram buckets
+static const time_t transfer_queue_wait_levels[] = {
+	(time_t)10,         (time_t)30,        // 10 Sec, 30 Sec
+	(time_t) 1 * 60,    (time_t) 3 * 60,   //  1 Min,  3 Min
+	(time_t)10 * 60,    (time_t)30 * 60,   // 10 Min, 30 Min
+	(time_t) 1 * 60*60, (time_t) 3 * 60*60 //  1 Hr,   3 Hr
+};
+
+void
+IOStats::InitWaitTimeHistograms() {
+	upload_wait_times.set_levels(transfer_queue_wait_levels,COUNTOF(transfer_queue_wait_levels));
+	download_wait_times.set_levels(transfer_queue_wait_levels,COUNTOF(transfer_queue_wait_levels));
+}
+
 void
 IOStats::ConfigureEMAHorizons(classy_counted_ptr<stats_ema_config> config) {
 	bytes_sent.ConfigureEMAHorizons(config);
@@ -1113,6 +1387,8 @@ TransferQueueManager::UpdateIOStats()
 	m_disk_throttle_low_stat = m_disk_load_low_throttle;
 	m_disk_throttle_high_stat = m_disk_load_high_throttle;
 	m_disk_throttle_limit_stat = m_throttle_disk_load_max_concurrency;
+	m_upload_throughput_limit_stat = m_upload_throughput.limit;
+	m_download_throughput_limit_stat = m_download_throughput.limit;
 
 	double disk_load_short = m_iostats.file_read.EMAValue(m_disk_throttle_short_horizon.c_str()) +
 	                         m_iostats.file_write.EMAValue(m_disk_throttle_short_horizon.c_str());
@@ -1228,6 +1504,7 @@ TransferQueueManager::publish_user_stats(ClassAd * ad, const char *user, int fla
 		dn.iostats.file_write.Publish(*ad, "FileTransferFileWriteSeconds", ema_flags);
 		dn.iostats.net_read.Publish(*ad, "FileTransferNetReadSeconds", ema_flags);
 		dn.iostats.download_MB_waiting.Publish(*ad, "FileTransferMBWaitingToDownload", flags|dn.iostats.download_MB_waiting.PubValue);
+		dn.iostats.download_wait_times.Publish(*ad, "FileTransferDownloadWaitTimes", flags);
 	} else {
 		// if there are now counters for this user, then remove the attributes
 		// we can use the overall stats to unpublish, since that have the same EMA config as the per-user stats.
@@ -1235,6 +1512,7 @@ TransferQueueManager::publish_user_stats(ClassAd * ad, const char *user, int fla
 		m_iostats.file_write.Unpublish(*ad, "FileTransferFileWriteSeconds");
 		m_iostats.net_read.Unpublish(*ad, "FileTransferNetReadSeconds");
 		m_iostats.download_MB_waiting.Unpublish(*ad, "FileTransferMBWaitingToDownload");
+		m_iostats.download_wait_times.Unpublish(*ad, "FileTransferDownloadWaitTimes");
 	}
 
 	up_down_user[0] = 'U';
@@ -1246,6 +1524,7 @@ TransferQueueManager::publish_user_stats(ClassAd * ad, const char *user, int fla
 		up.iostats.file_read.Publish(*ad,"FileTransferFileReadSeconds",ema_flags);
 		up.iostats.net_write.Publish(*ad,"FileTransferNetWriteSeconds",ema_flags);
 		up.iostats.upload_MB_waiting.Publish(*ad,"FileTransferMBWaitingToUpload", flags|up.iostats.upload_MB_waiting.PubValue);
+		up.iostats.upload_wait_times.Publish(*ad,"FileTransferUploadWaitTimes", flags);
 	} else {
 		// if there are now counters for this user, then remove the attributes
 		// we can use the overall stats to unpublish, since that have the same EMA config as the per-user stats.
@@ -1253,5 +1532,6 @@ TransferQueueManager::publish_user_stats(ClassAd * ad, const char *user, int fla
 		m_iostats.file_read.Unpublish(*ad,"FileTransferFileReadSeconds");
 		m_iostats.net_write.Unpublish(*ad,"FileTransferNetWriteSeconds");
 		m_iostats.upload_MB_waiting.Unpublish(*ad,"FileTransferMBWaitingToUpload");
+		m_iostats.upload_wait_times.Unpublish(*ad,"FileTransferUploadWaitTimes");
 	}
 }
@@ -38,16 +38,23 @@ class IOStats {
 	stats_entry_sum_ema_rate<double> net_write;
 	stats_entry_abs<double> upload_MB_waiting;
 	stats_entry_abs<double> download_MB_waiting;
+		// how long transfers waited in the queue before starting
+	stats_histogram<time_t> upload_wait_times;
+	stats_histogram<time_t> download_wait_times;
 
 	void Add(IOStats &s);
 	void Clear();
 	void ConfigureEMAHorizons(classy_counted_ptr<stats_ema_config> config);
+		// Must be called once before the wait time histograms are used.
+		// (Not done in the constructor, because the histograms must not
+		// be copied once they have been allocated.)
+	void InitWaitTimeHistograms();
 };
 
 // transfer queue server's representation of a client
 class TransferQueueRequest {
  public:
-	TransferQueueRequest(ReliSock *sock,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,bool downloading,time_t max_queue_age);
+	TransferQueueRequest(ReliSock *sock,filesize_t sandbox_size,char const *fname,char const *jobid,char const *queue_user,char const *peer,bool downloading,time_t max_queue_age);
 	~TransferQueueRequest();
 
 	char const *Description();
@@ -68,6 +75,9 @@ class TransferQueueRequest {
 	                    // to a different file without notifying us.
 	bool m_downloading; // true if client wants to download a file; o.w. upload
 	bool m_gave_go_ahead; // true if we told this client to go ahead
+	bool m_small_sandbox_slot; // true if started ahead of the queue as a small sandbox
+	std::string m_peer; // address of the other end of the transfer; may be empty
+	double m_bytes_rate; // recently reported bytes/s, or -1 if no report yet
 	bool m_notified_about_taking_too_long;
 
 	time_t m_max_queue_age; // clean transfer from queue after this time
@@ -154,6 +164,38 @@ class TransferQueueManager: public Service {
 	stats_entry_ema<double> m_disk_throttle_excess;
 	stats_entry_ema<double> m_disk_throttle_shortfall;
 
+		// Concurrency limit per direction that is raised one transfer
+		// at a time for as long as that raises the aggregate transfer
+		// rate, and lowered again when it doesn't.
+	class ThroughputThrottle {
+	public:
+		ThroughputThrottle(): limit(0), rate_at_step(0), stepped(0), last_step(0) {}
+		int limit;           // 0 until first measured
+		double rate_at_step; // bytes/s when the limit last changed
+		time_t stepped;      // when the limit last changed
+		int last_step;       // +1, -1, or 0 if not yet changed
+	};
+	bool m_throttle_throughput;
+	double m_throughput_min_gain;
+	time_t m_throughput_increment_wait;
+	ThroughputThrottle m_upload_throughput;
+	ThroughputThrottle m_download_throughput;
+	stats_entry_abs<int> m_upload_throughput_limit_stat;
+	stats_entry_abs<int> m_download_throughput_limit_stat;
+
+	double m_small_sandbox_MB;
+	int m_small_sandbox_slots;
+
+		// active transfers to one destination in one direction
+	class PeerLoad {
+	public:
+		PeerLoad(): running(0), reporting(0), rate(0) {}
+		int running;
+		int reporting; // number of running transfers that have reported a rate
+		double rate;   // sum of their rates
+	};
+	typedef std::map< std::string,PeerLoad > PeerLoadMap; // key = up_down + peer
+
 	unsigned int m_round_robin_counter; // increments each time we send GoAhead to a client
 
 	class TransferQueueUser {
@@ -193,7 +235,11 @@ class TransferQueueManager: public Service {
 		RegisterStats(user,iostats,true,unpublish_ad);
 	}
 
-	void parseThrottleConfig(char const *config_param,bool &enable_throttle,double &low,double &high,std::string &throttle_short_horizon,std::string &throttle_long_horizon,time_t &throttle_increment_wait);
+	void AdjustThroughputLimit(ThroughputThrottle &throttle,bool downloading,int running,int waiting);
+	bool ThroughputLimitReached(bool downloading,int running);
+	double ExpectedRate(TransferQueueRequest *client,PeerLoadMap &peer_load,double default_rate);
+
+		void parseThrottleConfig(char const *config_param,bool &enable_throttle,double &low,double &high,std::string &throttle_short_horizon,std::string &throttle_long_horizon,time_t &throttle_increment_wait);
 	void notifyAboutTransfersTakingTooLong();
 
 };
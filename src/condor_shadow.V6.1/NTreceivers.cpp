@@ -37,7 +37,6 @@
 #endif
 
 extern ReliSock *syscall_sock;
-extern BaseShadow *Shadow;
 extern RemoteResource *thisRemoteResource;
 
 
@@ -204,20 +203,20 @@ do_REMOTE_syscall()
            return -1;
        }
 
-		if( Shadow->supportsReconnect() ) {
+		if( thisRemoteResource->getShadow()->supportsReconnect() ) {
 				// instead of having to EXCEPT, we can now try to
 				// reconnect.  happy day! :)
 			dprintf( D_ALWAYS, "%s\n", err_msg.Value() );
 
-			Shadow->resourceDisconnected(thisRemoteResource);
+			thisRemoteResource->getShadow()->resourceDisconnected(thisRemoteResource);
 
-			if (!Shadow->shouldAttemptReconnect(thisRemoteResource)) {
+			if (!thisRemoteResource->getShadow()->shouldAttemptReconnect(thisRemoteResource)) {
 					dprintf(D_ALWAYS, "This job cannot reconnect to starter, so job exiting\n");
-					Shadow->gracefulShutDown();
+					thisRemoteResource->getShadow()->gracefulShutDown();
 					EXCEPT( "%s", err_msg.Value() );
 			}
 				// tell the shadow to start trying to reconnect
-			Shadow->reconnect();
+			thisRemoteResource->getShadow()->reconnect();
 				// we need to return 0 so that our caller doesn't
 				// think the job exited and doesn't do anything to the
 				// syscall socket.
@@ -57,7 +57,9 @@ BaseShadow::BaseShadow() {
 	core_file_name = NULL;
 	scheddAddr = NULL;
 	job_updater = NULL;
-	ASSERT( !myshadow_ptr );	// make cetain we're only instantiated once
+		// make cetain we're only instantiated once, unless this
+		// process services several jobs
+	ASSERT( !myshadow_ptr || multiJobShadow );
 	myshadow_ptr = this;
 	exception_already_logged = false;
 	began_execution = FALSE;
@@ -74,10 +76,16 @@ BaseShadow::BaseShadow() {
 	attemptingReconnectAtStartup = false;
 	m_force_fast_starter_shutdown = false;
 	m_committed_time_finalized = false;
+	m_exiting = false;
+	m_exit_reason = -1;
+	m_exit_tid = -1;
 }
 
 BaseShadow::~BaseShadow() {
-	myshadow_ptr = NULL;
+	if( myshadow_ptr == this ) {
+		myshadow_ptr = NULL;
+	}
+	if (m_exit_tid != -1) daemonCore->Cancel_Timer(m_exit_tid);
 	if (jobAd) FreeJobAd(jobAd);
 	if (gjid) free(gjid); 
 	if (scheddAddr) free(scheddAddr);
@@ -333,7 +341,8 @@ BaseShadow::shutDown( int reason )
 {
 		// exit now if there is no job ad
 	if ( !getJobAd() ) {
-		DC_Exit( reason );
+		exitJob( reason );
+		return;
 	}
 	
 		// if we are being called from the exception handler, return
@@ -389,11 +398,11 @@ BaseShadow::reconnectFailed( const char* reason )
 	if ( attemptingReconnectAtStartup ) {
 		dprintf(D_ALWAYS,"Exiting with JOB_RECONNECT_FAILED\n");
 		// does not return
-		DC_Exit( JOB_RECONNECT_FAILED );
+		exitJob( JOB_RECONNECT_FAILED );
 	} else {
 		dprintf(D_ALWAYS,"Exiting with JOB_SHOULD_REQUEUE\n");
 		// does not return
-		DC_Exit( JOB_SHOULD_REQUEUE );
+		exitJob( JOB_SHOULD_REQUEUE );
 	}
 
 	// Should never get here....
@@ -409,7 +418,8 @@ BaseShadow::holdJob( const char* reason, int hold_reason_code, int hold_reason_s
 
 	if( ! jobAd ) {
 		dprintf( D_ALWAYS, "In HoldJob() w/ NULL JobAd!\n" );
-		DC_Exit( JOB_SHOULD_HOLD );
+		exitJob( JOB_SHOULD_HOLD );
+		return;
 	}
 
 		// cleanup this shadow (kill starters, etc)
@@ -442,7 +452,7 @@ BaseShadow::holdJobAndExit( const char* reason, int hold_reason_code, int hold_r
 	// here it exits later with a different error code that causes the job
 	// to be rescheduled.
 	// exitAfterEvictingJob( JOB_SHOULD_HOLD );
-	DC_Exit( JOB_SHOULD_HOLD );
+	exitJob( JOB_SHOULD_HOLD );
 }
 
 void
@@ -468,7 +478,8 @@ BaseShadow::mockTerminateJob( std::string exit_reason,
 	if( ! jobAd ) {
 		dprintf(D_ALWAYS, "BaseShadow::mockTerminateJob(): NULL JobAd! "
 			"Holding Job!");
-		DC_Exit( JOB_SHOULD_HOLD );
+		exitJob( JOB_SHOULD_HOLD );
+		return;
 	}
 
 	// Insert the various exit attributes into our job ad.
@@ -533,7 +544,8 @@ BaseShadow::retryJobCleanup( void )
 		        "(SHADOW_MAX_JOB_CLEANUP_RETRIES=%d) reached"
 		        "; Forcing job requeue!\n",
 		        m_max_cleanup_retries);
-		DC_Exit(JOB_SHOULD_REQUEUE);
+		exitJob(JOB_SHOULD_REQUEUE);
+		return;
 	}
 	ASSERT(m_cleanup_retry_tid == -1);
 	m_cleanup_retry_tid = daemonCore->Register_Timer(m_cleanup_retry_delay, 0,
@@ -614,7 +626,8 @@ BaseShadow::terminateJob( update_style_t kind ) // has a default argument of US_
 			// email the user, but get values from jobad
 		emailTerminateEvent( reason, kind );
 
-		DC_Exit( reason );
+		exitJob( reason );
+		return;
 	}
 
 	// the default path when kind == US_NORMAL
@@ -709,7 +722,7 @@ BaseShadow::terminateJob( update_style_t kind ) // has a default argument of US_
 	}
 
 	// does not return.
-	DC_Exit( reason );
+	exitJob( reason );
 }
 
 
@@ -735,7 +748,8 @@ BaseShadow::evictJob( int reason )
 
 	if( ! jobAd ) {
 		dprintf( D_ALWAYS, "In evictJob() w/ NULL JobAd!\n" );
-		DC_Exit( reason );
+		exitJob( reason );
+		return;
 	}
 
 		// cleanup this shadow (kill starters, etc)
@@ -1181,6 +1195,38 @@ BaseShadow::logRequeueEvent( const char* reason )
 }
 
 
+void
+BaseShadow::exitJob( int reason )
+{
+	if( !multiJobShadow ) {
+		DC_Exit( reason );
+	}
+
+		// Other jobs share this process, so just finish this one.
+		// Our callers expect not to return into a live job, so the
+		// schedd is told (and this object deleted) from a timer.
+	if( m_exiting ) {
+		return;
+	}
+	dprintf( D_ALWAYS, "Job %d.%d leaving multi-job shadow with "
+			 "exit reason %d\n", getCluster(), getProc(), reason );
+	m_exiting = true;
+	m_exit_reason = reason;
+	m_exit_tid = daemonCore->Register_Timer( 0,
+					(TimerHandlercpp)&BaseShadow::exitJobHandler,
+					"BaseShadow::exitJobHandler", this );
+}
+
+
+void
+BaseShadow::exitJobHandler( void )
+{
+	m_exit_tid = -1;
+		// deletes this
+	multiJobShadowExited( this, m_exit_reason );
+}
+
+
 void
 BaseShadow::checkSwap( void )
 {
@@ -1202,18 +1248,21 @@ BaseShadow::checkSwap( void )
 
 	if( free_swap < reserved_swap ) {
 		dprintf( D_ALWAYS, "Not enough reserved swap space\n" );
-		DC_Exit( JOB_NO_MEM );
+		exitJob( JOB_NO_MEM );
 	}
 }	
 
 
 // Note: log_except is static
 void
-BaseShadow::log_except(const char *msg)
+BaseShadow::log_except(const char *msg, BaseShadow *shadow)
 {
 	if(!msg) msg = "";
 
-	if ( BaseShadow::myshadow_ptr == NULL ) {
+	if ( shadow == NULL ) {
+		shadow = BaseShadow::myshadow_ptr;
+	}
+	if ( shadow == NULL ) {
 		::dprintf (D_ALWAYS, "Unable to log ULOG_SHADOW_EXCEPTION event (no Shadow object): %s\n", msg);
 		return;
 	}
@@ -1225,8 +1274,6 @@ BaseShadow::log_except(const char *msg)
 	snprintf(event.message, sizeof(event.message), "%s", msg);
 	event.message[sizeof(event.message)-1] = '\0';
 
-	BaseShadow *shadow = BaseShadow::myshadow_ptr;
-
 	// we want to log the events from the perspective of the
 	// user job, so if the shadow *sent* the bytes, then that
 	// means the user job *received* the bytes
@@ -1466,7 +1513,8 @@ display_dprintf_header(char **buf,int *bufpos,int *buflen)
 		mypid = daemonCore->getpid();
 	}
 
-	if (Shadow) {
+		// a multi-job shadow has no one job to name
+	if (Shadow && !multiJobShadow) {
 		mycluster = Shadow->getCluster();
 		myproc = Shadow->getProc();
 	}
@@ -225,7 +225,16 @@ class BaseShadow : public Service
 			some cases that means we need to wait around for the starter
 			to tell us what happened.
 		*/
-	virtual void exitAfterEvictingJob( int reason ) { DC_Exit( reason ); }
+	virtual void exitAfterEvictingJob( int reason ) { exitJob( reason ); }
+
+		/** Finish with this job, reporting reason to the schedd.
+			A single-job shadow simply exits with reason.  A
+			multi-job shadow reports reason for this job alone and
+			deletes this object once control returns to DaemonCore,
+			so callers must return right after calling this.
+		*/
+	void exitJob( int reason );
+	bool isExiting( void ) { return m_exiting; }
 	virtual bool exitDelayed( int & /*reason*/ ) { return false; }
 
 		/** The total number of bytes sent over the network on
@@ -311,8 +320,10 @@ class BaseShadow : public Service
 		/// Returns true if job requests graceful removal
 	bool jobWantsGracefulRemoval();
 
-		/// Called by EXCEPT handler to log to user log
-	static void log_except(const char *msg);
+		/** Called by EXCEPT handler to log to user log.  Logs to the
+			given job's log, or to that of the current Shadow if NULL.
+		*/
+	static void log_except(const char *msg, BaseShadow *shadow = NULL);
 
 	//set by pseudo_ulog() to suppress "Shadow exception!"
 	bool exception_already_logged;
@@ -487,6 +498,12 @@ class BaseShadow : public Service
 		/// Timer id for the job cleanup retry handler.
 	int m_cleanup_retry_tid;
 
+		/// Set once exitJob() has been called for this job.
+	bool m_exiting;
+	int m_exit_reason;
+	int m_exit_tid;
+	void exitJobHandler( void );
+
 		/// Number of times we have retried job cleanup.
 	int m_num_cleanup_retries;
 
@@ -518,6 +535,13 @@ extern bool recycleShadow(int previous_job_exit_reason);
 // fix the update ad from the starter to work around starter bugs.
 extern void fix_update_ad(ClassAd & update_ad);
 
+// In a multi-job shadow, report the exit reason for this shadow's job
+// to the schedd, delete it, and start the replacement job, if any.
+extern void multiJobShadowExited(BaseShadow *shadow, int reason);
+
+// True if this process services several jobs (--multi-job).
+extern bool multiJobShadow;
+
 extern BaseShadow *Shadow;
 
 #endif
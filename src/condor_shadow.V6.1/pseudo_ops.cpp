@@ -33,7 +33,6 @@
 #include "nullfile.h"
 
 extern ReliSock *syscall_sock;
-extern BaseShadow *Shadow;
 extern RemoteResource *thisRemoteResource;
 extern RemoteResource *parallelMasterResource;
 
@@ -74,7 +73,7 @@ int
 pseudo_register_job_info(ClassAd* ad)
 {
 	fix_update_ad(*ad);
-	Shadow->updateFromStarterClassAd(ad);
+	thisRemoteResource->getShadow()->updateFromStarterClassAd(ad);
 	return 0;
 }
 
@@ -102,7 +101,7 @@ pseudo_get_job_info(ClassAd *&ad, bool &delete_ad)
 
 	thisRemoteResource->initFileTransfer();
 
-	Shadow->publishShadowAttrs( the_ad );
+	thisRemoteResource->getShadow()->publishShadowAttrs( the_ad );
 
 	ad = the_ad;
 
@@ -195,7 +194,7 @@ pseudo_job_exit(int status, int reason, ClassAd* ad)
 	fix_update_ad(*ad);
 	thisRemoteResource->updateFromStarter( ad );
 	thisRemoteResource->resourceExit( reason, status );
-	Shadow->updateJobInQueue( U_STATUS );
+	thisRemoteResource->getShadow()->updateJobInQueue( U_STATUS );
 	return 0;
 }
 
@@ -218,7 +217,7 @@ pseudo_job_termination( ClassAd *ad )
 
 	// This will utilize only the correct arguments depending on if the
 	// process exited with a signal or not.
-	Shadow->mockTerminateJob( exit_reason, exited_by_signal, exit_code,
+	thisRemoteResource->getShadow()->mockTerminateJob( exit_reason, exited_by_signal, exit_code,
 		exit_signal, core_dumped );
 
 	return 0;
@@ -236,7 +235,7 @@ pseudo_register_mpi_master_info( ClassAd* ad )
 				 ATTR_MPI_MASTER_ADDR );
 		return -1;
 	}
-	if( ! Shadow->setMpiMasterInfo(addr) ) {
+	if( ! thisRemoteResource->getShadow()->setMpiMasterInfo(addr) ) {
 		dprintf( D_ALWAYS, "ERROR: received "
 				 "pseudo_register_mpi_master_info for a non-MPI job!\n" );
 		free(addr);
@@ -261,7 +260,7 @@ static void complete_path( const char *short_path, MyString &full_path )
 		full_path = short_path;
 	} else {
 		full_path.formatstr("%s%s%s",
-						  Shadow->getIwd(),
+						  thisRemoteResource->getShadow()->getIwd(),
 						  DIR_DELIM_STRING,
 						  short_path);
 	}
@@ -295,7 +294,7 @@ int pseudo_get_file_info_new( const char *logical_name, char *&actual_url )
 
 	/* Any name comparisons must check the logical name, the simple name, and the full path */
 
-	if(Shadow->getJobAd()->LookupString(ATTR_FILE_REMAPS,remap_list) &&
+	if(thisRemoteResource->getShadow()->getJobAd()->LookupString(ATTR_FILE_REMAPS,remap_list) &&
 	  (filename_remap_find( remap_list.c_str(), logical_name, remap ) ||
 	   filename_remap_find( remap_list.c_str(), split_file.Value(), remap ) ||
 	   filename_remap_find( remap_list.c_str(), full_path.Value(), remap ))) {
@@ -374,7 +373,7 @@ static void append_buffer_info( MyString &url, const char *method, char const *p
 	/* Now check for individual file overrides */
 	/* These lines have the same syntax as a remap list */
 
-	if(Shadow->getJobAd()->LookupString(ATTR_BUFFER_FILES,buffer_list)) {
+	if(thisRemoteResource->getShadow()->getJobAd()->LookupString(ATTR_BUFFER_FILES,buffer_list)) {
 		if( filename_remap_find(buffer_list.c_str(),path,buffer_string) ||
 		    filename_remap_find(buffer_list.c_str(),file.Value(),buffer_string) ) {
 
@@ -406,7 +405,7 @@ static int attr_list_has_file( const char *attr, const char *path )
 
 	file = condor_basename(path);
 
-	Shadow->getJobAd()->LookupString(attr,str);
+	thisRemoteResource->getShadow()->getJobAd()->LookupString(attr,str);
 	StringList list(str.c_str());
 
 	if( list.contains_withwildcard(path) || list.contains_withwildcard(file) ) {
@@ -440,8 +439,8 @@ int pseudo_get_buffer_info( int *bytes_out, int *block_size_out, int *prefetch_b
 {
 	int bytes=0, block_size=0;
 
-	Shadow->getJobAd()->LookupInteger(ATTR_BUFFER_SIZE,bytes);
-	Shadow->getJobAd()->LookupInteger(ATTR_BUFFER_BLOCK_SIZE,block_size);
+	thisRemoteResource->getShadow()->getJobAd()->LookupInteger(ATTR_BUFFER_SIZE,bytes);
+	thisRemoteResource->getShadow()->getJobAd()->LookupInteger(ATTR_BUFFER_BLOCK_SIZE,block_size);
 
 	if( bytes<0 ) bytes = 0;
 	if( block_size<0 ) block_size = 0;
@@ -527,12 +526,12 @@ pseudo_ulog( ClassAd *ad )
 			//to be logged as ShadowExceptionEvents, rather than
 			//RemoteErrorEvents.  The result is ugly, but guaranteed to
 			//be compatible with other user-log reading tools.
-			BaseShadow::log_except(critical_error);
+			BaseShadow::log_except(critical_error, thisRemoteResource->getShadow());
 			event_already_logged = true;
 		}
 	}
 
-	if( !event_already_logged && !Shadow->uLog.writeEvent( event, ad ) ) {
+	if( !event_already_logged && !thisRemoteResource->getShadow()->uLog.writeEvent( event, ad ) ) {
 		MyString add_str;
 		sPrintAd(add_str, *ad);
 		dprintf(
@@ -547,13 +546,21 @@ pseudo_ulog( ClassAd *ad )
 		if(!hold_reason) {
 			hold_reason = "Job put on hold by remote host.";
 		}
-		Shadow->holdJobAndExit(hold_reason,hold_reason_code,hold_reason_sub_code);
+		thisRemoteResource->getShadow()->holdJobAndExit(hold_reason,hold_reason_code,hold_reason_sub_code);
 		//should never get here, because holdJobAndExit() exits.
 	}
 
 	if( critical_error ) {
 		//Suppress ugly "Shadow exception!"
-		Shadow->exception_already_logged = true;
+		thisRemoteResource->getShadow()->exception_already_logged = true;
+
+			// In a multi-job shadow, fail only the job this came from.
+		if( multiJobShadow ) {
+			thisRemoteResource->getShadow()->exitJob( JOB_EXCEPTION );
+			free( hold_reason_buf );
+			delete event;
+			return result;
+		}
 
 		//lame: at the time of this writing, EXCEPT does not want const:
 		EXCEPT("%s", critical_error);
@@ -585,7 +592,7 @@ pseudo_phase( char *phase )
 	ASSERT(ad);
 	ad->Assign(ATTR_JOB_TRANSFERRING_OUTPUT,true);
 	ad->Assign(ATTR_JOB_TRANSFERRING_OUTPUT_TIME,t);
-	Shadow->updateJobInQueue(U_PERIODIC);
+	thisRemoteResource->getShadow()->updateJobInQueue(U_PERIODIC);
 
 	// prepare to write a phase transition event to the log
 	GenericEvent event;
@@ -600,7 +607,7 @@ pseudo_phase( char *phase )
 	ASSERT(ead);
 
 	// write the event
-	if( !Shadow->uLog.writeEvent( &event, ead ) ) {
+	if( !thisRemoteResource->getShadow()->uLog.writeEvent( &event, ead ) ) {
 		MyString add_str;
 		sPrintAd(add_str, *ead);
 		dprintf(
@@ -661,7 +668,7 @@ pseudo_set_job_attr( const char *name, const char *expr, bool log )
 	} else {
 		remote = parallelMasterResource;
 	}
-	if(Shadow->updateJobAttr(name,expr,log)) {
+	if(thisRemoteResource->getShadow()->updateJobAttr(name,expr,log)) {
 		dprintf(D_SYSCALLS,"pseudo_set_job_attr(%s,%s) succeeded\n",name,expr);
 		ClassAd *ad = remote->getJobAd();
 		ASSERT(ad);
@@ -1477,6 +1477,9 @@ RemoteResource::updateFromStarter( ClassAd* update_ad )
 
     CopyAttribute(ATTR_IO_WAIT, *jobAd, *update_ad);
 
+	CopyAttribute(ATTR_MEMORY_PRESSURE_EVENTS, *jobAd, *update_ad);
+	CopyAttribute(ATTR_LAST_MEMORY_PRESSURE_DATE, *jobAd, *update_ad);
+
 	// FIXME: If we're convinced that we want a whitelist here (chirp
 	// would seem to make a mockery of that), we should at least rewrite
 	// all of the copies to be based on a table.
@@ -1488,6 +1491,19 @@ RemoteResource::updateFromStarter( ClassAd* update_ad )
 	CopyAttribute( "PostExitSignal", *jobAd, *update_ad );
 	CopyAttribute( "PostExitBySignal", *jobAd, *update_ad );
 
+		// How long the starter took to get this run of the job going
+	CopyAttribute( ATTR_STARTER_PREWARMED, *jobAd, *update_ad );
+	CopyAttribute( ATTR_STARTER_INIT_DURATION, *jobAd, *update_ad );
+	CopyAttribute( ATTR_STARTER_JOB_AD_DURATION, *jobAd, *update_ad );
+	CopyAttribute( ATTR_STARTER_SANDBOX_DURATION, *jobAd, *update_ad );
+	CopyAttribute( ATTR_STARTER_ENVIRONMENT_DURATION, *jobAd, *update_ad );
+	CopyAttribute( ATTR_STARTER_SPAWN_DURATION, *jobAd, *update_ad );
+	CopyAttribute( ATTR_STARTER_STARTUP_DURATION, *jobAd, *update_ad );
+
+		// Input files the starter took from its data reuse directory
+	CopyAttribute( ATTR_DATA_REUSE_BYTES_REFLINKED, *jobAd, *update_ad );
+	CopyAttribute( ATTR_DATA_REUSE_BYTES_COPIED, *jobAd, *update_ad );
+
 	classad::ClassAd * toeTag = dynamic_cast<classad::ClassAd *>(update_ad->Lookup(ATTR_JOB_TOE));
 	if( toeTag ) {
 		CopyAttribute(ATTR_JOB_TOE, *jobAd, *update_ad );
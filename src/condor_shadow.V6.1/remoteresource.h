@@ -169,6 +169,12 @@ class RemoteResource : public Service {
 		*/ 
 	ReliSock* getClaimSock();
 
+		/** Return the shadow of the job running on this host.  The
+			syscall handlers act on this, rather than on the global
+			Shadow, since a multi-job shadow has several.
+		*/
+	BaseShadow* getShadow( void ) { return shadow; }
+
 		/** Called when our syscall socket got closed.  So, cancel the
 			daemoncore socket handler, delete the object, and set our
 			pointer to NULL.
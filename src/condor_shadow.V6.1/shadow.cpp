@@ -26,10 +26,11 @@
 #include "condor_email.h"        // for email.
 #include "metric_units.h"
 #include "store_cred.h"
+#include "condor_sinful.h"
 
 extern "C" char* d_format_time(double);
 
-UniShadow::UniShadow() : delayedExitReason( -1 ) {
+UniShadow::UniShadow() : delayedExitReason( -1 ), exitLeaseTid( -1 ) {
 		// pass RemoteResource ourself, so it knows where to go if
 		// it has to call something like shutDown().
 	remRes = new RemoteResource( this );
@@ -37,8 +38,12 @@ UniShadow::UniShadow() : delayedExitReason( -1 ) {
 
 UniShadow::~UniShadow() {
 	if ( remRes ) delete remRes;
-	daemonCore->Cancel_Command( SHADOW_UPDATEINFO );
-	daemonCore->Cancel_Command( CREDD_GET_PASSWD );
+	if ( exitLeaseTid != -1 ) daemonCore->Cancel_Timer( exitLeaseTid );
+		// a multi-job shadow registers these once for all its jobs
+	if ( !multiJobShadow ) {
+		daemonCore->Cancel_Command( SHADOW_UPDATEINFO );
+		daemonCore->Cancel_Command( CREDD_GET_PASSWD );
+	}
 }
 
 
@@ -122,6 +127,13 @@ UniShadow::init( ClassAd* job_ad, const char* schedd_addr, const char *xfer_queu
 		// In this case we just pass the pointer along...
 	remRes->setJobAd( jobAd );
 	
+		// A multi-job shadow registers these commands once for
+		// all of its jobs, and hands each update to the job whose
+		// starter sent it.
+	if( multiJobShadow ) {
+		return;
+	}
+
 		// Register command which gets updates from the starter
 		// on the job's image size, cpu usage, etc.  Each kind of
 		// shadow implements it's own version of this to deal w/ it
@@ -204,7 +216,7 @@ UniShadow::gracefulShutDown( void )
 			// there's no lease or it has already expired.
 			remRes->killStarter(true);
 		} else {
-			DC_Exit( JOB_SHOULD_REQUEUE );
+			exitJob( JOB_SHOULD_REQUEUE );
 		}
 	}
 }
@@ -232,6 +244,20 @@ UniShadow::claimIsClosing( void )
 }
 
 
+bool
+UniShadow::isStarterAddress( const char *addr )
+{
+	char *starter_addr = NULL;
+	if( remRes ) {
+		remRes->getStarterAddress( starter_addr );
+	}
+	bool is_starter = starter_addr && addr &&
+		Sinful( starter_addr ).addressPointsToMe( Sinful( addr ) );
+	free( starter_addr );
+	return is_starter;
+}
+
+
 void
 UniShadow::emailTerminateEvent( int exitReason, update_style_t kind )
 {
@@ -282,7 +308,7 @@ void UniShadow::removeJob( const char* reason )
 	if ( iPrevExitReason != JOB_SHOULD_REMOVE && iPrevExitReason != -1)
 	{
 		// don't wait for final update b/c there isn't one.
-		DC_Exit( JOB_SHOULD_REMOVE );
+		exitJob( JOB_SHOULD_REMOVE );
 	}
 }
 
@@ -576,11 +602,11 @@ UniShadow::exitAfterEvictingJob( int reason ) {
 	// do important-looking things between calling cleanUp() and calling
 	// DC_Exit().
 	if( remRes->gotJobExit() || remRes->getClaimSock() == NULL ) {
-		DC_Exit( reason );
-	} else {
+		exitJob( reason );
+	} else if( exitLeaseTid == -1 ) {
 		this->delayedExitReason = reason;
 		remRes->setExitReason( reason );
-		daemonCore->Register_Timer( 20, 0,
+		exitLeaseTid = daemonCore->Register_Timer( 20, 0,
 				(TimerHandlercpp)&UniShadow::exitLeaseHandler,
 				"exit lease handler", this );
 	}
@@ -597,7 +623,8 @@ UniShadow::exitDelayed( int &reason ) {
 
 void
 UniShadow::exitLeaseHandler() {
-	DC_Exit( delayedExitReason );
+	exitLeaseTid = -1;
+	exitJob( delayedExitReason );
 }
 
 void
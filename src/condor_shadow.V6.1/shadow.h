@@ -108,6 +108,11 @@ class UniShadow : public BaseShadow
 		*/
 	bool claimIsClosing( void );
 
+		/** Return true if addr is the address of the starter
+			running this shadow's job.
+		*/
+	bool isStarterAddress( const char *addr );
+
 		/* The number of bytes transferred from the perspective of
 		 * the shadow (NOT the starter/job).
 		 */
@@ -188,6 +193,7 @@ class UniShadow : public BaseShadow
  private:
 	RemoteResource *remRes;
 	int delayedExitReason;
+	int exitLeaseTid;
 
 	void requestJobRemoval();
 };
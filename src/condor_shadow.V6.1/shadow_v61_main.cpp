@@ -31,6 +31,9 @@
 #include "dc_schedd.h"
 #include "spool_version.h"
 #include "file_transfer.h"
+#include "store_cred.h"
+#include "proc.h"
+#include <map>
 
 BaseShadow *Shadow = NULL;
 
@@ -45,6 +48,16 @@ static const char * xfer_queue_contact_info = NULL;
 bool sendUpdatesToSchedd = true;
 static time_t shadow_worklife_expires = 0;
 
+// In a multi-job shadow, the schedd keeps our stdin open and writes
+// one job ad after another to it, each followed by a "***" line.  Ads
+// with ATTR_SHADOW_SIGNAL are signals for one of our running jobs.
+bool multiJobShadow = false;
+static std::map<PROC_ID,BaseShadow*> multi_jobs;
+static int job_pipe = -1;
+static std::string job_pipe_buf;
+static ClassAd *job_pipe_ad = NULL;
+static bool job_pipe_eof = false;
+
 static void
 usage( int argc, char* argv[] )
 {
@@ -133,6 +146,11 @@ parseArgs( int argc, char *argv[] )
 			continue;
 		}
 
+		if (strcmp(opt, "--multi-job") == 0) {
+			multiJobShadow = true;
+			continue;
+		}
+
 			// the only other argument we understand is the
 			// filename we should read our ClassAd from, "-" for
 			// STDIN.  There's no further checking we need to do 
@@ -283,6 +301,10 @@ void startShadow( ClassAd *ad )
 
 	initShadow( ad );
 
+	if( multiJobShadow ) {
+		multi_jobs[PROC_ID(Shadow->getCluster(), Shadow->getProc())] = Shadow;
+	}
+
 	bool wantClaiming = false;
 	ad->LookupBool(ATTR_CLAIM_STARTD, wantClaiming);
 
@@ -318,6 +340,241 @@ void startShadow( ClassAd *ad )
 }
 
 
+	// Deliver a signal to one job's shadow object.
+static int
+signalShadow( BaseShadow *shadow, int sig )
+{
+	int iRet = 0;
+	switch (sig)
+	{
+		case SIGUSR1: // remove the job
+			iRet =  shadow->handleJobRemoval(sig);
+			break;
+		case DC_SIGSUSPEND: // send down a signal to suspend the job
+			dprintf( D_ALWAYS, "***SUSPEND THE JOB\n");
+			iRet =  shadow->JobSuspend(sig);
+			break;
+		case DC_SIGCONTINUE: // send down a signal to continue the job
+			dprintf( D_ALWAYS, "***CONTINUE THE JOB\n");
+			iRet =  shadow->JobResume(sig);
+			break;
+		case UPDATE_JOBAD:
+			iRet =  shadow->handleUpdateJobAd(sig);
+			break;
+		default: 
+			break;
+	}
+	return iRet;
+}
+
+
+	// Make shadow the job our global Shadow refers to.  In a multi-job
+	// shadow, that is only used to name a job in the log and by the
+	// EXCEPT handler; everything else is handed its job explicitly.
+static void
+setCurrentShadow( BaseShadow *shadow )
+{
+	Shadow = shadow;
+	BaseShadow::myshadow_ptr = shadow;
+}
+
+
+	// Delete one job's shadow object and point Shadow at one of the
+	// remaining jobs, if any.
+static void
+deleteMultiJob( BaseShadow *shadow )
+{
+	multi_jobs.erase( PROC_ID(shadow->getCluster(), shadow->getProc()) );
+	delete shadow;
+	setCurrentShadow( multi_jobs.empty() ? NULL : multi_jobs.begin()->second );
+}
+
+
+static void
+multiJobShadowExitIfIdle( void )
+{
+	if( job_pipe_eof && multi_jobs.empty() ) {
+		dprintf( D_ALWAYS, "No jobs left and no more coming; exiting.\n" );
+		DC_Exit( JOB_EXITED );
+	}
+}
+
+
+void
+multiJobShadowExited( BaseShadow *shadow, int reason )
+{
+	int job_cluster = shadow->getCluster();
+	int job_proc = shadow->getProc();
+	PROC_ID job_id( job_cluster, job_proc );
+
+	bool want_job = reason == JOB_EXITED && !job_pipe_eof &&
+		!( shadow_worklife_expires && time(NULL) > shadow_worklife_expires );
+
+	dprintf( D_ALWAYS, "Reporting exit reason %d for job %d.%d%s.\n",
+			 reason, job_cluster, job_proc,
+			 want_job ? " and attempting to fetch new job" : "" );
+
+	ClassAd *new_job_ad = NULL;
+	if( sendUpdatesToSchedd ) {
+		ASSERT( schedd_addr );
+		DCSchedd schedd(schedd_addr);
+		MyString error_msg;
+		if( !schedd.recycleShadow( reason, &new_job_ad, error_msg, &job_id, want_job ) ) {
+				// The schedd will learn this job's fate when we
+				// exit, but we will carry on with our other jobs.
+			dprintf( D_ALWAYS, "recycleShadow() failed for job %d.%d: %s\n",
+					 job_cluster, job_proc, error_msg.Value() );
+			delete new_job_ad;
+			new_job_ad = NULL;
+		}
+	}
+
+	deleteMultiJob( shadow );
+
+	if( new_job_ad ) {
+		new_job_ad->LookupInteger(ATTR_CLUSTER_ID,cluster);
+		new_job_ad->LookupInteger(ATTR_PROC_ID,proc);
+		dprintf(D_ALWAYS,"Switching to new job %d.%d\n",cluster,proc);
+		startShadow( new_job_ad );
+	}
+
+	multiJobShadowExitIfIdle();
+}
+
+
+static void
+handleJobPipeAd( ClassAd *ad )
+{
+	int job_cluster = -1, job_proc = -1;
+	ad->LookupInteger( ATTR_CLUSTER_ID, job_cluster );
+	ad->LookupInteger( ATTR_PROC_ID, job_proc );
+
+	int sig = 0;
+	if( !ad->LookupInteger( ATTR_SHADOW_SIGNAL, sig ) ) {
+			// a new job for us to run
+		if( multi_jobs.count( PROC_ID(job_cluster, job_proc) ) ) {
+			dprintf( D_ALWAYS, "ERROR: already running job %d.%d, "
+					 "ignoring duplicate job ad\n", job_cluster, job_proc );
+			delete ad;
+			return;
+		}
+		cluster = job_cluster;
+		proc = job_proc;
+		dprintf( D_ALWAYS, "Adding job %d.%d to this shadow (%d jobs)\n",
+				 cluster, proc, (int)multi_jobs.size() + 1 );
+		startShadow( ad );
+		return;
+	}
+	delete ad;
+
+	std::map<PROC_ID,BaseShadow*>::iterator it =
+		multi_jobs.find( PROC_ID(job_cluster, job_proc) );
+	if( it == multi_jobs.end() ) {
+		dprintf( D_FULLDEBUG, "Ignoring signal %d for job %d.%d, which is "
+				 "not running here\n", sig, job_cluster, job_proc );
+		return;
+	}
+	BaseShadow *shadow = it->second;
+
+	dprintf( D_ALWAYS, "Got signal %d for job %d.%d\n",
+			 sig, job_cluster, job_proc );
+	switch( sig ) {
+	case SIGKILL:
+			// The schedd has already dealt with this job and won't
+			// hear from us about it again; just let it go.
+		deleteMultiJob( shadow );
+		multiJobShadowExitIfIdle();
+		break;
+	case SIGTERM:
+		shadow->gracefulShutDown();
+		break;
+	case SIGQUIT:
+		shadow->shutDownFast( JOB_NOT_CKPTED );
+		break;
+	default:
+		signalShadow( shadow, sig );
+		break;
+	}
+}
+
+
+	// SHADOW_UPDATEINFO from one of our starters.  It doesn't say
+	// which job it is about, so go by the starter's address.
+static int
+multiJobUpdateInfo( Service *, int /* command */, Stream *s )
+{
+	ClassAd update_ad;
+	s->decode();
+	if( ! getClassAd(s, update_ad) ) {
+		dprintf( D_ALWAYS, "ERROR in multiJobUpdateInfo: "
+				 "Can't read ClassAd, aborting.\n" );
+		return FALSE;
+	}
+	s->end_of_message();
+
+	std::string starter_addr;
+	update_ad.LookupString( ATTR_STARTER_IP_ADDR, starter_addr );
+
+	std::map<PROC_ID,BaseShadow*>::iterator it;
+	for( it = multi_jobs.begin(); it != multi_jobs.end(); it++ ) {
+		UniShadow *shadow = dynamic_cast<UniShadow*>( it->second );
+		if( shadow && shadow->isStarterAddress( starter_addr.c_str() ) ) {
+			fix_update_ad( update_ad );
+			return shadow->updateFromStarterClassAd( &update_ad );
+		}
+	}
+	dprintf( D_FULLDEBUG, "Ignoring SHADOW_UPDATEINFO from starter %s, "
+			 "which is running none of our jobs\n", starter_addr.c_str() );
+	return FALSE;
+}
+
+
+static int
+jobPipeHandler( Service *, int )
+{
+	char buf[4096];
+	int n = daemonCore->Read_Pipe( job_pipe, buf, sizeof(buf) );
+	if( n < 0 && (errno == EINTR || errno == EAGAIN) ) {
+		return TRUE;
+	}
+	if( n <= 0 ) {
+		dprintf( D_ALWAYS, "Schedd closed our job pipe; will exit once "
+				 "our %d jobs are done.\n", (int)multi_jobs.size() );
+		daemonCore->Close_Pipe( job_pipe );
+		job_pipe = -1;
+		job_pipe_eof = true;
+		multiJobShadowExitIfIdle();
+		return TRUE;
+	}
+	job_pipe_buf.append( buf, n );
+
+	size_t pos;
+	while( (pos = job_pipe_buf.find('\n')) != std::string::npos ) {
+		std::string line = job_pipe_buf.substr( 0, pos );
+		job_pipe_buf.erase( 0, pos + 1 );
+
+		if( !job_pipe_ad ) {
+			job_pipe_ad = new ClassAd;
+		}
+		if( line.empty() || line[0] == '#' ) {
+			continue;
+		}
+		if( line == "***" ) {
+			ClassAd *ad = job_pipe_ad;
+			job_pipe_ad = NULL;
+			handleJobPipeAd( ad );
+			continue;
+		}
+		if( !job_pipe_ad->Insert( line.c_str() ) ) {
+				// don't take our other jobs down over one bad ad
+			dprintf( D_ALWAYS, "ERROR: Failed to insert \"%s\" into ClassAd!\n",
+					 line.c_str() );
+		}
+	}
+	return TRUE;
+}
+
+
 int handleJobRemoval(Service*,int sig)
 {
 	if( Shadow ) {
@@ -330,30 +587,17 @@ int handleJobRemoval(Service*,int sig)
 int handleSignals(Service*,int sig)
 {
 	int iRet =0;
-	if( Shadow ) 
-	{
-		
-		switch (sig)
-		{
-			case SIGUSR1: // remove the job
-				iRet =  Shadow->handleJobRemoval(sig);
-				break;
-			case DC_SIGSUSPEND: // send down a signal to suspend the job
-				dprintf( D_ALWAYS, "***SUSPEND THE JOB\n");
-				iRet =  Shadow->JobSuspend(sig);
-				break;
-			case DC_SIGCONTINUE: // send down a signal to continue the job
-				dprintf( D_ALWAYS, "***CONTINUE THE JOB\n");
-				iRet =  Shadow->JobResume(sig);
-				break;
-			case UPDATE_JOBAD:
-				iRet =  Shadow->handleUpdateJobAd(sig);
-				break;
-			default: 
-				break;
-				
+	if( multiJobShadow ) {
+			// a signal to the process is for all of our jobs
+		std::map<PROC_ID,BaseShadow*> jobs = multi_jobs;
+		std::map<PROC_ID,BaseShadow*>::iterator it;
+		for( it = jobs.begin(); it != jobs.end(); it++ ) {
+			iRet = signalShadow( it->second, sig );
 		}
-		
+	}
+	else if( Shadow ) 
+	{
+		iRet = signalShadow( Shadow, sig );
 	}
 	return iRet;
 }
@@ -406,6 +650,35 @@ main_init(int argc, char *argv[])
 
 	CheckSpoolVersion(SPOOL_MIN_VERSION_SHADOW_SUPPORTS,SPOOL_CUR_VERSION_SHADOW_SUPPORTS);
 
+	if( multiJobShadow ) {
+		if( !job_ad_file || strcmp(job_ad_file, "-") != 0 || is_reconnect ) {
+			EXCEPT( "--multi-job requires job ads on STDIN and no --reconnect" );
+		}
+
+			// UniShadow registers these per job; we serve all of our
+			// jobs, so register them once here.
+		daemonCore->
+			Register_Command( SHADOW_UPDATEINFO, "SHADOW_UPDATEINFO",
+							  (CommandHandler)&multiJobUpdateInfo,
+							  "multiJobUpdateInfo", NULL, DAEMON );
+		daemonCore->
+			Register_Command( CREDD_GET_PASSWD, "CREDD_GET_PASSWD",
+							  (CommandHandler)&get_cred_handler,
+							  "get_cred_handler", NULL, DAEMON, D_COMMAND,
+							  true /*force authentication*/ );
+
+			// Don't read STDIN through stdio: it would buffer job
+			// ads we want the pipe handler to see.
+		job_pipe = daemonCore->Inherit_Pipe( fileno(stdin),
+											 false,    // read pipe
+											 true,     // registerable
+											 false );  // blocking
+		daemonCore->Register_Pipe( job_pipe, "job ad pipe",
+								   (PipeHandler)&jobPipeHandler,
+								   "jobPipeHandler" );
+		return;
+	}
+
 	ClassAd* ad = readJobAd();
 	if( ! ad ) {
 		EXCEPT( "Failed to read job ad!" );
@@ -417,6 +690,13 @@ main_init(int argc, char *argv[])
 void
 main_config()
 {
+	if( multiJobShadow ) {
+		std::map<PROC_ID,BaseShadow*>::iterator it;
+		for( it = multi_jobs.begin(); it != multi_jobs.end(); it++ ) {
+			it->second->config();
+		}
+		return;
+	}
 	Shadow->config();
 }
 
@@ -424,12 +704,28 @@ main_config()
 void
 main_shutdown_fast()
 {
+	if( multiJobShadow ) {
+		std::map<PROC_ID,BaseShadow*> jobs = multi_jobs;
+		std::map<PROC_ID,BaseShadow*>::iterator it;
+		for( it = jobs.begin(); it != jobs.end(); it++ ) {
+			it->second->shutDownFast( JOB_NOT_CKPTED );
+		}
+		return;
+	}
 	Shadow->shutDownFast( JOB_NOT_CKPTED );
 }
 
 void
 main_shutdown_graceful()
 {
+	if( multiJobShadow ) {
+		std::map<PROC_ID,BaseShadow*> jobs = multi_jobs;
+		std::map<PROC_ID,BaseShadow*>::iterator it;
+		for( it = jobs.begin(); it != jobs.end(); it++ ) {
+			it->second->gracefulShutDown();
+		}
+		return;
+	}
 	Shadow->gracefulShutDown();
 }
 
@@ -465,6 +761,7 @@ printClassAd( void )
 	printf( "%s = True\n", ATTR_HAS_RECONNECT );
 	printf( "%s = True\n", ATTR_HAS_JOB_AD_FROM_FILE );
 	printf( "%s = True\n", ATTR_HAS_VM );
+	printf( "%s = True\n", ATTR_HAS_MULTI_JOB );
 	printf( "%s = \"%s\"\n", ATTR_VERSION, CondorVersion() );
 }
 
@@ -489,6 +786,10 @@ main( int argc, char **argv )
 bool
 recycleShadow(int previous_job_exit_reason)
 {
+		// a multi-job shadow asks for new work in exitJob()
+	if( multiJobShadow ) {
+		return false;
+	}
 	if( previous_job_exit_reason != JOB_EXITED ) {
 		return false;
 	}
@@ -1217,6 +1217,7 @@ CpuAttributes::CpuAttributes( MachAttributes* map_arg,
 	c_console_idle = -1;
 	c_slot_disk = c_disk = 0;
 	c_total_disk = 0;
+	c_execute_disk = 0;
 
 	c_condor_load = -1.0;
 	c_owner_load = -1.0;
@@ -1392,10 +1393,14 @@ CpuAttributes::compute( amask_t how_much )
 		if (disk_as_str && string_is_long_param(disk_as_str, temp_disk)) {
 			c_total_disk = temp_disk;
 		} else {
-			// only calculate total_disk once
-			if ((c_total_disk == 0) || (param_boolean("STARTD_RECOMPUTE_DISK_FREE", false))) {
-				c_total_disk = sysapi_disk_space(rip->executeDir());
+			// only measure the execute partition once
+			if ((c_execute_disk == 0) || (param_boolean("STARTD_RECOMPUTE_DISK_FREE", false))) {
+				c_execute_disk = sysapi_disk_space(rip->executeDir());
 			}
+				// count sandboxes still being deleted as free, whether
+				// or not we measured again
+			c_total_disk = c_execute_disk +
+				resmgr->execute_cleanup.pendingKB(rip->executeDir());
 		}
 
 		if (IS_UPDATE(how_much)) {
@@ -1530,6 +1535,9 @@ CpuAttributes::swap_attributes(CpuAttributes & attra, CpuAttributes & attrb, int
 		long long ll = attra.c_total_disk;
 		attra.c_total_disk = attrb.c_total_disk;
 		attrb.c_total_disk = ll;
+		ll = attra.c_execute_disk;
+		attra.c_execute_disk = attrb.c_execute_disk;
+		attrb.c_execute_disk = ll;
 	}
 }
 
@@ -366,6 +366,7 @@ public:
 	void init_total_disk(const CpuAttributes* r_attr) {
 		if (r_attr && (r_attr->c_execute_partition_id == c_execute_partition_id)) {
 			c_total_disk = r_attr->c_total_disk;
+			c_execute_disk = r_attr->c_execute_disk;
 		}
 	}
 	static void swap_attributes(CpuAttributes & attra, CpuAttributes & attrb, int flags);
@@ -390,6 +391,9 @@ private:
 		// here in the per-slot data structure, rather than in the machine-wide
 		// data structure.
 	long long c_total_disk;
+		// free space last measured on that partition; c_total_disk is
+		// this plus what is still being deleted from the trash
+	long long c_execute_disk;
 
 	int				c_phys_mem;
 	int				c_slot_mem;
@@ -120,6 +120,9 @@ void ResMgr::Stats::Init()
    STATS_POOL_ADD(daemonCore->dc_stats.Pool, "ResMgr", WalkEvalState, IF_VERBOSEPUB);
    STATS_POOL_ADD(daemonCore->dc_stats.Pool, "ResMgr", WalkUpdate, IF_VERBOSEPUB);
    STATS_POOL_ADD(daemonCore->dc_stats.Pool, "ResMgr", WalkOther, IF_VERBOSEPUB);
+   STATS_POOL_ADD(daemonCore->dc_stats.Pool, "ResMgr", Publish, IF_VERBOSEPUB);
+   STATS_POOL_ADD(daemonCore->dc_stats.Pool, "ResMgr", UpdatesFull, IF_VERBOSEPUB);
+   STATS_POOL_ADD(daemonCore->dc_stats.Pool, "ResMgr", UpdatesDelta, IF_VERBOSEPUB);
 }
 
 double ResMgr::Stats::BeginRuntime(stats_recent_counter_timer &  /*probe*/)
@@ -744,6 +747,16 @@ ResMgr::sum( ResourceFloatMember memberfunc )
 }
 
 
+void
+ResMgr::slotTypes( std::set<int> &types )
+{
+	types.clear();
+	for( int i = 0; resources && i < nresources; i++ ) {
+		types.insert( abs(resources[i]->type()) );
+	}
+}
+
+
 void
 ResMgr::resource_sort( ComparisonFunc compar )
 {
@@ -1076,7 +1089,7 @@ ResMgr::final_update( void )
 
 int
 ResMgr::send_update( int cmd, ClassAd* public_ad, ClassAd* private_ad,
-					 bool nonblock )
+					 bool nonblock, ClassAd *delta_ad, int *deltas_sent )
 {
 	static bool first_time = true;
 
@@ -1084,7 +1097,7 @@ ResMgr::send_update( int cmd, ClassAd* public_ad, ClassAd* private_ad,
 	num_updates++;
 
 	int res = daemonCore->sendUpdates(cmd, public_ad, private_ad, nonblock, &m_token_requester,
-		DCTokenRequester::default_identity, "ADVERTISE_STARTD");
+		DCTokenRequester::default_identity, "ADVERTISE_STARTD", delta_ad, deltas_sent);
 
 	if (first_time) {
 		first_time = false;
@@ -1287,6 +1300,10 @@ ResMgr::publish( ClassAd* cp, amask_t how_much )
 	startd_stats.Publish(*cp, 0);
 	startd_stats.Tick(time(0));
 
+	if( m_reuse_dir && IS_UPDATE(how_much) && IS_PUBLIC(how_much) ) {
+		m_reuse_dir->Publish( *cp );
+	}
+
 #if HAVE_HIBERNATION
     m_hibernation_manager->publish( *cp );
 #endif
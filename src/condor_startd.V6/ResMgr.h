@@ -35,6 +35,8 @@
 #include "Resource.h"
 #include "claim.h"
 #include "starter_mgr.h"
+#include "execute_cleanup.h"
+#include "docker_prefetch.h"
 #include "vmuniverse_mgr.h"
 
 #if HAVE_HIBERNATION
@@ -161,8 +163,11 @@ public:
 	int		num_cpus( void ) { return m_attr->num_cpus(); }
 	int		num_real_cpus( void ) { return m_attr->num_real_cpus(); }
 	int		numSlots( void ) { return nresources; }
+		// The slot types, as positive numbers, of all our slots
+	void	slotTypes( std::set<int> &types );
 
-	int		send_update( int, ClassAd*, ClassAd*, bool nonblocking );
+	int		send_update( int, ClassAd*, ClassAd*, bool nonblocking, ClassAd *delta_ad = NULL,
+						 int *deltas_sent = NULL );
 	void	final_update( void );
 	
 		// Evaluate the state of all resources.
@@ -254,6 +259,10 @@ public:
 
 	StarterMgr starter_mgr;
 
+	ExecuteCleanup execute_cleanup;
+
+	DockerPrefetch docker_prefetch;
+
 	VMUniverseMgr m_vmuniverse_mgr;
 
 #if HAVE_BACKFILL
@@ -283,6 +292,9 @@ public:
        stats_recent_counter_timer WalkEvalState;
        stats_recent_counter_timer WalkUpdate;
        stats_recent_counter_timer WalkOther;
+       stats_recent_counter_timer Publish;
+       stats_entry_recent<int> UpdatesFull;
+       stats_entry_recent<int> UpdatesDelta;
 
        // TJ: for now these stats will be registered in the DC pool.
        void Init(void);
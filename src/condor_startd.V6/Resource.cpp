@@ -329,6 +329,8 @@ Resource::Resource( CpuAttributes* cap, int rid, bool multiple_slots, Resource*
 	r_no_collector_updates = SlotType::type_param_boolean(cap, "HIDDEN", false);
 
 	update_tid = -1;
+	r_last_update_ad = NULL;
+	r_last_full_update = 0;
 
 	r_cpu_busy = 0;
 	r_cpu_busy_start_time = 0;
@@ -413,6 +415,7 @@ Resource::~Resource()
 		delete r_pre_pre; r_pre_pre = NULL;
 	}
 	delete r_classad; r_classad = NULL;
+	delete r_last_update_ad; r_last_update_ad = NULL;
 	delete r_cod_mgr; r_cod_mgr = NULL;
 	delete r_reqexp; r_reqexp = NULL;
 	delete r_attr; r_attr = NULL;
@@ -1340,6 +1343,7 @@ Resource::do_update( void )
 	int rval;
 	ClassAd private_ad;
 	ClassAd public_ad;
+	double runtime = resmgr->stats.BeginRuntime(resmgr->stats.Publish);
 
         // Get the public and private ads
     publish_for_update( &public_ad, &private_ad );
@@ -1413,9 +1417,37 @@ Resource::do_update( void )
 		public_ad.Delete( * i );
 	}
 
+		// Between full updates, collectors that can take it get only
+		// what changed.  Send the full ad at least once per
+		// UPDATE_INTERVAL so a collector that lost track catches up.
+	time_t now = time(NULL);
+	ClassAd delta_ad;
+	bool send_delta = send_delta_updates && r_last_update_ad &&
+		now - r_last_full_update < update_interval &&
+		build_update_delta( public_ad, delta_ad );
+	delete r_last_update_ad;
+	r_last_update_ad = NULL;
+	if( send_delta_updates ) {
+			// Copy before sending, which adds attributes of its own.
+		r_last_update_ad = new ClassAd( public_ad );
+	}
+	if( !send_delta ) {
+		r_last_full_update = now;
+	}
+	resmgr->stats.EndRuntime(resmgr->stats.Publish, runtime);
+
 		// Send class ads to collector(s)
+	int deltas_sent = 0;
 	rval = resmgr->send_update( UPDATE_STARTD_AD, &public_ad,
-								&private_ad, true );
+								&private_ad, true,
+								send_delta ? &delta_ad : NULL, &deltas_sent );
+		// A delta that couldn't go is sent as a full ad instead, so
+		// only count the update as a delta if one actually went.
+	if( deltas_sent > 0 ) {
+		resmgr->stats.UpdatesDelta += 1;
+	} else {
+		resmgr->stats.UpdatesFull += 1;
+	}
 	if( rval ) {
 		dprintf( D_FULLDEBUG, "Sent update to %d collector(s)\n", rval );
 	} else {
@@ -1427,6 +1459,42 @@ Resource::do_update( void )
 	update_tid = -1;
 }
 
+// Fill delta_ad with the attributes of public_ad that differ from the
+// last update, plus what the collector needs to find the ad.  Returns
+// false if a full update is needed instead, because an attribute went
+// away or nearly everything changed.
+bool
+Resource::build_update_delta( ClassAd & public_ad, ClassAd & delta_ad )
+{
+	for( auto i = r_last_update_ad->begin(); i != r_last_update_ad->end(); ++i ) {
+		if( ! public_ad.Lookup( i->first ) ) {
+			return false;
+		}
+	}
+
+	for( auto i = public_ad.begin(); i != public_ad.end(); ++i ) {
+		ExprTree * old_expr = r_last_update_ad->Lookup( i->first );
+		if( ! old_expr || ! old_expr->SameAs( i->second ) ) {
+			delta_ad.Insert( i->first, i->second->Copy() );
+		}
+	}
+	if( delta_ad.size() * 2 > public_ad.size() ) {
+		return false;
+	}
+
+	const char * const key_attrs[] = {
+		ATTR_MY_TYPE, ATTR_TARGET_TYPE, ATTR_NAME,
+		ATTR_MY_ADDRESS, ATTR_STARTD_IP_ADDR
+	};
+	for( auto attr : key_attrs ) {
+		if( ! delta_ad.Lookup( attr ) && public_ad.Lookup( attr ) ) {
+			CopyAttribute( attr, delta_ad, public_ad );
+		}
+	}
+	return true;
+}
+
+
 void
 Resource::publish_for_update ( ClassAd *public_ad ,ClassAd *private_ad )
 {
@@ -1474,6 +1542,9 @@ Resource::final_update( void )
 #endif
 
 	resmgr->send_update( INVALIDATE_STARTD_ADS, &invalidate_ad, NULL, false );
+
+	delete r_last_update_ad;
+	r_last_update_ad = NULL;
 }
 
 
@@ -3485,7 +3556,7 @@ void Resource::init_total_disk(const Resource * pslot)
 	r_attr->init_total_disk(pslot->r_attr);
 }
 
-Resource * initialize_resource(Resource * rip, ClassAd * req_classad, Claim* &leftover_claim)
+Resource * initialize_resource(Resource * rip, ClassAd * req_classad, Claim* &leftover_claim, bool defer_update)
 {
 	ASSERT(rip);
 	ASSERT(req_classad);
@@ -3723,16 +3794,18 @@ Resource * initialize_resource(Resource * rip, ClassAd * req_classad, Claim* &le
 
 			// Recompute the partitionable slot's resources
 		rip->change_state( unclaimed_state );
-			// Call update() in case we were never matched, i.e. no state change
-			// Note: update() may create a new claim if pass thru Owner state
-		rip->update();
 
 		resmgr->addResource( new_rip );
 
-			// XXX: This is overkill, but the best way, right now, to
-			// get many of the new_rip's attributes calculated.
-		resmgr->compute( A_ALL );
-		resmgr->compute( A_TIMEOUT | A_UPDATE );
+			// When carving several slots for one request, the caller
+			// does the rest once, after the last one; until then,
+			// publish just enough for the next request to see what
+			// is left.
+		if( defer_update ) {
+			rip->refresh_classad( A_PUBLIC );
+		} else {
+			finish_partitioning( rip );
+		}
 
 			// Stash pslot claim as the "leftover_claim", which
 			// we will send back directly to the schedd iff it supports
@@ -3761,6 +3834,18 @@ Resource * initialize_resource(Resource * rip, ClassAd * req_classad, Claim* &le
 	}
 }
 
+void finish_partitioning(Resource * rip)
+{
+		// Call update() in case we were never matched, i.e. no state change
+		// Note: update() may create a new claim if pass thru Owner state
+	rip->update();
+
+		// XXX: This is overkill, but the best way, right now, to
+		// get many of the new_rip's attributes calculated.
+	resmgr->compute( A_ALL );
+	resmgr->compute( A_TIMEOUT | A_UPDATE );
+}
+
 void
 Resource::publishDynamicChildSummaries(ClassAd *cap) {
 
@@ -358,6 +358,12 @@ private:
 
 	int			update_tid;	// DaemonCore timer id for update delay
 
+		// The public ad as of the last update, and when the last full
+		// update went out; collectors are sent deltas against it.
+	ClassAd*	r_last_update_ad;
+	time_t		r_last_full_update;
+	bool		build_update_delta( ClassAd & public_ad, ClassAd & delta_ad );
+
 	int		r_cpu_busy;
 	time_t	r_cpu_busy_start_time;
 	time_t	r_last_compute_condor_load;
@@ -405,6 +411,10 @@ Arguments
   this will hold the claim to the leftovers.  Otherwise, it will be
   unchanged.
 
+- defer_update - Input: If true, don't update the partitionable slot
+  or recompute the other slots; the caller will call
+  finish_partitioning() once it is done carving slots.
+
 Return
 
 Returns the Resource the job will actually be running on.  It does not need to
@@ -414,6 +424,11 @@ carve out a new dynamic slot for his job.
 
 The job may be rejected, in which case the returned Resource will be null.
 */
-Resource * initialize_resource(Resource * rip, ClassAd * req_classad, Claim* &leftover_claim);
+Resource * initialize_resource(Resource * rip, ClassAd * req_classad, Claim* &leftover_claim, bool defer_update = false);
+
+/* Update the partitionable slot rip and recompute all slots after one
+or more calls to initialize_resource() with defer_update set.
+*/
+void finish_partitioning(Resource * rip);
 
 #endif /* _STARTD_RESOURCE_H */
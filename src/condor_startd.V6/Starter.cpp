@@ -41,6 +41,9 @@
 #if defined(LINUX)
 #include "glexec_starter.linux.h"
 #endif
+#if !defined(WIN32)
+#include "fdpass.h"
+#endif
 
 // Keep track of living Starters
 std::map<pid_t, Starter*> living_starters;
@@ -706,7 +709,9 @@ Starter::exited(Claim * claim, int status) // Claim may be NULL.
 		// If we created the parent execute directory (say for filesystem
 		// encryption), then clean that up, too.
 	ASSERT( executeDir() );
-	cleanup_execute_dir( s_pid, executeDir(), s_created_execute_dir );
+	long long disk_kb = 0;
+	jobAd->LookupInteger( ATTR_DISK_USAGE, disk_kb );
+	cleanup_execute_dir( s_pid, executeDir(), s_created_execute_dir, disk_kb );
 
 #if defined(LINUX)
 	if( param_boolean( "GLEXEC_STARTER", false ) ) {
@@ -1060,6 +1065,9 @@ int Starter::execDCStarter(
 		dprintf(D_ALWAYS, "Setting affinity env to %s\n", affinityString.c_str());
 	}
 
+	if( !std_fds && !fs_remap && handoffToPrewarmed(claim, args, new_env, s) ) {
+		return s_pid;
+	}
 
 	ReliSock child_job_update_sock;   // child inherits this socket
 	ASSERT( !s_job_update_sock );
@@ -1169,6 +1177,76 @@ int Starter::execDCStarter(
 	return s_pid;
 }
 
+/*
+  Hand the claim to one of the StarterMgr's prewarmed starters instead
+  of spawning a new one.  It gets what we would have spawned it with,
+  the arguments, environment and syscall sock, followed by the machine
+  ad as usual; see handlePrewarmHandoff() in the starter.  Only starters
+  for a job from a shadow, spawned the ordinary way, are prewarmed.
+*/
+bool
+Starter::handoffToPrewarmed( Claim *claim, ArgList const &args, Env const &env, Stream *s )
+{
+#if defined(WIN32)
+	(void)claim;
+	(void)args;
+	(void)env;
+	(void)s;
+	return false;
+#else
+	if( !claim || !s || s->type() != Stream::reli_sock || s_reaper_id > 0 ||
+		param_boolean("GLEXEC_STARTER", false) )
+	{
+		return false;
+	}
+
+	PrewarmedStarter ps;
+	if( !resmgr->starter_mgr.takePrewarmed(abs(claim->rip()->type()), s_path, ps) ) {
+		return false;
+	}
+
+	ClassAd handoff;
+	MyString args_str, env_str, error_msg;
+	bool ok = args.GetArgsStringV2Raw(&args_str, &error_msg) &&
+		env.getDelimitedStringV2Raw(&env_str, &error_msg);
+	char *sock_state = ((ReliSock *)s)->serialize();
+	handoff.Assign( ATTR_JOB_ARGUMENTS2, args_str );
+	handoff.Assign( ATTR_JOB_ENVIRONMENT2, env_str );
+	handoff.Assign( "SyscallSock", sock_state );
+	delete [] sock_state;
+
+	ps.update_sock->encode();
+	ok = ok && putClassAd(ps.update_sock, handoff) &&
+		ps.update_sock->end_of_message() &&
+		claim->writeMachAd(ps.update_sock) &&
+		fdpass_send(ps.handoff_fd, ((ReliSock *)s)->get_file_desc()) == 0;
+	if( !ok ) {
+		dprintf( D_ALWAYS, "Failed to hand claim to prewarmed starter pid %d, "
+				 "spawning a new one\n", ps.pid );
+		resmgr->starter_mgr.discardPrewarmed( ps );
+		return false;
+	}
+	close( ps.handoff_fd );
+
+	ASSERT( !s_job_update_sock );
+	s_job_update_sock = ps.update_sock;
+	if( daemonCore->Register_Socket(
+			s_job_update_sock,
+			"starter ClassAd update socket",
+			(SocketHandlercpp)&Starter::receiveJobClassAdUpdate,
+			"receiveJobClassAdUpdate",
+			this) < 0 )
+	{
+		EXCEPT("Failed to register ClassAd update socket.");
+	}
+
+	s_pid = ps.pid;
+	dprintf( D_ALWAYS, "Handed claim to prewarmed starter pid %d\n", s_pid );
+	return true;
+#endif
+}
+
+
 #if defined(LINUX)
 void
 Starter::cleanupAfterGlexec(Claim * claim)
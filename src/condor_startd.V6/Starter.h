@@ -113,6 +113,9 @@ private:
 		// claim is optional here, and may be NULL (e.g. boinc) but it may NOT be null when glexec is enabled. (sigh)
 	int		execDCStarter( Claim *, ArgList const &args, Env const *env,
 						   int std_fds[], Stream* s );
+		// returns true if the claim went to a prewarmed starter
+	bool	handoffToPrewarmed( Claim *, ArgList const &args, Env const &env,
+								Stream* s );
 #if HAVE_BOINC
 	int 	execBOINCStarter( Claim * );
 #endif /* HAVE_BOINC */
@@ -1239,6 +1239,62 @@ abort_claim( Resource* rip )
 	return FALSE;
 }
 
+/*
+  The schedd may ask for more than one dynamic slot like rip, which was
+  just carved for this request, so that filling a large machine with
+  small jobs doesn't take one claim request per slot.  Carve as many
+  more as the partitionable slot will hold, up to the number asked for
+  and CLAIM_DYNAMIC_SLOTS_PER_REQUEST, then update the partitionable
+  slot and recompute the others once for all of them.
+*/
+static void
+carve_extra_dynamic_slots( Resource* rip, ClassAd* req_classad,
+						   Claim* &leftover_claim,
+						   std::vector<Resource*> &extra_slots )
+{
+	Resource *parent = rip->get_parent();
+	int wanted = 1;
+	req_classad->LookupInteger( "_condor_NUM_DYNAMIC_SLOTS", wanted );
+	wanted = MIN( wanted, param_integer("CLAIM_DYNAMIC_SLOTS_PER_REQUEST", 1, 1) );
+	if( !parent || parent->r_has_cp || wanted <= 1 ) {
+		return;
+	}
+
+	std::vector<ClassAd*> extra_ads;
+	while( (int)extra_slots.size() + 1 < wanted ) {
+		ClassAd *extra_ad = new ClassAd( *req_classad );
+		Resource *extra = initialize_resource( parent, extra_ad, leftover_claim, true );
+		if( !extra || extra == parent ) {
+			delete extra_ad;
+			break;
+		}
+		extra_slots.push_back( extra );
+		extra_ads.push_back( extra_ad );
+	}
+	if( extra_slots.empty() ) {
+		return;
+	}
+	finish_partitioning( parent );
+
+	size_t kept = 0;
+	for( size_t i = 0; i < extra_slots.size(); i++ ) {
+		Resource *extra = extra_slots[i];
+		if( !extra->willingToRun( extra_ads[i] ) ) {
+			extra->dprintf( D_ALWAYS, "Request to claim extra dynamic slot refused.\n" );
+			delete extra_ads[i];
+			extra->change_state( delete_state );
+			continue;
+		}
+		extra->r_cur->setjobad( extra_ads[i] );
+		extra->r_cur->setrank( extra->compute_rank( extra_ads[i] ) );
+		extra_slots[kept++] = extra;
+	}
+	extra_slots.resize( kept );
+	parent->dprintf( D_FULLDEBUG, "Carved %d extra dynamic slot(s) for this claim request\n",
+					 (int)kept );
+}
+
+
 #define ABORT \
 delete req_classad;						\
 return_code = abort_claim(rip);		\
@@ -1561,13 +1617,20 @@ request_claim( Resource* rip, Claim *claim, char* id, Stream* stream )
 	}
 #endif /* HAVE_BACKFILL */
 
+		// If the schedd asked for more than one dynamic slot, carve
+		// the rest now, so they all go back in the one reply.
+	std::vector<Resource*> extra_slots;
+	if( new_dynamic_slot ) {
+		carve_extra_dynamic_slots( rip, req_classad, leftover_claim, extra_slots );
+	}
+
 		// If we're still here, we're ready to accpet the claim now.
 		// Call this other function to actually reply to the schedd
 		// and perform the last half of the protocol.  We use the same
 		// function after the preemption has completed when the startd
 		// is finally ready to reply to the and finish the claiming
 		// process.
-	accept_request_claim( rip, leftover_claim, and_pair );
+	accept_request_claim( rip, leftover_claim, and_pair, &extra_slots );
 
 		// We always need to return KEEP_STREAM so that daemon core
 		// doesn't try to delete the stream we've already deleted.
@@ -1605,8 +1668,22 @@ abort_accept_claim( Resource* rip, Stream* stream )
 }
 
 
+static void
+discard_extra_slots( std::vector<Resource*> *extra_slots )
+{
+	if( !extra_slots ) {
+		return;
+	}
+	for( size_t i = 0; i < extra_slots->size(); i++ ) {
+		(*extra_slots)[i]->change_state( delete_state );
+	}
+	extra_slots->clear();
+}
+
+
 bool
-accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
+accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair,
+					  std::vector<Resource*> *extra_slots )
 {
 	int interval = -1;
 	char *client_addr = NULL;
@@ -1629,10 +1706,19 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 		Reply of 4 (REQUEST_CLAIM_PAIR) means claim accepted by a slot
 		  that is paired, and the partner slot ad and claim id will be
 		  sent next.
+		Reply of 5 (REQUEST_CLAIM_SLOTS) means claim accepted by a
+		  partitionable slot, which was split into more dynamic slots
+		  as the schedd asked.  The number of extra slots is sent
+		  next, then the claim id and slot ad of each, then whether
+		  there are leftovers and, if so, their claim id and slot ad.
 	*/
+	bool have_leftovers = leftover_claim && leftover_claim->id() &&
+		leftover_claim->rip()->r_classad;
 	int cmd = OK;
-	if ( leftover_claim && leftover_claim->id() && 
-		 leftover_claim->rip()->r_classad ) 
+	if ( extra_slots && !extra_slots->empty() ) {
+		cmd = REQUEST_CLAIM_SLOTS;
+	}
+	else if ( have_leftovers )
 	{
 		// schedd wants leftovers, send reply code 3
 		cmd = REQUEST_CLAIM_LEFTOVERS;
@@ -1649,10 +1735,37 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 	if( !stream->put( cmd ) ) {
 		rip->dprintf( D_ALWAYS, 
 			"Can't to send cmd %d to schedd as claim request reply.\n", cmd );
+		discard_extra_slots( extra_slots );
 		abort_accept_claim( rip, stream );
 		return false;
 	}
-	if ( cmd == REQUEST_CLAIM_LEFTOVERS )
+	if ( cmd == REQUEST_CLAIM_SLOTS )
+	{
+		dprintf(D_FULLDEBUG,"Sending %d extra dynamic slot claims to schedd\n",
+				(int)extra_slots->size());
+
+		bool sent = stream->put( (int)extra_slots->size() );
+		for( size_t i = 0; sent && i < extra_slots->size(); i++ ) {
+			Resource *extra = (*extra_slots)[i];
+			MyString claimId(extra->r_cur->id());
+			sent = stream->put(claimId) && putClassAd(stream, *extra->r_classad);
+		}
+		sent = sent && stream->put( have_leftovers ? 1 : 0 );
+		if( sent && have_leftovers ) {
+			leftover_claim->rip()->r_classad->Assign(ATTR_LAST_SLOT_NAME, rip->r_name);
+			MyString claimId(leftover_claim->id());
+			sent = stream->put(claimId) &&
+				putClassAd(stream, *leftover_claim->rip()->r_classad);
+		}
+		if( !sent ) {
+			rip->dprintf( D_ALWAYS,
+				"Can't send extra dynamic slot claims to schedd.\n" );
+			discard_extra_slots( extra_slots );
+			abort_accept_claim( rip, stream );
+			return false;
+		}
+	}
+	else if ( cmd == REQUEST_CLAIM_LEFTOVERS )
 	{
 		// schedd just claimed a dynamic slot, and it wants
 		// us to send back to the classad and the new claim id for
@@ -1666,6 +1779,7 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 		{
 			rip->dprintf( D_ALWAYS, 
 				"Can't send partitionable slot leftovers to schedd.\n" );
+			discard_extra_slots( extra_slots );
 			abort_accept_claim( rip, stream );
 			return false;
 		}
@@ -1680,6 +1794,7 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 		if ( !stream->put(claimId) || ! putClassAd(stream, *ripb->r_classad)) {
 			rip->dprintf( D_ALWAYS,
 				"Can't send paired slot claim & ad to schedd.\n" );
+			discard_extra_slots( extra_slots );
 			abort_accept_claim( rip, stream );
 			return false;
 		}
@@ -1687,6 +1802,7 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 
 	if( !stream->end_of_message() ) {
 		rip->dprintf( D_ALWAYS, "Can't to send eom to schedd.\n" );
+		discard_extra_slots( extra_slots );
 		abort_accept_claim( rip, stream );
 		return false;
 	}
@@ -1700,6 +1816,7 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 		stream->decode();
 		if( ! stream->code(client_addr) ) {
 			rip->dprintf( D_ALWAYS, "Can't receive schedd addr.\n" );
+			discard_extra_slots( extra_slots );
 			abort_accept_claim( rip, stream );
 			return false;
 		} else {
@@ -1709,6 +1826,7 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 			rip->dprintf( D_ALWAYS, "Can't receive alive interval\n" );
 			free( client_addr );
 			client_addr = NULL;
+			discard_extra_slots( extra_slots );
 			abort_accept_claim( rip, stream );
 			return false;
 		} else {
@@ -1773,12 +1891,32 @@ accept_request_claim( Resource* rip, Claim* leftover_claim, bool and_pair )
 
 	rip->r_cur->loadRequestInfo();
 
+		// Start pulling the job's image while the shadow gets going.
+	resmgr->docker_prefetch.prefetch( rip->r_cur->ad(), rip->r_classad );
+
 		// Since we're done talking to this schedd, delete the stream.
 	rip->r_cur->setRequestStream( NULL );
 
 	rip->dprintf( D_ALWAYS, "State change: claiming protocol successful\n" );
 	rip->change_state( claimed_state );
 	if (ripb) { ripb->change_state( claimed_state ); }
+
+		// The extra dynamic slots belong to the same schedd and user.
+	for( size_t i = 0; extra_slots && i < extra_slots->size(); i++ ) {
+		Resource *extra = (*extra_slots)[i];
+		Client *client = extra->r_cur->client();
+		extra->r_cur->setaliveint( rip->r_cur->getaliveint() );
+		client->setaddr( rip->r_cur->client()->addr() );
+		client->sethost( rip->r_cur->client()->host() );
+		if( !RemoteOwner.empty() ) {
+			client->setowner( RemoteOwner.c_str() );
+			client->setuser( RemoteOwner.c_str() );
+		}
+		extra->r_cur->loadAccountingInfo();
+		extra->r_cur->loadRequestInfo();
+		extra->dprintf( D_ALWAYS, "State change: claimed with %s\n", rip->r_name );
+		extra->change_state( claimed_state );
+	}
 	return true;
 }
 
@@ -117,8 +117,10 @@ int match_info( Resource*, char* );
 // Schedd Agent requests a claim
 int request_claim( Resource*, Claim *, char*, Stream* ); 
 
-// Accept claim from schedd agent
-bool accept_request_claim( Resource* , Claim * = NULL, bool and_pair = false );
+// Accept claim from schedd agent, along with any extra dynamic slots
+// carved from the same partitionable slot for the same request
+bool accept_request_claim( Resource* , Claim * = NULL, bool and_pair = false,
+						   std::vector<Resource*> *extra_slots = NULL );
 
 // Activate a claim with a given starter
 int activate_claim( Resource*, Stream* ); 
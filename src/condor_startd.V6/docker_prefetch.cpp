@@ -0,0 +1,142 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "startd.h"
+#include "docker_prefetch.h"
+#include "docker-api.h"
+
+#include <algorithm>
+
+	// How long a pull may take, in seconds.
+static const int prefetch_timeout = 30 * 60;
+
+static int
+prefetch_child( void *arg, Stream * )
+{
+	std::string *image = static_cast<std::string *>( arg );
+	CondorError err;
+	return DockerAPI::pull( *image, prefetch_timeout, err ) == 0 ? 0 : 1;
+}
+
+
+DockerPrefetch::DockerPrefetch()
+	: m_enabled( false ),
+	  m_reaper_id( -1 ),
+	  m_tid( 0 )
+{
+}
+
+
+DockerPrefetch::~DockerPrefetch()
+{
+	if( m_reaper_id >= 0 && daemonCore ) {
+		daemonCore->Cancel_Reaper( m_reaper_id );
+	}
+}
+
+
+void
+DockerPrefetch::init( void )
+{
+#ifdef WIN32
+	m_enabled = false;
+#else
+	m_enabled = param_boolean( "DOCKER_PREFETCH_IMAGES", false );
+	if( m_enabled && m_reaper_id < 0 ) {
+		m_reaper_id = daemonCore->Register_Reaper( "DockerPrefetch reaper",
+			(ReaperHandlercpp)&DockerPrefetch::reaper,
+			"DockerPrefetch::reaper()", this );
+		ASSERT( m_reaper_id != FALSE );
+	}
+#endif
+}
+
+
+void
+DockerPrefetch::prefetch( ClassAd *job_ad, ClassAd *mach_ad )
+{
+	if( !m_enabled || !job_ad || !mach_ad ) {
+		return;
+	}
+
+	std::string image;
+	bool has_docker = false;
+	if( !job_ad->LookupString( ATTR_DOCKER_IMAGE, image ) || image.empty() ||
+		!mach_ad->LookupBool( ATTR_HAS_DOCKER, has_docker ) || !has_docker )
+	{
+		return;
+	}
+
+	auto it = std::find( m_recent.begin(), m_recent.end(), image );
+	if( it != m_recent.end() ) {
+		m_recent.erase( it );
+		m_recent.push_back( image );
+		return;
+	}
+	m_recent.push_back( image );
+	size_t limit = param_integer( "DOCKER_IMAGE_CACHE_SIZE", 8, 1 );
+	while( m_recent.size() > limit ) {
+		m_recent.pop_front();
+	}
+
+	m_queue.push_back( image );
+	if( !m_tid ) {
+		startChild();
+	}
+}
+
+
+void
+DockerPrefetch::startChild( void )
+{
+	while( !m_queue.empty() && !m_tid ) {
+		std::string image = m_queue.front();
+		m_queue.pop_front();
+			// The child gets its own copy of image when it forks.
+		m_tid = daemonCore->Create_Thread( prefetch_child, &image, NULL, m_reaper_id );
+		if( !m_tid ) {
+			dprintf( D_ALWAYS, "DockerPrefetch: failed to start a process to pull %s\n",
+					 image.c_str() );
+			m_recent.remove( image );
+		} else {
+			dprintf( D_FULLDEBUG, "DockerPrefetch: pulling %s\n", image.c_str() );
+			m_pulling = image;
+		}
+	}
+}
+
+
+int
+DockerPrefetch::reaper( int tid, int status )
+{
+	if( tid != m_tid ) {
+		return FALSE;
+	}
+	m_tid = 0;
+	if( status != 0 ) {
+		dprintf( D_ALWAYS, "DockerPrefetch: pull of %s failed (status %d); "
+				 "the job will pull it when it starts\n", m_pulling.c_str(), status );
+			// so that the next claim for it tries again
+		m_recent.remove( m_pulling );
+	}
+	m_pulling.clear();
+	startChild();
+	return TRUE;
+}
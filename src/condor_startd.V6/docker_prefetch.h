@@ -0,0 +1,64 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef _CONDOR_DOCKER_PREFETCH_H
+#define _CONDOR_DOCKER_PREFETCH_H
+
+#include "condor_daemon_core.h"
+
+#include <deque>
+#include <list>
+#include <string>
+
+/*
+  Pulls the Docker image of a job as soon as the job claims a slot,
+  while the shadow is still starting up and sending the job's input,
+  so that the pull is not part of starting the container.  Pulls run
+  one at a time in a child process.  Images pulled recently are not
+  pulled again; how many are remembered is DOCKER_IMAGE_CACHE_SIZE.
+
+  Nothing is pulled unless DOCKER_PREFETCH_IMAGES is true.
+*/
+class DockerPrefetch : public Service {
+public:
+	DockerPrefetch();
+	~DockerPrefetch();
+
+		// (Re)read DOCKER_PREFETCH_IMAGES.
+	void init( void );
+
+		// Pull the image named by job_ad, if any, for a slot with
+		// the given machine ad.
+	void prefetch( ClassAd *job_ad, ClassAd *mach_ad );
+
+private:
+	bool m_enabled;
+	int m_reaper_id;
+	int m_tid;
+		// what the running child is pulling
+	std::string m_pulling;
+	std::deque<std::string> m_queue;
+		// most recent last
+	std::list<std::string> m_recent;
+
+	void startChild( void );
+	int reaper( int tid, int status );
+};
+
+#endif /* _CONDOR_DOCKER_PREFETCH_H */
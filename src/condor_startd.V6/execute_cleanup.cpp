@@ -0,0 +1,386 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "startd.h"
+#include "execute_cleanup.h"
+#include "directory_util.h"
+#include "filesystem_remap.h"
+#include "utc_time.h"
+
+#ifndef WIN32
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#ifndef WIN32
+namespace {
+
+	// A directory in the trash.  It is removed once everything in it
+	// has been, so it holds its fd open until then and its children
+	// are opened relative to it; nothing in the tree is ever looked up
+	// by path, so a symlink can't lead us out of it.
+struct TrashDir {
+	TrashDir *parent;
+		// relative to parent, or a full path at the top of the tree
+	std::string name;
+	int fd;
+		// children not yet removed, plus one until this has been read
+	int pending;
+};
+
+	// Everything here is protected by trash_mutex.
+std::mutex trash_mutex;
+std::condition_variable trash_ready;
+std::vector<TrashDir *> trash_todo;
+int trash_busy = 0;
+long long trash_files = 0;
+long long trash_dirs = 0;
+long long trash_errors = 0;
+
+	// Called with trash_mutex held, once everything in dir is gone.
+void
+trash_dir_done( TrashDir *dir )
+{
+	while( dir ) {
+		if( dir->fd >= 0 ) {
+			close( dir->fd );
+		}
+		int parent_fd = dir->parent ? dir->parent->fd : AT_FDCWD;
+		if( unlinkat( parent_fd, dir->name.c_str(), AT_REMOVEDIR ) == 0 ) {
+			trash_dirs++;
+		} else if( errno != ENOENT ) {
+			trash_errors++;
+		}
+		TrashDir *parent = dir->parent;
+		delete dir;
+		if( !parent || --parent->pending > 0 ) {
+			break;
+		}
+		dir = parent;
+	}
+}
+
+	// Remove the files in dir and return the directories under it.
+void
+trash_read_dir( TrashDir *dir, std::vector<TrashDir *> &subdirs,
+				long long &files, long long &errors )
+{
+	int parent_fd = dir->parent ? dir->parent->fd : AT_FDCWD;
+	dir->fd = openat( parent_fd, dir->name.c_str(),
+					  O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC );
+	if( dir->fd < 0 ) {
+		if( errno == ENOTDIR || errno == ELOOP ) {
+				// not a directory after all; done with it
+			if( unlinkat( parent_fd, dir->name.c_str(), 0 ) == 0 ) {
+				files++;
+			} else if( errno != ENOENT ) {
+				errors++;
+			}
+		} else if( errno != ENOENT ) {
+			errors++;
+		}
+		return;
+	}
+
+	int read_fd = dup( dir->fd );
+	DIR *dirp = read_fd >= 0 ? fdopendir( read_fd ) : NULL;
+	if( !dirp ) {
+		if( read_fd >= 0 ) {
+			close( read_fd );
+		}
+		errors++;
+		return;
+	}
+	struct dirent *de;
+	while( (de = readdir( dirp )) ) {
+		if( !strcmp( de->d_name, "." ) || !strcmp( de->d_name, ".." ) ) {
+			continue;
+		}
+		bool is_dir = de->d_type == DT_DIR;
+		if( de->d_type == DT_UNKNOWN ) {
+			struct stat st;
+			is_dir = fstatat( dir->fd, de->d_name, &st, AT_SYMLINK_NOFOLLOW ) == 0 &&
+				S_ISDIR( st.st_mode );
+		}
+		if( is_dir ) {
+			subdirs.push_back( new TrashDir{ dir, de->d_name, -1, 1 } );
+		} else if( unlinkat( dir->fd, de->d_name, 0 ) == 0 ) {
+			files++;
+		} else if( errno != ENOENT ) {
+			errors++;
+		}
+	}
+	closedir( dirp );
+}
+
+void
+trash_worker()
+{
+	std::unique_lock<std::mutex> guard( trash_mutex );
+	for(;;) {
+		while( trash_todo.empty() && trash_busy > 0 ) {
+			trash_ready.wait( guard );
+		}
+		if( trash_todo.empty() ) {
+			trash_ready.notify_all();
+			return;
+		}
+
+			// Last in, first out, so that we finish off one branch
+			// before starting the next and hold few directories open.
+		TrashDir *dir = trash_todo.back();
+		trash_todo.pop_back();
+		trash_busy++;
+		guard.unlock();
+
+		std::vector<TrashDir *> subdirs;
+		long long files = 0;
+		long long errors = 0;
+		trash_read_dir( dir, subdirs, files, errors );
+
+		guard.lock();
+		trash_busy--;
+		trash_files += files;
+		trash_errors += errors;
+		dir->pending += (int)subdirs.size();
+		trash_todo.insert( trash_todo.end(), subdirs.begin(), subdirs.end() );
+		if( --dir->pending == 0 ) {
+			trash_dir_done( dir );
+		}
+		trash_ready.notify_all();
+	}
+}
+
+struct TrashBatch {
+	int threads;
+	std::vector<std::string> paths;
+};
+
+	// Runs in a child process, so that the threads can't get in the
+	// way of anything in the startd, and so that they run as root
+	// whatever the startd's priv state.
+int
+trash_child( void *arg, Stream * )
+{
+	TrashBatch *batch = static_cast<TrashBatch *>( arg );
+
+	set_root_priv();
+	double start = condor_gettimestamp_double();
+
+	for( auto &path : batch->paths ) {
+		trash_todo.push_back( new TrashDir{ NULL, path, -1, 1 } );
+	}
+	std::vector<std::thread> workers;
+	for( int i = 0; i < batch->threads; i++ ) {
+		workers.emplace_back( trash_worker );
+	}
+	for( auto &worker : workers ) {
+		worker.join();
+	}
+
+	dprintf( D_FULLDEBUG, "ExecuteCleanup: removed %lld files and %lld directories "
+			 "in %.3fs with %d thread(s), %lld error(s)\n",
+			 trash_files, trash_dirs, condor_gettimestamp_double() - start,
+			 batch->threads, trash_errors );
+	return trash_errors ? 1 : 0;
+}
+
+}
+#endif
+
+
+ExecuteCleanup::ExecuteCleanup()
+	: m_threads( 0 ),
+	  m_reaper_id( -1 ),
+	  m_tid( 0 )
+{
+}
+
+
+ExecuteCleanup::~ExecuteCleanup()
+{
+	if( m_reaper_id >= 0 && daemonCore ) {
+		daemonCore->Cancel_Reaper( m_reaper_id );
+	}
+}
+
+
+void
+ExecuteCleanup::init( void )
+{
+#ifdef WIN32
+	m_threads = 0;
+#else
+	m_threads = param_integer( "EXECUTE_CLEANUP_THREADS", 0, 0, 64 );
+	if( !enabled() ) {
+		return;
+	}
+
+	if( m_reaper_id < 0 ) {
+		m_reaper_id = daemonCore->Register_Reaper( "ExecuteCleanup reaper",
+			(ReaperHandlercpp)&ExecuteCleanup::reaper,
+			"ExecuteCleanup::reaper()", this );
+		ASSERT( m_reaper_id != FALSE );
+	}
+
+	StringList execute_dirs;
+	resmgr->FillExecuteDirsList( &execute_dirs );
+	TemporaryPrivSentry sentry( PRIV_ROOT );
+	MyString dirbuf;
+	pair_strings_vector root_dirs = root_dir_list();
+	char const *exec_path;
+	execute_dirs.rewind();
+	while( (exec_path = execute_dirs.next()) ) {
+		for( auto it = root_dirs.begin(); it != root_dirs.end(); ++it ) {
+			const char *exec_path_full = dirscat( it->second.c_str(), exec_path, dirbuf );
+			if( !exec_path_full ) {
+				continue;
+			}
+			std::string trash_path;
+			formatstr( trash_path, "%s%s", exec_path_full, EXECUTE_TRASH_DIR );
+			if( mkdir( trash_path.c_str(), 0700 ) < 0 && errno != EEXIST ) {
+				dprintf( D_ALWAYS, "ExecuteCleanup: failed to create %s: %s; "
+						 "sandboxes there will be removed inline\n",
+						 trash_path.c_str(), strerror(errno) );
+			}
+		}
+	}
+#endif
+}
+
+
+bool
+ExecuteCleanup::trash( char const *exec_path, char const *dir_name, long long disk_kb )
+{
+#ifdef WIN32
+	(void)exec_path; (void)dir_name; (void)disk_kb;
+	return false;
+#else
+	if( !enabled() ) {
+		return false;
+	}
+
+	TemporaryPrivSentry sentry( PRIV_ROOT );
+	bool queued = false;
+	MyString dirbuf;
+	pair_strings_vector root_dirs = root_dir_list();
+	for( auto it = root_dirs.begin(); it != root_dirs.end(); ++it ) {
+		const char *exec_path_full = dirscat( it->second.c_str(), exec_path, dirbuf );
+		if( !exec_path_full ) {
+			continue;
+		}
+			// dirscat() leaves a trailing slash
+		std::string sandbox, trash_path, trashed;
+		formatstr( sandbox, "%s%s", exec_path_full, dir_name );
+		formatstr( trash_path, "%s%s", exec_path_full, EXECUTE_TRASH_DIR );
+		formatstr( trashed, "%s/%s", trash_path.c_str(), dir_name );
+
+		struct stat st;
+		if( lstat( sandbox.c_str(), &st ) == 0 &&
+			rename( sandbox.c_str(), trashed.c_str() ) < 0 )
+		{
+			dprintf( D_FULLDEBUG, "ExecuteCleanup: failed to move %s into %s: %s\n",
+					 sandbox.c_str(), trash_path.c_str(), strerror(errno) );
+			return false;
+		}
+		if( lstat( trashed.c_str(), &st ) == 0 &&
+			m_queued.find( trashed ) == m_queued.end() )
+		{
+				// The sandbox is only in one of the roots, so only
+				// the first counts against the disk.
+			m_queued[trashed] = Entry{ exec_path, queued ? 0 : disk_kb };
+			queued = true;
+			dprintf( D_FULLDEBUG, "ExecuteCleanup: queued %s (%lld KB)\n",
+					 trashed.c_str(), disk_kb );
+		}
+	}
+
+	if( !m_tid ) {
+		startChild();
+	}
+	return true;
+#endif
+}
+
+
+long long
+ExecuteCleanup::pendingKB( char const *exec_path ) const
+{
+	long long kb = 0;
+	for( auto &queued : m_queued ) {
+		if( queued.second.exec_path == exec_path ) {
+			kb += queued.second.disk_kb;
+		}
+	}
+	return kb;
+}
+
+
+void
+ExecuteCleanup::startChild( void )
+{
+#ifndef WIN32
+	if( m_queued.empty() ) {
+		return;
+	}
+
+	TrashBatch batch;
+	batch.threads = m_threads > 0 ? m_threads : 1;
+	for( auto &queued : m_queued ) {
+		batch.paths.push_back( queued.first );
+	}
+		// The child gets its own copy of batch when it forks.
+	m_tid = daemonCore->Create_Thread( trash_child, &batch, NULL, m_reaper_id );
+	if( !m_tid ) {
+		dprintf( D_ALWAYS, "ExecuteCleanup: failed to start a process to remove %d sandbox(es)\n",
+				 (int)batch.paths.size() );
+		return;
+	}
+	m_batch = batch.paths;
+#endif
+}
+
+
+int
+ExecuteCleanup::reaper( int tid, int status )
+{
+	if( tid != m_tid ) {
+		return FALSE;
+	}
+	m_tid = 0;
+
+	if( status != 0 ) {
+		dprintf( D_ALWAYS, "ExecuteCleanup: failed to remove all of %d sandbox(es) "
+				 "in the trash (status %d); they will be removed when the startd restarts\n",
+				 (int)m_batch.size(), status );
+	} else {
+		dprintf( D_FULLDEBUG, "ExecuteCleanup: reaped process %d, which removed %d sandbox(es)\n",
+				 tid, (int)m_batch.size() );
+	}
+	for( auto &path : m_batch ) {
+		m_queued.erase( path );
+	}
+	m_batch.clear();
+
+		// anything trashed while that ran
+	startChild();
+	return TRUE;
+}
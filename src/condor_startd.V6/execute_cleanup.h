@@ -0,0 +1,82 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef _CONDOR_EXECUTE_CLEANUP_H
+#define _CONDOR_EXECUTE_CLEANUP_H
+
+#include "condor_daemon_core.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+  Deletes job sandboxes in the background, so that a slot can be
+  claimed again as soon as its starter exits, however many files the
+  job left behind.  A sandbox is renamed into the execute directory's
+  trash directory, which is cheap, and a child process removes
+  everything in the trash with EXECUTE_CLEANUP_THREADS threads.
+  Space held by the trash is counted as free when the startd works out
+  how much disk it has.
+
+  When EXECUTE_CLEANUP_THREADS is 0, or on Windows, this does nothing
+  and sandboxes are removed inline as before.
+*/
+class ExecuteCleanup : public Service {
+public:
+	ExecuteCleanup();
+	~ExecuteCleanup();
+
+		// (Re)read EXECUTE_CLEANUP_THREADS and make a trash directory
+		// in each execute directory.
+	void init( void );
+
+	bool enabled( void ) const { return m_threads > 0; }
+
+		/** Queue the sandbox dir_name in exec_path for deletion, moving
+			it into the trash if the starter has not already done so.
+			Looks under every named chroot, as cleanup_execute_dir() does.
+			@param disk_kb how big the sandbox was last seen to be
+			@return false if it could not be moved into the trash, in
+			which case the caller should remove it itself */
+	bool trash( char const *exec_path, char const *dir_name, long long disk_kb );
+
+		// KB in the trash of the given execute directory that has not
+		// yet been freed.
+	long long pendingKB( char const *exec_path ) const;
+
+private:
+	struct Entry {
+		std::string exec_path;
+		long long disk_kb;
+	};
+
+	int m_threads;
+	int m_reaper_id;
+	int m_tid;
+		// full path of each queued sandbox in the trash
+	std::map<std::string, Entry> m_queued;
+		// what the running child was given
+	std::vector<std::string> m_batch;
+
+	void startChild( void );
+	int reaper( int tid, int status );
+};
+
+#endif /* _CONDOR_EXECUTE_CLEANUP_H */
@@ -56,6 +56,7 @@ ResMgr*	resmgr;			// Pointer to the resource manager object
 int	polling_interval = 0;	// Interval for polling when there are resources in use
 int	update_interval = 0;	// Interval to update CM
 int	update_offset = 0;		// Interval offset to update CM
+bool	send_delta_updates = true;	// Send only changes between full updates
 
 // String Lists
 StringList *startd_job_attrs = NULL;
@@ -211,6 +212,8 @@ main_init( int, char* argv[] )
 	resmgr->FillExecuteDirsList( &execute_dirs );
 	check_execute_dir_perms( execute_dirs );
 	cleanup_execute_dirs( execute_dirs );
+	resmgr->execute_cleanup.init();
+	resmgr->docker_prefetch.init();
 
 		// Compute all attributes
 	resmgr->compute( A_ALL );
@@ -470,6 +473,8 @@ finish_main_config( void )
 	cron_job_mgr->Reconfig(  );
 	bench_job_mgr->Reconfig(  );
 	resmgr->starter_mgr.init();
+	resmgr->execute_cleanup.init();
+	resmgr->docker_prefetch.init();
 
 #if HAVE_HIBERNATION
 	resmgr->updateHibernateConfiguration();
@@ -494,6 +499,7 @@ init_params( int /* first_time */)
 
 	update_interval = param_integer( "UPDATE_INTERVAL", 300, 1 );
 	update_offset = param_integer( "UPDATE_OFFSET", 0, 0 );
+	send_delta_updates = param_boolean( "STARTD_SEND_DELTA_UPDATES", true );
 
 	if( accountant_host ) {
 		free( accountant_host );
@@ -580,6 +586,16 @@ init_params( int /* first_time */)
 	}
 
 	pid_snapshot_interval = param_integer( "PID_SNAPSHOT_INTERVAL", DEFAULT_PID_SNAPSHOT_INTERVAL );
+#if defined(HAVE_EXT_LIBCGROUP)
+		// With cgroups, each job's family asks the procd for what it
+		// needs itself: snapshots of /proc, or a look at its cgroup's
+		// process list.  The starter's own family need not make the
+		// procd walk /proc any more often than it already does.
+	std::string base_cgroup;
+	if( param( base_cgroup, "BASE_CGROUP" ) ) {
+		pid_snapshot_interval = -1;
+	}
+#endif
 
 	if( valid_cod_users ) {
 		delete( valid_cod_users );
@@ -816,6 +832,7 @@ main_shutdown_fast()
 		// Remember that we're in shutdown-mode so we will refuse
 		// various commands. 
 	resmgr->markShutdown();
+	resmgr->starter_mgr.releasePrewarmed();
 
 	daemonCore->Reset_Reaper( main_reaper, "shutdown_reaper", 
 								 (ReaperHandler)shutdown_reaper,
@@ -851,6 +868,7 @@ main_shutdown_graceful()
 		// Remember that we're in shutdown-mode so we will refuse
 		// various commands. 
 	resmgr->markShutdown();
+	resmgr->starter_mgr.releasePrewarmed();
 
 	daemonCore->Reset_Reaper( main_reaper, "shutdown_reaper", 
 								 (ReaperHandler)shutdown_reaper,
@@ -878,6 +896,10 @@ reaper(Service *, int pid, int status)
 				pid, WEXITSTATUS(status));
 	}
 
+	if( resmgr->starter_mgr.prewarmedStarterExited(pid) ) {
+		return TRUE;
+	}
+
 	// Adjust info for vm universe
 	resmgr->m_vmuniverse_mgr.freeVM(pid);
 
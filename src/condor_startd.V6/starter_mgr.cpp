@@ -36,15 +36,18 @@
 #include "condor_common.h"
 #include "startd.h"
 #include "my_popen.h"
+#include "shared_port_endpoint.h"
 
 
-StarterMgr::StarterMgr() : _haveStandardUni(false)
+StarterMgr::StarterMgr() : _haveStandardUni(false), m_prewarm_tid(-1)
 {
 }
 
 
 StarterMgr::~StarterMgr()
 {
+	releasePrewarmed();
+
 	Starter* tmp_starter;
 	starters.Rewind();
 	while( starters.Next(tmp_starter) ) {
@@ -61,6 +64,10 @@ StarterMgr::init( void )
 	StringList starter_list;
 	StringList checked_starter_list;
 	Starter* tmp_starter;
+
+		// The starter binaries or their config may have changed
+	releasePrewarmed();
+
 	starters.Rewind();
 	while( starters.Next(tmp_starter) ) {
 		delete( tmp_starter );
@@ -117,6 +124,9 @@ StarterMgr::init( void )
 	if( starters.IsEmpty() ) {
 		dprintf(D_ALWAYS,"WARNING WARNING WARNING: No valid starters were found!  Is something wrong with your Condor installation?  This startd will not be able to run jobs.\n");
 	}
+
+		// From a timer, since on startup the slots don't exist yet
+	schedulePrewarm( 0 );
 }
 
 
@@ -279,3 +289,198 @@ StarterMgr::registerStarter( const char* path )
 }
 
 
+void
+StarterMgr::schedulePrewarm( int delay )
+{
+	if( m_prewarm_tid != -1 || !daemonCore ) {
+		return;
+	}
+	m_prewarm_tid = daemonCore->Register_Timer( delay,
+		(TimerHandlercpp)&StarterMgr::prewarm, "StarterMgr::prewarm", this );
+}
+
+
+void
+StarterMgr::prewarm( void )
+{
+	m_prewarm_tid = -1;
+
+	int count = param_integer( "PREWARMED_STARTERS", 0, 0 );
+	if( count <= 0 || !resmgr || resmgr->isShuttingDown() ) {
+		return;
+	}
+
+		// Only the first DaemonCore starter is prewarmed; with the
+		// default STARTER_LIST, that is the one nearly every job uses.
+	Starter *tmp_starter, *dc_starter = NULL;
+	starters.Rewind();
+	while( starters.Next(tmp_starter) ) {
+		if( tmp_starter->is_dc() ) {
+			dc_starter = tmp_starter;
+			break;
+		}
+	}
+	if( ! dc_starter ) {
+		return;
+	}
+
+	std::set<int> slot_types;
+	resmgr->slotTypes( slot_types );
+	for( int slot_type : slot_types ) {
+		int have = 0;
+		for( const auto &ps : m_prewarmed ) {
+			if( ps.slot_type == slot_type && ps.path == dc_starter->path() ) {
+				have++;
+			}
+		}
+		for( ; have < count; have++ ) {
+			if( ! spawnPrewarmed(slot_type, dc_starter->path()) ) {
+					// try again later, rather than spinning
+				schedulePrewarm( 60 );
+				return;
+			}
+		}
+	}
+}
+
+
+bool
+StarterMgr::spawnPrewarmed( int slot_type, const char *path )
+{
+#if defined(WIN32)
+		// we have no way to pass the syscall sock to a running process
+	(void)slot_type;
+	(void)path;
+	return false;
+#else
+	int fds[2];
+	if( socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0 ) {
+		dprintf( D_ALWAYS, "ERROR: Failed to create socketpair for prewarmed starter: %s\n",
+				 strerror(errno) );
+		return false;
+	}
+
+	ReliSock child_job_update_sock;
+	ReliSock *update_sock = new ReliSock;
+	if( !update_sock->connect_socketpair(child_job_update_sock) ) {
+		dprintf( D_ALWAYS, "ERROR: Failed to create job ClassAd update socket for prewarmed starter\n" );
+		delete update_sock;
+		close( fds[0] );
+		close( fds[1] );
+		return false;
+	}
+
+		// The same arguments Starter::execDCStarter() would use, minus
+		// everything that depends on the claim.
+	ArgList args;
+	args.AppendArg( "condor_starter" );
+	args.AppendArg( "-f" );
+	if( slot_type != 0 ) {
+		std::string slot_type_name;
+		formatstr( slot_type_name, "slot_type_%d", slot_type );
+		args.AppendArg( "-local-name" );
+		args.AppendArg( slot_type_name );
+	}
+	args.AppendArg( "-prewarm" );
+
+	Stream *inherit_list[] = { &child_job_update_sock, 0 };
+	int std_fds[3] = { fds[1], -1, -1 };
+
+	FamilyInfo fi;
+	fi.max_snapshot_interval = pid_snapshot_interval;
+
+	MyString daemon_sock = SharedPortEndpoint::GenerateEndpointName( "starter" );
+	pid_t pid = daemonCore->
+		Create_Process( path, args, PRIV_ROOT, main_reaper,
+		                TRUE, TRUE, NULL, NULL, &fi, inherit_list, std_fds,
+		                NULL, 0, NULL, 0, NULL, NULL, daemon_sock.c_str() );
+	close( fds[1] );
+	if( pid == FALSE ) {
+		dprintf( D_ALWAYS, "ERROR: Failed to spawn prewarmed starter %s\n", path );
+		delete update_sock;
+		close( fds[0] );
+		return false;
+	}
+
+	dprintf( D_FULLDEBUG, "Spawned prewarmed starter pid %d for slot type %d\n",
+			 pid, slot_type );
+
+	PrewarmedStarter ps;
+	ps.pid = pid;
+	ps.slot_type = slot_type;
+	ps.path = path;
+	ps.update_sock = update_sock;
+	ps.handoff_fd = fds[0];
+	m_prewarmed.push_back( ps );
+	return true;
+#endif
+}
+
+
+bool
+StarterMgr::takePrewarmed( int slot_type, const char *path, PrewarmedStarter &ps )
+{
+	for( auto it = m_prewarmed.begin(); it != m_prewarmed.end(); ++it ) {
+		if( it->slot_type != slot_type || it->path != path ||
+			daemonCore->ProcessExitedButNotReaped(it->pid) )
+		{
+			continue;
+		}
+		ps = *it;
+		m_prewarmed.erase( it );
+		schedulePrewarm( 0 );
+		return true;
+	}
+	return false;
+}
+
+
+void
+StarterMgr::discardPrewarmed( PrewarmedStarter &ps )
+{
+		// Closing our ends of its sockets tells it to exit
+	delete ps.update_sock;
+	ps.update_sock = NULL;
+	if( ps.handoff_fd >= 0 ) {
+		close( ps.handoff_fd );
+		ps.handoff_fd = -1;
+	}
+	m_prewarmed_released.insert( ps.pid );
+}
+
+
+void
+StarterMgr::releasePrewarmed( void )
+{
+	for( auto &ps : m_prewarmed ) {
+		discardPrewarmed( ps );
+	}
+	m_prewarmed.clear();
+	if( m_prewarm_tid != -1 && daemonCore ) {
+		daemonCore->Cancel_Timer( m_prewarm_tid );
+	}
+	m_prewarm_tid = -1;
+}
+
+
+bool
+StarterMgr::prewarmedStarterExited( pid_t pid )
+{
+	if( m_prewarmed_released.erase(pid) ) {
+		return true;
+	}
+	for( auto it = m_prewarmed.begin(); it != m_prewarmed.end(); ++it ) {
+		if( it->pid != pid ) {
+			continue;
+		}
+		dprintf( D_ALWAYS, "Prewarmed starter pid %d exited before it was handed a claim\n", pid );
+		discardPrewarmed( *it );
+		m_prewarmed_released.erase( pid );
+		m_prewarmed.erase( it );
+			// don't replace it right away, in case starters are
+			// failing as soon as they start
+		schedulePrewarm( 60 );
+		return true;
+	}
+	return false;
+}
@@ -49,8 +49,26 @@
 #include "Starter.h"
 #include "simplelist.h"
 
+#include <list>
+#include <set>
+
+
+	// A starter spawned ahead of time with -prewarm, which has read its
+	// config and is waiting for us to hand it a claim.
+struct PrewarmedStarter {
+	pid_t pid;
+	int slot_type;
+	std::string path;
+		// our end of its job ClassAd update socket, over which the
+		// handoff is sent
+	ReliSock *update_sock;
+		// our end of the unix domain socket on its stdin, over which
+		// the syscall sock is passed
+	int handoff_fd;
+};
+
 
-class StarterMgr {
+class StarterMgr : public Service {
 public:
 	StarterMgr();
 	~StarterMgr();
@@ -66,13 +84,45 @@ public:
 	void printStarterInfo( int debug_level );
 
 	bool haveStandardUni() const { return _haveStandardUni; }
+
+		/** Take a prewarmed starter of the given binary for the given
+			slot type out of the pool, if there is one.  The pool is
+			topped up again soon after.
+			@return false if there is none to take
+		*/
+	bool takePrewarmed( int slot_type, const char *path, PrewarmedStarter &ps );
+
+		// Get rid of a prewarmed starter that was taken but could not
+		// be handed its claim
+	void discardPrewarmed( PrewarmedStarter &ps );
+
+		// Tell every prewarmed starter in the pool to exit
+	void releasePrewarmed( void );
+
+		/** Called by the reaper for every starter that exits.
+			@return true if it was a prewarmed starter that was never
+			handed a claim, which needs no further handling
+		*/
+	bool prewarmedStarterExited( pid_t pid );
+
 private:
 
 	Starter* registerStarter( const char* path );
 
+		// Timer handler that spawns prewarmed starters until there
+		// are PREWARMED_STARTERS of them for each slot type in use
+	void prewarm( void );
+	void schedulePrewarm( int delay );
+	bool spawnPrewarmed( int slot_type, const char *path );
+
 	SimpleList<Starter*> starters;
 	bool _haveStandardUni;
 
+	std::list<PrewarmedStarter> m_prewarmed;
+		// released or discarded, but not yet reaped
+	std::set<pid_t> m_prewarmed_released;
+	int m_prewarm_tid;
+
         // This makes this class un-copy-able:
     StarterMgr( const StarterMgr& );
     StarterMgr& operator = ( const StarterMgr& );
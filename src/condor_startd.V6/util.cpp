@@ -333,7 +333,7 @@ bool retry_cleanup_execute_dir(const std::string & path, int /*options*/, int &
 }
 
 void
-cleanup_execute_dir(int pid, char const *exec_path, bool remove_exec_subdir)
+cleanup_execute_dir(int pid, char const *exec_path, bool remove_exec_subdir, long long disk_kb)
 {
 	ASSERT( pid );
 
@@ -380,6 +380,13 @@ cleanup_execute_dir(int pid, char const *exec_path, bool remove_exec_subdir)
 
 	check_recovery_file( pid_dir_path.c_str());
 
+		// If we can, leave the sandbox to be deleted in the background,
+		// so that the slot is free to run another job right away.
+	if ( ! remove_exec_subdir &&
+		 resmgr->execute_cleanup.trash( exec_path, pid_dir.c_str(), disk_kb ) ) {
+		return;
+	}
+
 	// Instantiate a directory object pointing at the execute directory
 	MyString dirbuf;
 	pair_strings_vector root_dirs = root_dir_list();
@@ -55,6 +55,7 @@
 #include "starter_util.h"
 #include "condor_random_num.h"
 #include "data_reuse.h"
+#include "utc_time.h"
 
 extern void main_shutdown_fast();
 
@@ -91,6 +92,8 @@ CStarter::CStarter()
 	m_all_jobs_done = false;
 	m_deferred_job_update = false;
 	m_shutdown_exit_code = STARTER_EXIT_NORMAL;
+	m_startup_begin = 0;
+	m_startup_last = 0;
 }
 
 
@@ -1957,6 +1960,7 @@ CStarter::createTempExecuteDir( void )
 	}
 	dprintf( D_FULLDEBUG, "Done moving to directory \"%s\"\n", WorkingDir.Value() );
 	set_priv( priv );
+	startupPhaseDone( ATTR_STARTER_SANDBOX_DURATION );
 	return true;
 }
 
@@ -1970,6 +1974,8 @@ CStarter::createTempExecuteDir( void )
 int
 CStarter::jobEnvironmentReady( void )
 {
+	startupPhaseDone( ATTR_STARTER_ENVIRONMENT_DURATION );
+
 #if defined(LINUX)
 		//
 		// For the GLEXEC_JOB case, we should now be able to
@@ -2473,6 +2479,16 @@ CStarter::SpawnJob( void )
 			free( tool_daemon_name );
 		}
 
+		startupPhaseDone( ATTR_STARTER_SPAWN_DURATION );
+		if( m_startup_begin > 0 ) {
+			double total = m_startup_last - m_startup_begin;
+			m_startup_timing.Assign( ATTR_STARTER_STARTUP_DURATION, total );
+			dprintf( D_ALWAYS, "Job started %.3f seconds after the starter %s\n",
+					 total, m_startup_timing.Lookup(ATTR_STARTER_PREWARMED) ?
+					 "was handed the claim" : "started" );
+			m_startup_begin = 0;
+		}
+
 			// let our JobInfoCommunicator know the job was started.
 		jic->allJobsSpawned();
 		return TRUE;
@@ -3052,10 +3068,40 @@ CStarter::publishJobInfoAd(List<UserProc>* proc_list, ClassAd* ad)
 	if( post_script && post_script->PublishUpdateAd(ad) ) {
 		found_one = true;
 	}
+	ad->Update( m_startup_timing );
+	if( m_reuse_dir ) {
+		m_reuse_dir->PublishSandboxStats( *ad );
+	}
 	return found_one;
 }
 
 
+void
+CStarter::startupBegin( double when, bool prewarmed )
+{
+	m_startup_begin = when;
+	m_startup_last = when;
+	m_startup_timing.Clear();
+	if( prewarmed ) {
+		m_startup_timing.Assign( ATTR_STARTER_PREWARMED, true );
+	}
+}
+
+
+void
+CStarter::startupPhaseDone( const char *attr )
+{
+		// Only the first time through each phase counts; a job that
+		// is restarted in this starter has already been timed.
+	if( m_startup_begin <= 0 || m_startup_timing.Lookup(attr) ) {
+		return;
+	}
+	double now = condor_gettimestamp_double();
+	m_startup_timing.Assign( attr, now - m_startup_last );
+	m_startup_last = now;
+}
+
+
 bool
 CStarter::publishPreScriptUpdateAd( ClassAd* ad )
 {
@@ -3673,6 +3719,14 @@ CStarter::removeTempExecuteDir( void )
 
 	bool has_failed = false;
 
+	// If the startd deletes sandboxes in the background, just move ours
+	// into its trash directory (EXECUTE_TRASH_DIR), so that
+	// we can exit and free up the slot without waiting.
+	bool use_trash = false;
+#if !defined(WIN32)
+	use_trash = param_integer( "EXECUTE_CLEANUP_THREADS", 0 ) > 0;
+#endif
+
 	// since we chdir()'d to the execute directory, we can't
 	// delete it until we get out (at least on WIN32). So lets
 	// just chdir() to EXECUTE so we're sure we can remove it.
@@ -3697,6 +3751,21 @@ CStarter::removeTempExecuteDir( void )
 				continue;
 			}
 		}
+		if ( use_trash ) {
+			MyString sandbox, trash_dir, trashed;
+			dircat( full_exec_dir.Value(), dir_name.Value(), sandbox );
+			dircat( full_exec_dir.Value(), EXECUTE_TRASH_DIR, trash_dir );
+			dircat( trash_dir.Value(), dir_name.Value(), trashed );
+			TemporaryPrivSentry sentry( PRIV_ROOT );
+			if ( rename( sandbox.Value(), trashed.Value() ) == 0 ) {
+				dprintf( D_FULLDEBUG, "Moved %s to %s\n", sandbox.Value(), trashed.Value() );
+				continue;
+			}
+			if ( errno != ENOENT ) {
+				dprintf( D_FULLDEBUG, "Failed to move %s to %s (%s), removing it\n",
+					sandbox.Value(), trashed.Value(), strerror(errno) );
+			}
+		}
 		Directory execute_dir( full_exec_dir.Value(), PRIV_ROOT );
 		if ( execute_dir.Find_Named_Entry( dir_name.Value() ) ) {
 
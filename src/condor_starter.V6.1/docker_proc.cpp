@@ -93,6 +93,7 @@ DockerProc::~DockerProc() {
 	if ( daemonCore && daemonCore->SocketIsRegistered(&listener)) {
 		daemonCore->Cancel_Socket(&listener);
 	}
+	DockerAPI::stopStats( containerName );
 }
 
 int DockerProc::StartJob() {
@@ -65,7 +65,7 @@ const char* CHIRP_CONFIG_FILENAME = ".chirp.config";
 #	define file_remove remove
 #endif
 
-JICShadow::JICShadow( const char* shadow_name ) : JobInfoCommunicator(),
+JICShadow::JICShadow( const char* shadow_name, ReliSock *handoff_syscall_sock ) : JobInfoCommunicator(),
 	m_wrote_chirp_config(false), m_job_update_attrs_set(false)
 {
 	if( ! shadow_name ) {
@@ -76,6 +76,9 @@ JICShadow::JICShadow( const char* shadow_name ) : JobInfoCommunicator(),
 	shadow = NULL;
 	shadow_version = NULL;
 	filetrans = NULL;
+	m_input_transfer_retries = 0;
+	m_resume_input_on_reconnect = false;
+	m_resume_input_tid = -1;
 	m_did_transfer = false;
 	m_filetrans_sec_session = NULL;
 	m_reconnect_sec_session = NULL;
@@ -107,14 +110,19 @@ JICShadow::JICShadow( const char* shadow_name ) : JobInfoCommunicator(),
 	m_job_startd_update_sock = socks[0];
 	socks++;
 
-	if (socks[0] == NULL || 
-		socks[0]->type() != Stream::reli_sock) 
-	{
-		dprintf(D_ALWAYS, "Failed to inherit remote system call socket.\n");
-		Starter->StarterExit( STARTER_EXIT_GENERAL_FAILURE );
+		// a prewarmed starter is handed the syscall sock after it starts
+	if( handoff_syscall_sock ) {
+		syscall_sock = handoff_syscall_sock;
+	} else {
+		if (socks[0] == NULL || 
+			socks[0]->type() != Stream::reli_sock) 
+		{
+			dprintf(D_ALWAYS, "Failed to inherit remote system call socket.\n");
+			Starter->StarterExit( STARTER_EXIT_GENERAL_FAILURE );
+		}
+		syscall_sock = (ReliSock *)socks[0];
+		socks++;
 	}
-	syscall_sock = (ReliSock *)socks[0];
-	socks++;
 
 	m_proxy_expiration_tid = -1;
 	m_refresh_sandbox_creds_tid = -1;
@@ -137,6 +145,9 @@ JICShadow::~JICShadow()
 	if( m_proxy_expiration_tid != -1 ){
 		daemonCore->Cancel_Timer(m_proxy_expiration_tid);
 	}
+	if( m_resume_input_tid != -1 ){
+		daemonCore->Cancel_Timer(m_resume_input_tid);
+	}
 	if( shadow ) {
 		delete shadow;
 	}
@@ -171,6 +182,7 @@ JICShadow::init( void )
 				 "Failed to get job ad from shadow!\n" );
 		return false;
 	}
+	Starter->startupPhaseDone( ATTR_STARTER_JOB_AD_DURATION );
 
 	if ( m_job_startd_update_sock )
 	{
@@ -476,6 +488,7 @@ JICShadow::transferOutput( bool &transient_failure )
 		filetrans->addFileToExceptionList(".docker_stderr");
 		filetrans->addFileToExceptionList(".update.ad");
 		filetrans->addFileToExceptionList(".update.ad.tmp");
+		filetrans->addFileToExceptionList(TransferProgressFileName);
 		if (m_wrote_chirp_config) {
 			filetrans->addFileToExceptionList(CHIRP_CONFIG_FILENAME);
 		}
@@ -774,6 +787,14 @@ JICShadow::reconnect( ReliSock* s, ClassAd* ad )
 
 	StreamHandler::ReconnectAll();
 
+	if( m_resume_input_on_reconnect && m_resume_input_tid == -1 ) {
+		m_resume_input_tid = daemonCore->Register_Timer(
+				0,
+				(TimerHandlercpp)&JICShadow::resumeInputTransfer,
+				"resumeInputTransfer",
+				this );
+	}
+
 	if( job_cleanup_disconnected ) {
 			/*
 			  if we were trying to cleanup our job and we noticed we
@@ -2507,6 +2528,9 @@ JICShadow::transferCompleted( FileTransfer *ftrans )
 			// to do.
 		FileTransfer::FileTransferInfo ft_info = ftrans->GetInfo();
 		if ( !ft_info.success ) {
+			if( ft_info.try_again && retryInputTransfer() ) {
+				return TRUE;
+			}
 			if(!ft_info.try_again) {
 					// Put the job on hold.
 				ASSERT(ft_info.hold_code != 0);
@@ -2559,6 +2583,54 @@ JICShadow::transferCompleted( FileTransfer *ftrans )
 }
 
 
+bool
+JICShadow::retryInputTransfer( void )
+{
+	int max_retries = param_integer( "STARTER_INPUT_TRANSFER_RETRIES", 3, 0 );
+	if( m_input_transfer_retries >= max_retries ) {
+		return false;
+	}
+	m_input_transfer_retries++;
+
+	if( shadowDisconnected() ) {
+		dprintf( D_ALWAYS, "Input transfer failed while disconnected from the "
+				 "shadow; will resume it when the shadow reconnects.\n" );
+		m_resume_input_on_reconnect = true;
+		return true;
+	}
+
+	dprintf( D_ALWAYS, "Input transfer failed; resuming it (retry %d of %d).\n",
+			 m_input_transfer_retries, max_retries );
+	m_resume_input_tid = daemonCore->Register_Timer(
+			param_integer( "STARTER_INPUT_TRANSFER_RETRY_DELAY", 10, 0 ),
+			(TimerHandlercpp)&JICShadow::resumeInputTransfer,
+			"resumeInputTransfer",
+			this );
+	return true;
+}
+
+void
+JICShadow::resumeInputTransfer( void )
+{
+	m_resume_input_tid = -1;
+	m_resume_input_on_reconnect = false;
+
+		// The transfer socket may have broken before the syscall socket
+		// did; if so, wait for the shadow to come back.
+	if( shadowDisconnected() ) {
+		m_resume_input_on_reconnect = true;
+		return;
+	}
+
+	if( ! filetrans->DownloadFiles(false) ) {
+		dprintf( D_ALWAYS, "Could not restart input transfer: %s\n",
+				 filetrans->GetInfo().error_desc.Value() );
+		if( ! retryInputTransfer() ) {
+			EXCEPT( "Could not initiate file transfer" );
+		}
+	}
+}
+
 bool
 JICShadow::getJobAdFromShadow( void )
 {
@@ -36,8 +36,12 @@
 class JICShadow : public JobInfoCommunicator
 {
 public:
-		/// Constructor
-	JICShadow( const char* shadow_name );
+		/** Constructor
+			@param shadow_name Address of the shadow
+			@param handoff_syscall_sock Syscall sock handed to a
+			prewarmed starter, otherwise NULL to inherit it
+		*/
+	JICShadow( const char* shadow_name, ReliSock *handoff_syscall_sock = NULL );
 
 		/// Destructor
 	~JICShadow();
@@ -295,6 +299,16 @@ private:
 		/// Callback for when the FileTransfer object is done
 	int transferCompleted(FileTransfer *);
 
+		/** After a transient failure to receive the input sandbox,
+			arrange to try again, now or once the shadow reconnects.
+			The retry resumes files from where they left off.
+			@return false if out of retries
+		*/
+	bool retryInputTransfer( void );
+
+		/// Start another attempt at receiving the input sandbox
+	void resumeInputTransfer( void );
+
 		/// Do the RSC to get the job classad from the shadow
 	bool getJobAdFromShadow( void );
 
@@ -474,6 +488,9 @@ private:
 	IOProxy io_proxy;
 
 	FileTransfer *filetrans;
+	int m_input_transfer_retries;
+	bool m_resume_input_on_reconnect;
+	int m_resume_input_tid;
 	bool m_ft_rval;
 	FileTransfer::FileTransferInfo m_ft_info;
 	bool m_did_transfer;
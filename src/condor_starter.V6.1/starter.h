@@ -302,6 +302,20 @@ public:
 	htcondor::DataReuseDirectory * getDataReuseDirectory() const {return m_reuse_dir.get();}
 
 	void SetJobEnvironmentReady(const bool isReady) {m_job_environment_is_ready = isReady;}
+
+		/** Start timing how long it takes to get the job going.
+			@param when Time the starter process started, or, for a
+			prewarmed starter, when the startd handed it a claim
+			@param prewarmed Was this starter waiting in the startd's
+			pool of prewarmed starters?
+		*/
+	void startupBegin( double when, bool prewarmed );
+
+		/** Record the seconds since the previous startup phase ended
+			in the given attribute.  The attributes are published in
+			our update ads, so they end up in the job ad.
+		*/
+	void startupPhaseDone( const char *attr );
 protected:
 	List<UserProc> m_job_list;
 	List<UserProc> m_reaped_job_list;
@@ -408,6 +422,12 @@ private:
 
 		// Manage the data reuse directory.
 	std::unique_ptr<htcondor::DataReuseDirectory> m_reuse_dir;
+
+		// Durations of the phases of starting the job, see
+		// startupPhaseDone()
+	ClassAd m_startup_timing;
+	double m_startup_begin;
+	double m_startup_last;
 };
 
 #endif
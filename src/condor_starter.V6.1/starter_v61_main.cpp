@@ -39,10 +39,18 @@
 #include "docker_proc.h"
 #include "condor_getcwd.h"
 #include "singularity.h"
+#include "utc_time.h"
+#include "setenv.h"
+#include "env.h"
+#if !defined(WIN32)
+#include "fdpass.h"
+#endif
 
 
 extern "C" int exception_cleanup(int,int,const char*);	/* Our function called by EXCEPT */
 JobInfoCommunicator* parseArgs( int argc, char* argv [] );
+static void initStarter( int argc, char *argv[] );
+static void waitForHandoff();
 
 static CStarter StarterObj;
 CStarter *Starter = &StarterObj;
@@ -61,6 +69,16 @@ static int starter_stdin_fd = -1;
 static int starter_stdout_fd = -1;
 static int starter_stderr_fd = -1;
 
+	// When we started, for timing how long it takes to get the job going
+static double starter_start_time = 0;
+
+	// Set while a prewarmed starter waits for the startd to hand it a
+	// claim; see handlePrewarmHandoff()
+static bool waiting_for_handoff = false;
+static ReliSock *handoff_syscall_sock = NULL;
+static ArgList handoff_args;
+static char **handoff_argv = NULL;
+
 [[noreturn]]
 static void PREFAST_NORETURN
 usage()
@@ -200,6 +218,8 @@ static char* orig_cwd = NULL;
 void
 main_pre_dc_init( int argc, char* argv[] )
 {	
+	starter_start_time = condor_gettimestamp_double();
+
 		// figure out what get_mySubSystem() should be based on argv[0], or
 		// if we see "-gridshell" anywhere on the command-line
 	const char* base = condor_basename(argv[0]);
@@ -298,6 +318,19 @@ main_init(int argc, char *argv[])
 	// register a cleanup routine to kill our kids in case we EXCEPT
 	_EXCEPT_Cleanup = exception_cleanup;
 
+	if( argc == 2 && strcmp(argv[1], "-prewarm") == MATCH ) {
+		waitForHandoff();
+		return;
+	}
+
+	Starter->startupBegin( starter_start_time, false );
+	initStarter( argc, argv );
+}
+
+
+static void
+initStarter( int argc, char *argv[] )
+{
 	JobInfoCommunicator* jic = NULL;
 
 		// now, based on the command line args, figure out what kind
@@ -313,6 +346,8 @@ main_init(int argc, char *argv[])
 		usage();
 	}
 
+	Starter->startupPhaseDone( ATTR_STARTER_INIT_DURATION );
+
 	if( !Starter->Init(jic, orig_cwd, is_gridshell, starter_stdin_fd,
 					   starter_stdout_fd, starter_stderr_fd) ) {
 		dprintf(D_ALWAYS, "Unable to start job.\n");
@@ -321,6 +356,136 @@ main_init(int argc, char *argv[])
 }
 
 
+/*
+  A prewarmed starter is spawned by the startd with "-prewarm" and no
+  claim, and waits here, with daemon core up and the config read, for
+  the startd to hand it one.  The handoff comes over the job ClassAd
+  update socket we inherited: an ad with the arguments and environment
+  the startd would have spawned us with, and the serialized state of
+  the shadow's syscall sock.  The descriptor of that sock comes over
+  the unix domain socket on our stdin.  If the startd closes the update
+  socket instead, it has shrunk its pool, and we just exit.
+*/
+static int
+handlePrewarmHandoff( Service *, Stream *stream )
+{
+	double handoff_time = condor_gettimestamp_double();
+	ClassAd handoff;
+
+	stream->decode();
+	if( !getClassAd(stream, handoff) || !stream->end_of_message() ) {
+		dprintf( D_ALWAYS, "Released by the startd without a claim, exiting.\n" );
+		DC_Exit( 0 );
+	}
+	daemonCore->Cancel_Socket( stream );
+	waiting_for_handoff = false;
+	Starter->startupBegin( handoff_time, true );
+
+	std::string args_str, env_str, sock_state;
+	handoff.LookupString( ATTR_JOB_ARGUMENTS2, args_str );
+	handoff.LookupString( ATTR_JOB_ENVIRONMENT2, env_str );
+	handoff.LookupString( "SyscallSock", sock_state );
+
+	int fd = -1;
+#if !defined(WIN32)
+	fd = fdpass_recv( starter_stdin_fd );
+	close( starter_stdin_fd );
+	int null_fd = safe_open_wrapper_follow( NULL_FILE, O_RDONLY );
+	if( null_fd >= 0 ) {
+		dup2( null_fd, 0 );
+		close( null_fd );
+	}
+	starter_stdin_fd = dup( 0 );
+#endif
+	size_t state_pos = sock_state.find( '*' );
+	if( fd < 0 || state_pos == std::string::npos ) {
+		dprintf( D_ALWAYS, "ERROR: Failed to receive the syscall sock from the startd\n" );
+		DC_Exit( STARTER_EXIT_GENERAL_FAILURE );
+	}
+		// the serialized state starts with the startd's descriptor
+	sock_state.replace( 0, state_pos, std::to_string(fd) );
+	handoff_syscall_sock = new ReliSock();
+	handoff_syscall_sock->serialize( sock_state.c_str() );
+
+		// The environment carries config overrides such as EXECUTE,
+		// which we would have read at startup if the startd had
+		// spawned us for this claim.
+	Env env;
+	MyString error_msg;
+	if( !env.MergeFromV2Raw(env_str.c_str(), &error_msg) ) {
+		dprintf( D_ALWAYS, "ERROR: Invalid environment from startd: %s\n",
+				 error_msg.Value() );
+		DC_Exit( STARTER_EXIT_GENERAL_FAILURE );
+	}
+	char **env_array = env.getStringArray();
+	for( int i = 0; env_array[i]; i++ ) {
+		char *eq = strchr( env_array[i], '=' );
+		if( !eq ) {
+			continue;
+		}
+		*eq = '\0';
+		SetEnv( env_array[i], eq + 1 );
+		if( strncasecmp(env_array[i], "_condor_", 8) == MATCH && env_array[i][8] ) {
+			config_insert( env_array[i] + 8, eq + 1 );
+		}
+	}
+	deleteStringArray( env_array );
+
+		// Strip the daemon core options, which daemon core would have
+		// handled for a starter spawned the usual way.  We already have
+		// the local name, since prewarmed starters are per slot type.
+	ArgList args;
+	if( !args.AppendArgsV2Raw(args_str.c_str(), &error_msg) || args.Count() < 1 ) {
+		dprintf( D_ALWAYS, "ERROR: Invalid arguments from startd: %s\n",
+				 error_msg.Value() );
+		DC_Exit( STARTER_EXIT_GENERAL_FAILURE );
+	}
+	handoff_args.AppendArg( args.GetArg(0) );
+	for( int i = 1; i < args.Count(); i++ ) {
+		char const *arg = args.GetArg( i );
+		if( strcmp(arg, "-f") == MATCH ) {
+			continue;
+		}
+		if( strcmp(arg, "-local-name") == MATCH && i+1 < args.Count() ) {
+			i++;
+			continue;
+		}
+		if( strcmp(arg, "-a") == MATCH && i+1 < args.Count() ) {
+			DC_Set_Log_Append( args.GetArg(++i) );
+			continue;
+		}
+		handoff_args.AppendArg( arg );
+	}
+
+	MyString display;
+	handoff_args.GetArgsStringForDisplay( &display );
+	dprintf( D_ALWAYS, "Prewarmed starter handed a claim: %s\n", display.Value() );
+
+	handoff_argv = handoff_args.GetStringArray();
+	my_argc = handoff_args.Count();
+	my_argv = handoff_argv;
+	initStarter( my_argc, my_argv );
+	return KEEP_STREAM;
+}
+
+
+static void
+waitForHandoff()
+{
+	Stream **socks = daemonCore->GetInheritedSocks();
+	if( socks[0] == NULL || socks[0]->type() != Stream::reli_sock ) {
+		dprintf( D_ALWAYS, "ERROR: Prewarmed starter did not inherit the update socket\n" );
+		DC_Exit( STARTER_EXIT_GENERAL_FAILURE );
+	}
+	if( daemonCore->Register_Socket(socks[0], "startd handoff socket",
+			handlePrewarmHandoff, "handlePrewarmHandoff") < 0 ) {
+		EXCEPT( "Failed to register the startd handoff socket" );
+	}
+	waiting_for_handoff = true;
+	dprintf( D_ALWAYS, "Prewarmed starter waiting for a claim from the startd\n" );
+}
+
+
 void
 invalid( char* opt )
 {
@@ -672,7 +837,7 @@ parseArgs( int argc, char* argv [] )
 					 "shadow host\n", _jobinputad );
 			usage();
 		}
-		jic = new JICShadow( shadow_host );
+		jic = new JICShadow( shadow_host, handoff_syscall_sock );
 		free( shadow_host );
 		shadow_host = NULL;
 		free( schedd_addr );
@@ -746,6 +911,9 @@ parseArgs( int argc, char* argv [] )
 void
 main_config()
 {
+	if( waiting_for_handoff ) {
+		return;
+	}
 	Starter->Config();
 }
 
@@ -753,6 +921,9 @@ main_config()
 void
 main_shutdown_fast()
 {
+	if( waiting_for_handoff ) {
+		DC_Exit( 0 );
+	}
 	if ( Starter->RemoteShutdownFast(0) ) {
 		// ShutdownFast says it is already finished, because there are
 		// no jobs to shutdown.  No need to stick around.
@@ -764,6 +935,9 @@ main_shutdown_fast()
 void
 main_shutdown_graceful()
 {
+	if( waiting_for_handoff ) {
+		DC_Exit( 0 );
+	}
 	if ( Starter->RemoteShutdownGraceful(0) ) {
 		// ShutdownGraceful says it is already finished, because
 		// there are no jobs to shutdown.  No need to stick around.
@@ -775,6 +949,10 @@ extern "C"
 int exception_cleanup(int,int,const char*errmsg)
 {
 	_EXCEPT_Cleanup = NULL;
+	if( ! Starter->jic ) {
+			// a prewarmed starter that was never handed a claim
+		return 0;
+	}
 	Starter->jic->notifyStarterError(errmsg,true,0,0);
 	Starter->RemoteShutdownFast(0);
 	Starter->FinalCleanup();
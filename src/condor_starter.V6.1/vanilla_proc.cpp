@@ -143,6 +143,12 @@ VanillaProc::VanillaProc(ClassAd* jobAd) : OsProc(jobAd),
 	m_oom_fd(-1),
 	m_oom_efd(-1),
 	m_oom_efd2(-1),
+	m_pressure_fd(-1),
+	m_pressure_efd(-1),
+	m_pressure_efd2(-1),
+	m_last_pressure_update(0),
+	m_pressure_events(0),
+	m_last_pressure_event(0),
 	isCheckpointing(false),
 	isSoftKilling(false)
 {
@@ -155,6 +161,7 @@ VanillaProc::VanillaProc(ClassAd* jobAd) : OsProc(jobAd),
 VanillaProc::~VanillaProc()
 {
 	cleanupOOM();
+	cleanupMemoryPressure();
 }
 
 int
@@ -715,6 +722,7 @@ VanillaProc::StartJob()
 			dprintf(D_FULLDEBUG, "Invalid value of Cpus in machine ClassAd; ignoring.\n");
 		}
 		setupOOMEvent(cgroup);
+		setupMemoryPressureEvent(cgroup);
 	}
 
     m_statistics.Reconfig();
@@ -799,6 +807,11 @@ VanillaProc::PublishUpdateAd( ClassAd* ad )
 		ad->Assign(ATTR_IO_WAIT, usage->io_wait);
 	}
 
+	if (m_pressure_events > 0) {
+		ad->Assign(ATTR_MEMORY_PRESSURE_EVENTS, m_pressure_events);
+		ad->Assign(ATTR_LAST_MEMORY_PRESSURE_DATE, m_last_pressure_event);
+	}
+
 
 		// Update our knowledge of how many processes the job has
 	num_pids = usage->num_procs;
@@ -1089,6 +1102,7 @@ VanillaProc::finishShutdownFast()
 
 	if (m_oom_efd != -1) {dprintf(D_FULLDEBUG, "Closing event FD pipe in shutdown %d.\n", m_oom_efd);}
 	cleanupOOM();
+	cleanupMemoryPressure();
 
 	return false;	// shutdown is pending, so return false
 }
@@ -1191,6 +1205,181 @@ VanillaProc::outOfMemoryEvent(int /* fd */)
 	return 0;
 }
 
+/*
+ * Clean up any file descriptors associated with memory pressure notification.
+ */
+void
+VanillaProc::cleanupMemoryPressure()
+{
+	if (m_pressure_efd != -1)
+	{
+		daemonCore->Close_Pipe(m_pressure_efd);
+		daemonCore->Close_Pipe(m_pressure_efd2);
+		m_pressure_efd = -1;
+		m_pressure_efd2 = -1;
+	}
+	if (m_pressure_fd != -1)
+	{
+		close(m_pressure_fd);
+		m_pressure_fd = -1;
+	}
+}
+
+/*
+ * This will be called when the job's memory cgroup reports pressure at
+ * or above STARTER_MEMORY_PRESSURE_LEVEL.
+ */
+int
+VanillaProc::memoryPressureEvent(int /* fd */)
+{
+	int efd = -1;
+	if (m_pressure_efd == -1 || !daemonCore->Get_Pipe_FD(m_pressure_efd, &efd) || efd == -1) {
+		return 0;
+	}
+		// drain the notification fd, or it stays hot
+	uint64_t events = 0;
+	if (read(efd, &events, sizeof(events)) != sizeof(events)) {
+		return 0;
+	}
+
+	// As with the OOM event, the notification also fires when the
+	// cgroup is removed at the end of the job.
+	if (num_pids == 0) {
+		dprintf(D_FULLDEBUG, "Closing memory pressure event FD pipe %d.\n", m_pressure_efd);
+		cleanupMemoryPressure();
+		return 0;
+	}
+
+	time_t now = time(NULL);
+	m_pressure_events += (int)events;
+	m_last_pressure_event = now;
+
+	// Pressure can be reported many times a second while it lasts;
+	// one update every few seconds is plenty for the startd's policy.
+	const time_t min_pressure_update_interval = 10;
+	if (now - m_last_pressure_update < min_pressure_update_interval) {
+		return 0;
+	}
+	m_last_pressure_update = now;
+
+	dprintf(D_FULLDEBUG, "Job's memory cgroup is under memory pressure; sending an update now.\n");
+	Starter->jic->periodicJobUpdate();
+	return 0;
+}
+
+/*
+ * Subscribe to the job memory cgroup's memory.pressure_level, so that
+ * memory trouble reaches the startd and shadow as it happens rather
+ * than at the next periodic update.
+ */
+int
+VanillaProc::setupMemoryPressureEvent(const std::string &cgroup_string)
+{
+#if !(defined(HAVE_EVENTFD) && defined(HAVE_EXT_LIBCGROUP))
+	// Shut the compiler up.
+	cgroup_string.size();
+	return 0;
+#else
+	std::string level;
+	param(level, "STARTER_MEMORY_PRESSURE_LEVEL", "medium");
+	lower_case(level);
+	if (level.empty() || level == "none") {
+		return 0;
+	}
+	if (level != "low" && level != "medium" && level != "critical") {
+		dprintf(D_ALWAYS, "Ignoring invalid STARTER_MEMORY_PRESSURE_LEVEL %s; "
+			"it must be low, medium, critical or none.\n", level.c_str());
+		return 1;
+	}
+
+	char *mount_point = NULL;
+	int err = cgroup_get_subsys_mount_point(MEMORY_CONTROLLER_STR, &mount_point);
+	if (err || !mount_point) {
+		dprintf(D_FULLDEBUG,
+			"Memcg is not available; memory pressure notification disabled for starter.\n");
+		return 1;
+	}
+	std::string memcg_dir = mount_point;
+	free(mount_point);
+	memcg_dir += "/";
+	memcg_dir += cgroup_string;
+	std::string pressure_level_str = memcg_dir + "/memory.pressure_level";
+	std::string event_control_str = memcg_dir + "/cgroup.event_control";
+
+	int tmp_efd = eventfd(0, EFD_CLOEXEC);
+	if (tmp_efd == -1) {
+		dprintf(D_ALWAYS,
+			"Unable to create new event FD for starter: %u %s\n",
+			errno, strerror(errno));
+		return 1;
+	}
+
+	TemporaryPrivSentry sentry(PRIV_ROOT);
+	m_pressure_fd = open(pressure_level_str.c_str(), O_RDONLY | O_CLOEXEC);
+	if (m_pressure_fd == -1) {
+		// older kernels have no memory.pressure_level
+		dprintf(D_FULLDEBUG,
+			"Unable to open %s; memory pressure notification disabled for starter: %u %s\n",
+			pressure_level_str.c_str(), errno, strerror(errno));
+		close(tmp_efd);
+		return 1;
+	}
+	int event_ctrl_fd = open(event_control_str.c_str(), O_WRONLY | O_CLOEXEC);
+	if (event_ctrl_fd == -1) {
+		dprintf(D_ALWAYS,
+			"Unable to open event control for starter: %u %s\n",
+			errno, strerror(errno));
+		close(tmp_efd);
+		cleanupMemoryPressure();
+		return 1;
+	}
+
+	std::string sub_str;
+	formatstr(sub_str, "%d %d %s", tmp_efd, m_pressure_fd, level.c_str());
+	if (full_write(event_ctrl_fd, sub_str.c_str(), sub_str.size()) < 0) {
+		dprintf(D_ALWAYS,
+			"Unable to write into event control file for starter: %u %s\n",
+			errno, strerror(errno));
+		close(event_ctrl_fd);
+		close(tmp_efd);
+		cleanupMemoryPressure();
+		return 1;
+	}
+	close(event_ctrl_fd);
+
+	// Fool DC into talking to the eventfd, as for the OOM event
+	int pipes[2]; pipes[0] = -1; pipes[1] = -1;
+	int fd_to_replace = -1;
+	if (!daemonCore->Create_Pipe(pipes, true) || pipes[0] == -1) {
+		dprintf(D_ALWAYS, "Unable to create a DC pipe\n");
+		close(tmp_efd);
+		cleanupMemoryPressure();
+		return 1;
+	}
+	if (!daemonCore->Get_Pipe_FD(pipes[0], &fd_to_replace) || fd_to_replace == -1) {
+		dprintf(D_ALWAYS, "Unable to lookup pipe's FD\n");
+		close(tmp_efd);
+		daemonCore->Close_Pipe(pipes[0]);
+		daemonCore->Close_Pipe(pipes[1]);
+		cleanupMemoryPressure();
+		return 1;
+	}
+	dup3(tmp_efd, fd_to_replace, O_CLOEXEC);
+	close(tmp_efd);
+	m_pressure_efd = pipes[0];
+	m_pressure_efd2 = pipes[1];
+
+	if (-1 == daemonCore->Register_Pipe(pipes[0], "memory pressure event fd", static_cast<PipeHandlercpp>(&VanillaProc::memoryPressureEvent), "Memory Pressure Event Handler", this, HANDLE_READ))
+	{
+		dprintf(D_ALWAYS, "Failed to register memory pressure event FD pipe.\n");
+		cleanupMemoryPressure();
+		return 1;
+	}
+	dprintf(D_FULLDEBUG, "Subscribed the starter to %s memory pressure notification for this cgroup.\n", level.c_str());
+	return 0;
+#endif
+}
+
 int
 VanillaProc::setupOOMScore(int oom_adj, int oom_score_adj)
 {
@@ -133,6 +133,18 @@ private:
 	int outOfMemoryEvent(int fd);
 	int setupOOMEvent(const std::string & cgroup_string);
 
+	// Memory pressure notification for the job's cgroup, which sends
+	// the startd and shadow an update ahead of the periodic one.
+	int m_pressure_fd; // memory.pressure_level
+	int m_pressure_efd; // The event FD "pipe" to watch
+	int m_pressure_efd2; // The other end of m_pressure_efd.
+	time_t m_last_pressure_update;
+	int m_pressure_events; // published as MemoryPressureEvents
+	time_t m_last_pressure_event;
+	void cleanupMemoryPressure();
+	int memoryPressureEvent(int fd);
+	int setupMemoryPressureEvent(const std::string & cgroup_string);
+
 	std::string m_pid_ns_status_filename;
 
 	// Internal helper functions.
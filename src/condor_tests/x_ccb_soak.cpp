@@ -0,0 +1,189 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/*
+ * Register many simulated CCB listeners with a CCB server (the
+ * collector) and keep them heartbeating, to see how the server copes
+ * with lots of targets.  Each listener is a bare ReliSock speaking the
+ * same messages as CCBListener.
+ *
+ *   x_ccb_soak.exe [-pool <host>] [-count <listeners>] [-rounds <n>]
+ *
+ * The lib_ccb_soak test runs a few thousand.  For a soak of 100000,
+ * raise the hard limit on open files for this tool and the collector,
+ * set COLLECTOR_MAX_FILE_DESCRIPTORS to match, and run with
+ * -count 100000.
+ */
+
+#include "condor_common.h"
+#include "condor_config.h"
+#include "condor_debug.h"
+#include "condor_distribution.h"
+#include "condor_attributes.h"
+#include "condor_commands.h"
+#include "daemon.h"
+#include "reli_sock.h"
+#include "utc_time.h"
+
+static void
+usage( char const *name )
+{
+	fprintf( stderr, "Usage: %s [-pool <host>] [-count <listeners>] [-rounds <heartbeat rounds>]\n", name );
+	exit( 1 );
+}
+
+static bool
+send_msg( ReliSock *sock, ClassAd &msg )
+{
+	sock->encode();
+	return putClassAd( sock, msg ) && sock->end_of_message();
+}
+
+static bool
+read_msg( ReliSock *sock, ClassAd &msg )
+{
+	sock->decode();
+	return getClassAd( sock, msg ) && sock->end_of_message();
+}
+
+static double
+rate( size_t n, double seconds )
+{
+	return seconds > 0 ? n / seconds : 0;
+}
+
+int
+main( int argc, char *argv[] )
+{
+	myDistro->Init( argc, argv );
+	set_priv_initialize();
+	config();
+	dprintf_config_tool_on_error(0);
+	dprintf_OnExitDumpOnErrorBuffer(stderr);
+
+	char const *pool = NULL;
+	int count = 1000;
+	int rounds = 3;
+	for( int i = 1; i < argc; i++ ) {
+		if( !strcmp(argv[i],"-pool") && i+1 < argc ) {
+			pool = argv[++i];
+		}
+		else if( !strcmp(argv[i],"-count") && i+1 < argc ) {
+			count = atoi(argv[++i]);
+		}
+		else if( !strcmp(argv[i],"-rounds") && i+1 < argc ) {
+			rounds = atoi(argv[++i]);
+		}
+		else {
+			usage( argv[0] );
+		}
+	}
+	if( count <= 0 || rounds < 0 ) {
+		usage( argv[0] );
+	}
+
+#ifndef WIN32
+		// one socket per listener
+	struct rlimit rl;
+	if( getrlimit(RLIMIT_NOFILE,&rl) == 0 && rl.rlim_cur < rl.rlim_max ) {
+		rl.rlim_cur = rl.rlim_max;
+		setrlimit(RLIMIT_NOFILE,&rl);
+	}
+#endif
+
+	Daemon ccb( DT_COLLECTOR, pool );
+	if( !ccb.locate() ) {
+		fprintf( stderr, "ERROR: %s\n", ccb.error() );
+		exit( 1 );
+	}
+
+	std::vector<ReliSock *> listeners;
+	listeners.reserve( count );
+	bool failed = false;
+
+	double start = condor_gettimestamp_double();
+	for( int i = 0; i < count; i++ ) {
+		CondorError errstack;
+		ReliSock *sock = (ReliSock *)ccb.startCommand( CCB_REGISTER, Stream::reli_sock, 20, &errstack );
+		if( !sock ) {
+			fprintf( stderr, "ERROR: listener %d failed to connect to %s: %s\n",
+					 i, ccb.addr(), errstack.getFullText().c_str() );
+			failed = true;
+			break;
+		}
+
+		ClassAd msg;
+		msg.Assign( ATTR_COMMAND, CCB_REGISTER );
+		std::string name;
+		formatstr( name, "x_ccb_soak listener %d", i );
+		msg.Assign( ATTR_NAME, name );
+
+		ClassAd reply;
+		std::string ccbid;
+		if( !send_msg(sock,msg) || !read_msg(sock,reply) ||
+			!reply.LookupString(ATTR_CCBID,ccbid) )
+		{
+			fprintf( stderr, "ERROR: listener %d failed to register with %s\n",
+					 i, ccb.addr() );
+			delete sock;
+			failed = true;
+			break;
+		}
+		listeners.push_back( sock );
+	}
+	double elapsed = condor_gettimestamp_double() - start;
+	printf( "Registered %d of %d listeners in %.2fs (%.0f/s)\n",
+			(int)listeners.size(), count, elapsed, rate(listeners.size(),elapsed) );
+
+		// Every listener heartbeats at once, then waits for the echo;
+		// this is the worst case for the server's per-target handling.
+	for( int round = 1; round <= rounds && !failed; round++ ) {
+		start = condor_gettimestamp_double();
+		for( size_t i = 0; i < listeners.size(); i++ ) {
+			ClassAd msg;
+			msg.Assign( ATTR_COMMAND, ALIVE );
+			if( !send_msg(listeners[i],msg) ) {
+				fprintf( stderr, "ERROR: listener %d failed to send heartbeat\n", (int)i );
+				failed = true;
+				break;
+			}
+		}
+		for( size_t i = 0; i < listeners.size() && !failed; i++ ) {
+			ClassAd reply;
+			int cmd = -1;
+			if( !read_msg(listeners[i],reply) ||
+				!reply.LookupInteger(ATTR_COMMAND,cmd) || cmd != ALIVE )
+			{
+				fprintf( stderr, "ERROR: listener %d got no heartbeat reply\n", (int)i );
+				failed = true;
+			}
+		}
+		elapsed = condor_gettimestamp_double() - start;
+		if( !failed ) {
+			printf( "Heartbeat round %d: %d listeners answered in %.2fs (%.0f/s)\n",
+					round, (int)listeners.size(), elapsed, rate(listeners.size(),elapsed) );
+		}
+	}
+
+	for( size_t i = 0; i < listeners.size(); i++ ) {
+		delete listeners[i];
+	}
+
+	return failed ? 1 : 0;
+}
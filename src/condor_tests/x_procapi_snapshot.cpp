@@ -0,0 +1,176 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/*
+ * Time ProcAPI::getProcInfoList(), the snapshot the procd takes of
+ * every process on the machine, against the number of processes.
+ * Forks the given number of idle children, times snapshots the old
+ * way, then again after ProcAPI::setIncrementalScan(), checking each
+ * time that every child was seen.  Between incremental snapshots some
+ * children are replaced, to check that new processes are found and
+ * old ones forgotten.
+ *
+ *   x_procapi_snapshot.exe [-procs <n>] [-snapshots <n>] [-events]
+ *
+ * -events also listens to the kernel's process connector, which needs
+ * root.  To see how the cost grows, run with -procs 1000, 10000 and so
+ * on; raise the limit on processes per user first.
+ */
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "procapi.h"
+#include "utc_time.h"
+
+#include <set>
+
+static std::set<pid_t> children;
+
+static void
+usage( char const *name )
+{
+	fprintf( stderr, "Usage: %s [-procs <n>] [-snapshots <n>] [-events]\n", name );
+	exit( 1 );
+}
+
+static bool
+add_child()
+{
+	pid_t pid = fork();
+	if( pid == -1 ) {
+		fprintf( stderr, "ERROR: fork failed: %s\n", strerror(errno) );
+		return false;
+	}
+	if( pid == 0 ) {
+		for(;;) {
+			pause();
+		}
+	}
+	children.insert( pid );
+	return true;
+}
+
+static void
+remove_child()
+{
+	pid_t pid = *children.begin();
+	children.erase( children.begin() );
+	kill( pid, SIGKILL );
+	waitpid( pid, NULL, 0 );
+}
+
+	// Take one snapshot and check that it has exactly our children.
+static bool
+snapshot( double &seconds, int &total )
+{
+	double start = condor_gettimestamp_double();
+	procInfo *list = ProcAPI::getProcInfoList();
+	seconds = condor_gettimestamp_double() - start;
+
+	std::set<pid_t> seen;
+	total = 0;
+	for( procInfo *pi = list; pi; pi = pi->next ) {
+		total++;
+		if( pi->ppid == getpid() ) {
+			seen.insert( pi->pid );
+		}
+	}
+	ProcAPI::freeProcInfoList( list );
+
+	if( seen != children ) {
+		fprintf( stderr, "ERROR: snapshot saw %d of our children, expected %d\n",
+				 (int)seen.size(), (int)children.size() );
+		return false;
+	}
+	return true;
+}
+
+static bool
+time_snapshots( char const *what, int snapshots, bool churn )
+{
+	double sum = 0;
+	double first = 0;
+	int total = 0;
+	for( int i = 0; i < snapshots; i++ ) {
+		if( churn && i > 0 ) {
+			for( int j = 0; j < 10 && !children.empty(); j++ ) {
+				remove_child();
+				if( !add_child() ) {
+					return false;
+				}
+			}
+		}
+		double seconds = 0;
+		if( !snapshot( seconds, total ) ) {
+			return false;
+		}
+		if( i == 0 ) {
+			first = seconds;
+		} else {
+			sum += seconds;
+		}
+	}
+	printf( "%s: %d processes, first snapshot %.2fms, then %.2fms each\n",
+			what, total, first * 1000,
+			snapshots > 1 ? sum * 1000 / (snapshots - 1) : 0.0 );
+	return true;
+}
+
+int
+main( int argc, char *argv[] )
+{
+	int procs = 100;
+	int snapshots = 10;
+	bool events = false;
+	for( int i = 1; i < argc; i++ ) {
+		if( !strcmp(argv[i],"-procs") && i+1 < argc ) {
+			procs = atoi(argv[++i]);
+		}
+		else if( !strcmp(argv[i],"-snapshots") && i+1 < argc ) {
+			snapshots = atoi(argv[++i]);
+		}
+		else if( !strcmp(argv[i],"-events") ) {
+			events = true;
+		}
+		else {
+			usage( argv[0] );
+		}
+	}
+	if( procs < 0 || snapshots < 1 ) {
+		usage( argv[0] );
+	}
+
+	bool ok = true;
+	for( int i = 0; i < procs && ok; i++ ) {
+		ok = add_child();
+	}
+
+	if( ok ) {
+		ok = time_snapshots( "full scan", snapshots, false );
+	}
+	if( ok ) {
+		ProcAPI::setIncrementalScan( events );
+		ok = time_snapshots( "incremental", snapshots, true );
+	}
+
+	while( !children.empty() ) {
+		remove_child();
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,312 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test the CEDAR session ciphers, and report how fast each one goes.
+ */
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+#include "condor_crypt_3des.h"
+#include "condor_crypt_blowfish.h"
+#include "condor_crypt_aes.h"
+
+#ifdef HAVE_EXT_OPENSSL
+
+	// initiator is the side that connected; only AES_CFB cares.
+static Condor_Crypt_Base *make_crypt(Protocol protocol, const KeyInfo &key, bool initiator)
+{
+	switch (protocol) {
+	case CONDOR_BLOWFISH: return new Condor_Crypt_Blowfish(key);
+	case CONDOR_3DES: return new Condor_Crypt_3des(key);
+	case CONDOR_AES: return new Condor_Crypt_AES(key, initiator);
+	default: return NULL;
+	}
+}
+
+static const char *protocol_name(Protocol protocol)
+{
+	switch (protocol) {
+	case CONDOR_BLOWFISH: return "BLOWFISH";
+	case CONDOR_3DES: return "3DES";
+	case CONDOR_AES: return "AES_CFB";
+	default: return "?";
+	}
+}
+
+	// CEDAR encrypts each put_bytes() on its own and decrypts whatever
+	// get_bytes() returns, so the receiver's pieces need not line up
+	// with the sender's.  Encrypt and decrypt in different sized pieces
+	// to check that the stream state carries across calls.
+static bool round_trip(Protocol protocol)
+{
+	MyString header;
+	header.formatstr("%s decrypts what it encrypts, in pieces of different sizes", protocol_name(protocol));
+	emit_test(header.Value());
+
+	unsigned char key_data[24];
+	for (int i = 0; i < (int)sizeof(key_data); i++) {
+		key_data[i] = (unsigned char)(i * 7 + 1);
+	}
+	KeyInfo key(key_data, sizeof(key_data), protocol);
+	Condor_Crypt_Base *sender = make_crypt(protocol, key, true);
+	Condor_Crypt_Base *receiver = make_crypt(protocol, key, false);
+
+	const int len = 10000;
+	unsigned char plain[len];
+	unsigned char cipher[len];
+	unsigned char result[len];
+	for (int i = 0; i < len; i++) {
+		plain[i] = (unsigned char)(i % 251);
+	}
+
+	bool ok = true;
+	for (int pos = 0, piece = 1; pos < len; pos += piece, piece = piece * 3 % 97 + 1) {
+		int n = MIN(piece, len - pos);
+		unsigned char *out = NULL;
+		int out_len = 0;
+		if (!sender->encrypt(plain + pos, n, out, out_len) || out_len != n) { ok = false; }
+		if (out) { memcpy(cipher + pos, out, MIN(n, out_len)); free(out); }
+	}
+	for (int pos = 0, piece = 5; pos < len; pos += piece, piece = piece * 7 % 89 + 1) {
+		int n = MIN(piece, len - pos);
+		unsigned char *out = NULL;
+		int out_len = 0;
+		if (!receiver->decrypt(cipher + pos, n, out, out_len) || out_len != n) { ok = false; }
+		if (out) { memcpy(result + pos, out, MIN(n, out_len)); free(out); }
+	}
+	delete sender;
+	delete receiver;
+
+	bool changed = memcmp(plain, cipher, len) != 0;
+	bool matched = memcmp(plain, result, len) == 0;
+
+	emit_input_header();
+	emit_param("Bytes", "%d", len);
+	emit_output_expected_header();
+	emit_param("Ciphertext differs from plaintext", "%s", "yes");
+	emit_param("Decrypted text matches plaintext", "%s", "yes");
+	emit_output_actual_header();
+	emit_param("Ciphertext differs from plaintext", "%s", changed ? "yes" : "NO");
+	emit_param("Decrypted text matches plaintext", "%s", matched ? "yes" : "NO");
+	if (!ok || !changed || !matched) {
+		FAIL;
+	}
+	PASS;
+}
+
+static MyString to_hex(const unsigned char *data, int len)
+{
+	MyString hex;
+	for (int i = 0; i < len; i++) {
+		hex.formatstr_cat("%02x", data[i]);
+	}
+	return hex;
+}
+
+static void from_hex(const char *hex, unsigned char *data)
+{
+	for (int i = 0; hex[2 * i]; i++) {
+		unsigned int byte = 0;
+		sscanf(hex + 2 * i, "%2x", &byte);
+		data[i] = (unsigned char)byte;
+	}
+}
+
+	// NIST SP 800-38A, F.3.13 and F.3.14: CFB128-AES256.  Encrypt and
+	// decrypt in pieces that do not fall on block boundaries, as CEDAR
+	// does.
+static bool test_aes_known_answer()
+{
+	emit_test("AES_CFB matches the NIST SP 800-38A CFB128-AES256 vectors");
+
+	const char *key_hex = "603deb1015ca71be2b73aef0857d7781"
+		"1f352c073b6108d72d9810a30914dff4";
+	const char *iv_hex = "000102030405060708090a0b0c0d0e0f";
+	const char *plain_hex = "6bc1bee22e409f96e93d7e117393172a"
+		"ae2d8a571e03ac9c9eb76fac45af8e51"
+		"30c81c46a35ce411e5fbc1191a0a52ef"
+		"f69f2445df4f9b17ad2b417be66c3710";
+	const char *cipher_hex = "dc7e84bfda79164b7ecd8486985d3860"
+		"39ffed143b28b1c832113c6331e5407b"
+		"df10132415e54b92a13ed0a8267ae2f9"
+		"75a385741ab9cef82031623d55b1e471";
+
+	unsigned char key_data[32];
+	unsigned char iv[16];
+	unsigned char plain[64];
+	unsigned char cipher[64];
+	from_hex(key_hex, key_data);
+	from_hex(iv_hex, iv);
+	from_hex(plain_hex, plain);
+	from_hex(cipher_hex, cipher);
+	KeyInfo key(key_data, sizeof(key_data), CONDOR_AES);
+	Condor_Crypt_AES crypt(key, iv, iv);
+
+	const int pieces[] = { 5, 16, 27, 16 };
+	unsigned char encrypted[64];
+	unsigned char decrypted[64];
+	bool ok = true;
+	for (int pass = 0; pass < 2; pass++) {
+		crypt.resetState();
+		for (int i = 0, pos = 0; i < 4; pos += pieces[i], i++) {
+			unsigned char *out = NULL;
+			int out_len = 0;
+			if (pass == 0) {
+				ok = crypt.encrypt(plain + pos, pieces[i], out, out_len) && ok;
+				if (out) { memcpy(encrypted + pos, out, MIN(out_len, pieces[i])); }
+			} else {
+				ok = crypt.decrypt(cipher + pos, pieces[i], out, out_len) && ok;
+				if (out) { memcpy(decrypted + pos, out, MIN(out_len, pieces[i])); }
+			}
+			ok = ok && out_len == pieces[i];
+			free(out);
+		}
+	}
+	MyString actual_cipher = to_hex(encrypted, sizeof(encrypted));
+	MyString actual_plain = to_hex(decrypted, sizeof(decrypted));
+
+	emit_input_header();
+	emit_param("Key", "%s", key_hex);
+	emit_param("IV", "%s", iv_hex);
+	emit_param("Plaintext", "%s", plain_hex);
+	emit_output_expected_header();
+	emit_param("Ciphertext", "%s", cipher_hex);
+	emit_param("Decrypted", "%s", plain_hex);
+	emit_output_actual_header();
+	emit_param("Ciphertext", "%s", actual_cipher.Value());
+	emit_param("Decrypted", "%s", actual_plain.Value());
+	if (!ok || actual_cipher != cipher_hex || actual_plain != plain_hex) {
+		FAIL;
+	}
+	PASS;
+}
+
+	// The two directions of a session must not start from the same IV,
+	// or the first bytes each side sends would share a key stream.
+static bool test_aes_directions_differ()
+{
+	emit_test("AES_CFB encrypts the two directions of a session differently");
+
+	unsigned char key_data[24];
+	for (int i = 0; i < (int)sizeof(key_data); i++) {
+		key_data[i] = (unsigned char)(i * 7 + 1);
+	}
+	KeyInfo key(key_data, sizeof(key_data), CONDOR_AES);
+	Condor_Crypt_AES initiator(key, true);
+	Condor_Crypt_AES responder(key, false);
+
+	unsigned char plain[32];
+	memset(plain, 'x', sizeof(plain));
+	unsigned char *sent = NULL;
+	unsigned char *answered = NULL;
+	int sent_len = 0;
+	int answered_len = 0;
+	bool ok = initiator.encrypt(plain, sizeof(plain), sent, sent_len) &&
+		responder.encrypt(plain, sizeof(plain), answered, answered_len) &&
+		sent_len == (int)sizeof(plain) && answered_len == (int)sizeof(plain);
+	bool differ = ok && memcmp(sent, answered, sizeof(plain)) != 0;
+	free(sent);
+	free(answered);
+
+	emit_input_header();
+	emit_param("Plaintext", "%s", "32 bytes of 'x', sent each way");
+	emit_output_expected_header();
+	emit_param("Ciphertexts differ", "%s", "yes");
+	emit_output_actual_header();
+	emit_param("Ciphertexts differ", "%s", differ ? "yes" : "NO");
+	if (!ok || !differ) {
+		FAIL;
+	}
+	PASS;
+}
+
+	// Time the cipher on 64k pieces, the size file transfer encrypts,
+	// and report MB/s.  This is informational; it only fails if the
+	// cipher does.
+static bool throughput(Protocol protocol)
+{
+	MyString header;
+	header.formatstr("%s throughput on 64k pieces", protocol_name(protocol));
+	emit_test(header.Value());
+
+	unsigned char key_data[24];
+	memset(key_data, 0x5a, sizeof(key_data));
+	KeyInfo key(key_data, sizeof(key_data), protocol);
+	Condor_Crypt_Base *crypt = make_crypt(protocol, key, true);
+
+	const int piece = 65536;
+	const int pieces = 256;
+	unsigned char *plain = (unsigned char *)malloc(piece);
+	memset(plain, 'x', piece);
+
+	bool ok = true;
+	double start = _condor_debug_get_time_double();
+	for (int i = 0; i < pieces && ok; i++) {
+		unsigned char *out = NULL;
+		int out_len = 0;
+		ok = crypt->encrypt(plain, piece, out, out_len);
+		free(out);
+	}
+	double elapsed = _condor_debug_get_time_double() - start;
+	free(plain);
+	delete crypt;
+
+	double mb = (double)piece * pieces / (1024 * 1024);
+	emit_input_header();
+	emit_param("MB encrypted", "%.0f", mb);
+	emit_output_actual_header();
+	emit_param("Seconds", "%.3f", elapsed);
+	emit_param("MB/s", "%.1f", elapsed > 0 ? mb / elapsed : 0.0);
+	if (!ok) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_blowfish_round_trip() { return round_trip(CONDOR_BLOWFISH); }
+static bool test_3des_round_trip() { return round_trip(CONDOR_3DES); }
+static bool test_aes_round_trip() { return round_trip(CONDOR_AES); }
+static bool test_blowfish_throughput() { return throughput(CONDOR_BLOWFISH); }
+static bool test_3des_throughput() { return throughput(CONDOR_3DES); }
+static bool test_aes_throughput() { return throughput(CONDOR_AES); }
+
+#endif /* HAVE_EXT_OPENSSL */
+
+bool OTEST_Condor_Crypt() {
+	emit_object("Condor_Crypt");
+	emit_comment("The Condor_Crypt_Base subclasses encrypt CEDAR sessions. They are stream ciphers whose state carries from one call to the next.");
+
+	FunctionDriver driver;
+#ifdef HAVE_EXT_OPENSSL
+	driver.register_function(test_blowfish_round_trip);
+	driver.register_function(test_3des_round_trip);
+	driver.register_function(test_aes_round_trip);
+	driver.register_function(test_aes_known_answer);
+	driver.register_function(test_aes_directions_differ);
+	driver.register_function(test_blowfish_throughput);
+	driver.register_function(test_3des_throughput);
+	driver.register_function(test_aes_throughput);
+#endif
+
+	return driver.do_all_functions();
+}
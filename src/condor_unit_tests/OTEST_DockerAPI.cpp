@@ -0,0 +1,156 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ * 
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ * 
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Test how the stream of stats from the Docker daemon is taken apart.
+ */
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+#include "env.h"
+#include "CondorError.h"
+#include "condor_classad.h"
+#include "docker-api.h"
+
+	// Two samples as the Docker daemon sends them, chunk encoded.  The
+	// first chunk ends in the middle of a sample, the second sample's
+	// newline is a chunk of its own, and the chunk sizes are followed
+	// by an extension.
+static const char stats_stream[] =
+	"18\r\n{\"read\":\"one\",\"mem\":{\"us\r\n"
+	"10\r\nage\":1}}\n{\"read\"\r\n"
+	"19;ext=1\r\n:\"two\",\"mem\":{\"usage\":2}}\r\n"
+	"1\r\n\n\r\n"
+	"0\r\n\r\n";
+
+	// Feed the stream in pieces of the given size, as the reads from
+	// the daemon might return it, and keep the newest sample.
+static bool feed(int piece, std::string &sample, int &samples, bool &done)
+{
+	std::string raw, body;
+	int len = (int)strlen(stats_stream);
+	samples = 0;
+	done = false;
+	for (int pos = 0; pos < len && !done; pos += piece) {
+		raw.append(stats_stream + pos, MIN(piece, len - pos));
+		if (!DockerAPI::decodeChunks(raw, body, done)) {
+			return false;
+		}
+		if (DockerAPI::lastStatsSample(body, sample)) {
+			samples++;
+		}
+	}
+	return raw.empty() && body.empty();
+}
+
+static bool test_chunked_samples(int piece)
+{
+	MyString header;
+	header.formatstr("The newest sample is found in a chunked stats stream read %d bytes at a time", piece);
+	emit_test(header.Value());
+
+	std::string sample;
+	int samples = 0;
+	bool done = false;
+	bool ok = feed(piece, sample, samples, done);
+	const char *expected = "{\"read\":\"two\",\"mem\":{\"usage\":2}}";
+
+	emit_input_header();
+	emit_param("Piece size", "%d", piece);
+	emit_output_expected_header();
+	emit_param("Decoded cleanly", "%s", "yes");
+	emit_param("Stream ended", "%s", "yes");
+	emit_param("Newest sample", "%s", expected);
+	emit_output_actual_header();
+	emit_param("Decoded cleanly", "%s", ok ? "yes" : "NO");
+	emit_param("Stream ended", "%s", done ? "yes" : "NO");
+	emit_param("Newest sample", "%s", sample.c_str());
+	if (!ok || !done || sample != expected || samples < 1) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_chunked_whole() { return test_chunked_samples(sizeof(stats_stream)); }
+static bool test_chunked_bytewise() { return test_chunked_samples(1); }
+static bool test_chunked_pieces() { return test_chunked_samples(7); }
+
+	// Both samples arrive in the first read; only the second counts.
+static bool test_chunked_first_sample()
+{
+	emit_test("A sample split across chunks is put back together");
+
+	std::string raw = "18\r\n{\"read\":\"one\",\"mem\":{\"us\r\n10\r\nage\":1}}\n{\"read\"\r\n";
+	std::string body, sample;
+	bool done = false;
+	bool ok = DockerAPI::decodeChunks(raw, body, done);
+	bool found = ok && DockerAPI::lastStatsSample(body, sample);
+	const char *expected = "{\"read\":\"one\",\"mem\":{\"usage\":1}}";
+
+	emit_input_header();
+	emit_param("Chunks", "%s", "two, ending mid-sample");
+	emit_output_expected_header();
+	emit_param("Sample", "%s", expected);
+	emit_param("Left over", "%s", "{\"read\"");
+	emit_output_actual_header();
+	emit_param("Sample", "%s", sample.c_str());
+	emit_param("Left over", "%s", body.c_str());
+	if (!found || done || sample != expected || body != "{\"read\"") {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_not_chunked()
+{
+	emit_test("Data that is not chunk encoded is refused");
+
+	std::string raw = "{\"read\":\"one\"}\n";
+	std::string body;
+	bool done = false;
+	bool ok = DockerAPI::decodeChunks(raw, body, done);
+
+	emit_input_header();
+	emit_param("Raw", "%s", "{\"read\":\"one\"}\\n");
+	emit_output_expected_header();
+	emit_retval("%s", "false");
+	emit_output_actual_header();
+	emit_retval("%s", ok ? "true" : "false");
+	if (ok) {
+		FAIL;
+	}
+	PASS;
+}
+
+bool OTEST_DockerAPI() {
+	emit_object("DockerAPI");
+	emit_comment("The Docker daemon sends a container's stats as a chunk encoded stream of JSON samples, one per line.");
+
+	FunctionDriver driver;
+	driver.register_function(test_chunked_whole);
+	driver.register_function(test_chunked_bytewise);
+	driver.register_function(test_chunked_pieces);
+	driver.register_function(test_chunked_first_sample);
+	driver.register_function(test_not_chunked);
+
+	return driver.do_all_functions();
+}
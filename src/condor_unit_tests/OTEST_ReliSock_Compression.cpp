@@ -0,0 +1,226 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/* Send a message and a file over a compressed ReliSock on the loopback
+   interface, with and without encryption, and check that both arrive
+   intact and were compressed where they should be: everything on a
+   plain connection, nothing on an encrypted one unless
+   CEDAR_COMPRESS_ENCRYPTED allows the file to be.
+ */
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "function_test_driver.h"
+#include "unit_test_utils.h"
+#include "emit.h"
+#include "reli_sock.h"
+#include "cedar_compression.h"
+#include "condor_attributes.h"
+
+#ifndef WIN32
+
+static const int message_len = 200000;
+static const int file_len = 1000000;
+
+static void fill(std::string &data, int len, int seed)
+{
+	data.resize(len);
+	for (int i = 0; i < len; i++) {
+		data[i] = "compressible cedar data "[(i / 7 + seed) % 24];
+	}
+}
+
+static void set_key(ReliSock &sock)
+{
+	unsigned char key_data[32];
+	for (int i = 0; i < (int)sizeof(key_data); i++) {
+		key_data[i] = (unsigned char)(i * 11 + 3);
+	}
+	KeyInfo key(key_data, sizeof(key_data), CONDOR_AES);
+	sock.set_crypto_key(true, &key);
+}
+
+static long long inflated_bytes(bool encrypted)
+{
+	ClassAd ad;
+	CedarCompression::Publish(ad);
+	std::string attr;
+	formatstr(attr, "Cedar%sInflatedBytes", encrypted ? "Encrypted" : "Plain");
+	long long bytes = 0;
+	ad.LookupInteger(attr, bytes);
+	return bytes;
+}
+
+	// The child sends; the parent receives and checks.
+static void send_all(int port, bool encrypt)
+{
+	std::string message;
+	fill(message, message_len, 1);
+	std::string file_data;
+	fill(file_data, file_len, 2);
+	FILE *fp = tmpfile();
+	if (!fp || fwrite(file_data.data(), 1, file_data.size(), fp) != file_data.size() ||
+		fflush(fp) != 0)
+	{
+		_exit(1);
+	}
+
+	ReliSock sock;
+	sock.timeout(20);
+	if (!sock.connect("127.0.0.1", port)) {
+		_exit(2);
+	}
+	if (encrypt) {
+		set_key(sock);
+	}
+	sock.set_compression(true);
+	sock.encode();
+	filesize_t size = 0;
+	if (!sock.put(message) || !sock.end_of_message() ||
+		sock.put_file(&size, fileno(fp)) < 0 || !sock.end_of_message())
+	{
+		_exit(3);
+	}
+	fclose(fp);
+	_exit(0);
+}
+
+static bool round_trip(bool encrypt, bool compress_encrypted)
+{
+	if (!encrypt) {
+		emit_test("A compressed ReliSock carries a message and a file intact, and compresses both");
+	} else if (!compress_encrypted) {
+		emit_test("A compressed, encrypted ReliSock carries a message and a file intact, and compresses neither");
+	} else {
+		emit_test("With CEDAR_COMPRESS_ENCRYPTED, a compressed, encrypted ReliSock compresses only the file");
+	}
+
+	if (!CedarCompression::Available()) {
+		emit_comment("Built without zlib; nothing to test.");
+		PASS;
+	}
+
+	ReliSock listener;
+	if (!listener.bind(CP_IPV4, false, 0, true) || !listener.listen()) {
+		emit_comment("Could not listen on the loopback interface.");
+		FAIL;
+	}
+	int port = listener.get_port();
+
+	long long before = inflated_bytes(encrypt);
+
+	param_insert("CEDAR_COMPRESS_ENCRYPTED", compress_encrypted ? "true" : "false");
+	pid_t pid = fork();
+	if (pid < 0) {
+		FAIL;
+	}
+	if (pid == 0) {
+		listener.close();
+		send_all(port, encrypt);
+	}
+	param_insert("CEDAR_COMPRESS_ENCRYPTED", "false");
+
+	std::string expected_message;
+	fill(expected_message, message_len, 1);
+	std::string expected_file;
+	fill(expected_file, file_len, 2);
+
+	ReliSock sock;
+	bool ok = listener.accept(sock) != 0;
+	sock.timeout(20);
+	if (ok && encrypt) {
+		set_key(sock);
+	}
+	sock.decode();
+	std::string message;
+	std::string file_data;
+	filesize_t size = 0;
+	FILE *fp = tmpfile();
+	ok = ok && fp && sock.get(message) && sock.end_of_message();
+	long long after_message = inflated_bytes(encrypt);
+	ok = ok && sock.get_file(&size, fileno(fp)) >= 0 && sock.end_of_message();
+	long long after_file = inflated_bytes(encrypt);
+	if (ok) {
+		file_data.resize(file_len + 1);
+		rewind(fp);
+		file_data.resize(fread(&file_data[0], 1, file_data.size(), fp));
+	}
+	if (fp) {
+		fclose(fp);
+	}
+	sock.close();
+
+	int status = -1;
+	waitpid(pid, &status, 0);
+
+	bool message_compressed = after_message > before;
+	bool file_compressed = after_file > after_message;
+	bool expect_message = !encrypt;
+	bool expect_file = !encrypt || compress_encrypted;
+
+	emit_input_header();
+	emit_param("Encrypted", "%s", encrypt ? "yes" : "no");
+	emit_param("CEDAR_COMPRESS_ENCRYPTED", "%s", compress_encrypted ? "true" : "false");
+	emit_param("Message bytes", "%d", message_len);
+	emit_param("File bytes", "%d", file_len);
+	emit_output_expected_header();
+	emit_param("Sender exit status", "%d", 0);
+	emit_param("Message matches", "%s", "yes");
+	emit_param("File matches", "%s", "yes");
+	emit_param("Message was compressed", "%s", expect_message ? "yes" : "no");
+	emit_param("File was compressed", "%s", expect_file ? "yes" : "no");
+	emit_output_actual_header();
+	emit_param("Sender exit status", "%d", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+	emit_param("Message matches", "%s", message == expected_message ? "yes" : "NO");
+	emit_param("File matches", "%s", file_data == expected_file ? "yes" : "NO");
+	emit_param("Message was compressed", "%s", message_compressed ? "yes" : "no");
+	emit_param("File was compressed", "%s", file_compressed ? "yes" : "no");
+	if (!ok || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+		message != expected_message || file_data != expected_file ||
+		message_compressed != expect_message || file_compressed != expect_file)
+	{
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_plain_round_trip() { return round_trip(false, false); }
+#ifdef HAVE_EXT_OPENSSL
+static bool test_encrypted_round_trip() { return round_trip(true, false); }
+static bool test_encrypted_opt_in_round_trip() { return round_trip(true, true); }
+#endif
+
+#endif /* WIN32 */
+
+bool OTEST_ReliSock_Compression() {
+	emit_object("ReliSock_Compression");
+	emit_comment("ReliSock compresses messages a packet at a time and file data a chunk at a time. On an encrypted connection nothing is compressed unless CEDAR_COMPRESS_ENCRYPTED is set, and then only file data, before it is encrypted.");
+
+	FunctionDriver driver;
+#ifndef WIN32
+	driver.register_function(test_plain_round_trip);
+#ifdef HAVE_EXT_OPENSSL
+	driver.register_function(test_encrypted_round_trip);
+	driver.register_function(test_encrypted_opt_in_round_trip);
+#endif
+#endif
+
+	return driver.do_all_functions();
+}
@@ -63,6 +63,9 @@ bool OTEST_TmpDir(void);
 bool OTEST_StatInfo(void);
 bool OTEST_condor_sockaddr();
 bool OTEST_ranger();
+bool OTEST_Condor_Crypt();
+bool OTEST_ReliSock_Compression();
+bool OTEST_DockerAPI();
 
 	// function map that maps testing function names to testing functions
 const static struct {
@@ -98,6 +101,9 @@ const static struct {
 	map(OTEST_StatInfo),
 	map(OTEST_condor_sockaddr),
 	map(OTEST_ranger),
+	map(OTEST_Condor_Crypt),
+	map(OTEST_ReliSock_Compression),
+	map(OTEST_DockerAPI),
 };
 int function_map_num_elems = sizeof(function_map) / sizeof(function_map[0]);
 
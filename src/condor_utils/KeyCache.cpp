@@ -23,6 +23,19 @@
 #include "CryptKey.h"
 #include "condor_attributes.h"
 #include "internet.h"
+#include "util_lib_proto.h"
+
+	// Bookkeeping attributes added to the policy ad of each session
+	// written by KeyCache::persist().
+static const char *ATTR_KC_ID = "KeyCacheId";
+static const char *ATTR_KC_ADDR = "KeyCacheAddress";
+static const char *ATTR_KC_KEY = "KeyCacheKey";
+static const char *ATTR_KC_PROTOCOL = "KeyCacheProtocol";
+static const char *ATTR_KC_KEY_DURATION = "KeyCacheKeyDuration";
+static const char *ATTR_KC_EXPIRATION = "KeyCacheExpiration";
+static const char *ATTR_KC_LEASE_INTERVAL = "KeyCacheLeaseInterval";
+static const char *ATTR_KC_LEASE_EXPIRATION = "KeyCacheLeaseExpiration";
+static const char *KC_FILE_DELIM = "***";
 
 KeyCacheEntry::KeyCacheEntry( char const *id_param, const condor_sockaddr * addr_param, KeyInfo* key_param, ClassAd * policy_param, int expiration_param, int lease_interval ) {
 	if (id_param) {
@@ -53,6 +66,8 @@ KeyCacheEntry::KeyCacheEntry( char const *id_param, const condor_sockaddr * addr
 	_lease_interval = lease_interval;
 	_lease_expiration = 0;
 	_lingering = false;
+	_persist = false;
+	_indexed_expiration = 0;
 	renewLease();
 }
 
@@ -152,6 +167,8 @@ void KeyCacheEntry::copy_storage(const KeyCacheEntry &copy) {
 	_lease_interval = copy._lease_interval;
 	_lease_expiration = copy._lease_expiration;
 	_lingering = copy._lingering;
+	_persist = copy._persist;
+	_indexed_expiration = 0;
 }
 
 
@@ -235,6 +252,7 @@ void KeyCache::delete_storage()
 		}
 		m_index->clear();
 	}
+	m_expiry_index.clear();
 }
 
 
@@ -264,6 +282,7 @@ bool KeyCache::insert(KeyCacheEntry &e) {
 	}
 	else {
 		addToIndex(new_ent);
+		addToExpiryIndex(new_ent);
 	}
 
 	return retval;
@@ -392,6 +411,7 @@ bool KeyCache::remove(const char *key_id) {
 
 	if (res) {
 		removeFromIndex( tmp_ptr );
+		removeFromExpiryIndex( tmp_ptr );
 
 		// ** HEY **
 		// key_id could be pointing to the string tmp_ptr->id.  so, we'd
@@ -417,26 +437,247 @@ void KeyCache::expire(KeyCacheEntry *e) {
 	free( key_id );
 }
 
+void
+KeyCache::addToExpiryIndex(KeyCacheEntry *key)
+{
+	key->_indexed_expiration = key->expiration();
+	if( key->_indexed_expiration ) {
+		m_expiry_index.insert(std::make_pair(key->_indexed_expiration, key));
+	}
+}
+
+void
+KeyCache::removeFromExpiryIndex(KeyCacheEntry *key)
+{
+	if( !key->_indexed_expiration ) {
+		return;
+	}
+	std::pair<KeyCacheExpiryIndex::iterator, KeyCacheExpiryIndex::iterator> range =
+		m_expiry_index.equal_range(key->_indexed_expiration);
+	for( KeyCacheExpiryIndex::iterator it = range.first; it != range.second; ++it ) {
+		if( it->second == key ) {
+			m_expiry_index.erase(it);
+			break;
+		}
+	}
+	key->_indexed_expiration = 0;
+}
+
+void
+KeyCache::setExpiration(KeyCacheEntry *key, int new_expiration)
+{
+	removeFromExpiryIndex(key);
+	key->setExpiration(new_expiration);
+	addToExpiryIndex(key);
+}
+
 StringList * KeyCache::getExpiredKeys() {
 
 	// draw the line
     StringList * list = new StringList();
 	time_t cutoff_time = time(0);
 
-	// iterate through all entries from the hash
-	KeyCacheEntry* key_entry;
-    MyString id;
-	key_table->startIterations();
-	while (key_table->iterate(id, key_entry)) {
-		// check the freshness date on that key
-		if (key_entry->expiration() && key_entry->expiration() <= cutoff_time) {
-            list->append(id.Value());
-			//expire(key_entry);
+	// walk the expiry index up to the line.  entries whose lease was
+	// renewed since they were indexed are moved to their new place,
+	// which is past the line, so each entry is looked at once.
+	KeyCacheExpiryIndex::iterator it = m_expiry_index.begin();
+	while( it != m_expiry_index.end() && it->first <= cutoff_time ) {
+		KeyCacheEntry *key_entry = it->second;
+		time_t expiration = key_entry->expiration();
+		if( expiration && expiration <= cutoff_time ) {
+			list->append(key_entry->id());
+			++it;
+			continue;
 		}
+		it = m_expiry_index.erase(it);
+		addToExpiryIndex(key_entry);
 	}
     return list;
 }
 
+static void
+hex_encode(const unsigned char *data, int len, std::string &out)
+{
+	static const char digits[] = "0123456789abcdef";
+	out.clear();
+	out.reserve(2*len);
+	for( int i = 0; i < len; i++ ) {
+		out += digits[data[i] >> 4];
+		out += digits[data[i] & 0xf];
+	}
+}
+
+static bool
+hex_decode(const std::string &in, std::vector<unsigned char> &out)
+{
+	if( in.size() % 2 ) {
+		return false;
+	}
+	out.clear();
+	for( size_t i = 0; i < in.size(); i += 2 ) {
+		int hi = isxdigit(in[i]) ? (isdigit(in[i]) ? in[i] - '0' : (tolower(in[i]) - 'a' + 10)) : -1;
+		int lo = isxdigit(in[i+1]) ? (isdigit(in[i+1]) ? in[i+1] - '0' : (tolower(in[i+1]) - 'a' + 10)) : -1;
+		if( hi < 0 || lo < 0 ) {
+			return false;
+		}
+		out.push_back((unsigned char)(hi << 4 | lo));
+	}
+	return true;
+}
+
+int
+KeyCache::persist(const char *filename)
+{
+	std::string tmp_filename;
+	formatstr(tmp_filename, "%s.tmp", filename);
+
+	FILE *fp = safe_fcreate_replace_if_exists(tmp_filename.c_str(), "w", 0600);
+	if( !fp ) {
+		dprintf(D_ALWAYS, "KEYCACHE: failed to create %s: %s\n",
+				tmp_filename.c_str(), strerror(errno));
+		return -1;
+	}
+
+	int count = 0;
+	bool failed = false;
+	time_t now = time(0);
+	KeyCacheEntry *key_entry;
+	key_table->startIterations();
+	while( key_table->iterate(key_entry) ) {
+		if( !key_entry->getPersistFlag() || key_entry->getLingerFlag() ||
+			!key_entry->key() || !key_entry->policy() )
+		{
+			continue;
+		}
+		if( key_entry->expiration() && key_entry->expiration() <= now ) {
+			continue;
+		}
+
+		ClassAd ad(*key_entry->policy());
+		std::string key_hex;
+		hex_encode(key_entry->key()->getKeyData(), key_entry->key()->getKeyLength(), key_hex);
+		ad.Assign(ATTR_KC_ID, key_entry->id());
+		if( key_entry->addr() ) {
+			ad.Assign(ATTR_KC_ADDR, key_entry->addr()->to_sinful());
+		}
+		ad.Assign(ATTR_KC_KEY, key_hex);
+		ad.Assign(ATTR_KC_PROTOCOL, (int)key_entry->key()->getProtocol());
+		ad.Assign(ATTR_KC_KEY_DURATION, key_entry->key()->getDuration());
+		ad.Assign(ATTR_KC_EXPIRATION, key_entry->_expiration);
+		ad.Assign(ATTR_KC_LEASE_INTERVAL, key_entry->_lease_interval);
+		ad.Assign(ATTR_KC_LEASE_EXPIRATION, (long long)key_entry->_lease_expiration);
+
+		if( fPrintAd(fp, ad) < 0 || fprintf(fp, "%s\n", KC_FILE_DELIM) < 0 ) {
+			failed = true;
+			break;
+		}
+		count++;
+	}
+
+	if( fclose(fp) != 0 ) {
+		failed = true;
+	}
+	if( failed || rotate_file(tmp_filename.c_str(), filename) != 0 ) {
+		dprintf(D_ALWAYS, "KEYCACHE: failed to write %s: %s\n",
+				filename, strerror(errno));
+		unlink(tmp_filename.c_str());
+		return -1;
+	}
+	dprintf(D_SECURITY, "KEYCACHE: saved %d sessions to %s\n", count, filename);
+	return count;
+}
+
+int
+KeyCache::restore(const char *filename)
+{
+	FILE *fp = safe_fopen_no_create(filename, "r");
+	if( !fp ) {
+		if( errno != ENOENT ) {
+			dprintf(D_ALWAYS, "KEYCACHE: failed to open %s: %s\n",
+					filename, strerror(errno));
+		}
+		return -1;
+	}
+
+#ifndef WIN32
+		// The file holds session keys; don't trust one that anybody
+		// else could have written or read.
+	struct stat st;
+	if( fstat(fileno(fp), &st) != 0 || st.st_uid != geteuid() || (st.st_mode & 077) ) {
+		dprintf(D_ALWAYS, "KEYCACHE: ignoring %s, which is not private to uid %d\n",
+				filename, (int)geteuid());
+		fclose(fp);
+		return -1;
+	}
+#endif
+
+	int count = 0;
+	time_t now = time(0);
+	for(;;) {
+		ClassAd ad;
+		int is_eof = 0, error = 0, empty = 0;
+		InsertFromFile(fp, ad, KC_FILE_DELIM, is_eof, error, empty);
+		if( error ) {
+			dprintf(D_ALWAYS, "KEYCACHE: failed to parse %s\n", filename);
+			break;
+		}
+		if( empty ) {
+			if( is_eof ) {
+				break;
+			}
+			continue;
+		}
+
+		std::string id, addr_str, key_hex;
+		int protocol = 0, key_duration = 0, expiration = 0, lease_interval = 0;
+		long long lease_expiration = 0;
+		if( !ad.LookupString(ATTR_KC_ID, id) || !ad.LookupString(ATTR_KC_KEY, key_hex) ) {
+			continue;
+		}
+		ad.LookupString(ATTR_KC_ADDR, addr_str);
+		ad.LookupInteger(ATTR_KC_PROTOCOL, protocol);
+		ad.LookupInteger(ATTR_KC_KEY_DURATION, key_duration);
+		ad.LookupInteger(ATTR_KC_EXPIRATION, expiration);
+		ad.LookupInteger(ATTR_KC_LEASE_INTERVAL, lease_interval);
+		ad.LookupInteger(ATTR_KC_LEASE_EXPIRATION, lease_expiration);
+		const char *bookkeeping[] = { ATTR_KC_ID, ATTR_KC_ADDR, ATTR_KC_KEY,
+			ATTR_KC_PROTOCOL, ATTR_KC_KEY_DURATION, ATTR_KC_EXPIRATION,
+			ATTR_KC_LEASE_INTERVAL, ATTR_KC_LEASE_EXPIRATION };
+		for( size_t i = 0; i < sizeof(bookkeeping)/sizeof(bookkeeping[0]); i++ ) {
+			ad.Delete(bookkeeping[i]);
+		}
+
+			// the lease kept running while we were down
+		if( (expiration && expiration <= now) || (lease_expiration && lease_expiration <= now) ) {
+			continue;
+		}
+
+		std::vector<unsigned char> key_data;
+		if( !hex_decode(key_hex, key_data) || key_data.empty() ) {
+			dprintf(D_ALWAYS, "KEYCACHE: bad key for session %s in %s\n", id.c_str(), filename);
+			continue;
+		}
+		condor_sockaddr addr;
+		bool have_addr = !addr_str.empty() && addr.from_sinful(addr_str.c_str());
+
+		KeyInfo key(&key_data[0], (int)key_data.size(), (Protocol)protocol, key_duration);
+		KeyCacheEntry entry(id.c_str(), have_addr ? &addr : NULL, &key, &ad, expiration, lease_interval);
+		entry._lease_expiration = (time_t)lease_expiration;
+		entry.setPersistFlag(true);
+		if( insert(entry) ) {
+			count++;
+		}
+	}
+	fclose(fp);
+
+		// The sessions live in memory now, and are written out
+		// again when the daemon next shuts down.
+	unlink(filename);
+
+	dprintf(D_SECURITY, "KEYCACHE: restored %d sessions from %s\n", count, filename);
+	return count;
+}
+
 StringList *
 KeyCache::getKeysForPeerAddress(char const *addr)
 {
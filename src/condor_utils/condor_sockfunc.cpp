@@ -34,6 +34,20 @@ int condor_accept(int sockfd, condor_sockaddr& addr)
 
 }
 
+#if defined(HAVE_ACCEPT4)
+int condor_accept4(int sockfd, condor_sockaddr& addr, int flags)
+{
+	sockaddr_storage st;
+	socklen_t len = sizeof(st);
+	int ret = accept4(sockfd, (sockaddr*)&st, &len, flags);
+
+	if (ret >= 0) {
+		addr = condor_sockaddr((sockaddr*)&st);
+	}
+	return ret;
+}
+#endif
+
 int condor_bind(int sockfd, const condor_sockaddr& addr)
 {
 	if (addr.is_ipv6() && addr.is_link_local()) {
@@ -27,6 +27,7 @@
 #include "directory.h"
 #include "directory_util.h"
 #include "condor_mkstemp.h"
+#include "condor_attributes.h"
 
 #include <stdio.h>
 
@@ -34,6 +35,13 @@
 
 #include <openssl/evp.h>
 
+#if defined(LINUX)
+#include <sys/ioctl.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
 using namespace htcondor;
 
 
@@ -393,6 +401,7 @@ DataReuseDirectory::HandleEvent(ULogEvent &event, CondorError & err)
 			iter->second->getTag(),
 			comEvent.getSize()));
 		m_contents.emplace_back(std::move(entry));
+		m_misses++;
 	}
 		break;
 	case ULOG_FILE_USED: {
@@ -406,6 +415,8 @@ DataReuseDirectory::HandleEvent(ULogEvent &event, CondorError & err)
 			});
 		if (iter != m_contents.end()) {
 			(*iter)->update_last_use(event.GetEventclock());
+			m_hits++;
+			m_bytes_saved += (*iter)->size();
 			return true;
 		}
 		dprintf(D_ALWAYS, "File with checksum %s used - but file is unknown to our state.\n",
@@ -526,6 +537,12 @@ DataReuseDirectory::CacheFile(const std::string &source, const std::string &chec
 		return false;
 	}
 
+		// When the job's sandbox and the cache share a filesystem that
+		// supports it, the cached file can share the sandbox file's
+		// blocks.  We still read the clone back to verify the checksum.
+	bool cloned = Reflink(dest_fd, source_fd);
+	int read_fd = cloned ? dest_fd : source_fd;
+
 	auto mdctx = EVP_MD_CTX_create();
 	EVP_DigestInit_ex(mdctx, md, NULL);
 
@@ -533,16 +550,15 @@ DataReuseDirectory::CacheFile(const std::string &source, const std::string &chec
 	memory_buffer.reserve(64*1024);
 	ssize_t bytes;
 	while (true) {
-		bytes = _condor_full_read(source_fd, &memory_buffer[0], 64*1024);
+		bytes = _condor_full_read(read_fd, &memory_buffer[0], 64*1024);
 		if (bytes <= 0) {
 			break;
 		}
-		auto write_bytes = _condor_full_write(dest_fd, &memory_buffer[0], bytes);
-		if (write_bytes != bytes) {
+		if (!cloned && _condor_full_write(dest_fd, &memory_buffer[0], bytes) != bytes) {
 			bytes = -1;
 			break;
 		}
-		EVP_DigestUpdate(mdctx, &memory_buffer[0], write_bytes);
+		EVP_DigestUpdate(mdctx, &memory_buffer[0], bytes);
 	}
 	if (bytes < 0) {
 		err.pushf("DataReuse", errno, "Failure when copying the file to cache directory: %s",
@@ -698,6 +714,7 @@ DataReuseDirectory::RetrieveFile(const std::string &destination, const std::stri
 	}
 
 	std::string source = (*iter)->fname();
+	uint64_t size = (*iter)->size();
 
 	int source_fd = -1;
 	{
@@ -722,6 +739,17 @@ DataReuseDirectory::RetrieveFile(const std::string &destination, const std::stri
 		return false;
 	}
 
+		// The sandbox copy can point at the cached blocks instead of
+		// duplicating them.  The contents were verified against the
+		// checksum when they went into the cache, and the clone is
+		// copy-on-write, so the job can't change what's cached.
+	if (Reflink(dest_fd, source_fd)) {
+		close(dest_fd);
+		close(source_fd);
+		m_bytes_reflinked += size;
+		return WriteFileUsedEvent(checksum, checksum_type, tag, err);
+	}
+
 	auto md = EVP_get_digestbyname(checksum_type.c_str());
 	if (!md) {
 		err.pushf("DataReuse", 9, "Failed to find impelmentation of checksum type %s.",
@@ -774,7 +802,54 @@ DataReuseDirectory::RetrieveFile(const std::string &destination, const std::stri
 		// TODO: remove file.
 		return false;
 	}
+	m_bytes_copied += size;
+
+	return WriteFileUsedEvent(checksum, checksum_type, tag, err);
+}
 
+
+bool
+DataReuseDirectory::Reflink(int dest_fd, int source_fd)
+{
+#if defined(LINUX)
+	struct stat source_stat, dest_stat;
+	if (fstat(source_fd, &source_stat) == -1 || fstat(dest_fd, &dest_stat) == -1) {
+		return false;
+	}
+	auto devices = std::make_pair(source_stat.st_dev, dest_stat.st_dev);
+	if (m_no_reflink.find(devices) != m_no_reflink.end()) {
+		return false;
+	}
+	if (ioctl(dest_fd, FICLONE, source_fd) == 0) {
+		return true;
+	}
+		// These mean the filesystems can't do it at all, so don't
+		// try again for files between the same two.
+	int clone_errno = errno;
+	if (clone_errno == EXDEV || clone_errno == EOPNOTSUPP ||
+		clone_errno == ENOTTY || clone_errno == EINVAL)
+	{
+		dprintf(D_FULLDEBUG, "DataReuse: Files can't be reflinked between "
+			"devices %lu and %lu (%s); copying them instead.\n",
+			(unsigned long)source_stat.st_dev, (unsigned long)dest_stat.st_dev,
+			strerror(clone_errno));
+		m_no_reflink.insert(devices);
+	} else {
+		dprintf(D_FULLDEBUG, "DataReuse: Unable to reflink file (%s); copying instead.\n",
+			strerror(clone_errno));
+	}
+#else
+	(void)dest_fd;
+	(void)source_fd;
+#endif
+	return false;
+}
+
+
+bool
+DataReuseDirectory::WriteFileUsedEvent(const std::string &checksum,
+	const std::string &checksum_type, const std::string &tag, CondorError &err)
+{
 	FileUsedEvent event;
 	event.setChecksumType(checksum_type);
 	event.setChecksum(checksum);
@@ -785,3 +860,109 @@ DataReuseDirectory::RetrieveFile(const std::string &destination, const std::stri
 	}
 	return true;
 }
+
+
+bool
+DataReuseDirectory::ComputeChecksum(const std::string &source, const std::string &checksum_type,
+	std::string &checksum, CondorError &err, int64_t length)
+{
+	if (!IsChecksumTypeSupported(checksum_type)) {
+		err.pushf("DataReuse", 17, "Checksum type %s is not supported.",
+			checksum_type.c_str());
+		return false;
+	}
+
+	auto md = EVP_get_digestbyname(checksum_type.c_str());
+	if (!md) {
+		err.pushf("DataReuse", 9, "Failed to find impelmentation of checksum type %s.",
+			checksum_type.c_str());
+		return false;
+	}
+
+	int source_fd = safe_open_wrapper_follow(source.c_str(), O_RDONLY);
+	if (source_fd == -1) {
+		err.pushf("DataReuse", errno, "Unable to open file to checksum (%s): %s",
+			source.c_str(), strerror(errno));
+		return false;
+	}
+
+	auto mdctx = EVP_MD_CTX_create();
+	EVP_DigestInit_ex(mdctx, md, NULL);
+
+	std::vector<char> memory_buffer(64*1024);
+	ssize_t bytes = 0;
+	int64_t remaining = length;
+	while (remaining != 0) {
+		size_t want = memory_buffer.size();
+		if (remaining > 0 && remaining < (int64_t)want) {
+			want = remaining;
+		}
+		bytes = _condor_full_read(source_fd, &memory_buffer[0], want);
+		if (bytes <= 0) {
+			break;
+		}
+		EVP_DigestUpdate(mdctx, &memory_buffer[0], bytes);
+		if (remaining > 0) {
+			remaining -= bytes;
+		}
+	}
+	close(source_fd);
+	if (bytes < 0) {
+		err.pushf("DataReuse", errno, "Failure when reading file to checksum (%s): %s",
+			source.c_str(), strerror(errno));
+		EVP_MD_CTX_destroy(mdctx);
+		return false;
+	}
+	if (remaining > 0) {
+		err.pushf("DataReuse", 5, "File to checksum (%s) is shorter than %lld bytes.",
+			source.c_str(), (long long)length);
+		EVP_MD_CTX_destroy(mdctx);
+		return false;
+	}
+
+	unsigned char md_value[EVP_MAX_MD_SIZE];
+	unsigned int md_len;
+	EVP_DigestFinal_ex(mdctx, md_value, &md_len);
+	EVP_MD_CTX_destroy(mdctx);
+
+	checksum.clear();
+	checksum.reserve(2*md_len);
+	char hex[3];
+	for (unsigned int idx = 0; idx < md_len; idx++) {
+		snprintf(hex, sizeof(hex), "%02x", md_value[idx]);
+		checksum += hex;
+	}
+	return true;
+}
+
+void
+DataReuseDirectory::PublishSandboxStats(ClassAd &ad) const
+{
+	if (!m_bytes_reflinked && !m_bytes_copied) {
+		return;
+	}
+	ad.Assign(ATTR_DATA_REUSE_BYTES_REFLINKED, (long long)m_bytes_reflinked);
+	ad.Assign(ATTR_DATA_REUSE_BYTES_COPIED, (long long)m_bytes_copied);
+}
+
+
+void
+DataReuseDirectory::Publish(ClassAd &ad)
+{
+	time_t now = time(NULL);
+	if (now - m_last_publish >= 60) {
+		m_last_publish = now;
+		CondorError err;
+		LogSentry sentry = LockLog(err);
+		if (!sentry.acquired() || !UpdateState(sentry, err)) {
+			dprintf(D_FULLDEBUG, "Failed to update state of reuse directory for publication: %s\n",
+				err.getFullText().c_str());
+		}
+	}
+
+	ad.Assign("DataReuseHits", (long long)m_hits);
+	ad.Assign("DataReuseMisses", (long long)m_misses);
+	ad.Assign("DataReuseBytesSaved", (long long)m_bytes_saved);
+	uint64_t lookups = m_hits + m_misses;
+	ad.Assign("DataReuseHitRate", lookups ? static_cast<double>(m_hits) / lookups : 0.0);
+}
@@ -27,6 +27,8 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <set>
+#include <utility>
 #include <unordered_map>
 
 class CondorError;
@@ -62,6 +64,22 @@ public:
 
 	static bool IsChecksumTypeSupported(const std::string &type) {return type == "sha256";}
 
+		// Compute the checksum of a file, reading it with the current
+		// privileges, in the same form RetrieveFile() and CacheFile()
+		// expect.  A non-negative length checksums only that many
+		// bytes from the start of the file.
+	static bool ComputeChecksum(const std::string &source, const std::string &checksum_type,
+		std::string &checksum, CondorError &err, int64_t length = -1);
+
+		// Publish how often jobs found their input files in the
+		// directory and how many bytes that saved.  The state is
+		// re-read from the log at most once a minute.
+	void Publish(ClassAd &ad);
+
+		// Publish, for the job, how many bytes of the files this object
+		// retrieved into the sandbox were reflinked and how many copied.
+	void PublishSandboxStats(ClassAd &ad) const;
+
 private:
 	class LogSentry {
 	public:
@@ -136,6 +154,13 @@ private:
 	bool ClearSpace(uint64_t size, LogSentry &sentry, CondorError &err);
 	bool UpdateState(LogSentry &sentry, CondorError &err);
 	bool HandleEvent(ULogEvent &event, CondorError &err);
+	bool WriteFileUsedEvent(const std::string &checksum, const std::string &checksum_type,
+		const std::string &tag, CondorError &err);
+
+		// Make dest_fd share source_fd's blocks instead of copying them,
+		// if the filesystems allow.  Returns false if the caller has
+		// to copy.
+	bool Reflink(int dest_fd, int source_fd);
 
 	LogSentry LockLog(CondorError &err);
 	bool UnlockLog(LogSentry sentry, CondorError &err);
@@ -150,6 +175,19 @@ private:
 	uint64_t m_stored_space{0};
 	uint64_t m_allocated_space{0};
 
+		// Files handed out of, and added to, the directory since the
+		// state log was started.
+	uint64_t m_hits{0};
+	uint64_t m_misses{0};
+	uint64_t m_bytes_saved{0};
+	time_t m_last_publish{0};
+
+		// Files retrieved into sandboxes by this process.
+	uint64_t m_bytes_reflinked{0};
+	uint64_t m_bytes_copied{0};
+		// (source, destination) devices that can't reflink
+	std::set<std::pair<dev_t, dev_t>> m_no_reflink;
+
 	std::string m_dirpath;
 	MyString m_logname;
 
@@ -11,9 +11,11 @@
 
 #include "docker-api.h"
 #include <algorithm>
+#include <map>
 
 #if !defined(WIN32)
 #include <sys/un.h>
+#include <poll.h>
 #endif
 
 
@@ -28,6 +30,10 @@ static int run_simple_docker_command(const std::string &command,
 static int gc_image(const std::string &image);
 static std::string makeHostname(ClassAd *machineAd, ClassAd *jobAd);
 static int check_if_docker_offline(MyPopenTimer & pgmIn, const char * cmd_str, int original_error_code);
+#if !defined(WIN32)
+int sendDockerAPIRequest( const std::string & request, std::string & response );
+static void docker_api_get( std::string & request, const char * path );
+#endif
 
 static std::string HTCondorLabel = "--label=org.htcondorproject=True";
 int DockerAPI::default_timeout = 120;
@@ -571,6 +577,49 @@ DockerAPI::rmi(const std::string &image, CondorError &err) {
 }
 
 
+#if !defined(WIN32)
+	// Returns 1 if the image is stored locally, 0 if not, and -1 if
+	// the API can't be reached.
+static int
+image_is_local( const std::string & image ) {
+	std::string request, response, path;
+	formatstr( path, "/images/%s/json", image.c_str() );
+	docker_api_get( request, path.c_str() );
+	if( sendDockerAPIRequest( request, response ) < 0 ) {
+		return -1;
+	}
+	int status = 0;
+	sscanf( response.c_str(), "HTTP/%*s %d", &status );
+	return status == 200 ? 1 : 0;
+}
+#endif
+
+int
+DockerAPI::pull(const std::string &image, int timeout, CondorError &err) {
+#if !defined(WIN32)
+	if( image_is_local( image ) == 1 ) {
+		return 0;
+	}
+#endif
+
+	dprintf( D_ALWAYS, "Pulling docker image %s\n", image.c_str() );
+	int rv = run_simple_docker_command("pull", image, timeout, err, true);
+	if( rv < 0 ) {
+		return rv;
+	}
+
+		// docker pull prints progress rather than the image name, so
+		// see for ourselves whether it worked.
+#if !defined(WIN32)
+	if( image_is_local( image ) == 0 ) {
+		dprintf( D_ALWAYS | D_FAILURE, "Failed to pull docker image %s\n", image.c_str() );
+		return -4;
+	}
+#endif
+	return 0;
+}
+
+
 int
 DockerAPI::kill(const std::string &image, CondorError &err) {
 	return run_simple_docker_command("kill", image, default_timeout, err);
@@ -597,8 +646,12 @@ DockerAPI::unpause( const std::string & container, CondorError & err ) {
 }
 
 #if !defined(WIN32)
-int
-sendDockerAPIRequest( const std::string & request, std::string & response ) {
+	// Requests to the Docker daemon share one connection, kept open
+	// between them, rather than paying for a connect every time.
+static int docker_api_sock = -1;
+
+static int
+connect_docker_socket() {
 	int uds = socket(AF_UNIX, SOCK_STREAM, 0);
 	if (uds < 0) {
 		dprintf(D_ALWAYS, "Can't create unix domain socket, no docker statistics will be available\n");
@@ -611,7 +664,6 @@ sendDockerAPIRequest( const std::string & request, std::string & response ) {
 	sa.sun_family = AF_UNIX;
 	strncpy(sa.sun_path, "/var/run/docker.sock",sizeof(sa.sun_path) - 1);
 
-	{
 	TemporaryPrivSentry sentry(PRIV_ROOT);
 	int cr = connect(uds, (struct sockaddr *) &sa, sizeof(sa));
 	if (cr != 0) {
@@ -619,30 +671,269 @@ sendDockerAPIRequest( const std::string & request, std::string & response ) {
 		close(uds);
 		return -1;
 	}
+	return uds;
+}
+
+static bool
+write_docker_socket( int fd, const std::string & request ) {
+	size_t sent = 0;
+	while (sent < request.length()) {
+		int flags = 0;
+#ifdef MSG_NOSIGNAL
+			// the daemon may have closed an idle connection
+		flags |= MSG_NOSIGNAL;
+#endif
+		ssize_t rv = send(fd, request.c_str() + sent, request.length() - sent, flags);
+		if (rv < 0 && errno == EINTR) { continue; }
+		if (rv <= 0) { return false; }
+		sent += rv;
 	}
+	return true;
+}
 
-	int ret = write(uds, request.c_str(), request.length());
-	if (ret < 0) {
-		dprintf(D_ALWAYS, "Can't send request to docker server, no statistics will be available\n");
-		close(uds);
-		return -1;
+	// Wait up to timeout seconds for something to read from fd, and
+	// append it to buf.  Returns the number of bytes read, 0 at the end
+	// of the stream or on an error, or -1 if nothing came in time.
+static int
+read_docker_socket( int fd, std::string & buf, int timeout ) {
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	int rv = poll(&pfd, 1, timeout * 1000);
+	if (rv < 0 && errno != EINTR) { return 0; }
+	if (rv <= 0) { return -1; }
+
+	char tmp[16384];
+	ssize_t n = read(fd, tmp, sizeof(tmp));
+	if (n <= 0) { return 0; }
+	buf.append(tmp, n);
+	return (int)n;
+}
+
+	// Read one HTTP response from fd, undoing any chunked transfer
+	// encoding, so that the connection can be used again after.
+static bool
+read_docker_response( int fd, std::string & headers, std::string & body, bool & keep_open ) {
+	const int timeout = 5;
+	std::string buf;
+	size_t header_end;
+	while ((header_end = buf.find("\r\n\r\n")) == std::string::npos) {
+		if (read_docker_socket(fd, buf, timeout) <= 0) { return false; }
+	}
+	headers = buf.substr(0, header_end);
+	buf.erase(0, header_end + 4);
+
+	std::string lower = headers;
+	lower_case(lower);
+	keep_open = lower.compare(0, 8, "http/1.1") == 0 &&
+		lower.find("\r\nconnection: close") == std::string::npos;
+
+	int status = 0;
+	sscanf(headers.c_str(), "HTTP/%*s %d", &status);
+	long long length = -1;
+	size_t pos = lower.find("\r\ncontent-length:");
+	if (pos != std::string::npos) {
+		length = atoll(lower.c_str() + pos + 17);
+	}
+
+	body.clear();
+	if (status == 204 || status == 304) {
+		// never a body
+	} else if (lower.find("\r\ntransfer-encoding: chunked") != std::string::npos) {
+		bool done = false;
+		for (;;) {
+			if (!DockerAPI::decodeChunks(buf, body, done)) { return false; }
+			if (done) { break; }
+			if (read_docker_socket(fd, buf, timeout) <= 0) { return false; }
+		}
+	} else if (length >= 0) {
+		while (buf.size() < (size_t)length) {
+			if (read_docker_socket(fd, buf, timeout) <= 0) { return false; }
+		}
+		body = buf.substr(0, length);
+	} else {
+		int rv;
+		while ((rv = read_docker_socket(fd, buf, timeout)) > 0) {}
+		if (rv < 0) { return false; }
+		body = buf;
+		keep_open = false;
 	}
+	return true;
+}
+
+	// The response is the headers, a blank line and the body, as on
+	// the wire but with any chunked encoding undone.
+int
+sendDockerAPIRequest( const std::string & request, std::string & response ) {
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		bool reused = docker_api_sock >= 0;
+		if (!reused) {
+			docker_api_sock = connect_docker_socket();
+			if (docker_api_sock < 0) { return -1; }
+		}
 
-	char buf[1024];
-	int written;
+		std::string headers, body;
+		bool keep_open = false;
+		if (!write_docker_socket(docker_api_sock, request) ||
+			!read_docker_response(docker_api_sock, headers, body, keep_open))
+		{
+			close(docker_api_sock);
+			docker_api_sock = -1;
+				// If the daemon closed the connection while it sat
+				// idle, try again on a new one.
+			if (reused) { continue; }
+			dprintf(D_ALWAYS, "Can't send request to docker server, no statistics will be available\n");
+			return -1;
+		}
+		if (!keep_open) {
+			close(docker_api_sock);
+			docker_api_sock = -1;
+		}
 
-	// read with 200 second timeout, no flags, nonblocking
-	while ((written = condor_read("Docker Socket", uds, buf, 1, 5, 0, false)) > 0) {
-		response.append(buf, written);
+		response = headers + "\r\n\r\n" + body;
+		dprintf(D_FULLDEBUG, "sendDockerAPIRequest(%s) = %s\n",
+			request.c_str(), response.c_str());
+		return 0;
 	}
+	return -1;
+}
 
-	dprintf(D_FULLDEBUG, "sendDockerAPIRequest(%s) = %s\n",
-		request.c_str(), response.c_str());
-	close(uds);
-	return 0;
+static void
+docker_api_get( std::string & request, const char * path ) {
+	formatstr(request, "GET %s HTTP/1.1\r\nHost: docker\r\n\r\n", path);
+}
+
+	// A container's stats, which the Docker daemon sends a new sample
+	// of every second or so for as long as the container runs.
+struct DockerStatsStream {
+	int fd;
+	bool chunked;
+		// what has been read since the headers, still chunk encoded
+	std::string raw;
+		// decoded, but not yet a whole sample
+	std::string body;
+};
+static std::map<std::string, DockerStatsStream> docker_stats_streams;
+
+	// Decode what has come in on the stream.  Returns false once the
+	// stream has ended or is not making sense.
+static bool
+decode_stats_stream( DockerStatsStream & stream ) {
+	if (!stream.chunked) {
+		stream.body += stream.raw;
+		stream.raw.clear();
+		return true;
+	}
+	bool done = false;
+	return DockerAPI::decodeChunks(stream.raw, stream.body, done) && !done;
+}
+
+	// Get the most recent sample from the container's stats stream,
+	// opening the stream if need be.
+static bool
+latest_streamed_stats( const std::string & container, std::string & sample ) {
+	auto it = docker_stats_streams.find(container);
+	bool fresh = it == docker_stats_streams.end();
+	if (fresh) {
+		int fd = connect_docker_socket();
+		if (fd < 0) { return false; }
+
+		std::string request, path, buf;
+		formatstr(path, "/containers/%s/stats", container.c_str());
+		docker_api_get(request, path.c_str());
+		size_t header_end = std::string::npos;
+		if (write_docker_socket(fd, request)) {
+			while ((header_end = buf.find("\r\n\r\n")) == std::string::npos) {
+				if (read_docker_socket(fd, buf, 5) <= 0) { break; }
+			}
+		}
+		int status = 0;
+		sscanf(buf.c_str(), "HTTP/%*s %d", &status);
+		if (header_end == std::string::npos || status != 200) {
+			close(fd);
+			return false;
+		}
+		std::string lower = buf.substr(0, header_end);
+		lower_case(lower);
+		DockerStatsStream stream;
+		stream.fd = fd;
+		stream.chunked = lower.find("\r\ntransfer-encoding: chunked") != std::string::npos;
+		stream.raw = buf.substr(header_end + 4);
+		it = docker_stats_streams.insert(std::make_pair(container, stream)).first;
+	}
+	DockerStatsStream & stream = it->second;
+
+		// Take everything that has come in since last time.
+	int rv;
+	while ((rv = read_docker_socket(stream.fd, stream.raw, 0)) > 0) {}
+	bool open = rv != 0 && decode_stats_stream(stream);
+	bool found = DockerAPI::lastStatsSample(stream.body, sample);
+	while (!found && fresh && open) {
+		rv = read_docker_socket(stream.fd, stream.raw, 5);
+		if (rv < 0) { break; }
+		open = rv > 0 && decode_stats_stream(stream);
+		found = DockerAPI::lastStatsSample(stream.body, sample);
+	}
+
+	if (!open) {
+		close(stream.fd);
+		docker_stats_streams.erase(it);
+	}
+	return found;
 }
 #endif /* WIN32 */
 
+bool
+DockerAPI::decodeChunks( std::string & raw, std::string & body, bool & done ) {
+	for (;;) {
+		if (!raw.empty() && !isxdigit((unsigned char)raw[0])) { return false; }
+		size_t eol = raw.find("\r\n");
+		if (eol == std::string::npos) { return true; }
+		char * end = NULL;
+		size_t size = strtoul(raw.c_str(), &end, 16);
+		if (end == raw.c_str()) { return false; }
+			// the chunk and the CRLF after it
+		if (raw.size() < eol + 2 + size + 2) { return true; }
+		if (raw.compare(eol + 2 + size, 2, "\r\n") != 0) { return false; }
+		body.append(raw, eol + 2, size);
+		raw.erase(0, eol + 2 + size + 2);
+		if (size == 0) {
+			done = true;
+			return true;
+		}
+	}
+}
+
+bool
+DockerAPI::lastStatsSample( std::string & body, std::string & sample ) {
+	size_t end = body.rfind('\n');
+	if (end == std::string::npos) { return false; }
+	std::string complete = body.substr(0, end);
+	body.erase(0, end + 1);
+
+		// Each sample is one line of JSON; skip any blank lines.
+	trim(complete);
+	size_t start = complete.rfind('\n');
+	std::string last = complete.substr(start == std::string::npos ? 0 : start + 1);
+	trim(last);
+	if (last.empty() || last[0] != '{') { return false; }
+	sample = last;
+	return true;
+}
+
+void
+DockerAPI::stopStats( const std::string & container ) {
+#if !defined(WIN32)
+	auto it = docker_stats_streams.find(container);
+	if (it != docker_stats_streams.end()) {
+		close(it->second.fd);
+		docker_stats_streams.erase(it);
+	}
+#else
+	(void)container;
+#endif
+}
+
 
 	/* Find usage stats on a running container by talking
 	 * directly to the server
@@ -653,11 +944,16 @@ DockerAPI::stats(const std::string &container, uint64_t &memUsage, uint64_t &net
 #if defined(WIN32)
 	return -1;
 #else
-	std::string request, response;
-	formatstr( request, "GET /containers/%s/stats?stream=0 HTTP/1.0\r\n\r\n", container.c_str());
-
-	int rv = sendDockerAPIRequest( request, response );
-	if( rv < 0 ) { return rv; }
+	std::string response;
+	if (!latest_streamed_stats(container, response)) {
+			// Ask for a single sample instead.
+		std::string request, path;
+		formatstr(path, "/containers/%s/stats?stream=0", container.c_str());
+		docker_api_get(request, path.c_str());
+
+		int rv = sendDockerAPIRequest( request, response );
+		if( rv < 0 ) { return rv; }
+	}
 
 	// Response now contains an enormous JSON formatted response
 	// Hackily extract the fields we are interested in
@@ -826,12 +1122,84 @@ int DockerAPI::version( std::string & version, CondorError & /* err */ ) {
 int DockerAPI::majorVersion = -1;
 int DockerAPI::minorVersion = -1;
 
+#if !defined(WIN32)
+	// Inspect the container through the API, for the same attributes
+	// as the 'docker inspect' below.  Returns 1 if the API can't be
+	// reached, so the caller can fall back to the docker command.
+static int
+inspect_with_api( const std::string & containerID, ClassAd * dockerAd ) {
+	std::string request, response, path;
+	formatstr( path, "/containers/%s/json", containerID.c_str() );
+	docker_api_get( request, path.c_str() );
+	if( sendDockerAPIRequest( request, response ) < 0 ) {
+		return 1;
+	}
+
+	int status = 0;
+	sscanf( response.c_str(), "HTTP/%*s %d", &status );
+	auto separator = response.find( "\r\n\r\n" );
+	if( status != 200 || separator == std::string::npos ) {
+		dprintf( D_ALWAYS | D_FAILURE, "Failed to inspect container %s: %s\n",
+			containerID.c_str(), response.substr( 0, response.find( "\r\n" ) ).c_str() );
+		return -4;
+	}
+
+	classad::ClassAd result;
+	classad::ClassAdJsonParser cajp;
+	if(! cajp.ParseClassAd( response.substr( separator + 4 ), result, true )) {
+		return -4;
+	}
+	classad::ClassAd * state = dynamic_cast< classad::ClassAd * >( result.Lookup( "State" ) );
+	if( state == NULL ) {
+		return -4;
+	}
+
+	std::string id, name, startedAt, finishedAt, error;
+	int pid = 0, exitCode = 0;
+	bool running = false, oomKilled = false;
+	if( ! result.EvaluateAttrString( "Id", id ) ||
+		! result.EvaluateAttrString( "Name", name ) ||
+		! state->EvaluateAttrInt( "Pid", pid ) ||
+		! state->EvaluateAttrBool( "Running", running ) ||
+		! state->EvaluateAttrInt( "ExitCode", exitCode ) ||
+		! state->EvaluateAttrString( "StartedAt", startedAt ) ||
+		! state->EvaluateAttrString( "FinishedAt", finishedAt ) ||
+		! state->EvaluateAttrString( "Error", error ) ||
+		! state->EvaluateAttrBool( "OOMKilled", oomKilled ) ) {
+		dprintf( D_ALWAYS | D_FAILURE, "Inspection of container %s is missing attributes.\n", containerID.c_str() );
+		return -4;
+	}
+
+	dockerAd->Assign( "ContainerId", id );
+	dockerAd->Assign( "Pid", pid );
+	dockerAd->Assign( "Name", name );
+	dockerAd->Assign( "Running", running );
+	dockerAd->Assign( "ExitCode", exitCode );
+	dockerAd->Assign( "StartedAt", startedAt );
+	dockerAd->Assign( "FinishedAt", finishedAt );
+	dockerAd->Assign( "DockerError", error );
+		// a string, as 'docker inspect' prints it
+	dockerAd->Assign( "OOMKilled", oomKilled ? "true" : "false" );
+
+	dprintf( D_FULLDEBUG, "docker inspect through the API:\n" );
+	dPrintAd( D_FULLDEBUG, *dockerAd );
+	return 0;
+}
+#endif
+
 int DockerAPI::inspect( const std::string & containerID, ClassAd * dockerAd, CondorError & /* err */ ) {
 	if( dockerAd == NULL ) {
 		dprintf( D_ALWAYS | D_FAILURE, "dockerAd is NULL.\n" );
 		return -2;
 	}
 
+#if !defined(WIN32)
+	int rv = inspect_with_api( containerID, dockerAd );
+	if( rv <= 0 ) {
+		return rv;
+	}
+#endif
+
 	ArgList inspectArgs;
 	if ( ! add_docker_arg(inspectArgs))
 		return -1;
@@ -1171,8 +1539,9 @@ DockerAPI::getServicePorts( const std::string & container,
 	return -1;
 #else
 	std::string request, response;
-	formatstr( request, "GET /containers/%s/json HTTP/1.0\r\n\r\n",
-		container.c_str() );
+	std::string path;
+	formatstr( path, "/containers/%s/json", container.c_str() );
+	docker_api_get( request, path.c_str() );
 	int rv = sendDockerAPIRequest( request, response );
 	if( rv < 0 ) { return rv; }
 
@@ -83,6 +83,16 @@ class DockerAPI {
 		 */
 		static int rmi( const std::string & image, CondorError & err );
 
+		/**
+		 * Pulls the named image, unless it is already stored locally.
+		 *
+		 * @param image		The Docker image name.
+		 * @param timeout	How long to wait for the pull, in seconds.
+		 * @param error			....
+		 * @return				0 on success, negative otherwise.
+		 */
+		static int pull( const std::string & image, int timeout, CondorError & err );
+
 		/**
 		 * Sends a signal to the first process in the named container
 		 *
@@ -109,8 +119,35 @@ class DockerAPI {
 		// Only available in Docker 1.1 or later.
 		static int unpause( const std::string & container, CondorError & err );
 
+		/**
+		 * Obtains usage stats for a running container.  The first call
+		 * opens a stream of samples from the Docker daemon, and later
+		 * calls take the latest sample from it without waiting.
+		 */
 		static int stats(const std::string &container, uint64_t &memUsage, uint64_t &netIn, uint64_t &netOut, uint64_t &userCpu, uint64_t &sysCpu);
 
+		// Closes the container's stream of stats, if it has one.
+		static void stopStats( const std::string & container );
+
+		/**
+		 * Undoes HTTP chunked transfer encoding.  Moves the data of each
+		 * whole chunk at the front of raw to the end of body, leaving any
+		 * partial chunk in raw for next time.
+		 *
+		 * @param done			Set to true once the last, empty chunk is seen.
+		 * @return				false if raw is not chunk encoded.
+		 */
+		static bool decodeChunks( std::string & raw, std::string & body, bool & done );
+
+		/**
+		 * Takes the whole lines off the front of a decoded stats stream,
+		 * and sets sample to the last of them, which is the newest
+		 * sample.  A partial line stays in body.
+		 *
+		 * @return				true if sample was set.
+		 */
+		static bool lastStatsSample( std::string & body, std::string & sample );
+
 		/**
 		 * Obtains the docker-inspect values State.Running and State.ExitCode.
 		 *
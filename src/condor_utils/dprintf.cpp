@@ -301,7 +301,7 @@ DebugFileInfo::DebugFileInfo(const dprintf_output_settings& p) :
 	maxLog(p.logMax), logZero(0), maxLogNum(p.maxLogNum),
 	want_truncate(p.want_truncate), accepts_all(p.accepts_all),
 	rotate_by_time(p.rotate_by_time), dont_panic(false),
-	userData(0), dprintfFunc(_dprintf_global_func) {}
+	userData(0), asyncLength(0), dprintfFunc(_dprintf_global_func) {}
 
 bool DebugFileInfo::MatchesCatAndFlags(int cat_and_flags) const
 {
@@ -469,10 +469,11 @@ const char* _format_global_header(int cat_and_flags, int hdr_flags, DebugHeaderI
 	return buf;
 }
 
-void
-_dprintf_global_func(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, const char* message, DebugFileInfo* dbgInfo)
+// Format the header, message and any backtrace into a single record.
+// The record is in a static buffer that is good until the next call.
+static const char *
+_dprintf_format_record(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, const char* message, DebugFileInfo* dbgInfo, int & record_len)
 {
-	int start_pos = 0;
 	int bufpos = 0;
 	int rc = 0;
 	static char* buffer = NULL;
@@ -583,6 +584,17 @@ _dprintf_global_func(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, c
 	#endif // HAVE_BACKTRACE
 	}
 
+	record_len = bufpos;
+	return buffer;
+}
+
+// write() a whole record, looping on partial writes.
+static void
+_dprintf_write_record(int fd, const char * buffer, int bufpos)
+{
+	int start_pos = 0;
+	int rc = 0;
+
 		// We attempt to write the log record with one call to
 		// write(), because then O_APPEND will ensure (on
 		// compliant file systems) that writes from different
@@ -591,7 +603,7 @@ _dprintf_global_func(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, c
 		// but we do anyway in case one of the exotic signals
 		// that we are not blocking interrupts us.
 	while( start_pos<bufpos ) {
-		rc = write( fileno(dbgInfo->debugFP),
+		rc = write( fd,
 					buffer+start_pos,
 					bufpos-start_pos );
 		if( rc > 0 ) {
@@ -603,6 +615,74 @@ _dprintf_global_func(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, c
 	}
 }
 
+void
+_dprintf_global_func(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, const char* message, DebugFileInfo* dbgInfo)
+{
+	int record_len = 0;
+	const char * record = _dprintf_format_record(cat_and_flags, hdr_flags, info, message, dbgInfo, record_len);
+	_dprintf_write_record(fileno(dbgInfo->debugFP), record, record_len);
+}
+
+// Can writes to this log go through the async writer?  Logs that are
+// locked around each write, closed between writes or rotated by time
+// are left to the synchronous path.
+static bool
+_dprintf_async_eligible(const DebugFileInfo & it)
+{
+	return it.outputTarget == FILE_OUT && it.dprintfFunc == _dprintf_global_func &&
+		log_keep_open && ! DebugShouldLockToAppend && ! DebugLock &&
+		DebugRotateLog && ! it.rotate_by_time;
+}
+
+// The FILE_OUT counterpart of _dprintf_global_func when the async writer is on.
+// Opening and rotating the log still happen here, after whatever is queued
+// for the old file has been written.
+static void
+_dprintf_to_async_writer(int cat_and_flags, int hdr_flags, DebugHeaderInfo & info, const char* message, DebugFileInfo* dbgInfo)
+{
+	if ( ! dbgInfo->debugFP || (dbgInfo->maxLog && dbgInfo->asyncLength >= dbgInfo->maxLog)) {
+		dprintf_async_flush();
+		if ( ! debug_lock_it(dbgInfo, NULL, 0, dbgInfo->dont_panic)) {
+			return;
+		}
+		dbgInfo->asyncLength = lseek(fileno(dbgInfo->debugFP), 0, SEEK_END);
+	}
+	int fd = fileno(dbgInfo->debugFP);
+
+	long long total_dropped = 0;
+	long long dropped = dprintf_async_take_drops(total_dropped);
+	if (dropped) {
+		char notice[200];
+		snprintf(notice, sizeof(notice), "dprintf: log writer fell behind, dropped %lld messages (%lld since startup)\n",
+			dropped, total_dropped);
+		int notice_len = 0;
+		const char * record = _dprintf_format_record(D_ALWAYS, hdr_flags, info, notice, dbgInfo, notice_len);
+		if (dprintf_async_write(fd, record, notice_len) == DPRINTF_ASYNC_QUEUED) {
+			dbgInfo->asyncLength += notice_len;
+		}
+	}
+
+	int record_len = 0;
+	const char * record = _dprintf_format_record(cat_and_flags, hdr_flags, info, message, dbgInfo, record_len);
+	switch (dprintf_async_write(fd, record, record_len)) {
+		case DPRINTF_ASYNC_QUEUED:
+			dbgInfo->asyncLength += record_len;
+			break;
+		case DPRINTF_ASYNC_TOO_BIG:
+			_dprintf_write_record(fd, record, record_len);
+			dbgInfo->asyncLength += record_len;
+			break;
+		default:
+			break;
+	}
+
+		// Failures are what EXCEPT() and friends log just before they
+		// exit or abort, so don't leave them sitting in the queue.
+	if (cat_and_flags & D_FAILURE) {
+		dprintf_async_flush();
+	}
+}
+
 /* _condor_dfprintf_va
  * This function is used internally by the dprintf system wherever
  * it wants to write directly to the open debug log.
@@ -954,6 +1034,8 @@ _condor_dprintf_va( int cat_and_flags, DPF_IDENT ident, const char* fmt, va_list
 		// as well as whatever category it's currently in.
 		if (cat_and_flags & D_FAILURE) { basic_flag |= 1<<D_ERROR; }
 
+		bool async_writer = dprintf_async_active();
+
 		//PRAGMA_REMIND("TJ: fix this to distinguish between verbose:2 and verbose:3")
 		for(it = DebugLogs->begin(); it < DebugLogs->end(); it++, ++ixOutput)
 		{
@@ -961,6 +1043,11 @@ _condor_dprintf_va( int cat_and_flags, DPF_IDENT ident, const char* fmt, va_list
 			if (choice && !(choice & basic_flag) && !(choice & verbose_flag))
 				continue;
 
+			if (async_writer && _dprintf_async_eligible(*it)) {
+				_dprintf_to_async_writer(cat_and_flags, hdr_flags, info, message_buffer, &(*it));
+				continue;
+			}
+
 			/* Open and lock the log file */
 			bool   funlock_it = false;
 			switch ((*it).outputTarget) {
@@ -1369,6 +1456,7 @@ debug_close_file(struct DebugFileInfo* it)
 	FILE *debug_file_ptr = (*it).debugFP;
 
 	if( debug_file_ptr ) {
+		dprintf_async_flush();
 		if (debug_file_ptr) {
 			int close_result = fclose_wrapper( debug_file_ptr, FCLOSE_RETRY_MAX );
 			if (close_result < 0) {
@@ -1385,6 +1473,8 @@ debug_close_all_files()
 {
 	if ( ! DebugLogs) return;
 
+	dprintf_async_flush();
+
 	std::vector<DebugFileInfo>::iterator it;
 	for(it = DebugLogs->begin(); it < DebugLogs->end(); it++)
 	{
@@ -1458,6 +1548,7 @@ preserve_log_file(struct DebugFileInfo* it, bool dont_panic, time_t now)
 	(void)setBaseName(filePath.c_str());
 	timestamp = createRotateFilename(NULL, it->maxLogNum, now);
 	(void)sprintf( old, "%s.%s", filePath.c_str() , timestamp);
+	dprintf_async_flush();
 	_condor_dfprintf( it, "Saving log file to \"%s\"\n", old );
 	(void)fflush( debug_file_ptr );
 
@@ -2094,6 +2185,9 @@ safe_async_log_open()
 {
 	int fd;
 
+		// Anything still queued for the async writer happened first.
+	dprintf_async_crash_flush();
+
 	if (DprintfBroken || !_condor_dprintf_works || DebugLogs->empty()) {
 			// Note that although this would appear to enable
 			// backtrace printing to stderr before dprintf is
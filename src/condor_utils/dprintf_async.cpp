@@ -0,0 +1,394 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+/************************************************************************
+**
+**	Asynchronous writer for the debug log, enabled by
+**	<SUBSYS>_LOG_ASYNC_BUFFER_SIZE.  dprintf() still formats each
+**	record in the calling thread, but instead of writing it out it
+**	copies it into a bounded ring buffer, and a writer thread moves
+**	whatever has accumulated to the log files with one writev() per
+**	run of records for the same file.  When the ring is full, records
+**	are dropped and counted rather than making the caller wait for the
+**	disk.  Callers of dprintf() are already serialized by its mutex, so
+**	the ring has a single producer and a single consumer and needs no
+**	lock of its own.
+**
+************************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "dprintf_internal.h"
+
+#if !defined(WIN32)
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <sys/uio.h>
+
+namespace {
+
+	// Each record in the ring starts with one of these, and records
+	// start on 8 byte boundaries.  A record with fd == -1 is padding
+	// that fills out the end of the ring.
+struct RecordHeader {
+	int32_t len;
+	int32_t fd;
+};
+
+const size_t RECORD_ALIGN = 8;
+const int MAX_BATCH_IOV = 64;
+const size_t MIN_RING_SIZE = 64*1024;
+
+size_t record_size( size_t len )
+{
+	return (sizeof(RecordHeader) + len + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+}
+
+struct AsyncLog {
+	char *ring{NULL};
+	size_t capacity{0};
+		// Running byte counts; the offset into the ring is the count
+		// modulo capacity.  Only dprintf() advances head and only the
+		// writer thread (or a crash flush) advances tail.
+	std::atomic<unsigned long long> head{0};
+	std::atomic<unsigned long long> tail{0};
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable wake_writer;
+	std::condition_variable drained;
+	std::atomic<bool> writer_idle{false};
+	std::atomic<bool> crashed{false};
+	bool stopping{false};
+	pid_t owner{0};
+
+	long long dropped_messages{0};
+	long long dropped_bytes{0};
+	long long unreported_drops{0};
+	long long write_errors{0};
+
+	bool empty() const {
+		return head.load( std::memory_order_seq_cst ) == tail.load( std::memory_order_seq_cst );
+	}
+	void Run();
+	bool Push( int fd, const char *data, int len );
+	void Flush();
+	void Stop();
+};
+
+AsyncLog *async_log = NULL;
+
+	// Walk the records between tail and head, handing each run of
+	// records bound for the same file to write_run().  Returns the
+	// position the walk stopped at.
+template <class F>
+unsigned long long
+walk_records( const AsyncLog &log, unsigned long long pos, unsigned long long end, F write_run )
+{
+	struct iovec iov[MAX_BATCH_IOV];
+	int niov = 0;
+	int run_fd = -1;
+
+	while( pos < end ) {
+		const RecordHeader *hdr = (const RecordHeader *)(log.ring + pos % log.capacity);
+		size_t rsize = record_size( hdr->len );
+		if( hdr->fd >= 0 ) {
+			if( niov && (hdr->fd != run_fd || niov == MAX_BATCH_IOV) ) {
+				break;
+			}
+			run_fd = hdr->fd;
+			iov[niov].iov_base = (void *)(hdr + 1);
+			iov[niov].iov_len = hdr->len;
+			++niov;
+		}
+		pos += rsize;
+	}
+	if( niov ) {
+		write_run( run_fd, iov, niov );
+	}
+	return pos;
+}
+
+	// Write out all of iov, picking up after a short write.
+bool
+write_all( int fd, struct iovec *iov, int niov )
+{
+	while( niov > 0 ) {
+		ssize_t rc = writev( fd, iov, niov );
+		if( rc < 0 ) {
+			if( errno == EINTR ) { continue; }
+			return false;
+		}
+		while( niov > 0 && (size_t)rc >= iov->iov_len ) {
+			rc -= iov->iov_len;
+			++iov; --niov;
+		}
+		if( niov > 0 ) {
+			iov->iov_base = (char *)iov->iov_base + rc;
+			iov->iov_len -= rc;
+		}
+	}
+	return true;
+}
+
+void
+AsyncLog::Run()
+{
+		// Signal handlers belong on the main thread.
+	sigset_t all;
+	sigfillset( &all );
+	pthread_sigmask( SIG_BLOCK, &all, NULL );
+
+	for(;;) {
+		{
+			std::unique_lock<std::mutex> guard( mutex );
+				// seq_cst; see Push().
+			writer_idle.store( true, std::memory_order_seq_cst );
+			while( empty() && !stopping ) {
+				wake_writer.wait( guard );
+			}
+			writer_idle = false;
+			if( empty() && stopping ) {
+				break;
+			}
+		}
+
+		unsigned long long end = head.load( std::memory_order_acquire );
+		unsigned long long pos = tail.load( std::memory_order_relaxed );
+		while( pos < end && !crashed ) {
+			pos = walk_records( *this, pos, end,
+				[this]( int fd, struct iovec *iov, int niov ) {
+					if( !write_all( fd, iov, niov ) ) { ++write_errors; }
+				} );
+			tail.store( pos, std::memory_order_release );
+		}
+
+		{
+			std::lock_guard<std::mutex> guard( mutex );
+		}
+		drained.notify_all();
+		if( crashed ) {
+			break;
+		}
+	}
+}
+
+bool
+AsyncLog::Push( int fd, const char *data, int len )
+{
+	size_t rsize = record_size( len );
+	unsigned long long pos = head.load( std::memory_order_relaxed );
+	size_t offset = pos % capacity;
+	size_t pad = (offset + rsize > capacity) ? capacity - offset : 0;
+
+	if( pos + pad + rsize - tail.load( std::memory_order_acquire ) > capacity ) {
+		++dropped_messages;
+		++unreported_drops;
+		dropped_bytes += len;
+		return false;
+	}
+
+	if( pad ) {
+		RecordHeader *hdr = (RecordHeader *)(ring + offset);
+		hdr->len = (int32_t)(pad - sizeof(RecordHeader));
+		hdr->fd = -1;
+		pos += pad;
+		offset = 0;
+	}
+	RecordHeader *hdr = (RecordHeader *)(ring + offset);
+	hdr->len = len;
+	hdr->fd = fd;
+	memcpy( hdr + 1, data, len );
+		// seq_cst, not release: the store to head and the load of
+		// writer_idle must not be reordered, or we could miss a
+		// writer that is just going to sleep.  Run() does the mirror
+		// image, storing writer_idle before it loads head in empty().
+	head.store( pos + rsize, std::memory_order_seq_cst );
+
+	if( writer_idle.load( std::memory_order_seq_cst ) ) {
+		std::lock_guard<std::mutex> guard( mutex );
+		wake_writer.notify_one();
+	}
+	return true;
+}
+
+void
+AsyncLog::Flush()
+{
+	std::unique_lock<std::mutex> guard( mutex );
+	while( !empty() && !crashed ) {
+		wake_writer.notify_one();
+		drained.wait( guard );
+	}
+}
+
+void
+AsyncLog::Stop()
+{
+	{
+		std::lock_guard<std::mutex> guard( mutex );
+		stopping = true;
+	}
+	wake_writer.notify_one();
+	writer.join();
+}
+
+void
+flush_at_exit()
+{
+	dprintf_async_flush();
+}
+
+}
+
+bool
+dprintf_async_configure( long long buffer_size )
+{
+	if( async_log && async_log->owner != getpid() ) {
+			// We forked, and the writer thread stayed behind in the
+			// parent.  Its records are the parent's to write, and the
+			// mutex it may have held belongs to that thread, so leave
+			// the whole thing alone.
+		async_log = NULL;
+	}
+
+	if( buffer_size > 0 && (size_t)buffer_size < MIN_RING_SIZE ) {
+		buffer_size = MIN_RING_SIZE;
+	}
+	buffer_size &= ~(long long)(RECORD_ALIGN - 1);
+
+	if( async_log ) {
+		if( (long long)async_log->capacity == buffer_size ) {
+			return true;
+		}
+		async_log->Stop();
+		free( async_log->ring );
+		delete async_log;
+		async_log = NULL;
+	}
+	if( buffer_size <= 0 ) {
+		return false;
+	}
+
+	static bool registered_exit_flush = false;
+	if( !registered_exit_flush ) {
+		atexit( flush_at_exit );
+		registered_exit_flush = true;
+	}
+
+		// With a writer thread in the picture, dprintf() must always
+		// take its mutex.
+	dprintf_make_thread_safe();
+
+	AsyncLog *log = new AsyncLog;
+	log->ring = (char *)malloc( buffer_size );
+	if( !log->ring ) {
+		delete log;
+		return false;
+	}
+	log->capacity = buffer_size;
+	log->owner = getpid();
+	try {
+		log->writer = std::thread( &AsyncLog::Run, log );
+	} catch( std::system_error & ) {
+		free( log->ring );
+		delete log;
+		return false;
+	}
+	async_log = log;
+	return true;
+}
+
+bool
+dprintf_async_active()
+{
+	return async_log && !async_log->crashed && async_log->owner == getpid();
+}
+
+int
+dprintf_async_write( int fd, const char *data, int len )
+{
+	if( !dprintf_async_active() ) {
+		return DPRINTF_ASYNC_TOO_BIG;
+	}
+		// A record that would take a big bite out of the ring is
+		// written directly rather than risk dropping everything
+		// that comes after it.
+	if( record_size( len ) > async_log->capacity / 4 ) {
+		async_log->Flush();
+		return DPRINTF_ASYNC_TOO_BIG;
+	}
+	return async_log->Push( fd, data, len ) ? DPRINTF_ASYNC_QUEUED : DPRINTF_ASYNC_DROPPED;
+}
+
+long long
+dprintf_async_take_drops( long long &total_dropped )
+{
+	if( !dprintf_async_active() ) {
+		total_dropped = 0;
+		return 0;
+	}
+	long long drops = async_log->unreported_drops;
+	async_log->unreported_drops = 0;
+	total_dropped = async_log->dropped_messages;
+	return drops;
+}
+
+void
+dprintf_async_flush()
+{
+	if( dprintf_async_active() ) {
+		async_log->Flush();
+	}
+}
+
+void
+dprintf_async_crash_flush()
+{
+		// Called from signal handlers, so stick to atomics and write().
+		// The writer thread may be part way through a batch, in which
+		// case some records may come out twice; better that than lost.
+	AsyncLog *log = async_log;
+	if( !log || log->owner != getpid() || log->crashed.exchange( true ) ) {
+		return;
+	}
+	unsigned long long end = log->head.load( std::memory_order_acquire );
+	unsigned long long pos = log->tail.load( std::memory_order_acquire );
+	while( pos < end ) {
+		pos = walk_records( *log, pos, end,
+			[]( int fd, struct iovec *iov, int niov ) {
+				write_all( fd, iov, niov );
+			} );
+	}
+	log->tail.store( end );
+}
+
+#else // WIN32
+
+bool dprintf_async_configure( long long /*buffer_size*/ ) { return false; }
+bool dprintf_async_active() { return false; }
+int dprintf_async_write( int, const char *, int ) { return DPRINTF_ASYNC_TOO_BIG; }
+long long dprintf_async_take_drops( long long &total_dropped ) { total_dropped = 0; return 0; }
+void dprintf_async_flush() {}
+void dprintf_async_crash_flush() {}
+
+#endif
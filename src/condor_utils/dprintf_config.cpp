@@ -358,6 +358,24 @@ dprintf_config( const char *subsys, struct dprintf_output_settings *p_info /* =
 		log_keep_open = param_boolean_int(pname, log_open_default);//dprintf_param_funcs->param_boolean_int(pname, log_open_default);
 	}
 
+	/*
+	** Hand writes to the log files to a writer thread, buffering
+	** at most this many bytes.  0 means write synchronously.
+	*/
+	long long async_buffer = 0;
+	(void)sprintf(pname, "%s_LOG_ASYNC_BUFFER_SIZE", subsys);
+	pval = param(pname);
+	if (pval) {
+		bool unit_is_time = false;
+		if ( ! dprintf_parse_log_size(pval, async_buffer, unit_is_time) || unit_is_time || async_buffer < 0) {
+			std::string m;
+			formatstr(m, "Invalid config %s = %s: %s must be a size >= 0 and may be followed by a units value\n", pname, pval, pname);
+			_condor_dprintf_exit(EINVAL, m.c_str());
+		}
+		free(pval);
+	}
+	dprintf_async_configure(async_buffer);
+
 	/*
 	If LOGS_USE_TIMESTAMP is enabled, we will print out Unix timestamps
 	instead of the standard date format in all the log messages
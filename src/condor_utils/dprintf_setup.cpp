@@ -193,7 +193,9 @@ void dprintf_set_outputs(const struct dprintf_output_settings *p_info, int c_inf
 
 	if(debugLogsOld)
 	{
-		
+			// the async writer may still have records for the old files
+		dprintf_async_flush();
+
 		for (it = debugLogsOld->begin(); it != debugLogsOld->end(); it++)
 		{
 			if ((it->outputTarget == SYSLOG) && (it->userData))
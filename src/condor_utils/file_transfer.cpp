@@ -43,6 +43,7 @@
 #include "condor_url.h"
 #include "my_popen.h"
 #include "file_transfer_stats.h"
+#include "file_transfer_streams.h"
 #include "utc_time.h"
 #include "data_reuse.h"
 #include "AWSv4-utils.h"
@@ -60,6 +61,7 @@
 
 const char * const StdoutRemapName = "_condor_stdout";
 const char * const StderrRemapName = "_condor_stderr";
+const char * const TransferProgressFileName = ".transfer_progress";
 
 // Transfer commands are sent from the upload side to the download side.
 // 0 - finished
@@ -80,6 +82,10 @@ const char * const StderrRemapName = "_condor_stderr";
 //     files available.
 // 9 - ClassAd contains a list of URLs that need to be signed for the uploader
 //     to proceed.
+// 10 - ClassAd asks the downloader which files it kept from an earlier,
+//     failed attempt; the response gives an offset and checksum for each.
+//     When such a file is sent, its data is preceded by the offset the
+//     uploader resumes from, or 0 if it starts over.
 enum class TransferCommand {
 	Unknown = -1,
 	Finished = 0,
@@ -89,6 +95,7 @@ enum class TransferCommand {
 	XferX509 = 4,
 	DownloadUrl = 5,
 	Mkdir = 6,
+	XferBatch = 7,
 	Other = 999
 };
 
@@ -96,11 +103,24 @@ enum class TransferSubCommand {
 	Unknown = -1,
 	UploadUrl = 7,
 	ReuseInfo = 8,
-	SignUrls = 9
+	SignUrls = 9,
+	ResumeInfo = 10
 };
 
+// Commands that are followed by the contents of a single file.
+static bool
+IsFileCommand( TransferCommand cmd )
+{
+	return cmd == TransferCommand::XferFile ||
+		cmd == TransferCommand::EnableEncryption ||
+		cmd == TransferCommand::DisableEncryption;
+}
+
 #define COMMIT_FILENAME ".ccommit.con"
 
+// A partly received file is kept up to a multiple of this many bytes.
+static const filesize_t TRANSFER_RESUME_BLOCK = 1024 * 1024;
+
 // Filenames are case insensitive on Win32, but case sensitive on Unix
 #ifdef WIN32
 #	define file_strcmp _stricmp
@@ -224,6 +244,21 @@ private:
 	filesize_t m_file_size{0};
 };
 
+/**
+ * A small file, or a directory, waiting to go out in a batch; see
+ * FileTransfer::SendFileBatch().
+ */
+struct FileBatchEntry {
+	MyString fullname;
+	MyString dest_filename;
+	bool is_directory{false};
+	condor_mode_t mode{NULL_FILE_PERMISSIONS};
+};
+
+	// Largest file that may be sent in a batch, whatever the sender's
+	// FILE_TRANSFER_BATCH_MAX_FILE_SIZE says; the receiver refuses more.
+const filesize_t FILE_BATCH_MAX_RECORD = 1024 * 1024;
+
 const int GO_AHEAD_FAILED = -1; // failed to contact transfer queue manager
 const int GO_AHEAD_UNDEFINED = 0;
 const int GO_AHEAD_ONCE = 1;    // send one file and ask again
@@ -2051,6 +2086,7 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 //	dprintf(D_FULLDEBUG,"TODD filetransfer DoDownload final_transfer=%d\n",final_transfer);
 
 	filesize_t sandbox_size = 0;
+	int transfer_streams = 0;
 	if( PeerDoesXferInfo ) {
 		ClassAd xfer_info;
 		if( !getClassAd(s,xfer_info) ) {
@@ -2058,6 +2094,7 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 			return_and_resetpriv( -1 );
 		}
 		xfer_info.LookupInteger(ATTR_SANDBOX_SIZE,sandbox_size);
+		xfer_info.LookupInteger(ATTR_TRANSFER_STREAMS,transfer_streams);
 	}
 
 	if( !s->end_of_message() ) {
@@ -2065,12 +2102,38 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 		return_and_resetpriv( -1 );
 	}
 
+	FileTransferStreamsReset streams_reset(m_streams);
+	if( transfer_streams > 0 ) {
+		if( !SetupTransferStreams(s, transfer_streams, false) ) {
+			dprintf(D_FULLDEBUG,"DoDownload: failed to set up data streams; exiting at %d\n",__LINE__);
+			return_and_resetpriv( -1 );
+		}
+	}
+
 	if( !final_transfer && IsServer() ) {
 		SpooledJobFiles::createJobSpoolDirectory(&jobAd,desired_priv_state);
 	}
 
 	bool sign_s3_urls = param_boolean("SIGN_S3_URLS", true) && PeerDoesS3Urls;
 
+		// A starter that fails to receive its input tries again, so
+		// keep what arrives.  Whatever is in the sandbox is written down
+		// unless the download completes, and the retry offers it back
+		// to the peer, which resumes each file it can verify.
+	bool resume_download = PeerDoesResume && IsClient() && !simple_init && !final_transfer &&
+		param_integer("FILE_TRANSFER_RESUME_MIN_SIZE", 10 * 1024 * 1024, 0) > 0;
+	TransferProgress progress;
+	TransferProgress resume_offers;
+	if( resume_download ) {
+		LoadTransferProgress(progress);
+	}
+	struct ProgressSaver {
+		FileTransfer &ft;
+		TransferProgress &progress;
+		bool active;
+		~ProgressSaver() { if( active ) { ft.SaveTransferProgress(progress); } }
+	} progress_saver{*this, progress, resume_download};
+
 		/*
 		  If we want to change priv states, do it now.
 		  Even if we don't transfer any files, we write a commit
@@ -2080,48 +2143,11 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 		saved_priv = set_priv( desired_priv_state );
 	}
 
-	// Start the main download loop. Read reply codes + filenames off a
-	// socket wire, s, then handle downloads according to the reply code.
-	for (;;) {
-		TransferCommand xfer_command = TransferCommand::Unknown;
-		{
-			int reply;
-			if( !s->code(reply) ) {
-				dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
-				return_and_resetpriv( -1 );
-			}
-			xfer_command = static_cast<TransferCommand>(reply);
-		}
-		if( !s->end_of_message() ) {
-			dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
-			return_and_resetpriv( -1 );
-		}
-		dprintf( D_FULLDEBUG, "FILETRANSFER: incoming file_command is %i\n", static_cast<int>(xfer_command));
-		if( xfer_command == TransferCommand::Finished ) {
-			break;
-		}
-
-		if ((xfer_command == TransferCommand::EnableEncryption) || (PeerDoesS3Urls && xfer_command == TransferCommand::DownloadUrl)) {
-			bool cryp_ret = s->set_crypto_mode(true);
-			if (!cryp_ret) {
-				dprintf(D_ALWAYS,"DoDownload: failed to enable crypto on incoming file, exiting at %d\n",__LINE__);
-				return_and_resetpriv( -1 );
-			}
-		} else if (xfer_command == TransferCommand::DisableEncryption) {
-			s->set_crypto_mode(false);
-		} else {
-			bool cryp_ret = s->set_crypto_mode(socket_default_crypto);
-			if(!cryp_ret) {
-				dprintf(D_ALWAYS,"DoDownload: failed to change crypto to %i on incoming file, "
-					"exiting at %d\n", socket_default_crypto, __LINE__);
-				return_and_resetpriv( -1 );
-			}
-		}
-
-		if( !s->code(filename) ) {
-			dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
-			return_and_resetpriv( -1 );
-		}
+		// Work out where a file named by our peer should be written.
+		// This is used for each file in a batch as well as for the
+		// single file that follows most commands.
+	auto download_fullname = [&]( MyString &filename, TransferCommand xfer_command ) {
+		MyString fullname;
 
 			// This check must come after we have called set_priv()
 		if( !LegalPathInSandbox(filename.Value(),Iwd) ) {
@@ -2221,6 +2247,57 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 			fullname.formatstr("%s%c%s",TmpSpoolSpace,DIR_DELIM_CHAR,filename.Value());
 		}
 
+		return fullname;
+	};
+
+	// Start the main download loop. Read reply codes + filenames off a
+	// socket wire, s, then handle downloads according to the reply code.
+	for (;;) {
+		TransferCommand xfer_command = TransferCommand::Unknown;
+		FileTransferStreams::File *streamed_file = nullptr;
+		int stream_rc = 0;
+		int batch_files = 0;
+		{
+			int reply;
+			if( !s->code(reply) ) {
+				dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
+				return_and_resetpriv( -1 );
+			}
+			xfer_command = static_cast<TransferCommand>(reply);
+		}
+		if( !s->end_of_message() ) {
+			dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
+			return_and_resetpriv( -1 );
+		}
+		dprintf( D_FULLDEBUG, "FILETRANSFER: incoming file_command is %i\n", static_cast<int>(xfer_command));
+		if( xfer_command == TransferCommand::Finished ) {
+			break;
+		}
+
+		if ((xfer_command == TransferCommand::EnableEncryption) || (PeerDoesS3Urls && xfer_command == TransferCommand::DownloadUrl)) {
+			bool cryp_ret = s->set_crypto_mode(true);
+			if (!cryp_ret) {
+				dprintf(D_ALWAYS,"DoDownload: failed to enable crypto on incoming file, exiting at %d\n",__LINE__);
+				return_and_resetpriv( -1 );
+			}
+		} else if (xfer_command == TransferCommand::DisableEncryption) {
+			s->set_crypto_mode(false);
+		} else {
+			bool cryp_ret = s->set_crypto_mode(socket_default_crypto);
+			if(!cryp_ret) {
+				dprintf(D_ALWAYS,"DoDownload: failed to change crypto to %i on incoming file, "
+					"exiting at %d\n", socket_default_crypto, __LINE__);
+				return_and_resetpriv( -1 );
+			}
+		}
+
+		if( !s->code(filename) ) {
+			dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
+			return_and_resetpriv( -1 );
+		}
+
+		fullname = download_fullname( filename, xfer_command );
+
 		auto iter = std::find_if(reuse_info.begin(), reuse_info.end(),
 			[&](ReuseInfo &info){return !strcmp(filename.Value(), info.filename().c_str());});
 		bool should_reuse = !reservation_id.empty() && m_reuse_dir && iter != reuse_info.end();
@@ -2313,6 +2390,23 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 		// deferred until the end of the loop.
 		isDeferredTransfer = false;
 
+			// If we offered the peer what we have of this file, it tells
+			// us where it picks up.
+		filesize_t resume_offset = 0;
+		auto offer = resume_offers.find(filename.Value());
+		if( offer != resume_offers.end() && IsFileCommand(xfer_command) ) {
+			if( !s->code(resume_offset) || !s->end_of_message() ) {
+				dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
+				return_and_resetpriv( -1 );
+			}
+			if( resume_offset != 0 && resume_offset != offer->second.offset ) {
+				dprintf(D_ALWAYS,"DoDownload: peer resumed %s at an offset we did not offer\n",filename.Value());
+				return_and_resetpriv( -1 );
+			}
+			resume_offers.erase(offer);
+			thisFileStats.TransferResumedBytes = resume_offset;
+		}
+
 		if (xfer_command == TransferCommand::Other) {
 			// filename already received:
 			// .  verify that it is the same as FileName attribute in following classad
@@ -2391,6 +2485,34 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 						"after encountering the following error: %s\n",
 						error_buf.Value());
 				}
+			} else if (subcommand == TransferSubCommand::ResumeInfo) {
+				if (!s->end_of_message()) {
+					dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
+					return_and_resetpriv( -1 );
+				}
+				std::vector<ExprTree*> resume_list;
+				if (resume_download) {
+					for (const auto &entry : progress) {
+						classad::ClassAd *ad = new classad::ClassAd();
+						ad->InsertAttr("FileName", entry.first);
+						ad->InsertAttr("Offset", static_cast<long long>(entry.second.offset));
+						ad->InsertAttr("ChecksumType", "sha256");
+						ad->InsertAttr("Checksum", entry.second.checksum);
+						resume_list.push_back(ad);
+					}
+					resume_offers = progress;
+					dprintf(D_FULLDEBUG, "DoDownload: Offering %d files kept from an earlier attempt.\n",
+						(int)resume_offers.size());
+				}
+				ClassAd ad;
+				ad.Insert("ResumeList", classad::ExprList::MakeExprList(resume_list));
+				s->encode();
+				if (!putClassAd(s, ad) || !s->end_of_message()) {
+					dprintf(D_FULLDEBUG,"DoDownload: exiting at %d\n",__LINE__);
+					return_and_resetpriv( -1 );
+				}
+				s->decode();
+				continue;
 			} else if (subcommand == TransferSubCommand::ReuseInfo) {
 					// We must consume the EOM in order to send the ClassAd later.
 				if (!s->end_of_message()) {
@@ -2459,6 +2581,12 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 								continue;
 							}
 							dprintf(D_FULLDEBUG, "Successfully retrieved %s from data reuse directory into job sandbox.\n", filename.c_str());
+							if (ExecFile && !file_strcmp(condor_basename(ExecFile), filename.c_str()) &&
+								chmod(dest_fname.c_str(), 0755) < 0)
+							{
+								dprintf(D_ALWAYS, "Failed to set execute bit on %s, errno=%d (%s)\n",
+									dest_fname.c_str(), errno, strerror(errno));
+							}
 							retrieved_files.push_back(filename);
 						}
 						std::unique_ptr<classad::ExprList> retrieved_list(new classad::ExprList());
@@ -2727,6 +2855,157 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 						error_buf.Value());
 				}
 			}
+		} else if ( xfer_command == TransferCommand::XferBatch ) {
+			// See SendFileBatch() for the format.  Files that fail are
+			// skipped, so the rest of the batch is still consumed, and
+			// the first failure is reported like get_file() would.
+			int count = 0;
+			int batch_rc = 0;
+			int batch_errno = 0;
+			MyString batch_failed;
+			std::vector<char> buf;
+			rc = s->code(count) ? 0 : -1;
+			for( int i = 0; i < count && rc == 0; i++ ) {
+				int type = 0;
+				MyString entry_filename;
+				condor_mode_t entry_mode = NULL_FILE_PERMISSIONS;
+				int64_t mtime = 0;
+				filesize_t size = -1;
+				if( !s->code(type) || !s->code(entry_filename) || !s->code(entry_mode) ||
+					!s->code(mtime) || !s->code(size) || size > FILE_BATCH_MAX_RECORD )
+				{
+					dprintf(D_ALWAYS,"DoDownload: failed to read batch record %d of %d.\n",i+1,count);
+					rc = -1;
+					break;
+				}
+				if( size > 0 ) {
+					buf.resize( size );
+					if( s->get_bytes( &buf[0], (int)size ) != (int)size ) {
+						rc = -1;
+						break;
+					}
+					bytes += size;
+				}
+				batch_files++;
+
+				MyString entry_fullname = download_fullname( entry_filename, xfer_command );
+				if( entry_fullname == NULL_FILE ) {
+					continue;
+				}
+				if( type == 1 ) {
+					if( entry_mode == NULL_FILE_PERMISSIONS ) {
+						entry_mode = (condor_mode_t) 0700;
+					}
+					mode_t old_umask = umask(0);
+					int mkdir_rc = mkdir( entry_fullname.Value(), (mode_t)entry_mode );
+					umask(old_umask);
+					if( mkdir_rc == -1 ) {
+						StatInfo st( entry_fullname.Value() );
+						if( errno != EEXIST || st.Error() || !st.IsDirectory() ) {
+							if( !batch_rc ) {
+								batch_rc = GET_FILE_OPEN_FAILED;
+								batch_errno = errno;
+								batch_failed = entry_fullname;
+							}
+						}
+					}
+					continue;
+				}
+				if( size < 0 ) {
+					// the sender couldn't read this one and will say so
+					continue;
+				}
+				if( this_file_max_bytes >= 0 && bytes > this_file_max_bytes ) {
+					if( !batch_rc ) {
+						batch_rc = GET_FILE_MAX_BYTES_EXCEEDED;
+						batch_failed = entry_fullname;
+					}
+					continue;
+				}
+
+				int fd = safe_open_wrapper_follow( entry_fullname.Value(), O_WRONLY | O_CREAT | O_TRUNC | _O_BINARY | O_LARGEFILE, 0600 );
+				int entry_rc = fd < 0 ? GET_FILE_OPEN_FAILED : 0;
+				filesize_t nwritten = 0;
+				while( !entry_rc && nwritten < size ) {
+					ssize_t n = write( fd, &buf[nwritten], size - nwritten );
+					if( n <= 0 ) {
+						entry_rc = GET_FILE_WRITE_FAILED;
+						break;
+					}
+					nwritten += n;
+				}
+				if( fd >= 0 && close( fd ) < 0 && !entry_rc ) {
+					entry_rc = GET_FILE_WRITE_FAILED;
+				}
+				if( entry_rc ) {
+					dprintf(D_ALWAYS,"DoDownload: failed to write %s from batch: (errno %d) %s\n",
+							entry_fullname.Value(), errno, strerror(errno));
+					if( !batch_rc ) {
+						batch_rc = entry_rc;
+						batch_errno = errno;
+						batch_failed = entry_fullname;
+					}
+					continue;
+				}
+
+				if( ExecFile && !file_strcmp( condor_basename( ExecFile ), entry_filename.Value() ) ) {
+					entry_mode = (condor_mode_t) 0755;
+				}
+				if( entry_mode != NULL_FILE_PERMISSIONS && chmod( entry_fullname.Value(), (mode_t)entry_mode ) < 0 ) {
+					dprintf( D_ALWAYS, "Failed to chmod file '%s': %s (errno: %d)\n",
+							 entry_fullname.Value(), strerror(errno), errno );
+				}
+					// Keep the sender's modification time, unless we
+					// need it to show the time of the download; see
+					// want_fsync above.
+				struct utimbuf timewrap;
+				timewrap.actime = timewrap.modtime = want_fsync ? time(NULL) : (time_t)mtime;
+				if( want_fsync || mtime > 0 ) {
+					utime( entry_fullname.Value(), &timewrap );
+				}
+
+				auto entry_reuse = std::find_if(reuse_info.begin(), reuse_info.end(),
+					[&](ReuseInfo &info){return !strcmp(entry_filename.Value(), info.filename().c_str());});
+				CondorError err;
+				if( !reservation_id.empty() && m_reuse_dir && entry_reuse != reuse_info.end() &&
+					!m_reuse_dir->CacheFile(entry_fullname.Value(), entry_reuse->checksum(),
+						entry_reuse->checksum_type(), reservation_id, err) )
+				{
+					dprintf(D_FULLDEBUG, "Failed to save file %s for reuse: %s\n", entry_fullname.Value(),
+						err.getFullText().c_str());
+				}
+			}
+			if( rc == 0 && batch_rc ) {
+				// name the file that failed in the error handling below
+				rc = batch_rc;
+				errno = batch_errno;
+				fullname = batch_failed;
+			}
+		} else if ( m_streams && (stream_rc = m_streams->ReceiveFile( s, fullname.Value(), this_file_max_bytes, streamed_file )) != 0 ) {
+			// The contents arrive on one of the data streams; the file
+			// is finished off once they have all drained, below.
+			rc = stream_rc < 0 ? -1 : 0;
+			if ( streamed_file ) {
+				streamed_file->make_executable = ExecFile && !file_strcmp( condor_basename( ExecFile ), filename.Value() );
+				streamed_file->reuse = should_reuse;
+				if ( should_reuse ) {
+					streamed_file->reuse_checksum = iter->checksum();
+					streamed_file->reuse_checksum_type = iter->checksum_type();
+				}
+			}
+		} else if ( resume_download ) {
+			// As below, but what arrives is kept for a retry.
+			rc = ReceiveResumableFile( s, filename.Value(), fullname.Value(), resume_offset, this_file_max_bytes, xfer_queue, progress, bytes );
+			CondorError err;
+			if (rc == 0 && should_reuse && !m_reuse_dir->CacheFile(fullname.Value(), iter->checksum(),
+					iter->checksum_type(), reservation_id, err))
+			{
+				dprintf(D_FULLDEBUG, "Failed to save file %s for reuse: %s\n", fullname.Value(),
+					err.getFullText().c_str());
+				if (!strcmp(err.subsys(), "DataReuse") && err.code() == 11) {
+					rc = -1;
+				}
+			}
 		} else if ( TransferFilePermissions ) {
 			// We could create the target's parent directories, but since
 			// we need to have sent them along as explicit transfer items
@@ -2815,7 +3094,7 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 			}
 		}
 
-		if ( ExecFile && !file_strcmp( condor_basename( ExecFile ), filename.Value() ) ) {
+		if ( !streamed_file && !batch_files && ExecFile && !file_strcmp( condor_basename( ExecFile ), filename.Value() ) ) {
 				// We're receiving the executable, make sure execute
 				// bit is set
 				// TODO How should we modify the permisions of the
@@ -2842,7 +3121,7 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 #endif
 		}
 
-		if ( want_fsync ) {
+		if ( want_fsync && !streamed_file && !batch_files ) {
 			struct utimbuf timewrap;
 
 			time_t current_time = time(NULL);
@@ -2855,12 +3134,20 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 		if( !s->end_of_message() ) {
 			return_and_resetpriv( -1 );
 		}
+		if( streamed_file ) {
+				// bytes and stats are accounted for after the streams finish
+			numFiles++;
+			continue;
+		}
 		*total_bytes += bytes;
 		thisFileStats.TransferFileBytes += bytes;
 		thisFileStats.TransferTotalBytes += bytes;
 		bytes = 0;
 
 		numFiles++;
+		if( batch_files > 1 ) {
+			numFiles += batch_files - 1;
+		}
 
 		// Gather a few more statistics
 		thisFileStats.TransferSuccess = download_success;
@@ -2871,6 +3158,10 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 		ClassAd thisFileStatsAd;
 		thisFileStats.Publish(thisFileStatsAd);
 		thisFileStatsAd.Update(pluginStatsAd);
+		if( xfer_command == TransferCommand::XferBatch ) {
+			// one record covers the whole batch, named for its first file
+			thisFileStatsAd.Assign("TransferFiles", batch_files);
+		}
 
 		// Write stats to disk
 		if( !isDeferredTransfer ) {
@@ -2884,6 +3175,88 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 	}
 	// End of the main download loop
 
+	// Wait for the data streams to drain, then finish off the files
+	// that came over them the way the loop above does for the rest.
+	if( m_streams ) {
+		bool streams_ok = m_streams->Finish();
+		for( auto &file : m_streams->Files() ) {
+			const char *name = file->name.c_str();
+			*total_bytes += file->stats.TransferFileBytes;
+
+			if( file->rc == 0 ) {
+				if( file->mode != NULL_FILE_PERMISSIONS && chmod( name, (mode_t)file->mode ) < 0 ) {
+					dprintf( D_ALWAYS, "Failed to chmod file '%s': %s (errno: %d)\n",
+							 name, strerror(errno), errno );
+				}
+				if( file->make_executable && chmod( name, 0755 ) < 0 ) {
+					dprintf( D_ALWAYS, "Failed to set execute bit on %s, errno=%d (%s)\n",
+							 name, errno, strerror(errno) );
+				}
+				if( want_fsync ) {
+					struct utimbuf timewrap;
+					time_t current_time = time(NULL);
+					timewrap.actime = current_time;
+					timewrap.modtime = current_time;
+					utime( name, &timewrap );
+				}
+				CondorError err;
+				if( file->reuse && !m_reuse_dir->CacheFile( name, file->reuse_checksum,
+						file->reuse_checksum_type, reservation_id, err ) )
+				{
+					dprintf( D_FULLDEBUG, "Failed to save file %s for reuse: %s\n", name,
+						err.getFullText().c_str() );
+					if( !strcmp(err.subsys(), "DataReuse") && err.code() == 11 ) {
+						file->rc = -1;
+						file->stats.TransferSuccess = false;
+					}
+				}
+			}
+			else if( strcmp( name, NULL_FILE ) ) {
+				IGNORE_RETURN unlink( name );
+			}
+
+			if( file->rc && download_success ) {
+				download_success = false;
+				error_buf.formatstr( "%s at %s failed to receive file %s",
+									 get_mySubSystem()->getName(), s->my_ip_str(), name );
+				hold_code = CONDOR_HOLD_CODE_DownloadFileError;
+				hold_subcode = file->error_errno;
+				if( file->rc == GET_FILE_OPEN_FAILED || file->rc == GET_FILE_WRITE_FAILED ) {
+					try_again = false;
+					error_buf.replaceString( "receive", "write to" );
+					error_buf.formatstr_cat( ": (errno %d) %s", file->error_errno, strerror(file->error_errno) );
+				}
+				else if( file->rc == GET_FILE_MAX_BYTES_EXCEEDED ) {
+					try_again = false;
+					error_buf.formatstr_cat( ": max total download bytes exceeded (max=%ld MB)",
+											 (long int)(MaxDownloadBytes/1024/1024) );
+					hold_code = CONDOR_HOLD_CODE_MaxTransferOutputSizeExceeded;
+					hold_subcode = 0;
+				}
+				else {
+					try_again = true;
+				}
+				dprintf( D_ALWAYS, "DoDownload: %s\n", error_buf.Value() );
+			}
+
+			ClassAd fileStatsAd;
+			file->stats.Publish( fileStatsAd );
+			OutputFileTransferStats( fileStatsAd );
+		}
+		if( !streams_ok && download_success ) {
+			download_success = false;
+			try_again = true;
+			hold_code = CONDOR_HOLD_CODE_DownloadFileError;
+			hold_subcode = 0;
+			error_buf.formatstr( "%s at %s failed to receive files: data stream failed",
+								 get_mySubSystem()->getName(), s->my_ip_str() );
+		}
+
+		ClassAd streamStatsAd;
+		m_streams->PublishStats( streamStatsAd );
+		OutputFileTransferStats( streamStatsAd );
+	}
+
         // Release transfer queue slot after file has been put but before the
         // final transfer ACKs are done.  In the future where multifile transfers
         // plugins are used in DoDownload, this would allow DoDownload side to
@@ -2990,6 +3363,12 @@ FileTransfer::DoDownload( filesize_t *total_bytes, ReliSock *s)
 
 	downloadEndTime = condor_gettimestamp_double();
 
+	if( resume_download ) {
+		progress_saver.active = false;
+		std::string record = std::string(Iwd) + DIR_DELIM_CHAR + TransferProgressFileName;
+		IGNORE_RETURN unlink(record.c_str());
+	}
+
 	download_success = true;
 	SendTransferAck(s,download_success,try_again,hold_code,hold_subcode,NULL);
 
@@ -3690,9 +4069,19 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
 		return_and_resetpriv( -1 );
 	}
+	int transfer_streams = 0;
+	if( PeerDoesTransferStreams ) {
+		transfer_streams = param_integer("FILE_TRANSFER_STREAMS", 1);
+		if( transfer_streams < 2 ) {
+			transfer_streams = 0;
+		}
+	}
 	if( PeerDoesXferInfo ) {
 		ClassAd xfer_info;
 		xfer_info.Assign(ATTR_SANDBOX_SIZE,sandbox_size);
+		if( transfer_streams ) {
+			xfer_info.Assign(ATTR_TRANSFER_STREAMS,transfer_streams);
+		}
 		if( !putClassAd(s,xfer_info) ) {
 			dprintf(D_FULLDEBUG,"DoUpload: failed to send xfer_info; exiting at %d\n",__LINE__);
 			return_and_resetpriv( -1 );
@@ -3703,6 +4092,14 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		return_and_resetpriv( -1 );
 	}
 
+	FileTransferStreamsReset streams_reset(m_streams);
+	if( transfer_streams && PeerDoesXferInfo ) {
+		if( !SetupTransferStreams(s, transfer_streams, true) ) {
+			dprintf(D_FULLDEBUG,"DoUpload: failed to set up data streams; exiting at %d\n",__LINE__);
+			return_and_resetpriv( -1 );
+		}
+	}
+
 	std::string tag;
 	if (jobAd.EvaluateAttrString(ATTR_USER, tag))
 	{
@@ -3764,40 +4161,65 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		m_reuse_info_err.clear();
 	}
 
-
-	std::unordered_set<std::string> skip_files;
-	if (!m_reuse_info.empty())
-	{
-		dprintf(D_FULLDEBUG, "DoUpload: Sending remote side hints about potential file reuse.\n");
-
+		// Send the peer a ClassAd command that it answers with a ClassAd
+		// of its own, such as the list of files it may already have.
+	bool info_go_ahead_done = false;
+	auto exchange_info = [&](const ClassAd &file_info, ClassAd &reply_ad) -> bool {
 			// Indicate a ClassAd-based command.
 		if( !s->snd_int(static_cast<int>(TransferCommand::Other), false) || !s->end_of_message() ) {
-			dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
-			return_and_resetpriv( -1 );
+			return false;
 		}
 			// Fake an empty filename.
 		if (!s->put("") || !s->end_of_message()) {
-			dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
-			return_and_resetpriv(-1);
+			return false;
 		}
 
-			// Here, we must wait for the go-ahead from the transfer peer.
-		if (!ReceiveTransferGoAhead(s, "", false, peer_goes_ahead_always, peer_max_transfer_bytes)) {
-			dprintf(D_FULLDEBUG, "DoUpload: exiting at %d\n",__LINE__);
-			return_and_resetpriv( -1 );
+		if (!info_go_ahead_done) {
+				// Here, we must wait for the go-ahead from the transfer peer.
+			if (!ReceiveTransferGoAhead(s, "", false, peer_goes_ahead_always, peer_max_transfer_bytes)) {
+				return false;
+			}
+				// Obtain the transfer token from the transfer queue.
+			if (!ObtainAndSendTransferGoAhead(xfer_queue, false, s, sandbox_size, "", I_go_ahead_always) ) {
+				return false;
+			}
+			info_go_ahead_done = true;
+		} else {
+			if (!peer_goes_ahead_always &&
+				!ReceiveTransferGoAhead(s, "", false, peer_goes_ahead_always, peer_max_transfer_bytes))
+			{
+				return false;
+			}
+			if (!I_go_ahead_always &&
+				!ObtainAndSendTransferGoAhead(xfer_queue, false, s, sandbox_size, "", I_go_ahead_always))
+			{
+				return false;
+			}
 		}
-			// Obtain the transfer token from the transfer queue.
-		if (!ObtainAndSendTransferGoAhead(xfer_queue, false, s, sandbox_size, "", I_go_ahead_always) ) {
-			dprintf(D_FULLDEBUG, "DoUpload: exiting at %d\n",__LINE__);
-			return_and_resetpriv( -1 );
+
+		if (!putClassAd(s, file_info) || !s->end_of_message()) {
+			return false;
 		}
+		s->decode();
+		if (!getClassAd(s, reply_ad)) {
+			return false;
+		}
+		if (!s->end_of_message()) {
+			return false;
+		}
+		s->encode();
+		return true;
+	};
 
+		// Send the peer a list of files it may already have, and get
+		// back the list of those it found in its data reuse directory.
+	auto exchange_reuse_info = [&](const std::vector<ReuseInfo> &reuse_list, ClassAd &reuse_ad) -> bool {
 		ClassAd file_info;
 		auto sub = static_cast<int>(TransferSubCommand::ReuseInfo);
 		file_info.InsertAttr("SubCommand", sub);
 		file_info.InsertAttr("Tag", tag);
 		std::vector<ExprTree*> info_list;
-		for (auto &info : m_reuse_info) {
+		for (auto &info : reuse_list) {
 			classad::ClassAd *ad = new classad::ClassAd();
 			ad->InsertAttr("FileName", condor_basename(info.filename().c_str()));
 			ad->InsertAttr("ChecksumType", info.checksum_type());
@@ -3806,21 +4228,69 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			info_list.push_back(ad);
 		}
 		file_info.Insert("ReuseList", classad::ExprList::MakeExprList(info_list));
-		if (!putClassAd(s, file_info) || !s->end_of_message()) {
+		return exchange_info(file_info, reuse_ad);
+	};
+
+		// Without a manifest from the user, checksum the larger input
+		// files ourselves -- but only once the peer has said it has a
+		// data reuse directory to look them up in.  The probe is an
+		// empty list; a peer without a directory answers with a Result.
+	filesize_t reuse_min_size = param_integer("DATA_REUSE_CHECKSUM_MIN_SIZE", 10 * 1024 * 1024, 0);
+	std::unordered_map<std::string, std::string> reuse_src_names;
+	if (m_reuse_info.empty() && PeerDoesReuseInfo && !m_final_transfer_flag &&
+		!simple_init && reuse_min_size > 0 &&
+		std::any_of(filelist.begin(), filelist.end(), [&](const FileTransferItem &item) {
+			return item.fileSize() >= reuse_min_size;
+		}))
+	{
+		ClassAd probe_ad;
+		if (!exchange_reuse_info(std::vector<ReuseInfo>(), probe_ad)) {
 			dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
-			return_and_resetpriv(-1);
+			return_and_resetpriv( -1 );
 		}
-		ClassAd reuse_ad;
-		s->decode();
-		if (!getClassAd(s, reuse_ad)) {
-			dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
-			return_and_resetpriv(-1);
+		if (probe_ad.Lookup("Result")) {
+			dprintf(D_FULLDEBUG, "DoUpload: Remote side has no data reuse directory.\n");
+		} else {
+			for (const auto &fileitem : filelist) {
+				if (fileitem.isSrcUrl() || fileitem.isDirectory() || fileitem.isDomainSocket() ||
+					!fileitem.destDir().empty() || fileitem.fileSize() < reuse_min_size)
+				{
+					continue;
+				}
+				const std::string &src_name = fileitem.srcName();
+				if (X509UserProxy && file_strcmp(src_name.c_str(), X509UserProxy) == 0) {
+					continue;
+				}
+				std::string src_fullname = src_name;
+				if (!fullpath(src_fullname.c_str())) {
+					src_fullname = std::string(Iwd) + DIR_DELIM_CHAR + src_name;
+				}
+				std::string checksum;
+				CondorError err;
+				if (!htcondor::DataReuseDirectory::ComputeChecksum(src_fullname, "sha256", checksum, err)) {
+					dprintf(D_FULLDEBUG, "DoUpload: Not offering %s for reuse: %s\n",
+						src_name.c_str(), err.getFullText().c_str());
+					continue;
+				}
+					// The executable lands in the sandbox under its
+					// standard name, and the reply comes back that way.
+				std::string reuse_name = (ExecFile && file_strcmp(ExecFile, src_name.c_str()) == 0) ? CONDOR_EXEC : src_name;
+				reuse_src_names[condor_basename(reuse_name.c_str())] = src_name;
+				m_reuse_info.emplace_back(reuse_name, checksum, "sha256", tag, fileitem.fileSize());
+			}
 		}
-		if (!s->end_of_message()) {
+	}
+
+	std::unordered_set<std::string> skip_files;
+	if (!m_reuse_info.empty())
+	{
+		dprintf(D_FULLDEBUG, "DoUpload: Sending remote side hints about potential file reuse.\n");
+
+		ClassAd reuse_ad;
+		if (!exchange_reuse_info(m_reuse_info, reuse_ad)) {
 			dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
 			return_and_resetpriv(-1);
 		}
-		s->encode();
 		classad::Value value;
 		classad_shared_ptr<classad::ExprList> exprlist;
 		if (reuse_ad.EvaluateAttr("ReuseList", value) && value.IsSListValue(exprlist))
@@ -3832,7 +4302,10 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 				if (!list_entry->Evaluate(entry_val) || !entry_val.IsStringValue(fname)) {
 					continue;
 				}
-				if (ExecFile && fname == "condor_exec.exe") {
+				auto src_iter = reuse_src_names.find(fname);
+				if (src_iter != reuse_src_names.end()) {
+					fname = src_iter->second;
+				} else if (ExecFile && fname == "condor_exec.exe") {
 					fname = ExecFile;
 				}
 				dprintf(D_FULLDEBUG, "DoUpload: File %s was reused.\n", fname.c_str());
@@ -3843,6 +4316,53 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		}
 	}
 
+		// Ask the peer what it kept from an earlier, failed attempt at
+		// this transfer.  That attempt may have been made by another
+		// process, such as the shadow before a reconnect, so always ask;
+		// the peer answers with an empty list if it has nothing.  Files
+		// whose kept part matches ours are sent from where it ends.
+	TransferProgress resume_offers;
+	filesize_t resume_min_size = param_integer("FILE_TRANSFER_RESUME_MIN_SIZE", 10 * 1024 * 1024, 0);
+	if (PeerDoesResume && !m_final_transfer_flag && !simple_init &&
+		resume_min_size > 0 &&
+		std::any_of(filelist.begin(), filelist.end(), [&](const FileTransferItem &item) {
+			return item.fileSize() >= resume_min_size;
+		}))
+	{
+		ClassAd file_info;
+		file_info.InsertAttr("SubCommand", static_cast<int>(TransferSubCommand::ResumeInfo));
+		ClassAd resume_ad;
+		if (!exchange_info(file_info, resume_ad)) {
+			dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
+			return_and_resetpriv( -1 );
+		}
+		classad::Value value;
+		classad_shared_ptr<classad::ExprList> exprlist;
+		if (resume_ad.EvaluateAttr("ResumeList", value) && value.IsSListValue(exprlist)) {
+			for (auto list_entry : (*exprlist)) {
+				classad::Value entry_val;
+				classad_shared_ptr<classad::ClassAd> entry_ad;
+				std::string fname, checksum_type;
+				long long offset = 0;
+				ResumePoint point;
+				if (!list_entry->Evaluate(entry_val) || !entry_val.IsSClassAdValue(entry_ad) ||
+					!entry_ad->EvaluateAttrString("FileName", fname) ||
+					!entry_ad->EvaluateAttrInt("Offset", offset) ||
+					!entry_ad->EvaluateAttrString("ChecksumType", checksum_type) ||
+					!entry_ad->EvaluateAttrString("Checksum", point.checksum) ||
+					!htcondor::DataReuseDirectory::IsChecksumTypeSupported(checksum_type) ||
+					offset <= 0)
+				{
+					continue;
+				}
+				point.offset = offset;
+				resume_offers[fname] = point;
+			}
+		}
+		dprintf(D_FULLDEBUG, "DoUpload: Remote side kept %d files from the last attempt.\n",
+			(int)resume_offers.size());
+	}
+
 	std::unordered_map<std::string, std::string> s3_url_map;
 	if (!s3_urls_to_sign.empty()) {
 		dprintf(D_FULLDEBUG, "DoUpload: Requesting %lu URLs to sign.\n", s3_urls_to_sign.size());
@@ -3918,9 +4438,43 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		}
 	}
 
+		// Runs of small files and directories are sent in batches, so
+		// that each one doesn't cost a command, a go-ahead and a
+		// put_file() of its own.
+	int batch_max_files = 0;
+	filesize_t batch_max_file_size = 0;
+	if( PeerDoesFileBatches ) {
+		batch_max_files = param_integer("FILE_TRANSFER_BATCH_MAX_FILES", 1000);
+		batch_max_file_size = param_integer("FILE_TRANSFER_BATCH_MAX_FILE_SIZE", 64 * 1024, 0, (int)FILE_BATCH_MAX_RECORD);
+	}
+	auto batchable = [&]( const FileTransferItem &item ) {
+		if( batch_max_files < 2 || batch_max_file_size <= 0 ) {
+			return false;
+		}
+		if( item.isSrcUrl() || item.isDestUrl() || item.isDomainSocket() ) {
+			return false;
+		}
+		if( item.isDirectory() ) {
+			return !item.isSymlink() && PeerUnderstandsMkdir;
+		}
+		const char *name = item.srcName().c_str();
+		if( item.fileSize() > batch_max_file_size ||
+			DontEncryptFiles->file_contains_withwildcard(name) ||
+			EncryptFiles->file_contains_withwildcard(name) )
+		{
+			return false;
+		}
+		if( X509UserProxy && DelegateX509Credentials && file_strcmp(name, X509UserProxy) == 0 ) {
+			return false;
+		}
+		return true;
+	};
+	std::vector<FileBatchEntry> batch;
+
 	std::sort(filelist.begin(), filelist.end());
-	for (auto &fileitem : filelist)
+	for (auto fileitem_it = filelist.begin(); fileitem_it != filelist.end(); ++fileitem_it)
 	{
+		auto &fileitem = *fileitem_it;
 			// If there's a signed URL to work with, we should use that instead.
 		auto iter = s3_url_map.find(fileitem.destUrl());
 		if (iter != s3_url_map.end()) {
@@ -4116,6 +4670,7 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 		}
 
 		bool fail_because_mkdir_not_supported = false;
+		int stream_rc = 0;
 		bool fail_because_symlink_not_supported = false;
 		if( fileitem.isDirectory() ) {
 			if( fileitem.isSymlink() ) {
@@ -4132,6 +4687,33 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			}
 		}
 
+		if( batchable(fileitem) ) {
+			FileBatchEntry entry;
+			entry.fullname = fullname;
+			entry.dest_filename = dest_filename;
+			entry.is_directory = fileitem.isDirectory();
+			if( entry.is_directory || TransferFilePermissions ) {
+				entry.mode = fileitem.fileMode();
+			}
+			batch.push_back(entry);
+
+				// Keep gathering unless the batch is full or the next
+				// file we will actually send can't join it.
+			auto next_it = std::next(fileitem_it);
+			while( next_it != filelist.end() && skip_files.find(next_it->srcName()) != skip_files.end() ) {
+				++next_it;
+			}
+			if( (int)batch.size() < batch_max_files && next_it != filelist.end() && batchable(*next_it) ) {
+				continue;
+			}
+
+			dprintf( D_FULLDEBUG, "DoUpload: sending a batch of %d files, starting with %s\n",
+					 (int)batch.size(), batch.front().dest_filename.Value() );
+			file_command = TransferCommand::XferBatch;
+			fullname = batch.front().fullname;
+			dest_filename = batch.front().dest_filename;
+		}
+
 		dprintf ( D_FULLDEBUG, "FILETRANSFER: outgoing file_command is %i for %s\n",
 				static_cast<int>(file_command), filename.c_str() );
 
@@ -4250,6 +4832,32 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			this_file_max_bytes = 0;
 		}
 
+			// If the peer kept part of this file from the last attempt,
+			// tell it where we pick up: after what it has, if that
+			// matches the start of our copy, or else from scratch.
+		filesize_t resume_offset = 0;
+		auto offer = resume_offers.find(dest_filename.Value());
+		if( offer != resume_offers.end() && IsFileCommand(file_command) ) {
+			std::string checksum;
+			CondorError err;
+			if( !fail_because_mkdir_not_supported && !fail_because_symlink_not_supported &&
+				htcondor::DataReuseDirectory::ComputeChecksum(fullname.Value(), "sha256", checksum, err, offer->second.offset) &&
+				checksum == offer->second.checksum )
+			{
+				resume_offset = offer->second.offset;
+				dprintf(D_FULLDEBUG, "DoUpload: resuming %s after %lld bytes\n",
+					fullname.Value(), (long long)resume_offset);
+			} else {
+				dprintf(D_FULLDEBUG, "DoUpload: sending all of %s; the part the remote side kept does not match\n",
+					fullname.Value());
+			}
+			resume_offers.erase(offer);
+			if( !s->code(resume_offset) || !s->end_of_message() ) {
+				dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",__LINE__);
+				return_and_resetpriv( -1 );
+			}
+		}
+
 		if ( file_command == TransferCommand::Other) {
 			// new-style, send classad
 
@@ -4384,6 +4992,19 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			else {
 				rc = 0;
 			}
+		} else if( file_command == TransferCommand::XferBatch ) {
+			MyString failed_file;
+			int failed_errno = 0;
+			rc = SendFileBatch( s, batch, this_file_max_bytes, bytes, failed_file, failed_errno );
+			if( rc < -1 ) {
+				// name the file that failed in the error handling below
+				fullname = failed_file;
+				errno = failed_errno;
+			}
+		} else if( m_streams && (stream_rc = m_streams->SendFile( s, fullname.Value(), this_file_max_bytes, TransferFilePermissions, !fail_because_mkdir_not_supported && !fail_because_symlink_not_supported && !resume_offset, bytes )) != 0 ) {
+			// the contents follow on one of the data streams; any
+			// failure there is reported when they are finished with
+			rc = stream_rc < 0 ? -1 : 0;
 		} else if( fail_because_mkdir_not_supported || fail_because_symlink_not_supported ) {
 			if( TransferFilePermissions ) {
 				rc = s->put_file_with_permissions( &bytes, NULL_FILE );
@@ -4396,9 +5017,9 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 				errno = EISDIR;
 			}
 		} else if ( TransferFilePermissions ) {
-			rc = s->put_file_with_permissions( &bytes, fullname.Value(), this_file_max_bytes, &xfer_queue );
+			rc = s->put_file_with_permissions( &bytes, fullname.Value(), this_file_max_bytes, &xfer_queue, resume_offset );
 		} else {
-			rc = s->put_file( &bytes, fullname.Value(), 0, this_file_max_bytes, &xfer_queue );
+			rc = s->put_file( &bytes, fullname.Value(), resume_offset, this_file_max_bytes, &xfer_queue );
 		}
 		if( rc < 0 ) {
 			int the_error = errno;
@@ -4499,12 +5120,25 @@ FileTransfer::DoUpload(filesize_t *total_bytes, ReliSock *s)
 			// the stdout/stderr files, since those are handled
 			// separately when building the list of files to transfer.
 
-		if( dest_filename.FindChar(DIR_DELIM_CHAR) < 0 &&
-			dest_filename != condor_basename(JobStdoutFile.Value()) &&
-			dest_filename != condor_basename(JobStderrFile.Value()) &&
-			(file_command != TransferCommand::Other || file_subcommand != TransferSubCommand::UploadUrl) )
-		{
-			Info.addSpooledFile( dest_filename.Value() );
+		std::vector<MyString> sent_names;
+		if( file_command == TransferCommand::XferBatch ) {
+			numFiles += (int)batch.size() - 1;
+			for( auto &entry : batch ) {
+				sent_names.push_back( entry.dest_filename );
+			}
+			batch.clear();
+		}
+		else {
+			sent_names.push_back( dest_filename );
+		}
+		for( auto &sent_name : sent_names ) {
+			if( sent_name.FindChar(DIR_DELIM_CHAR) < 0 &&
+				sent_name != condor_basename(JobStdoutFile.Value()) &&
+				sent_name != condor_basename(JobStderrFile.Value()) &&
+				(file_command != TransferCommand::Other || file_subcommand != TransferSubCommand::UploadUrl) )
+			{
+				Info.addSpooledFile( sent_name.Value() );
+			}
 		}
 	}
 	// Release transfer queue slot after file has been put but before the
@@ -4656,7 +5290,7 @@ FileTransfer::DoObtainAndSendTransferGoAhead(DCTransferQueue &xfer_queue,bool do
 	ASSERT( timeout > alive_slop );
 	timeout -= alive_slop;
 
-	if( !xfer_queue.RequestTransferQueueSlot(downloading,sandbox_size,full_fname,m_jobid.Value(),queue_user.c_str(),timeout,error_desc) )
+	if( !xfer_queue.RequestTransferQueueSlot(downloading,sandbox_size,full_fname,m_jobid.Value(),queue_user.c_str(),timeout,error_desc,s->peer_ip_str()) )
 	{
 		go_ahead = GO_AHEAD_FAILED;
 	}
@@ -4885,6 +5519,92 @@ FileTransfer::DoReceiveTransferGoAhead(
 	return true;
 }
 
+int
+FileTransfer::SendFileBatch(ReliSock *s, const std::vector<FileBatchEntry> &batch, filesize_t max_bytes, filesize_t &bytes, MyString &failed_file, int &failed_errno)
+{
+	int result = 0;
+	int count = (int)batch.size();
+	std::vector<char> buf;
+
+	// The batch is sent as a count followed by one record per entry:
+	// type (0 file, 1 directory), name, mode, mtime, size and then size
+	// bytes of data.  A file we can't send goes as a record with size -1,
+	// so the peer stays in step, and is reported like put_file() would.
+	bytes = 0;
+	if( !s->code(count) ) {
+		return -1;
+	}
+	for( auto &entry : batch ) {
+		int type = entry.is_directory ? 1 : 0;
+		MyString dest_filename = entry.dest_filename;
+		condor_mode_t mode = entry.mode;
+		int64_t mtime = 0;
+		filesize_t size = -1;
+
+		if( !entry.is_directory ) {
+			int rc = 0;
+			int fd = safe_open_wrapper_follow( entry.fullname.Value(), O_RDONLY | _O_BINARY | O_LARGEFILE, 0 );
+			struct stat st;
+			if( fd < 0 || fstat(fd, &st) < 0 ) {
+				rc = PUT_FILE_OPEN_FAILED;
+			}
+			else if( st.st_size > FILE_BATCH_MAX_RECORD ) {
+					// it grew since we looked at it
+				rc = PUT_FILE_OPEN_FAILED;
+				errno = EFBIG;
+			}
+			else if( max_bytes >= 0 && bytes + st.st_size > max_bytes ) {
+				rc = PUT_FILE_MAX_BYTES_EXCEEDED;
+				errno = 0;
+			}
+			else {
+				buf.resize( st.st_size );
+				filesize_t nread = 0;
+				while( nread < st.st_size ) {
+					ssize_t n = read( fd, &buf[nread], st.st_size - nread );
+					if( n <= 0 ) {
+						break;
+					}
+					nread += n;
+				}
+				if( nread != st.st_size ) {
+					rc = PUT_FILE_OPEN_FAILED;
+				}
+				else {
+					size = nread;
+					mtime = st.st_mtime;
+				}
+			}
+			if( rc ) {
+				int the_error = errno;
+				dprintf( D_ALWAYS, "DoUpload: failed to read %s for batch: (errno %d) %s\n",
+						 entry.fullname.Value(), the_error, strerror(the_error) );
+				if( !result ) {
+					result = rc;
+					failed_file = entry.fullname;
+					failed_errno = the_error;
+				}
+			}
+			if( fd >= 0 ) {
+				close( fd );
+			}
+		}
+
+		if( !s->code(type) || !s->code(dest_filename) || !s->code(mode) ||
+			!s->code(mtime) || !s->code(size) )
+		{
+			return -1;
+		}
+		if( size > 0 ) {
+			if( s->put_bytes( &buf[0], (int)size ) != (int)size ) {
+				return -1;
+			}
+			bytes += size;
+		}
+	}
+	return result;
+}
+
 int
 FileTransfer::ExitDoUpload(filesize_t *total_bytes, int numFiles, ReliSock *s, priv_state saved_priv, bool socket_default_crypto, bool upload_success, bool do_upload_ack, bool do_download_ack, bool try_again, int hold_code, int hold_subcode, char const *upload_error_desc,int DoUpload_exit_line)
 {
@@ -4894,8 +5614,33 @@ FileTransfer::ExitDoUpload(filesize_t *total_bytes, int numFiles, ReliSock *s, p
 	MyString download_error_buf;
 	char const *error_desc = NULL;
 
+	MyString stream_error_desc;
+
 	dprintf(D_FULLDEBUG,"DoUpload: exiting at %d\n",DoUpload_exit_line);
 
+		// Let the data streams drain before telling the peer we are
+		// done, so the upload ack covers what was sent over them.
+	if( m_streams && do_upload_ack && !m_streams->Finish() && upload_success ) {
+		upload_success = false;
+		rc = -1;
+		try_again = true;
+		hold_code = CONDOR_HOLD_CODE_UploadFileError;
+		hold_subcode = 0;
+		stream_error_desc = "data stream failed";
+		for( auto &file : m_streams->Files() ) {
+			if( file->rc ) {
+				stream_error_desc.formatstr("error sending %s", file->name.c_str());
+				if( !m_streams->StreamFailed() ) {
+					try_again = false;
+					hold_subcode = file->error_errno;
+					stream_error_desc.formatstr_cat(": (errno %d) %s", file->error_errno, strerror(file->error_errno));
+				}
+				break;
+			}
+		}
+		upload_error_desc = stream_error_desc.Value();
+	}
+
 	if( saved_priv != PRIV_UNKNOWN ) {
 		_set_priv(saved_priv,__FILE__,DoUpload_exit_line,1);
 	}
@@ -5194,6 +5939,248 @@ FileTransfer::setPeerVersion( const CondorVersionInfo &peer_version )
 
 	PeerDoesReuseInfo = peer_version.built_since_version(8,9,4);
 	PeerDoesS3Urls = peer_version.built_since_version(8,9,4);
+	PeerDoesTransferStreams = peer_version.built_since_version(8,9,6);
+	PeerDoesFileBatches = peer_version.built_since_version(8,9,6);
+	PeerDoesResume = peer_version.built_since_version(8,9,6);
+}
+
+void
+FileTransfer::LoadTransferProgress( TransferProgress &progress )
+{
+	priv_state saved_priv = PRIV_UNKNOWN;
+	if( want_priv_change ) {
+		saved_priv = set_priv( desired_priv_state );
+	}
+
+	std::string record = std::string(Iwd) + DIR_DELIM_CHAR + TransferProgressFileName;
+	FILE *fp = safe_fopen_wrapper_follow( record.c_str(), "r" );
+	if( fp ) {
+		std::string line;
+		while( readLine( line, fp ) ) {
+			long long offset = 0, mtime = 0;
+			char checksum[65];
+			int name_start = 0;
+			chomp( line );
+			if( sscanf( line.c_str(), "%lld %lld %64s %n", &offset, &mtime, checksum, &name_start ) < 3 ||
+				name_start <= 0 || offset <= 0 )
+			{
+				dprintf( D_ALWAYS, "Ignoring malformed line in %s: %s\n", record.c_str(), line.c_str() );
+				continue;
+			}
+			std::string name = line.substr( name_start );
+			std::string fullname = std::string(Iwd) + DIR_DELIM_CHAR + name;
+			StatInfo si( fullname.c_str() );
+			if( !LegalPathInSandbox( name.c_str(), Iwd ) || si.Error() ||
+				si.GetFileSize() < offset || si.GetModifyTime() != (time_t)mtime )
+			{
+				dprintf( D_FULLDEBUG, "Not resuming %s: it has changed since the last attempt.\n",
+						 name.c_str() );
+				continue;
+			}
+			ResumePoint &point = progress[name];
+			point.offset = offset;
+			point.mtime = mtime;
+			point.checksum = checksum;
+		}
+		fclose( fp );
+	}
+
+	if( saved_priv != PRIV_UNKNOWN ) {
+		set_priv( saved_priv );
+	}
+}
+
+void
+FileTransfer::SaveTransferProgress( TransferProgress &progress )
+{
+	priv_state saved_priv = PRIV_UNKNOWN;
+	if( want_priv_change ) {
+		saved_priv = set_priv( desired_priv_state );
+	}
+
+	std::string lines;
+	filesize_t total = 0;
+	for( auto it = progress.begin(); it != progress.end(); ) {
+		ResumePoint &point = it->second;
+		std::string fullname = std::string(Iwd) + DIR_DELIM_CHAR + it->first;
+		StatInfo si( fullname.c_str() );
+		CondorError err;
+		if( si.Error() || si.GetFileSize() < point.offset ||
+			(point.mtime && point.mtime != si.GetModifyTime()) ||
+			(point.checksum.empty() &&
+			 !htcondor::DataReuseDirectory::ComputeChecksum( fullname, "sha256", point.checksum, err, point.offset )) )
+		{
+			it = progress.erase( it );
+			continue;
+		}
+		point.mtime = si.GetModifyTime();
+		formatstr_cat( lines, "%lld %lld %s %s\n", (long long)point.offset,
+					   (long long)point.mtime, point.checksum.c_str(), it->first.c_str() );
+		total += point.offset;
+		++it;
+	}
+
+	std::string record = std::string(Iwd) + DIR_DELIM_CHAR + TransferProgressFileName;
+	if( lines.empty() ) {
+		IGNORE_RETURN unlink( record.c_str() );
+	} else {
+		FILE *fp = safe_fopen_wrapper_follow( record.c_str(), "w", 0600 );
+		bool written = fp && fputs( lines.c_str(), fp ) >= 0;
+		if( fp && fclose( fp ) != 0 ) {
+			written = false;
+		}
+		if( !written ) {
+			dprintf( D_ALWAYS, "Failed to write %s: %s\n", record.c_str(), strerror(errno) );
+			IGNORE_RETURN unlink( record.c_str() );
+		} else {
+			dprintf( D_ALWAYS, "Recorded %lld bytes of %d received files for a retry to resume from.\n",
+					 (long long)total, (int)progress.size() );
+		}
+	}
+
+	if( saved_priv != PRIV_UNKNOWN ) {
+		set_priv( saved_priv );
+	}
+}
+
+int
+FileTransfer::ReceiveResumableFile( ReliSock *s, const std::string &name, const char *fullname,
+	filesize_t offset, filesize_t max_bytes, DCTransferQueue &xfer_queue,
+	TransferProgress &progress, filesize_t &bytes )
+{
+	condor_mode_t file_mode = NULL_FILE_PERMISSIONS;
+	if( TransferFilePermissions ) {
+		s->decode();
+		if( !s->code( file_mode ) || !s->end_of_message() ) {
+			dprintf( D_ALWAYS, "DoDownload: failed to receive permissions of %s\n", fullname );
+			return -1;
+		}
+	}
+
+	if( !strcmp( fullname, NULL_FILE ) ) {
+		return s->get_file( &bytes, fullname, false, false, max_bytes, &xfer_queue );
+	}
+
+		// Whatever happens below, any old record no longer describes
+		// the file.
+	progress.erase( name );
+
+	int flags = O_WRONLY | O_CREAT | _O_BINARY | _O_SEQUENTIAL | O_LARGEFILE;
+	if( !offset ) {
+		flags |= O_TRUNC;
+	}
+	int fd = safe_open_wrapper_follow( fullname, flags, 0600 );
+	if( fd >= 0 && offset && ftruncate( fd, offset ) < 0 ) {
+			// Anything past the verified offset has to go.
+		int saved_errno = errno;
+		::close( fd );
+		fd = -1;
+		errno = saved_errno;
+	}
+	if( fd < 0 ) {
+			// As get_file() would, throw the data away to stay in step
+			// with the peer, and report why it couldn't be written.
+		int saved_errno = errno;
+		dprintf( D_ALWAYS, "DoDownload: failed to open %s, errno = %d: %s\n",
+				 fullname, saved_errno, strerror(saved_errno) );
+		int rc = s->get_file( &bytes, NULL_FILE, false, false, max_bytes, &xfer_queue );
+		if( rc < 0 ) {
+			return rc;
+		}
+		errno = saved_errno;
+		return GET_FILE_OPEN_FAILED;
+	}
+
+	if( offset ) {
+		dprintf( D_FULLDEBUG, "DoDownload: resuming %s after %lld bytes\n",
+				 fullname, (long long)offset );
+	}
+	int rc = s->get_file( &bytes, fd, false, offset > 0, max_bytes, &xfer_queue );
+	int saved_errno = errno;
+
+	StatInfo si( fd );
+	filesize_t have = si.Error() ? 0 : si.GetFileSize();
+	if( ::close( fd ) != 0 && rc >= 0 ) {
+		saved_errno = errno;
+		dprintf( D_ALWAYS, "DoDownload: failed to close %s, errno = %d: %s\n",
+				 fullname, saved_errno, strerror(saved_errno) );
+		rc = GET_FILE_WRITE_FAILED;
+	}
+
+	filesize_t resume_min_size = param_integer( "FILE_TRANSFER_RESUME_MIN_SIZE", 10 * 1024 * 1024, 0 );
+	if( rc == 0 ) {
+#ifndef WIN32
+		if( file_mode != NULL_FILE_PERMISSIONS && ::chmod( fullname, (mode_t)file_mode ) < 0 ) {
+			dprintf( D_ALWAYS, "DoDownload: failed to chmod %s: %s (errno: %d)\n",
+					 fullname, strerror(errno), errno );
+			return -1;
+		}
+#endif
+		if( have >= resume_min_size ) {
+			progress[name].offset = have;
+		}
+	}
+	else if( rc == GET_FILE_WRITE_FAILED || rc == GET_FILE_MAX_BYTES_EXCEEDED ||
+			 have - have % TRANSFER_RESUME_BLOCK < resume_min_size )
+	{
+		IGNORE_RETURN unlink( fullname );
+	}
+	else {
+			// Only whole blocks are kept; the retry truncates the file
+			// to the offset before appending to it.
+		progress[name].offset = have - have % TRANSFER_RESUME_BLOCK;
+	}
+
+	errno = saved_errno;
+	return rc;
+}
+
+bool
+FileTransfer::SetupTransferStreams( ReliSock *s, int requested, bool uploading )
+{
+	int count = 0;
+	int listen = 0;
+
+		// The downloader has the last word on the number of streams,
+		// and also says which side listens, so both sides agree even
+		// when they are, say, both clients.
+	if( uploading ) {
+		s->decode();
+		if( !s->code(count) || !s->code(listen) || !s->end_of_message() ) {
+			return false;
+		}
+		listen = !listen;
+	}
+	else {
+		count = MIN( requested, param_integer("FILE_TRANSFER_STREAMS", 1) );
+		if( count < 2 ) {
+			count = 0;
+		}
+		listen = IsServer() ? 1 : 0;
+		s->encode();
+		if( !s->code(count) || !s->code(listen) || !s->end_of_message() ) {
+			return false;
+		}
+	}
+
+	if( count >= 2 ) {
+		m_streams.reset( new FileTransferStreams() );
+		if( !m_streams->Open( s, listen != 0, count ) ) {
+			m_streams.reset();
+			return false;
+		}
+		if( m_streams->Count() == 0 ) {
+			m_streams.reset();
+		}
+	}
+
+	if( uploading ) {
+		s->encode();
+	}
+	else {
+		s->decode();
+	}
+	return true;
 }
 
 
@@ -35,9 +35,13 @@
 
 extern const char * const StdoutRemapName;
 extern const char * const StderrRemapName;
+// Kept in the sandbox of a receiver whose input transfer failed,
+// listing what had arrived; see FILE_TRANSFER_RESUME_MIN_SIZE.
+extern const char * const TransferProgressFileName;
 
 class FileTransfer;	// forward declatation
 class FileTransferItem;
+struct FileBatchEntry;
 typedef std::vector<FileTransferItem> FileTransferList;
 
 
@@ -78,6 +82,7 @@ enum FileTransferStatus {
 namespace htcondor {
 class DataReuseDirectory;
 }
+class FileTransferStreams;
 
 
 class FileTransfer final: public Service {
@@ -407,6 +412,9 @@ class FileTransfer final: public Service {
 	bool PeerDoesXferInfo{false};
 	bool PeerDoesReuseInfo{false};
 	bool PeerDoesS3Urls{false};
+	bool PeerDoesTransferStreams{false};
+	bool PeerDoesFileBatches{false};
+	bool PeerDoesResume{false};
 	bool TransferUserLog{false};
 	char* Iwd{nullptr};
 	StringList* ExceptionFiles{nullptr};
@@ -487,6 +495,42 @@ class FileTransfer final: public Service {
 	// Object to manage reuse of any data locally.
 	htcondor::DataReuseDirectory *m_reuse_dir{nullptr};
 
+	// Extra data connections for the transfer in progress, if both
+	// sides asked for them; see FILE_TRANSFER_STREAMS.
+	std::unique_ptr<FileTransferStreams> m_streams;
+
+	// Send a run of small files and directories as one message of
+	// records.  Returns 0, -1 if communication failed, or the PUT_FILE_*
+	// code of the first file that could not be sent, which is then
+	// named by failed_file and failed_errno.
+	int SendFileBatch(ReliSock *s, const std::vector<FileBatchEntry> &batch, filesize_t max_bytes, filesize_t &bytes, MyString &failed_file, int &failed_errno);
+
+	// How much of a file the receiver of an input transfer already has
+	// from an earlier attempt.  The checksum covers the first offset
+	// bytes; mtime is the file's when the record was made.
+	struct ResumePoint {
+		filesize_t offset{0};
+		time_t mtime{0};
+		std::string checksum;
+	};
+	typedef std::map<std::string, ResumePoint> TransferProgress;
+
+	// Read the record left in the sandbox by an earlier attempt,
+	// dropping entries for files that have changed since.
+	void LoadTransferProgress(TransferProgress &progress);
+
+	// Write the record, checksumming entries that don't have one.
+	void SaveTransferProgress(TransferProgress &progress);
+
+	// Receive a file, appending to what is already there if offset
+	// is non-zero.  On a failure that may be retried, the part that
+	// did arrive is kept and noted in progress.
+	int ReceiveResumableFile(ReliSock *s, const std::string &name, const char *fullname, filesize_t offset, filesize_t max_bytes, DCTransferQueue &xfer_queue, TransferProgress &progress, filesize_t &bytes);
+
+	// Agree on the number of data streams with the peer and open them.
+	// Returns false only if communication on s failed.
+	bool SetupTransferStreams(ReliSock *s, int requested, bool uploading);
+
 	// called to construct the catalog of files in a direcotry
 	bool BuildFileCatalog(time_t spool_time = 0, const char* iwd = NULL, FileCatalogHashTable **catalog = NULL);
 
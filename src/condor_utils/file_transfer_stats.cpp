@@ -35,6 +35,7 @@ void FileTransferStats::Init() {
 	TransferEndTime = 0;
 	TransferStartTime = 0;
 	TransferFileBytes = 0;
+	TransferResumedBytes = 0;
     LibcurlReturnCode = -1;
 }
 
@@ -69,6 +70,8 @@ void FileTransferStats::Publish(classad::ClassAd &ad) const {
         ad.InsertAttr("LibcurlReturnCode", LibcurlReturnCode);
     if (TransferTries > 0) 
         ad.InsertAttr("TransferTries", TransferTries);
+    if (TransferResumedBytes > 0)
+        ad.InsertAttr("TransferResumedBytes", TransferResumedBytes);
     if (!TransferType.empty())
         ad.InsertAttr("TransferType", TransferType);
     if (!TransferUrl.empty())
@@ -40,6 +40,7 @@
 		
 		long TransferFileBytes;
 		long TransferHTTPStatusCode;
+		long TransferResumedBytes;
 		long TransferTotalBytes;
 		long TransferTries;
 		
@@ -0,0 +1,636 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_classad.h"
+#include "condor_attributes.h"
+#include "basename.h"
+#include "condor_config.h"
+#include "condor_crypt.h"
+#include "condor_daemon_core.h"
+#include "condor_sinful.h"
+#include "condor_sockaddr.h"
+#include "stat_info.h"
+#include "utc_time.h"
+#include "file_transfer_streams.h"
+
+	// Files at least this big are cut into one range per stream.
+static const filesize_t SPLIT_FILE_SIZE = 64 * 1024 * 1024;
+
+	// How long to wait for the data connections to be made before
+	// giving up on them and using the command socket alone.
+static const int STREAM_CONNECT_TIMEOUT = 20;
+
+FileTransferStreams::FileTransferStreams()
+{
+}
+
+	// The data connections are made straight to a port this side picks,
+	// so they only work if the peer could have connected to us directly
+	// in the first place.  A daemon behind the shared port or CCB, or
+	// one that advertises a forwarded address, keeps to the single
+	// connection.
+static bool
+DirectlyReachable( std::string &why )
+{
+	std::string forwarding;
+	if( param( forwarding, "TCP_FORWARDING_HOST" ) && !forwarding.empty() ) {
+		why = "TCP_FORWARDING_HOST is set";
+		return false;
+	}
+	if( !daemonCore ) {
+		return true;
+	}
+	Sinful me( daemonCore->publicNetworkIpAddr() );
+	if( me.getSharedPortID() ) {
+		why = "it is reached through the shared port";
+		return false;
+	}
+	if( me.getCCBContact() ) {
+		why = "it is reached through CCB";
+		return false;
+	}
+	return true;
+}
+
+FileTransferStreams::~FileTransferStreams()
+{
+	Stop( true );
+}
+
+bool
+FileTransferStreams::Open( ReliSock *s, bool listen, int count )
+{
+	std::vector<std::unique_ptr<ReliSock>> socks;
+	std::string cookie;
+
+	if( listen ) {
+		ReliSock listener;
+		std::string address;
+		std::string why;
+		condor_sockaddr addr = s->my_addr();
+		if( !DirectlyReachable( why ) ) {
+			dprintf( D_FULLDEBUG, "FileTransferStreams: not listening for data streams, "
+					 "because %s; transferring over a single connection.\n", why.c_str() );
+		}
+		else if( listener.bind( addr.get_protocol(), false, 0, false ) && listener.listen() ) {
+			addr.set_port( listener.get_port() );
+			address = addr.to_sinful().Value();
+		}
+		else {
+			dprintf( D_ALWAYS, "FileTransferStreams: failed to create listen socket; "
+					 "transferring over a single connection.\n" );
+		}
+		char *key = Condor_Crypt_Base::randomHexKey( 16 );
+		cookie = key;
+		free( key );
+
+		ClassAd ad;
+		ad.Assign( "Address", address );
+		ad.Assign( "Cookie", cookie );
+		classad::References encrypted_attrs{"Cookie"};
+		s->encode();
+		if( !putClassAd( s, ad, 0, &encrypted_attrs ) || !s->end_of_message() ) {
+			return false;
+		}
+
+		int connected = 0;
+		s->decode();
+		if( !s->code( connected ) || !s->end_of_message() ) {
+			return false;
+		}
+
+		listener.timeout( STREAM_CONNECT_TIMEOUT );
+		socks.resize( connected > 0 ? connected : 0 );
+		int accepted = 0;
+		for( int i = 0; i < connected && !address.empty(); i++ ) {
+			std::unique_ptr<ReliSock> sock( listener.accept() );
+			if( !sock ) {
+				dprintf( D_ALWAYS, "FileTransferStreams: timed out waiting for data connection %d of %d.\n",
+						 i + 1, connected );
+				break;
+			}
+			sock->timeout( STREAM_CONNECT_TIMEOUT );
+			sock->decode();
+			std::string peer_cookie;
+			int index = -1;
+			if( !sock->code( peer_cookie ) || !sock->code( index ) || !sock->end_of_message() ||
+				peer_cookie != cookie || index < 0 || index >= connected || socks[index] )
+			{
+				dprintf( D_ALWAYS, "FileTransferStreams: rejecting data connection from %s.\n",
+						 sock->peer_description() );
+				break;
+			}
+			socks[index] = std::move( sock );
+			accepted++;
+		}
+		if( accepted != connected ) {
+			accepted = 0;
+			socks.clear();
+		}
+
+		s->encode();
+		if( !s->code( accepted ) || !s->end_of_message() ) {
+			return false;
+		}
+	}
+	else {
+		ClassAd ad;
+		s->decode();
+		if( !getClassAd( s, ad ) || !s->end_of_message() ) {
+			return false;
+		}
+		std::string address;
+		ad.LookupString( "Address", address );
+		ad.LookupString( "Cookie", cookie );
+
+		for( int i = 0; i < count && !address.empty(); i++ ) {
+			std::unique_ptr<ReliSock> sock( new ReliSock() );
+			sock->timeout( STREAM_CONNECT_TIMEOUT );
+			if( !sock->connect( address.c_str(), 0 ) ) {
+				dprintf( D_ALWAYS, "FileTransferStreams: failed to connect data stream to %s.\n",
+						 address.c_str() );
+				break;
+			}
+			sock->encode();
+			if( !sock->code( cookie ) || !sock->code( i ) || !sock->end_of_message() ) {
+				break;
+			}
+			socks.push_back( std::move( sock ) );
+		}
+
+		int connected = (int)socks.size();
+		s->encode();
+		if( !s->code( connected ) || !s->end_of_message() ) {
+			return false;
+		}
+		int accepted = 0;
+		s->decode();
+		if( !s->code( accepted ) || !s->end_of_message() ) {
+			return false;
+		}
+		if( accepted != connected ) {
+			socks.clear();
+		}
+	}
+
+	if( socks.empty() ) {
+		dprintf( D_FULLDEBUG, "FileTransferStreams: no data streams; "
+				 "transferring over a single connection.\n" );
+		return true;
+	}
+
+		// put_file() would otherwise look this up on the stream threads.
+	bool sendfile = param_boolean( "ENABLE_SENDFILE", true );
+	for( size_t i = 0; i < socks.size(); i++ ) {
+		std::string salt;
+		formatstr( salt, "%s:%d", cookie.c_str(), (int)i );
+		if( !socks[i]->set_derived_session_keys( *s, salt.c_str() ) ) {
+			dprintf( D_ALWAYS, "FileTransferStreams: failed to key data stream %d.\n", (int)i );
+			return false;
+		}
+		socks[i]->timeout( s->get_timeout_raw() );
+		socks[i]->set_sendfile( sendfile );
+
+		std::unique_ptr<Stream> stream( new Stream() );
+		stream->sock = std::move( socks[i] );
+		m_streams.push_back( std::move( stream ) );
+	}
+
+	dprintf( D_FULLDEBUG, "FileTransferStreams: transferring over %d data streams.\n",
+			 (int)m_streams.size() );
+	Start();
+	return true;
+}
+
+void
+FileTransferStreams::Start()
+{
+	dprintf_make_thread_safe();
+	m_start_time = condor_gettimestamp_double();
+	for( auto &stream : m_streams ) {
+		stream->thread = std::thread( &FileTransferStreams::Run, this, std::ref( *stream ) );
+	}
+}
+
+void
+FileTransferStreams::InitStats( File &file, const char *type )
+{
+	file.stats.TransferFileName = condor_basename( file.name.c_str() );
+	file.stats.TransferProtocol = "cedar";
+	file.stats.TransferType = type;
+	file.stats.TransferStartTime = condor_gettimestamp_double();
+}
+
+int
+FileTransferStreams::LeastAssignedStream() const
+{
+	int best = 0;
+	for( size_t i = 1; i < m_streams.size(); i++ ) {
+		if( m_streams[i]->assigned < m_streams[best]->assigned ) {
+			best = (int)i;
+		}
+	}
+	return best;
+}
+
+int
+FileTransferStreams::SendFile( ReliSock *s, const char *fullname, filesize_t max_bytes,
+		bool send_mode, bool allowed, filesize_t &bytes )
+{
+	StatInfo st( fullname );
+	filesize_t size = st.Error() ? 0 : st.GetFileSize();
+	bool on_streams = allowed && !st.Error() && !st.IsDirectory() &&
+		( max_bytes < 0 || size <= max_bytes );
+
+	int nranges = 1;
+	if( size >= SPLIT_FILE_SIZE ) {
+		nranges = (int)m_streams.size();
+	}
+
+		// Open the file once per range here, with the caller's
+		// privileges, so the stream threads never need to switch.
+	std::vector<int> fds;
+	for( int i = 0; on_streams && i < nranges; i++ ) {
+		int fd = safe_open_wrapper_follow( fullname, O_RDONLY | _O_BINARY | O_LARGEFILE, 0 );
+		if( fd < 0 ) {
+			on_streams = false;
+			break;
+		}
+		fds.push_back( fd );
+	}
+	if( !on_streams ) {
+		for( int fd : fds ) {
+			close( fd );
+		}
+		fds.clear();
+	}
+
+	int flag = on_streams ? 1 : 0;
+	if( !s->code( flag ) ) {
+		for( int fd : fds ) {
+			close( fd );
+		}
+		return -1;
+	}
+	if( !on_streams ) {
+		return 0;
+	}
+
+	std::unique_ptr<File> file( new File() );
+	file->name = fullname;
+	file->size = size;
+	file->mode = send_mode ? (condor_mode_t)st.GetMode() : NULL_FILE_PERMISSIONS;
+	file->pending = nranges;
+	InitStats( *file, "upload" );
+
+	bool encrypt = s->get_encryption();
+	filesize_t range_size = ( size + nranges - 1 ) / nranges;
+	std::vector<Range> ranges;
+	std::vector<int> range_streams;
+	for( int i = 0; i < nranges; i++ ) {
+		filesize_t offset = range_size * i;
+		filesize_t length = MIN( range_size, size - offset );
+		if( length < 0 ) {
+			length = 0;
+		}
+		int stream = LeastAssignedStream();
+		m_streams[stream]->assigned += length;
+		ranges.push_back( Range{ file.get(), fds[i], offset, length, encrypt } );
+		range_streams.push_back( stream );
+	}
+
+	condor_mode_t mode = file->mode;
+	bool ok = s->code( size ) && s->code( mode ) && s->code( nranges );
+	for( int i = 0; ok && i < nranges; i++ ) {
+		ok = s->code( range_streams[i] ) && s->code( ranges[i].offset ) && s->code( ranges[i].length );
+	}
+	if( !ok ) {
+		for( int fd : fds ) {
+			close( fd );
+		}
+		return -1;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_sending = true;
+		for( int i = 0; i < nranges; i++ ) {
+			m_streams[range_streams[i]]->queue.push_back( ranges[i] );
+		}
+		m_files.push_back( std::move( file ) );
+	}
+	m_cv.notify_all();
+
+	bytes = size;
+	return 1;
+}
+
+int
+FileTransferStreams::ReceiveFile( ReliSock *s, const char *fullname, filesize_t max_bytes,
+		File *&file_out )
+{
+	file_out = nullptr;
+
+	int flag = 0;
+	if( !s->code( flag ) ) {
+		return -1;
+	}
+	if( !flag ) {
+		return 0;
+	}
+
+	filesize_t size = 0;
+	condor_mode_t mode = NULL_FILE_PERMISSIONS;
+	int nranges = 0;
+	if( !s->code( size ) || !s->code( mode ) || !s->code( nranges ) ||
+		nranges < 1 || nranges > (int)m_streams.size() )
+	{
+		dprintf( D_ALWAYS, "FileTransferStreams: bad header for %s.\n", fullname );
+		return -1;
+	}
+
+	std::unique_ptr<File> file( new File() );
+	file->name = fullname;
+	file->size = size;
+	file->mode = mode;
+	file->pending = nranges;
+	InitStats( *file, "download" );
+
+	const char *dest = fullname;
+	if( max_bytes >= 0 && size > max_bytes ) {
+		file->rc = GET_FILE_MAX_BYTES_EXCEEDED;
+		dest = NULL_FILE;
+	}
+
+		// As in SendFile(), all the opening happens here.  The first
+		// open creates or truncates the file; the ranges after it each
+		// get their own descriptor so they can be written independently.
+	std::vector<Range> ranges;
+	std::vector<int> range_streams;
+	for( int i = 0; i < nranges; i++ ) {
+		int stream = -1;
+		Range range{ file.get(), -1, 0, 0, s->get_encryption() };
+		if( !s->code( stream ) || !s->code( range.offset ) || !s->code( range.length ) ||
+			stream < 0 || stream >= (int)m_streams.size() )
+		{
+			dprintf( D_ALWAYS, "FileTransferStreams: bad range header for %s.\n", fullname );
+			for( auto &r : ranges ) {
+				if( r.fd >= 0 ) close( r.fd );
+			}
+			return -1;
+		}
+		int flags = O_WRONLY | _O_BINARY | O_LARGEFILE;
+		if( i == 0 ) {
+			flags |= O_CREAT | O_TRUNC;
+		}
+		if( !file->rc ) {
+			range.fd = safe_open_wrapper_follow( dest, flags, 0600 );
+			if( range.fd < 0 ) {
+				file->rc = GET_FILE_OPEN_FAILED;
+				file->error_errno = errno;
+				dprintf( D_ALWAYS, "FileTransferStreams: failed to open %s, errno = %d: %s.\n",
+						 dest, errno, strerror( errno ) );
+			}
+		}
+		ranges.push_back( range );
+		range_streams.push_back( stream );
+	}
+	if( file->rc ) {
+			// Still read the data, so the streams stay in step, but
+			// send it nowhere.
+		for( auto &range : ranges ) {
+			if( range.fd >= 0 ) {
+				close( range.fd );
+			}
+			range.fd = safe_open_wrapper_follow( NULL_FILE, O_WRONLY, 0 );
+		}
+	}
+
+	file_out = file.get();
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		for( int i = 0; i < nranges; i++ ) {
+			m_streams[range_streams[i]]->queue.push_back( ranges[i] );
+		}
+		m_files.push_back( std::move( file ) );
+	}
+	m_cv.notify_all();
+
+	return 1;
+}
+
+bool
+FileTransferStreams::SendRange( Stream &stream, Range &range, filesize_t &bytes, int &rc, int &err )
+{
+	ReliSock *sock = stream.sock.get();
+	sock->encode();
+	if( !sock->set_crypto_mode( range.encrypt ) ) {
+		rc = -1;
+		return false;
+	}
+
+	StatInfo st( range.fd );
+	int result;
+	if( st.Error() || range.offset >= st.GetFileSize() ) {
+			// The file shrank after we queued it; send the range as
+			// empty rather than confuse put_file() with the offset.
+		result = sock->put_empty_file( &bytes );
+	}
+	else {
+		result = sock->put_file( &bytes, range.fd, range.offset, range.length, nullptr );
+		if( result == PUT_FILE_MAX_BYTES_EXCEEDED ) {
+				// Expected for every range but the last.
+			result = 0;
+		}
+	}
+	if( result < 0 ) {
+		rc = result;
+		err = errno;
+		return false;
+	}
+	if( !sock->end_of_message() ) {
+		rc = -1;
+		return false;
+	}
+	return true;
+}
+
+bool
+FileTransferStreams::ReceiveRange( Stream &stream, Range &range, filesize_t &bytes, int &rc, int &err )
+{
+	ReliSock *sock = stream.sock.get();
+	sock->decode();
+	if( !sock->set_crypto_mode( range.encrypt ) ) {
+		rc = -1;
+		return false;
+	}
+
+	if( range.fd >= 0 ) {
+		lseek( range.fd, range.offset, SEEK_SET );
+	}
+	int result = sock->get_file( &bytes, range.fd, false, false, range.length, nullptr );
+	if( result == GET_FILE_WRITE_FAILED ) {
+			// get_file() kept reading, so the stream is still usable.
+		rc = result;
+		err = errno;
+	}
+	else if( result < 0 ) {
+		rc = result;
+		err = errno;
+		return false;
+	}
+	if( !sock->end_of_message() ) {
+		rc = -1;
+		return false;
+	}
+	return true;
+}
+
+void
+FileTransferStreams::Run( Stream &stream )
+{
+	for( ;; ) {
+		Range range;
+		bool skip;
+		{
+			std::unique_lock<std::mutex> lock( m_mutex );
+			m_cv.wait( lock, [&]{ return !stream.queue.empty() || m_closing; } );
+			if( stream.queue.empty() ) {
+				return;
+			}
+			range = stream.queue.front();
+			stream.queue.pop_front();
+			skip = m_aborting || stream.failed;
+		}
+
+		double start = condor_gettimestamp_double();
+		filesize_t bytes = 0;
+		int rc = 0;
+		int err = 0;
+		bool stream_ok = false;
+		if( skip ) {
+			rc = -1;
+		}
+		else if( m_sending ) {
+			stream_ok = SendRange( stream, range, bytes, rc, err );
+		}
+		else {
+			stream_ok = ReceiveRange( stream, range, bytes, rc, err );
+		}
+		if( range.fd >= 0 ) {
+			close( range.fd );
+		}
+		double end = condor_gettimestamp_double();
+
+		std::lock_guard<std::mutex> lock( m_mutex );
+		stream.busy += end - start;
+		stream.bytes += bytes;
+		if( !stream_ok && !skip ) {
+			dprintf( D_ALWAYS, "FileTransferStreams: data stream to %s failed while %s %s.\n",
+					 stream.sock->peer_description(), m_sending ? "sending" : "receiving",
+					 range.file->name.c_str() );
+			stream.failed = true;
+			m_stream_failed = true;
+		}
+		File *file = range.file;
+		file->stats.TransferFileBytes += bytes;
+		file->stats.TransferTotalBytes += bytes;
+		if( rc && !file->rc ) {
+			file->rc = rc;
+			file->error_errno = err;
+		}
+		if( --file->pending == 0 ) {
+			file->stats.TransferEndTime = condor_gettimestamp_double();
+			file->stats.ConnectionTimeSeconds = file->stats.TransferEndTime - file->stats.TransferStartTime;
+			file->stats.TransferSuccess = file->rc == 0;
+		}
+	}
+}
+
+void
+FileTransferStreams::Stop( bool abort )
+{
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		if( m_closing && !abort ) {
+			return;
+		}
+		m_closing = true;
+		if( abort ) {
+			m_aborting = true;
+		}
+	}
+	m_cv.notify_all();
+
+	for( auto &stream : m_streams ) {
+		if( abort && stream->thread.joinable() ) {
+				// Knock the thread out of any blocking send or receive.
+			shutdown( stream->sock->get_file_desc(), 2 );
+		}
+	}
+	for( auto &stream : m_streams ) {
+		if( stream->thread.joinable() ) {
+			stream->thread.join();
+		}
+	}
+	m_end_time = condor_gettimestamp_double();
+}
+
+bool
+FileTransferStreams::Finish()
+{
+	Stop( false );
+
+	if( m_stream_failed ) {
+		return false;
+	}
+	for( auto &file : m_files ) {
+		if( file->rc ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void
+FileTransferStreams::PublishStats( ClassAd &ad ) const
+{
+	filesize_t total = 0;
+	std::string stream_bytes;
+	std::string stream_seconds;
+	for( auto &stream : m_streams ) {
+		total += stream->bytes;
+		formatstr_cat( stream_bytes, "%s%lld", stream_bytes.empty() ? "" : ",", (long long)stream->bytes );
+		formatstr_cat( stream_seconds, "%s%.3f", stream_seconds.empty() ? "" : ",", stream->busy );
+	}
+	double elapsed = m_end_time - m_start_time;
+
+	ad.Assign( "TransferProtocol", "cedar" );
+	ad.Assign( "TransferType", m_sending ? "upload" : "download" );
+	ad.Assign( ATTR_TRANSFER_STREAMS, (int)m_streams.size() );
+	ad.Assign( "TransferFiles", (int)m_files.size() );
+	ad.Assign( "TransferTotalBytes", total );
+	ad.Assign( "ConnectionTimeSeconds", elapsed );
+	ad.Assign( "TransferBytesPerSecond", elapsed > 0 ? total / elapsed : 0.0 );
+	ad.Assign( "TransferStreamBytes", stream_bytes );
+	ad.Assign( "TransferStreamSeconds", stream_seconds );
+	ad.Assign( "TransferSuccess", !m_stream_failed );
+}
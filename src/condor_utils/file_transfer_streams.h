@@ -0,0 +1,162 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2019, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef _FILE_TRANSFER_STREAMS_H
+#define _FILE_TRANSFER_STREAMS_H
+
+#include "condor_common.h"
+#include "reli_sock.h"
+#include "file_transfer_stats.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Extra data connections that FileTransfer opens next to its command
+ * socket when both peers set FILE_TRANSFER_STREAMS above 1.  The command
+ * socket still carries every file name, go-ahead and ack; only the
+ * contents of plain files move over the streams.  Small files go whole
+ * to whichever stream has been given the fewest bytes so far, and large
+ * files are cut into one range per stream.  Each stream is driven by its
+ * own thread, which works through the files queued for it in the same
+ * order on both sides, so the streams need no framing of their own.
+ */
+class FileTransferStreams {
+public:
+		// A file queued on the streams, and what became of it.
+	struct File {
+		std::string name;
+		filesize_t size{0};
+		condor_mode_t mode{NULL_FILE_PERMISSIONS};
+		FileTransferStats stats;
+			// 0, or the GET_FILE_* / PUT_FILE_* code of the first failure
+		int rc{0};
+		int error_errno{0};
+		int pending{0};
+
+			// Things the receiving FileTransfer finishes off once the
+			// file has arrived; see FileTransfer::DoDownload().
+		bool make_executable{false};
+		bool reuse{false};
+		std::string reuse_checksum;
+		std::string reuse_checksum_type;
+	};
+
+	FileTransferStreams();
+
+		// Abandons anything still queued and closes the streams.
+	~FileTransferStreams();
+
+		/** Open up to count data connections alongside s.  The side
+			that received the transfer connection (listen == true)
+			listens and the other side connects; if the connections
+			can't be made, both sides end up with Count() == 0 and
+			carry on over s alone.
+			@return false only if communication on s failed */
+	bool Open( ReliSock *s, bool listen, int count );
+
+	size_t Count() const { return m_streams.size(); }
+
+		/** Sender: tell the peer whether fullname follows on s as usual
+			or over the streams, and queue it if the latter.
+			@param allowed false to force the file onto s
+			@return 1 if queued (bytes is set), 0 if the caller must
+			send the file on s itself, -1 if communication on s failed */
+	int SendFile( ReliSock *s, const char *fullname, filesize_t max_bytes,
+			bool send_mode, bool allowed, filesize_t &bytes );
+
+		/** Receiver: the counterpart of SendFile().
+			@return 1 if queued (file is set), 0 if the file follows
+			on s as usual, -1 if communication on s failed */
+	int ReceiveFile( ReliSock *s, const char *fullname, filesize_t max_bytes,
+			File *&file );
+
+		/** Wait for everything queued to finish and stop the threads.
+			@return false if any file failed; see Files() and
+			StreamFailed() for why */
+	bool Finish();
+
+		// True if a stream broke, as opposed to a file failing to open
+		// or write at either end.
+	bool StreamFailed() const { return m_stream_failed; }
+
+	const std::vector<std::unique_ptr<File>> &Files() const { return m_files; }
+
+		// Totals and per-stream bytes and busy time, for the transfer
+		// statistics log.
+	void PublishStats( ClassAd &ad ) const;
+
+private:
+	struct Range {
+		File *file;
+		int fd;
+		filesize_t offset;
+		filesize_t length;
+		bool encrypt;
+	};
+
+	struct Stream {
+		std::unique_ptr<ReliSock> sock;
+		std::thread thread;
+		std::deque<Range> queue;
+		filesize_t assigned{0};
+		filesize_t bytes{0};
+		double busy{0};
+		bool failed{false};
+	};
+
+	void Start();
+	void InitStats( File &file, const char *type );
+	void Run( Stream &stream );
+		// Move one range over the stream.  A file-level failure is
+		// reported through rc and err; false means the stream broke.
+	bool SendRange( Stream &stream, Range &range, filesize_t &bytes, int &rc, int &err );
+	bool ReceiveRange( Stream &stream, Range &range, filesize_t &bytes, int &rc, int &err );
+	void Stop( bool abort );
+	int LeastAssignedStream() const;
+
+	bool m_sending{false};
+	std::vector<std::unique_ptr<Stream>> m_streams;
+	std::vector<std::unique_ptr<File>> m_files;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_closing{false};
+	bool m_aborting{false};
+	bool m_stream_failed{false};
+	double m_start_time{0};
+	double m_end_time{0};
+};
+
+	// Resets the owner of a FileTransferStreams when it goes out of
+	// scope, so returning early from a transfer aborts the streams.
+class FileTransferStreamsReset {
+public:
+	explicit FileTransferStreamsReset( std::unique_ptr<FileTransferStreams> &streams )
+		: m_streams( streams ) {}
+	~FileTransferStreamsReset() { m_streams.reset(); }
+private:
+	std::unique_ptr<FileTransferStreams> &m_streams;
+};
+
+#endif
@@ -459,6 +459,9 @@ ProcFamilyProxy::start_procd()
 	if (param_boolean("USE_PSS", false)) {
 		env.SetEnv("_condor_USE_PSS=TRUE");
 	}
+	if (!param_boolean("PROCD_USE_PROC_EVENTS", true)) {
+		env.SetEnv("_condor_PROCD_USE_PROC_EVENTS=FALSE");
+	}
 
 	// the (optional) maximum snapshot interval
 	// (the procd will default to every minute)